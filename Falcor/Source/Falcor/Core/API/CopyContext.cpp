@@ -68,6 +68,11 @@ namespace Falcor
         }
     }
 
+    bool CopyContext::ReadTextureTask::isComplete() const
+    {
+        return mpFence->getGpuValue() >= mpFence->getCpuValue() - 1;
+    }
+
     CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
     {
         return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
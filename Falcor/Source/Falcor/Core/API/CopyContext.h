@@ -45,6 +45,10 @@ namespace Falcor
             using SharedPtr = std::shared_ptr<ReadTextureTask>;
             static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
             std::vector<uint8_t> getData();
+
+            /** Check if the GPU has finished the copy, in which case getData() returns without waiting.
+            */
+            bool isComplete() const;
         private:
             ReadTextureTask() = default;
             GpuFence::SharedPtr mpFence;
@@ -153,7 +153,7 @@ namespace Falcor
         return pSwapChain3;
     }
 
-    DeviceHandle createDevice(IDXGIFactory4* pFactory, D3D_FEATURE_LEVEL requestedFeatureLevel, const std::vector<UUID>& experimentalFeatures)
+    DeviceHandle createDevice(IDXGIFactory4* pFactory, D3D_FEATURE_LEVEL requestedFeatureLevel, const std::vector<UUID>& experimentalFeatures, bool useSoftwareAdapter)
     {
         // Feature levels to try creating devices. Listed in descending order so the highest supported level is used.
         const static D3D_FEATURE_LEVEL kFeatureLevels[] =
@@ -278,8 +278,16 @@ namespace Falcor
             }
         }
 
-        // Retrieve the adapter that's been selected
-        FALCOR_D3D_CALL(pFactory->EnumAdapters1(selectedAdapterIndex, &pAdapter));
+        // Retrieve the adapter that's been selected, or the WARP software adapter if requested
+        if (useSoftwareAdapter)
+        {
+            logDebug("Using the WARP software adapter");
+            FALCOR_D3D_CALL(pFactory->EnumWarpAdapter(IID_PPV_ARGS(&pAdapter)));
+        }
+        else
+        {
+            FALCOR_D3D_CALL(pFactory->EnumAdapters1(selectedAdapterIndex, &pAdapter));
+        }
 
         if (requestedFeatureLevel == 0) createMaxFeatureLevel(kFeatureLevels, (uint32_t)arraysize(kFeatureLevels));
         else createMaxFeatureLevel(&requestedFeatureLevel, 1);
@@ -489,7 +497,7 @@ namespace Falcor
 
         // Create the device
         logDebug("Creating D3D12 device");
-        mApiHandle = createDevice(mpApiData->pDxgiFactory, getD3DFeatureLevel(mDesc.apiMajorVersion, mDesc.apiMinorVersion), mDesc.experimentalFeatures);
+        mApiHandle = createDevice(mpApiData->pDxgiFactory, getD3DFeatureLevel(mDesc.apiMajorVersion, mDesc.apiMinorVersion), mDesc.experimentalFeatures, mDesc.useSoftwareAdapter);
         if (mApiHandle == nullptr) return false;
 
         mSupportedFeatures = querySupportedFeatures(mApiHandle);
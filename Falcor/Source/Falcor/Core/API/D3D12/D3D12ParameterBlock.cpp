@@ -824,8 +824,9 @@ namespace Falcor
 
         auto pSlangTypeLayout = mpSpecializedReflector->getElementType()->getSlangTypeLayout();
 
-        auto requiredSize = pSlangTypeLayout->getSize();
-        if(auto pSlangPendingTypeLayout = pSlangTypeLayout->getPendingDataTypeLayout() )
+        // Reflection restored from the shader cache has no Slang type layout, but is never specialized.
+        size_t requiredSize = pSlangTypeLayout ? pSlangTypeLayout->getSize() : mpSpecializedReflector->getElementType()->getByteSize();
+        if(auto pSlangPendingTypeLayout = pSlangTypeLayout ? pSlangTypeLayout->getPendingDataTypeLayout() : nullptr )
         {
             // Note: In this case, the type being stored in this block has been specialized
             // (because concrete types have been plugged in for its interface-type fields),
@@ -1419,9 +1420,10 @@ namespace Falcor
         auto pSlangTypeLayout = getElementType()->getSlangTypeLayout();
 
         // If the element type has no unspecialized existential/interface types
-        // in it, then there is nothing to be done.
+        // in it, then there is nothing to be done. This is always the case for
+        // reflection restored from the shader cache, which has no Slang type layout.
         //
-        if( pSlangTypeLayout && pSlangTypeLayout->getSize(slang::ParameterCategory::ExistentialTypeParam) == 0 )
+        if( !pSlangTypeLayout || pSlangTypeLayout->getSize(slang::ParameterCategory::ExistentialTypeParam) == 0 )
         {
             mpSpecializedReflector = mpReflector;
             return false;
@@ -347,11 +347,8 @@ namespace Falcor
 
     void Texture::uploadInitData(const void* pData, bool autoGenMips)
     {
-        // TODO: This is a hack to allow multi-threaded texture loading using AsyncTextureLoader.
-        // Replace with something better.
-        static std::mutex mutex;
-        std::lock_guard<std::mutex> lock(mutex);
-
+        // Note: This uses the device's render context, which is not thread-safe.
+        // AsyncTextureLoader decodes on its worker threads but creates textures on the thread calling uploadStagedTextures().
         FALCOR_ASSERT(gpDevice);
         auto pRenderContext = gpDevice->getRenderContext();
         if (autoGenMips)
@@ -0,0 +1,133 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "StagedBufferUploader.h"
+#include "Core/API/CopyContext.h"
+
+namespace Falcor
+{
+    StagedBufferUploader::SharedPtr StagedBufferUploader::create(size_t mergeGap)
+    {
+        return SharedPtr(new StagedBufferUploader(mergeGap));
+    }
+
+    void StagedBufferUploader::setBlob(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size)
+    {
+        checkArgument(pBuffer != nullptr, "'pBuffer' must be a valid buffer.");
+        if (offset + size > pBuffer->getSize())
+        {
+            throw ArgumentError("'offset' ({}) and 'size' ({}) don't fit the buffer size {}.", offset, size, pBuffer->getSize());
+        }
+        if (size == 0) return;
+
+        // Buffers on the upload heap don't need staging.
+        if (pBuffer->getCpuAccess() == Buffer::CpuAccess::Write)
+        {
+            pBuffer->setBlob(pData, offset, size);
+            return;
+        }
+
+        auto& state = mBuffers[pBuffer.get()];
+        if (!state.pBuffer)
+        {
+            state.pBuffer = pBuffer;
+            state.shadow.resize(pBuffer->getSize());
+        }
+        FALCOR_ASSERT(state.shadow.size() == pBuffer->getSize());
+
+        std::memcpy(state.shadow.data() + offset, pData, size);
+        state.dirtyRanges.markDirty(offset, size);
+        mPendingWriteCount++;
+    }
+
+    void StagedBufferUploader::flush(CopyContext* pCopyContext)
+    {
+        FALCOR_ASSERT(pCopyContext);
+
+        Stats stats;
+        stats.writeCount = mPendingWriteCount;
+        mPendingWriteCount = 0;
+
+        // Coalesce the dirty ranges and compute the total staging size.
+        size_t stagingSize = 0;
+        for (auto& [pKey, state] : mBuffers)
+        {
+            if (!state.dirtyRanges.isDirty()) continue;
+
+            // Gaps can only be included if the shadow copy holds valid data everywhere.
+            state.dirtyRanges.setMergeGap(state.isMirrored ? mMergeGap : 0);
+            const auto& ranges = state.dirtyRanges.getRanges();
+            if (ranges.size() == 1 && ranges[0].offset == 0 && ranges[0].size == state.shadow.size()) state.isMirrored = true;
+
+            for (const auto& range : ranges) stagingSize += range.size;
+            stats.rangeCount += ranges.size();
+            stats.bufferCount++;
+        }
+        stats.byteCount = stagingSize;
+
+        if (stagingSize > 0)
+        {
+            // Pack all ranges into a single allocation on the upload heap and record the copies.
+            Buffer::SharedPtr pStaging = Buffer::create(stagingSize, Resource::BindFlags::None, Buffer::CpuAccess::Write, nullptr);
+            uint8_t* pDst = static_cast<uint8_t*>(pStaging->map(Buffer::MapType::Write));
+
+            size_t stagingOffset = 0;
+            for (auto& [pKey, state] : mBuffers)
+            {
+                if (!state.dirtyRanges.isDirty()) continue;
+
+                for (const auto& range : state.dirtyRanges.getRanges())
+                {
+                    std::memcpy(pDst + stagingOffset, state.shadow.data() + range.offset, range.size);
+                    pCopyContext->copyBufferRegion(state.pBuffer.get(), range.offset, pStaging.get(), stagingOffset, range.size);
+                    stagingOffset += range.size;
+                }
+                state.dirtyRanges.clear();
+            }
+            FALCOR_ASSERT(stagingOffset == stagingSize);
+            pStaging->unmap();
+        }
+
+        // Release buffers that are no longer referenced elsewhere.
+        for (auto it = mBuffers.begin(); it != mBuffers.end();)
+        {
+            if (it->second.pBuffer.use_count() == 1) it = mBuffers.erase(it);
+            else ++it;
+        }
+
+        mLastFlushStats = stats;
+        mTotalStats += stats;
+    }
+
+    uint64_t StagedBufferUploader::getShadowMemoryInBytes() const
+    {
+        uint64_t bytes = 0;
+        for (const auto& [pKey, state] : mBuffers) bytes += state.shadow.size();
+        return bytes;
+    }
+}
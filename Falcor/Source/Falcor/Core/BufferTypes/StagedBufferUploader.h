@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Buffer.h"
+#include "Utils/Algorithm/DirtyRangeTracker.h"
+#include <unordered_map>
+
+namespace Falcor
+{
+    class CopyContext;
+
+    /** Helper for batching CPU-side updates to GPU buffers.
+
+        Buffers without CPU write access are normally updated with Buffer::setBlob(),
+        which allocates a separate upload buffer and records a copy for every call.
+        This class instead keeps a CPU shadow copy of each registered buffer and
+        tracks the dirty byte ranges. On flush(), the dirty ranges of all buffers are
+        coalesced, packed into a single staging allocation on the upload heap and
+        copied with one copy command per coalesced range.
+
+        Once a buffer has been fully written, the shadow copy mirrors the GPU contents
+        and ranges separated by small gaps are merged to further reduce the number of copies.
+
+        Buffers are registered implicitly on the first write. A buffer is released
+        when the uploader holds the only reference to it after a flush.
+    */
+    class FALCOR_API StagedBufferUploader
+    {
+    public:
+        using SharedPtr = std::shared_ptr<StagedBufferUploader>;
+
+        static const size_t kDefaultMergeGap = 256;
+
+        /** Upload statistics.
+        */
+        struct Stats
+        {
+            uint64_t writeCount = 0;        ///< Number of setBlob()/setElement() calls.
+            uint64_t bufferCount = 0;       ///< Number of buffers that were updated.
+            uint64_t rangeCount = 0;        ///< Number of coalesced ranges, i.e. copy commands issued.
+            uint64_t byteCount = 0;         ///< Number of bytes uploaded.
+
+            Stats& operator+=(const Stats& other)
+            {
+                writeCount += other.writeCount;
+                bufferCount += other.bufferCount;
+                rangeCount += other.rangeCount;
+                byteCount += other.byteCount;
+                return *this;
+            }
+        };
+
+        /** Create a new uploader.
+            \param[in] mergeGap Dirty ranges separated by at most this many bytes are uploaded as one range.
+            \return New object, or throws an exception if creation failed.
+        */
+        static SharedPtr create(size_t mergeGap = kDefaultMergeGap);
+
+        /** Write data to a buffer. The data is copied to the shadow copy and uploaded on the next flush().
+            Buffers with CPU write access are written directly.
+            \param[in] pBuffer The destination buffer.
+            \param[in] pData Pointer to the data.
+            \param[in] offset Destination offset in bytes.
+            \param[in] size Size of the data in bytes.
+        */
+        void setBlob(const Buffer::SharedPtr& pBuffer, const void* pData, size_t offset, size_t size);
+
+        /** Write a single element to a structured buffer.
+            \param[in] pBuffer The destination buffer.
+            \param[in] index Element index.
+            \param[in] value The element.
+        */
+        template<typename T>
+        void setElement(const Buffer::SharedPtr& pBuffer, uint32_t index, const T& value)
+        {
+            setBlob(pBuffer, &value, sizeof(T) * index, sizeof(T));
+        }
+
+        /** Returns true if there are writes that have not been flushed.
+        */
+        bool hasPendingUploads() const { return mPendingWriteCount > 0; }
+
+        /** Record the copies for all pending writes.
+            \param[in] pCopyContext The copy context.
+        */
+        void flush(CopyContext* pCopyContext);
+
+        /** Drop the shadow copy of a buffer. Pending writes to the buffer are discarded.
+        */
+        void releaseBuffer(const Buffer* pBuffer) { mBuffers.erase(pBuffer); }
+
+        /** Get the statistics of the last flush.
+        */
+        const Stats& getLastFlushStats() const { return mLastFlushStats; }
+
+        /** Get the statistics accumulated over all flushes.
+        */
+        const Stats& getTotalStats() const { return mTotalStats; }
+
+        /** Get the memory in bytes used by the shadow copies.
+        */
+        uint64_t getShadowMemoryInBytes() const;
+
+    private:
+        StagedBufferUploader(size_t mergeGap) : mMergeGap(mergeGap) {}
+
+        struct BufferState
+        {
+            Buffer::SharedPtr pBuffer;
+            std::vector<uint8_t> shadow;            ///< CPU copy of the buffer contents.
+            DirtyRangeTracker dirtyRanges;
+            bool isMirrored = false;                ///< True if the whole buffer has been written, so the shadow copy matches the GPU contents.
+        };
+
+        size_t mMergeGap;
+        std::unordered_map<const Buffer*, BufferState> mBuffers;
+        uint64_t mPendingWriteCount = 0;
+
+        Stats mLastFlushStats;
+        Stats mTotalStats;
+    };
+}
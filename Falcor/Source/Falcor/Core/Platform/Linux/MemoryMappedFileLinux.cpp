@@ -25,41 +25,40 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
-#include "Utils/Math/MathConstants.slangh"
+#include "stdafx.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-import Scene.SDFs.SDF3DPrimitive;
-import Utils.Math.PackedFormats;
-
-#define GROUP_WIDTH 4
-
-cbuffer CB
-{
-    uint gGridWidth;
-    uint gPrimitiveCount;
-};
-
-StructuredBuffer<SDF3DPrimitive> gPrimitives;
-RWBuffer<float> gValues;
-
-[numthreads(GROUP_WIDTH, GROUP_WIDTH, GROUP_WIDTH)]
-void main(uint3 dispatchThreadID : SV_DispatchThreadID, uint3 groupThreadID : SV_GroupThreadID)
+namespace Falcor
 {
-    if (any(dispatchThreadID >= gGridWidth + 1)) return;
+    bool MemoryMappedFile::platformMap()
+    {
+        int fd = open(mPath.c_str(), O_RDONLY);
+        if (fd == -1) return false;
 
-    const uint3 valueCoords = dispatchThreadID;
+        struct stat st;
+        if (fstat(fd, &st) == -1 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
 
-    // Calculate the grid position of the value coordinates.
-    const float3 p = -0.5f + float3(valueCoords) / gGridWidth;
+        // The mapping stays valid after the file descriptor is closed.
+        void* pData = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (pData == MAP_FAILED) return false;
 
-    // Evaluate the signed distance value.
-    float sd = FLT_MAX;
+        madvise(pData, (size_t)st.st_size, MADV_RANDOM);
+        mpData = pData;
+        mSize = (size_t)st.st_size;
+        return true;
+    }
 
-    for (uint primitiveID = 0; primitiveID < gPrimitiveCount; primitiveID++)
+    void MemoryMappedFile::platformUnmap()
     {
-        SDF3DPrimitive primitive = gPrimitives[primitiveID];
-        sd = primitive.eval(p, sd);
+        munmap(const_cast<void*>(mpData), mSize);
     }
-
-    uint writeLocation = flatten3D(valueCoords, gGridWidth + 1, gGridWidth + 1);
-    gValues[writeLocation] = sd;
 }
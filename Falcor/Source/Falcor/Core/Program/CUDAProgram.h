@@ -78,6 +78,9 @@ namespace Falcor
             std::string& log,
             const std::string& name = "") const override;
 
+        // CUDA kernels are created from the specialized Slang program, which is not stored in the shader cache.
+        virtual bool canRestoreCachedKernels() const override { return false; }
+
     private:
         CUDAProgram() = default;
     };
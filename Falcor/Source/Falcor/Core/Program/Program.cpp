@@ -29,6 +29,9 @@
 #include "Program.h"
 #include "Utils/StringUtils.h"
 #include <slang/slang.h>
+#include <condition_variable>
+#include <thread>
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -40,6 +43,117 @@ namespace Falcor
 
     static Program::DefineList sGlobalDefineList;
     static bool sGenerateDebugInfo;
+    static std::mutex sCompilationStatsMutex;
+    static ShaderCache::SharedPtr spShaderCache;
+
+    namespace
+    {
+        /** Hash the contents of a file. Hashes are memoized per file and modification time, as the same
+            headers are included by most programs.
+        */
+        SHA1::MD hashFileContents(const std::string& path)
+        {
+            static std::mutex sMutex;
+            static std::unordered_map<std::string, std::pair<time_t, SHA1::MD>> sFileHashes;
+
+            time_t modifiedTime = getFileModifiedTime(path);
+            {
+                std::lock_guard<std::mutex> lock(sMutex);
+                auto it = sFileHashes.find(path);
+                if (it != sFileHashes.end() && it->second.first == modifiedTime) return it->second.second;
+            }
+
+            std::string contents = readFile(path);
+            SHA1::MD md = SHA1::compute(contents.data(), contents.size());
+
+            std::lock_guard<std::mutex> lock(sMutex);
+            sFileHashes[path] = { modifiedTime, md };
+            return md;
+        }
+
+        /** Entry point index used for the cache key of the serialized program reflection.
+        */
+        const uint32_t kReflectionCacheIndex = uint32_t(-1);
+
+        /** Entry point index used for the cache key of the serialized program version reflection.
+        */
+        const uint32_t kVersionReflectionCacheIndex = uint32_t(-2);
+
+        /** Entry point index used for the cache key of the list of files a program version depends on.
+        */
+        const uint32_t kDependencyListCacheIndex = uint32_t(-3);
+
+        ShaderCache::Key computeKernelCacheKey(const ShaderCache::Key& versionKey, const std::string& specializationKey, uint32_t entryPointIndex)
+        {
+            SHA1 sha1;
+            sha1.update(versionKey.data(), versionKey.size());
+            sha1.update(specializationKey.data(), specializationKey.size());
+            sha1.update(&entryPointIndex, sizeof(entryPointIndex));
+            return sha1.final();
+        }
+
+        /** Compute the cache key of a program version from the key of its compiler options and the contents of
+            the files it depends on. Paths are not hashed so that the key does not depend on the install location.
+        */
+        ShaderCache::Key computeVersionCacheKey(const ShaderCache::Key& optionsKey, const std::vector<std::string>& dependencyFiles)
+        {
+            SHA1 sha1;
+            sha1.update(optionsKey.data(), optionsKey.size());
+            for (const auto& path : dependencyFiles)
+            {
+                SHA1::MD md = hashFileContents(path);
+                sha1.update(md.data(), md.size());
+            }
+            return sha1.final();
+        }
+
+        /** Serialize a list of dependency files. Files in the shader directories are stored relative to them,
+            so that a shader cache bundle can be used from another install location.
+        */
+        std::string serializeDependencyList(const std::vector<std::string>& dependencyFiles)
+        {
+            std::string data;
+            for (const auto& path : dependencyFiles)
+            {
+                std::filesystem::path storedPath = std::filesystem::path(path).lexically_normal();
+                for (const auto& dir : getShaderDirectoriesList())
+                {
+                    auto relativePath = storedPath.lexically_relative(std::filesystem::path(dir).lexically_normal());
+                    if (!relativePath.empty() && *relativePath.begin() != "..")
+                    {
+                        storedPath = relativePath;
+                        break;
+                    }
+                }
+                data += storedPath.generic_string() + "\n";
+            }
+            return data;
+        }
+
+        /** Resolve a list of dependency files written by serializeDependencyList().
+            \return False if any of the files does not exist.
+        */
+        bool deserializeDependencyList(const Shader::Blob& blob, std::vector<std::string>& dependencyFiles)
+        {
+            std::string data(static_cast<const char*>(blob->getBufferPointer()), blob->getBufferSize());
+            for (const auto& storedPath : splitString(data, "\n"))
+            {
+                if (storedPath.empty()) continue;
+                std::string fullPath;
+                if (std::filesystem::path(storedPath).is_absolute())
+                {
+                    if (!std::filesystem::exists(storedPath)) return false;
+                    fullPath = storedPath;
+                }
+                else if (!findFileInShaderDirectories(storedPath, fullPath))
+                {
+                    return false;
+                }
+                dependencyFiles.push_back(fullPath);
+            }
+            return !dependencyFiles.empty();
+        }
+    }
 
     static Shader::SharedPtr createShaderFromBlob(const Shader::Blob& shaderBlob, ShaderType shaderType, const std::string& entryPointName, Shader::CompilerFlags flags, std::string& log)
     {
@@ -395,12 +509,85 @@ namespace Falcor
         return result;
     }
 
+    // Slang global sessions are not thread-safe. Threads compiling programs concurrently use their own session, see CompilerThreadPool.
+    static thread_local slang::IGlobalSession* tpThreadSlangGlobalSession = nullptr;
+
     slang::IGlobalSession* getSlangGlobalSession()
     {
+        if (tpThreadSlangGlobalSession) return tpThreadSlangGlobalSession;
         static slang::IGlobalSession* pSlangGlobalSession = createSlangGlobalSession();
         return pSlangGlobalSession;
     }
 
+    namespace
+    {
+        /** Pool of threads for compiling programs concurrently.
+            Each thread creates its own Slang global session on startup. The programs compiled on a thread keep referring
+            to its session, so the threads (like the main global session) live until the process exits.
+        */
+        class CompilerThreadPool
+        {
+        public:
+            static CompilerThreadPool& instance()
+            {
+                // Intentionally never destroyed, the worker threads are idle at exit and terminated by the OS.
+                static CompilerThreadPool* spInstance = new CompilerThreadPool();
+                return *spInstance;
+            }
+
+            /** Run tasks on the pool and wait for all of them to finish.
+                \param[in] taskCount Number of tasks.
+                \param[in] task Function called with the index of each task. Must not throw.
+            */
+            void run(size_t taskCount, const std::function<void(size_t)>& task)
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                FALCOR_ASSERT(mpTask == nullptr);
+                mpTask = &task;
+                mTaskCount = taskCount;
+                mNextTask = 0;
+                mPendingCount = taskCount;
+                mWorkAvailable.notify_all();
+                mWorkDone.wait(lock, [this] { return mPendingCount == 0; });
+                mpTask = nullptr;
+            }
+
+        private:
+            static constexpr uint32_t kMaxThreadCount = 8;
+
+            CompilerThreadPool()
+            {
+                uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 1u, kMaxThreadCount);
+                for (uint32_t i = 0; i < threadCount; i++) std::thread(&CompilerThreadPool::runWorker, this).detach();
+            }
+
+            void runWorker()
+            {
+                tpThreadSlangGlobalSession = createSlangGlobalSession();
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (true)
+                {
+                    mWorkAvailable.wait(lock, [this] { return mpTask && mNextTask < mTaskCount; });
+                    size_t index = mNextTask++;
+                    const auto& task = *mpTask;
+                    lock.unlock();
+                    task(index);
+                    lock.lock();
+                    if (--mPendingCount == 0) mWorkDone.notify_one();
+                }
+            }
+
+            std::mutex mMutex;
+            std::condition_variable mWorkAvailable;
+            std::condition_variable mWorkDone;
+            const std::function<void(size_t)>* mpTask = nullptr;    ///< Task function of the current run, or nullptr if idle.
+            size_t mTaskCount = 0;
+            size_t mNextTask = 0;
+            size_t mPendingCount = 0;
+        };
+    }
+
     // Translation a Falcor `ShaderType` to the corresponding `SlangStage`
     SlangStage getSlangStage(ShaderType type)
     {
@@ -505,7 +692,7 @@ namespace Falcor
         }
 
         // Add program specific defines.
-        for (const auto& shaderDefine : getDefineList())
+        for (const auto& shaderDefine : defineList)
         {
             addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
         }
@@ -682,17 +869,41 @@ namespace Falcor
         CpuTimer timer;
         timer.update();
 
-        auto pSlangGlobalScope = pVersion->getSlangGlobalScope();
-        auto pSlangSession = pSlangGlobalScope->getSession();
-
 #ifdef FALCOR_D3D12
         // Global-scope specialization parameters apply to all the entry points
         // in a `Program`. We will collect the arguments for global specialization
         // parameters here, using the global `ProgramVars`.
         //
         ParameterBlock::SpecializationArgs specializationArgs;
-        pVars->collectSpecializationArgs(specializationArgs);
+        if (pVars) pVars->collectSpecializationArgs(specializationArgs);
+
+        // The kernels only depend on the program version and the specialization key,
+        // so they can be restored from the shader cache without running Slang at all.
+        //
+        const bool useCachedKernels = spShaderCache && canRestoreCachedKernels();
+        if (useCachedKernels)
+        {
+            if (auto pProgramKernels = createCachedProgramKernels(pVersion, pVars, log))
+            {
+                timer.update();
+                double time = timer.delta();
+                {
+                    std::lock_guard<std::mutex> lock(sCompilationStatsMutex);
+                    sCompilationStats.programKernelsCount++;
+                    sCompilationStats.programKernelsTotalTime += time;
+                    sCompilationStats.programKernelsMaxTime = std::max(sCompilationStats.programKernelsMaxTime, time);
+                }
+                logDebug("Restored program kernels from shader cache in {:.3f} s: {}", time, getProgramDescString());
+                return pProgramKernels;
+            }
+        }
+#endif
 
+        // Note: For versions restored from the shader cache this runs the Slang front end.
+        auto pSlangGlobalScope = pVersion->getSlangGlobalScope();
+        auto pSlangSession = pSlangGlobalScope->getSession();
+
+#ifdef FALCOR_D3D12
         // Next we instruct Slang to specialize the global scope based on
         // the global specialization arguments.
         //
@@ -838,28 +1049,41 @@ namespace Falcor
         ProgramReflection::SharedPtr pReflector;
         doSlangReflection(pVersion, pSpecializedSlangProgram, pLinkedEntryPoints, pReflector, log);
 
-#ifdef FALCOR_D3D12
         // Create Shader objects for each entry point and cache them here
         std::vector<Shader::SharedPtr> allShaders;
+#ifdef FALCOR_D3D12
         for (uint32_t i = 0; i < allEntryPointCount; i++)
         {
             auto pLinkedEntryPoint = pLinkedEntryPoints[i];
             auto entryPointDesc = mDesc.mEntryPoints[i];
 
+            // Look up the kernel in the shader cache before invoking the downstream compiler.
+            ShaderCache::Key cacheKey;
             Shader::Blob blob;
-            ComPtr<slang::IBlob> pSlangDiagnostics;
-            bool failed = SLANG_FAILED(pLinkedEntryPoint->getEntryPointCode(
-                /* entryPointIndex: */ 0,
-                /* targetIndex: */ 0,
-                blob.writeRef(),
-                pSlangDiagnostics.writeRef()));
-
-            if (pSlangDiagnostics && pSlangDiagnostics->getBufferSize() > 0)
+            if (spShaderCache)
             {
-                log += (char const*)pSlangDiagnostics->getBufferPointer();
+                cacheKey = computeKernelCacheKey(pVersion->getCacheKey(), ProgramVersion::getSpecializationKey(pVars), i);
+                blob = spShaderCache->find(cacheKey);
             }
 
-            if (failed) return nullptr;
+            if (!blob)
+            {
+                ComPtr<slang::IBlob> pSlangDiagnostics;
+                bool failed = SLANG_FAILED(pLinkedEntryPoint->getEntryPointCode(
+                    /* entryPointIndex: */ 0,
+                    /* targetIndex: */ 0,
+                    blob.writeRef(),
+                    pSlangDiagnostics.writeRef()));
+
+                if (pSlangDiagnostics && pSlangDiagnostics->getBufferSize() > 0)
+                {
+                    log += (char const*)pSlangDiagnostics->getBufferPointer();
+                }
+
+                if (failed) return nullptr;
+
+                if (spShaderCache) spShaderCache->add(cacheKey, blob);
+            }
 
             Shader::SharedPtr shader = createShaderFromBlob(blob, entryPointDesc.stage, entryPointDesc.name, mDesc.getCompilerFlags(), log);
             if (!shader) return nullptr;
@@ -868,6 +1092,83 @@ namespace Falcor
         }
 #endif
 
+#ifdef FALCOR_D3D12
+        // Store the reflection next to the kernels so that later runs can skip Slang entirely.
+        if (useCachedKernels && pReflector)
+        {
+            auto data = pReflector->serialize();
+            auto key = computeKernelCacheKey(pVersion->getCacheKey(), ProgramVersion::getSpecializationKey(pVars), kReflectionCacheIndex);
+            spShaderCache->add(key, ShaderCache::createBlob(data.data(), data.size()));
+        }
+#endif
+
+        auto descStr = getProgramDescString();
+        ProgramKernels::SharedPtr pProgramKernels = createProgramKernelsFromShaders(
+            pVersion,
+            pSpecializedSlangProgram,
+            pReflector,
+            allShaders,
+            log);
+
+        timer.update();
+        double time = timer.delta();
+        {
+            std::lock_guard<std::mutex> lock(sCompilationStatsMutex);
+            sCompilationStats.programKernelsCount++;
+            sCompilationStats.programKernelsTotalTime += time;
+            sCompilationStats.programKernelsMaxTime = std::max(sCompilationStats.programKernelsMaxTime, time);
+        }
+        logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
+
+        return pProgramKernels;
+    }
+
+    ProgramKernels::SharedPtr Program::createCachedProgramKernels(
+        ProgramVersion const* pVersion,
+        ProgramVars    const* pVars,
+        std::string         & log) const
+    {
+        std::vector<Shader::SharedPtr> allShaders;
+#ifdef FALCOR_D3D12
+        const std::string specializationKey = ProgramVersion::getSpecializationKey(pVars);
+
+        auto pReflectionBlob = spShaderCache->find(computeKernelCacheKey(pVersion->getCacheKey(), specializationKey, kReflectionCacheIndex));
+        if (!pReflectionBlob) return nullptr;
+
+        uint32_t allEntryPointCount = uint32_t(mDesc.mEntryPoints.size());
+        std::vector<Shader::Blob> blobs;
+        for (uint32_t i = 0; i < allEntryPointCount; i++)
+        {
+            auto blob = spShaderCache->find(computeKernelCacheKey(pVersion->getCacheKey(), specializationKey, i));
+            if (!blob) return nullptr;
+            blobs.push_back(blob);
+        }
+
+        auto pReflector = ProgramReflection::deserialize(pVersion, pReflectionBlob->getBufferPointer(), pReflectionBlob->getBufferSize());
+        if (!pReflector || pReflector->getEntryPointGroups().size() != mDesc.mGroups.size()) return nullptr;
+
+        for (uint32_t i = 0; i < allEntryPointCount; i++)
+        {
+            const auto& entryPointDesc = mDesc.mEntryPoints[i];
+            Shader::SharedPtr shader = createShaderFromBlob(blobs[i], entryPointDesc.stage, entryPointDesc.name, mDesc.getCompilerFlags(), log);
+            if (!shader) return nullptr;
+            allShaders.push_back(std::move(shader));
+        }
+
+        // The program kernels only need the reflection for D3D12, so no Slang program is required.
+        return createProgramKernelsFromShaders(pVersion, nullptr, pReflector, allShaders, log);
+#else
+        return nullptr;
+#endif
+    }
+
+    ProgramKernels::SharedPtr Program::createProgramKernelsFromShaders(
+        const ProgramVersion* pVersion,
+        slang::IComponentType* pSpecializedSlangProgram,
+        const ProgramReflection::SharedPtr& pReflector,
+        const std::vector<Shader::SharedPtr>& allShaders,
+        std::string& log) const
+    {
         // In order to construct the `ProgramKernels` we need to extract
         // the kernels for each entry-point group.
         //
@@ -898,23 +1199,13 @@ namespace Falcor
             entryPointGroups.push_back(pEntryPointGroupKernels);
         }
 
-        auto descStr = getProgramDescString();
-        ProgramKernels::SharedPtr pProgramKernels = createProgramKernels(
+        return createProgramKernels(
             pVersion,
             pSpecializedSlangProgram,
             pReflector,
             entryPointGroups,
             log,
-            descStr);
-
-        timer.update();
-        double time = timer.delta();
-        sCompilationStats.programKernelsCount++;
-        sCompilationStats.programKernelsTotalTime += time;
-        sCompilationStats.programKernelsMaxTime = std::max(sCompilationStats.programKernelsMaxTime, time);
-        logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
-
-        return pProgramKernels;
+            getProgramDescString());
     }
 
     ProgramKernels::SharedPtr Program::createProgramKernels(
@@ -934,36 +1225,32 @@ namespace Falcor
             name);
     }
 
-    ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(
-        std::string& log) const
+    bool Program::createSlangComponents(
+        const DefineList&                               defineList,
+        ComPtr<slang::IComponentType>&                  pSlangGlobalScope,
+        std::vector<ComPtr<slang::IComponentType>>&     pSlangEntryPoints,
+        std::vector<std::string>&                       dependencyFiles,
+        std::string&                                    log) const
     {
-        CpuTimer timer;
-        timer.update();
-
-        auto pSlangRequest = createSlangCompileRequest(mDefineList);
-        if (pSlangRequest == nullptr) return nullptr;
+        auto pSlangRequest = createSlangCompileRequest(defineList);
+        if (pSlangRequest == nullptr) return false;
 
         SlangResult slangResult = spCompile(pSlangRequest);
         log += spGetDiagnosticOutput(pSlangRequest);
         if (SLANG_FAILED(slangResult))
         {
             spDestroyCompileRequest(pSlangRequest);
-            return nullptr;
+            return false;
         }
 
-        ComPtr<slang::IComponentType> pSlangGlobalScope;
         spCompileRequest_getProgram(
             pSlangRequest,
             pSlangGlobalScope.writeRef());
 
-        ComPtr<slang::ISession> pSlangSession(pSlangGlobalScope->getSession());
-
-        std::vector<ComPtr<slang::IComponentType>> pSlangEntryPoints;
+        pSlangEntryPoints.clear();
         uint32_t entryPointCount = (uint32_t)mDesc.mEntryPoints.size();
         for (uint32_t ee = 0; ee < entryPointCount; ++ee)
         {
-            auto entryPointDesc = mDesc.mEntryPoints[ee];
-
             ComPtr<slang::IComponentType> pSlangEntryPoint;
             spCompileRequest_getEntryPoint(
                 pSlangRequest,
@@ -979,6 +1266,51 @@ namespace Falcor
         {
             std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
             mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            dependencyFiles.push_back(depFilePath);
+        }
+
+        return true;
+    }
+
+    ProgramVersion::SharedPtr Program::preprocessAndCreateProgramVersion(
+        std::string& log) const
+    {
+        CpuTimer timer;
+        timer.update();
+
+        const ShaderCache::Key optionsKey = computeOptionsCacheKey();
+
+#ifdef FALCOR_D3D12
+        // Look up the version before running the Slang front end. If the files it depends on are unchanged,
+        // its reflection is restored from the shader cache and Slang only runs if it is needed later on.
+        //
+        const bool useCachedVersion = spShaderCache && canRestoreCachedKernels();
+        if (useCachedVersion)
+        {
+            if (auto pVersion = createCachedProgramVersion(optionsKey))
+            {
+                timer.update();
+                double time = timer.delta();
+                {
+                    std::lock_guard<std::mutex> lock(sCompilationStatsMutex);
+                    sCompilationStats.programVersionCount++;
+                    sCompilationStats.programVersionTotalTime += time;
+                    sCompilationStats.programVersionMaxTime = std::max(sCompilationStats.programVersionMaxTime, time);
+                }
+                logDebug("Restored program version from shader cache in {:.3f} s: {}", time, getProgramDescString());
+                return pVersion;
+            }
+        }
+#else
+        const bool useCachedVersion = false;
+#endif
+
+        ComPtr<slang::IComponentType> pSlangGlobalScope;
+        std::vector<ComPtr<slang::IComponentType>> pSlangEntryPoints;
+        std::vector<std::string> dependencyFiles;
+        if (!createSlangComponents(mDefineList, pSlangGlobalScope, pSlangEntryPoints, dependencyFiles, log))
+        {
+            return nullptr;
         }
 
         // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -993,21 +1325,6 @@ namespace Falcor
         //
         ProgramVersion::SharedPtr pVersion = ProgramVersion::createEmpty(const_cast<Program*>(this), pSlangGlobalScope);
 
-        // Note: Because of interactions between how `SV_Target` outputs
-        // and `u` register bindings work in Slang today (as a compatibility
-        // feature for Shader Model 5.0 and below), we need to make sure
-        // that the entry points are included in the component type we use
-        // for reflection.
-        //
-        // TODO: Once Slang drops that behavior for SM 5.1+, we should be able
-        // to just use `pSlangGlobalScope` for the reflection step instead
-        // of `pSlangProgram`.
-        //
-        ComPtr<slang::IComponentType> pSlangProgram;
-        spCompileRequest_getProgram(
-            pSlangRequest,
-            pSlangProgram.writeRef());
-
         ProgramReflection::SharedPtr pReflector;
         if (!doSlangReflection(pVersion.get(), pSlangGlobalScope, pSlangEntryPoints, pReflector, log))
         {
@@ -1021,17 +1338,118 @@ namespace Falcor
             pReflector,
             descStr,
             pSlangEntryPoints);
+        pVersion->mCacheKey = computeVersionCacheKey(optionsKey, dependencyFiles);
+
+        // Store the dependency list and the reflection so that later runs can skip the front end.
+        // Versions with specialization parameters are not stored, as their parameter blocks need the Slang type layouts.
+        if (useCachedVersion && pSlangGlobalScope->getSpecializationParamCount() == 0)
+        {
+            auto dependencyList = serializeDependencyList(dependencyFiles);
+            spShaderCache->add(computeKernelCacheKey(optionsKey, "", kDependencyListCacheIndex), ShaderCache::createBlob(dependencyList.data(), dependencyList.size()));
+            auto data = pReflector->serialize();
+            spShaderCache->add(computeKernelCacheKey(pVersion->mCacheKey, "", kVersionReflectionCacheIndex), ShaderCache::createBlob(data.data(), data.size()));
+        }
 
         timer.update();
         double time = timer.delta();
-        sCompilationStats.programVersionCount++;
-        sCompilationStats.programVersionTotalTime += time;
-        sCompilationStats.programVersionMaxTime = std::max(sCompilationStats.programVersionMaxTime, time);
+        {
+            std::lock_guard<std::mutex> lock(sCompilationStatsMutex);
+            sCompilationStats.programVersionCount++;
+            sCompilationStats.programVersionTotalTime += time;
+            sCompilationStats.programVersionMaxTime = std::max(sCompilationStats.programVersionMaxTime, time);
+        }
         logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
 
         return pVersion;
     }
 
+    ProgramVersion::SharedPtr Program::createCachedProgramVersion(const ShaderCache::Key& optionsKey) const
+    {
+        auto pDependencyBlob = spShaderCache->find(computeKernelCacheKey(optionsKey, "", kDependencyListCacheIndex));
+        if (!pDependencyBlob) return nullptr;
+
+        std::vector<std::string> dependencyFiles;
+        if (!deserializeDependencyList(pDependencyBlob, dependencyFiles)) return nullptr;
+
+        // The version key covers the current contents of the dependencies, so edited files result in a cache miss.
+        ShaderCache::Key versionKey = computeVersionCacheKey(optionsKey, dependencyFiles);
+        auto pReflectionBlob = spShaderCache->find(computeKernelCacheKey(versionKey, "", kVersionReflectionCacheIndex));
+        if (!pReflectionBlob) return nullptr;
+
+        ProgramVersion::SharedPtr pVersion = ProgramVersion::createEmpty(const_cast<Program*>(this), nullptr);
+        auto pReflector = ProgramReflection::deserialize(pVersion.get(), pReflectionBlob->getBufferPointer(), pReflectionBlob->getBufferSize());
+        if (!pReflector || pReflector->getEntryPointGroups().size() != mDesc.mGroups.size()) return nullptr;
+
+        pVersion->init(
+            mDefineList,
+            mTypeConformanceList,
+            pReflector,
+            getProgramDescString(),
+            {});
+        pVersion->mCacheKey = versionKey;
+
+        // Track the dependencies for hot reloading as if the front end had run.
+        mFileTimeMap.clear();
+        for (const auto& path : dependencyFiles) mFileTimeMap[path] = getFileModifiedTime(path);
+
+        return pVersion;
+    }
+
+    ShaderCache::Key Program::computeOptionsCacheKey() const
+    {
+        SHA1 sha1;
+        auto hashString = [&sha1](const std::string& str)
+        {
+            uint64_t length = str.size();
+            sha1.update(&length, sizeof(length));
+            sha1.update(str.data(), str.size());
+        };
+
+        // Compiler version and target.
+        hashString(spGetBuildTagString());
+        slang::TargetDesc targetDesc;
+        const char* targetMacroName = "";
+        setUpSlangCompilationTarget(targetDesc, targetMacroName);
+        sha1.update(&targetDesc.format, sizeof(targetDesc.format));
+        hashString(targetMacroName);
+
+        // Program description and compiler options.
+        hashString(getProgramDescString());
+        for (const auto& src : mDesc.mSources)
+        {
+            if (src.type == Desc::Source::Type::String) hashString(src.str);
+        }
+        for (const auto& entryPoint : mDesc.mEntryPoints)
+        {
+            hashString(entryPoint.name);
+            sha1.update(&entryPoint.stage, sizeof(entryPoint.stage));
+        }
+        hashString(mDesc.mShaderModel);
+        Shader::CompilerFlags compilerFlags = mDesc.getCompilerFlags();
+        sha1.update(&compilerFlags, sizeof(compilerFlags));
+        sha1.update(&sGenerateDebugInfo, sizeof(sGenerateDebugInfo));
+        for (const auto& arg : mDesc.mCompilerArguments) hashString(arg);
+
+        // Defines and type conformances.
+        for (const DefineList* pDefines : { &sGlobalDefineList, &mDefineList })
+        {
+            hashString("defines");
+            for (const auto& [name, value] : *pDefines)
+            {
+                hashString(name);
+                hashString(value);
+            }
+        }
+        for (const auto& [conformance, id] : mTypeConformanceList)
+        {
+            hashString(conformance.mTypeName);
+            hashString(conformance.mInterfaceName);
+            sha1.update(&id, sizeof(id));
+        }
+
+        return sha1.final();
+    }
+
     EntryPointGroupKernels::SharedPtr Program::createEntryPointGroupKernels(
         const std::vector<Shader::SharedPtr>& shaders,
         EntryPointBaseReflection::SharedPtr const& pReflector) const
@@ -1068,6 +1486,92 @@ namespace Falcor
         }
     }
 
+    std::vector<Program::CompileResult> Program::compilePrograms(const std::vector<CompileRequest>& requests)
+    {
+        struct Task
+        {
+            CompileRequest request;
+            CompileResult result;
+            ProgramVersion::SharedPtr pVersion;
+            ProgramKernels::SharedPtr pKernels;
+            std::string specializationKey;
+            std::string log;
+        };
+
+        // Collect the programs that need a new version. Each program is compiled at most once.
+        std::vector<Task> tasks;
+        std::unordered_set<const Program*> programs;
+        for (const auto& request : requests)
+        {
+            const Program* pProgram = request.pProgram.get();
+            if (!pProgram || !programs.insert(pProgram).second) continue;
+            if (!pProgram->mLinkRequired || pProgram->mProgramVersions.find(pProgram->mDefineList) != pProgram->mProgramVersions.end()) continue;
+
+            Task task;
+            task.request = request;
+            task.result.name = pProgram->getProgramDescString();
+            tasks.push_back(std::move(task));
+        }
+        if (tasks.empty()) return {};
+
+        auto compileTask = [&tasks](size_t index)
+        {
+            auto& task = tasks[index];
+            const auto& pProgram = task.request.pProgram;
+            try
+            {
+                auto startTime = CpuTimer::getCurrentTimePoint();
+                task.pVersion = pProgram->preprocessAndCreateProgramVersion(task.log);
+                auto versionTime = CpuTimer::getCurrentTimePoint();
+                task.result.versionTime = CpuTimer::calcDuration(startTime, versionTime) * 1e-3;
+                if (!task.pVersion) return;
+
+                // Kernels are only compiled here if their specialization is known. Otherwise they are compiled on first use.
+                const ProgramVars* pVars = task.request.pVars.get();
+                if (pVars || task.pVersion->getSpecializationParamCount() == 0)
+                {
+                    task.specializationKey = ProgramVersion::getSpecializationKey(pVars);
+                    task.pKernels = pProgram->preprocessAndCreateProgramKernels(task.pVersion.get(), pVars, task.log);
+                    task.result.kernelsTime = CpuTimer::calcDuration(versionTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                task.pVersion = nullptr;
+                task.pKernels = nullptr;
+                task.log += e.what();
+            }
+        };
+
+#ifdef FALCOR_D3D12
+        CompilerThreadPool::instance().run(tasks.size(), compileTask);
+#else
+        // The GFX device compiles kernels using the main Slang session, so programs are compiled serially.
+        for (size_t i = 0; i < tasks.size(); i++) compileTask(i);
+#endif
+
+        // Register the compiled versions and kernels with their programs.
+        std::vector<CompileResult> results;
+        results.reserve(tasks.size());
+        for (auto& task : tasks)
+        {
+            const auto& pProgram = task.request.pProgram;
+            if (task.pVersion)
+            {
+                if (!task.log.empty()) logWarning("Warnings in program:\n" + task.result.name + "\n" + task.log);
+                if (task.pKernels) task.pVersion->mpKernels[task.specializationKey] = task.pKernels;
+                pProgram->mProgramVersions[pProgram->mDefineList] = task.pVersion;
+                task.result.success = true;
+            }
+            else
+            {
+                logDebug("Failed to precompile program, it will be compiled on first use: {}", task.result.name);
+            }
+            results.push_back(std::move(task.result));
+        }
+        return results;
+    }
+
     void Program::reset()
     {
         mpActiveVersion = nullptr;
@@ -1160,6 +1664,16 @@ namespace Falcor
         return sGenerateDebugInfo;
     }
 
+    void Program::setShaderCache(const ShaderCache::SharedPtr& pCache)
+    {
+        spShaderCache = pCache;
+    }
+
+    const ShaderCache::SharedPtr& Program::getShaderCache()
+    {
+        return spShaderCache;
+    }
+
     FALCOR_SCRIPT_BINDING(Program)
     {
         pybind11::class_<Program, Program::SharedPtr>(m, "Program");
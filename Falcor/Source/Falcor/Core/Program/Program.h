@@ -29,6 +29,7 @@
 #include "Core/API/Shader.h"
 #include "Core/Program/ShaderLibrary.h"
 #include "Core/Program/ProgramVersion.h"
+#include "Core/Program/ShaderCache.h"
 
 namespace Falcor
 {
@@ -180,6 +181,24 @@ namespace Falcor
             double programKernelsTotalTime = 0.0;
         };
 
+        /** A program to compile ahead of its first use. See compilePrograms().
+        */
+        struct CompileRequest
+        {
+            SharedPtr pProgram;                         ///< Program to compile for its current defines.
+            std::shared_ptr<ProgramVars> pVars;         ///< Variables the program will be used with, or nullptr if not created yet.
+        };
+
+        /** Compilation result for a single program. See compilePrograms().
+        */
+        struct CompileResult
+        {
+            std::string name;                           ///< Program description.
+            double versionTime = 0.0;                   ///< Time spent creating the program version in seconds.
+            double kernelsTime = 0.0;                   ///< Time spent creating the program kernels in seconds.
+            bool success = false;                       ///< True if the program version was created.
+        };
+
         virtual ~Program() = 0;
 
         /** Get the API handle of the active program.
@@ -277,6 +296,18 @@ namespace Falcor
         */
         static bool isGenerateDebugInfoEnabled();
 
+        /** Set the cache used for compiled kernels.
+            Programs look up their kernels in the cache before compiling them, and add newly compiled kernels to it.
+            The cache is only used with the DXIL backend. Passing nullptr disables caching.
+            \param[in] pCache Shader cache.
+        */
+        static void setShaderCache(const ShaderCache::SharedPtr& pCache);
+
+        /** Get the cache used for compiled kernels.
+            \return Shader cache, or nullptr if caching is disabled.
+        */
+        static const ShaderCache::SharedPtr& getShaderCache();
+
         /** Get the program reflection for the active program.
             \return Program reflection object, or an exception is thrown on failure.
         */
@@ -289,6 +320,17 @@ namespace Falcor
             return mDesc.mGroups[groupIndex].entryPoints[entryPointIndexInGroup];
         }
 
+        /** Compile a set of programs concurrently ahead of their first use.
+            Each program is compiled for its current defines. Programs that already have a version for their current defines are skipped.
+            The kernels are compiled as well, specialized for the given variables. If no variables are given, the kernels
+            are only compiled if the program has no specialization parameters.
+            Programs that fail to compile are not reported here. They are compiled again on first use, which reports the error as usual.
+            Must not be called concurrently with any other use of the programs.
+            \param[in] requests Programs to compile.
+            \return Compilation result for each compiled program.
+        */
+        static std::vector<CompileResult> compilePrograms(const std::vector<CompileRequest>& requests);
+
         static const CompilationStats& getGlobalCompilationStats() { return sCompilationStats; }
         static void resetGlobalCompilationStats() { sCompilationStats = {}; }
 
@@ -315,13 +357,57 @@ namespace Falcor
             ProgramReflection::SharedPtr&               pReflector,
             std::string&                                log) const;
 
+        /** Run the Slang front end and get the global scope and entry points of the program.
+            \param[out] dependencyFiles Files the program depends on.
+            \return True if successful.
+        */
+        bool createSlangComponents(
+            const DefineList&                               defineList,
+            ComPtr<slang::IComponentType>&                  pSlangGlobalScope,
+            std::vector<ComPtr<slang::IComponentType>>&     pSlangEntryPoints,
+            std::vector<std::string>&                       dependencyFiles,
+            std::string&                                    log) const;
+
         ProgramVersion::SharedPtr preprocessAndCreateProgramVersion(std::string& log) const;
 
+        /** Create a program version from the reflection stored in the shader cache, without running the Slang front end.
+            \param[in] optionsKey Key of the compiler options, see computeOptionsCacheKey().
+            \return The version, or nullptr if it is not in the cache or any of its dependencies has changed.
+        */
+        ProgramVersion::SharedPtr createCachedProgramVersion(const ShaderCache::Key& optionsKey) const;
+
+        /** Compute the part of the shader cache key known before running the front end: compiler, target,
+            program description, defines and type conformances. The contents of the source files are not included.
+        */
+        ShaderCache::Key computeOptionsCacheKey() const;
+
         ProgramKernels::SharedPtr preprocessAndCreateProgramKernels(
             ProgramVersion const* pVersion,
             ProgramVars    const* pVars,
             std::string         & log) const;
 
+        /** Create program kernels from the reflection and kernel code stored in the shader cache.
+            \return The kernels, or nullptr if any of the cached data is missing.
+        */
+        ProgramKernels::SharedPtr createCachedProgramKernels(
+            ProgramVersion const* pVersion,
+            ProgramVars    const* pVars,
+            std::string         & log) const;
+
+        /** Group the compiled shaders by entry point group and create the program kernels.
+        */
+        ProgramKernels::SharedPtr createProgramKernelsFromShaders(
+            const ProgramVersion* pVersion,
+            slang::IComponentType* pSpecializedSlangProgram,
+            const ProgramReflection::SharedPtr& pReflector,
+            const std::vector<Shader::SharedPtr>& allShaders,
+            std::string& log) const;
+
+        /** Returns true if program kernels can be created without a specialized Slang program,
+            which is required to restore them and the program version from the shader cache.
+        */
+        virtual bool canRestoreCachedKernels() const { return true; }
+
         virtual EntryPointGroupKernels::SharedPtr createEntryPointGroupKernels(
             const std::vector<Shader::SharedPtr>& shaders,
             EntryPointGroupReflection::SharedPtr const& pReflector) const;
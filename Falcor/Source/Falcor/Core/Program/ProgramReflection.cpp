@@ -29,7 +29,9 @@
 #include "ProgramReflection.h"
 #include "Utils/StringUtils.h"
 #include <slang/slang.h>
+#include <cstring>
 #include <map>
+#include <unordered_set>
 using namespace slang;
 
 namespace Falcor
@@ -2316,9 +2318,18 @@ namespace Falcor
         if( iter != mMapNameToType.end() )
             return iter->second;
 
-        auto pSlangType = mpSlangReflector->findTypeByName(name.c_str());
+        // Reflection restored from serialized data looks up types in the Slang program of its version,
+        // which runs the front end if it has not run yet.
+        auto pSlangReflector = mpSlangReflector;
+        if (!pSlangReflector)
+        {
+            if (!mpProgramVersion) return nullptr;
+            pSlangReflector = mpProgramVersion->getSlangGlobalScope()->getLayout();
+        }
+
+        auto pSlangType = pSlangReflector->findTypeByName(name.c_str());
         if (!pSlangType) return nullptr;
-        auto pSlangTypeLayout = mpSlangReflector->getTypeLayout(pSlangType);
+        auto pSlangTypeLayout = pSlangReflector->getTypeLayout(pSlangType);
 
         auto pFalcorTypeLayout = reflectType(pSlangTypeLayout, nullptr, nullptr, mpProgramVersion);
         if (!pFalcorTypeLayout) return nullptr;
@@ -2365,4 +2376,574 @@ namespace Falcor
         return (*this == *pOtherInterface);
     }
 
+    //
+    // Serialization
+    //
+
+    namespace
+    {
+        const uint32_t kSerializedMagic = 0x46524c46; // "FLRF"
+        const uint32_t kSerializedVersion = 1;
+        const uint32_t kNullIndex = uint32_t(-1);
+
+        /** Tags of the records in serialized reflection data.
+            Types and parameter blocks are written as records before anything referencing them, and referenced by index.
+        */
+        enum class RecordTag : uint8_t
+        {
+            Type,
+            ParameterBlock,
+            EntryPointGroup,
+            End,
+        };
+
+        class BlobWriter
+        {
+        public:
+            template<typename T>
+            void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&value);
+                mData.insert(mData.end(), pBytes, pBytes + sizeof(T));
+            }
+
+            void writeString(const std::string& str)
+            {
+                write((uint32_t)str.size());
+                mData.insert(mData.end(), str.begin(), str.end());
+            }
+
+            void writeIndices(const std::vector<uint32_t>& indices)
+            {
+                write((uint32_t)indices.size());
+                for (auto index : indices) write(index);
+            }
+
+            std::vector<uint8_t>& getData() { return mData; }
+
+        private:
+            std::vector<uint8_t> mData;
+        };
+
+        class BlobReader
+        {
+        public:
+            BlobReader(const void* data, size_t size) : mpData(static_cast<const uint8_t*>(data)), mSize(size) {}
+
+            template<typename T>
+            T read()
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                T value;
+                checkAvailable(sizeof(T));
+                std::memcpy(&value, mpData + mOffset, sizeof(T));
+                mOffset += sizeof(T);
+                return value;
+            }
+
+            /** Read an element count, checking that the remaining data can hold that many elements.
+            */
+            uint32_t readCount(size_t minElementSize)
+            {
+                uint32_t count = read<uint32_t>();
+                checkAvailable(count * minElementSize);
+                return count;
+            }
+
+            std::string readString()
+            {
+                uint32_t length = readCount(1);
+                std::string str(reinterpret_cast<const char*>(mpData + mOffset), length);
+                mOffset += length;
+                return str;
+            }
+
+            std::vector<uint32_t> readIndices()
+            {
+                std::vector<uint32_t> indices(readCount(sizeof(uint32_t)));
+                for (auto& index : indices) index = read<uint32_t>();
+                return indices;
+            }
+
+        private:
+            void checkAvailable(size_t size) const
+            {
+                if (size > mSize - mOffset) throw RuntimeError("Unexpected end of serialized reflection data.");
+            }
+
+            const uint8_t* mpData;
+            size_t mSize;
+            size_t mOffset = 0;
+        };
+
+        void writeVariableMap(BlobWriter& writer, const ProgramReflection::VariableMap& varMap)
+        {
+            // Sort by name so that the serialized data is deterministic.
+            std::vector<const ProgramReflection::VariableMap::value_type*> entries;
+            for (const auto& entry : varMap) entries.push_back(&entry);
+            std::sort(entries.begin(), entries.end(), [](auto a, auto b) { return a->first < b->first; });
+
+            writer.write((uint32_t)entries.size());
+            for (auto pEntry : entries)
+            {
+                writer.writeString(pEntry->first);
+                writer.write(pEntry->second.bindLocation);
+                writer.writeString(pEntry->second.semanticName);
+                writer.write(pEntry->second.type);
+            }
+        }
+
+        ProgramReflection::VariableMap readVariableMap(BlobReader& reader)
+        {
+            ProgramReflection::VariableMap varMap;
+            uint32_t count = reader.readCount(1);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                std::string name = reader.readString();
+                ProgramReflection::ShaderVariable var;
+                var.bindLocation = reader.read<uint32_t>();
+                var.semanticName = reader.readString();
+                var.type = reader.read<ReflectionBasicType::Type>();
+                varMap[name] = var;
+            }
+            return varMap;
+        }
+    }
+
+    /** Writes and reads the binary representation of program reflection.
+        Shared types and parameter blocks are written once and referenced by index.
+    */
+    struct ProgramReflectionSerializer
+    {
+        // Writing
+
+        BlobWriter writer;
+        std::unordered_map<const ReflectionType*, uint32_t> typeIndices;
+        std::unordered_map<const ParameterBlockReflection*, uint32_t> blockIndices;
+        std::unordered_set<const ParameterBlockReflection*> entryPointGroups;
+
+        uint32_t writeType(const ReflectionType* pType)
+        {
+            if (!pType) return kNullIndex;
+            if (auto it = typeIndices.find(pType); it != typeIndices.end()) return it->second;
+
+            // Write all referenced objects first so that they exist when this type is read.
+            uint32_t elementTypeIndex = kNullIndex;
+            uint32_t blockIndex = kNullIndex;
+            std::vector<uint32_t> memberTypeIndices;
+            switch (pType->getKind())
+            {
+            case ReflectionType::Kind::Array:
+                elementTypeIndex = writeType(pType->asArrayType()->getElementType().get());
+                break;
+            case ReflectionType::Kind::Struct:
+                for (const auto& pMember : pType->asStructType()->mMembers) memberTypeIndices.push_back(writeType(pMember->getType().get()));
+                break;
+            case ReflectionType::Kind::Resource:
+                elementTypeIndex = writeType(pType->asResourceType()->getStructType().get());
+                blockIndex = writeBlock(pType->asResourceType()->getParameterBlockReflector().get());
+                break;
+            case ReflectionType::Kind::Interface:
+                blockIndex = writeBlock(pType->asInterfaceType()->getParameterBlockReflector().get());
+                break;
+            default:
+                break;
+            }
+
+            writer.write(RecordTag::Type);
+            writer.write(pType->getKind());
+            writer.write((uint64_t)pType->getByteSize());
+            writer.write((uint32_t)pType->mResourceRanges.size());
+            for (const auto& range : pType->mResourceRanges)
+            {
+                writer.write(range.descriptorType);
+                writer.write(range.count);
+                writer.write(range.baseIndex);
+            }
+
+            switch (pType->getKind())
+            {
+            case ReflectionType::Kind::Array:
+                writer.write(pType->asArrayType()->getElementCount());
+                writer.write(pType->asArrayType()->getElementByteStride());
+                writer.write(elementTypeIndex);
+                break;
+            case ReflectionType::Kind::Struct:
+            {
+                auto pStructType = pType->asStructType();
+                writer.writeString(pStructType->getName());
+                writer.write((uint32_t)pStructType->mMembers.size());
+                for (size_t i = 0; i < pStructType->mMembers.size(); i++)
+                {
+                    const auto& pMember = pStructType->mMembers[i];
+                    writer.writeString(pMember->getName());
+                    writer.write(memberTypeIndices[i]);
+                    writer.write(pMember->getBindLocation().getUniform().getByteOffset());
+                    writer.write(pMember->getBindLocation().getResource().getRangeIndex());
+                    writer.write(pMember->getBindLocation().getResource().getArrayIndex());
+                }
+                // Members added ignoring name conflicts have no name mapping, so the mapping is stored separately.
+                std::vector<std::pair<std::string, int32_t>> nameToIndex(pStructType->mNameToIndex.begin(), pStructType->mNameToIndex.end());
+                std::sort(nameToIndex.begin(), nameToIndex.end());
+                writer.write((uint32_t)nameToIndex.size());
+                for (const auto& [name, index] : nameToIndex)
+                {
+                    writer.writeString(name);
+                    writer.write(index);
+                }
+                break;
+            }
+            case ReflectionType::Kind::Basic:
+                writer.write(pType->asBasicType()->getType());
+                writer.write((uint8_t)pType->asBasicType()->isRowMajor());
+                break;
+            case ReflectionType::Kind::Resource:
+            {
+                auto pResourceType = pType->asResourceType();
+                writer.write(pResourceType->getType());
+                writer.write(pResourceType->getDimensions());
+                writer.write(pResourceType->getStructuredBufferType());
+                writer.write(pResourceType->getReturnType());
+                writer.write(pResourceType->getShaderAccess());
+                writer.write(elementTypeIndex);
+                writer.write(blockIndex);
+                break;
+            }
+            case ReflectionType::Kind::Interface:
+                writer.write(blockIndex);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+            }
+
+            uint32_t index = (uint32_t)typeIndices.size();
+            typeIndices[pType] = index;
+            return index;
+        }
+
+        uint32_t writeBlock(const ParameterBlockReflection* pBlock)
+        {
+            if (!pBlock) return kNullIndex;
+            if (auto it = blockIndices.find(pBlock); it != blockIndices.end()) return it->second;
+
+            uint32_t elementTypeIndex = writeType(pBlock->mpElementType.get());
+            std::vector<uint32_t> subObjectIndices;
+            for (const auto& range : pBlock->mResourceRanges) subObjectIndices.push_back(writeBlock(range.pSubObjectReflector.get()));
+
+            bool isEntryPointGroup = entryPointGroups.count(pBlock) != 0;
+            writer.write(isEntryPointGroup ? RecordTag::EntryPointGroup : RecordTag::ParameterBlock);
+            writer.write(elementTypeIndex);
+
+            const auto& cbInfo = pBlock->mDefaultConstantBufferBindingInfo;
+            writer.write(cbInfo.regIndex);
+            writer.write(cbInfo.regSpace);
+            writer.write(cbInfo.descriptorSetIndex);
+            writer.write((uint8_t)cbInfo.useRootConstants);
+
+            writer.write((uint32_t)pBlock->mResourceRanges.size());
+            for (size_t i = 0; i < pBlock->mResourceRanges.size(); i++)
+            {
+                const auto& range = pBlock->mResourceRanges[i];
+                writer.write(range.flavor);
+                writer.write(range.dimension);
+                writer.write(range.regIndex);
+                writer.write(range.regSpace);
+                writer.write(range.descriptorSetIndex);
+                writer.write(subObjectIndices[i]);
+            }
+
+#ifdef FALCOR_D3D12
+            writer.write((uint32_t)pBlock->mDescriptorSets.size());
+            for (const auto& set : pBlock->mDescriptorSets)
+            {
+                writer.write(set.layout.getVisibility());
+                writer.write((uint32_t)set.layout.getRangeCount());
+                for (size_t r = 0; r < set.layout.getRangeCount(); r++)
+                {
+                    const auto& range = set.layout.getRange(r);
+                    writer.write(range.type);
+                    writer.write(range.baseRegIndex);
+                    writer.write(range.descCount);
+                    writer.write(range.regSpace);
+                }
+                writer.writeIndices(set.resourceRangeIndices);
+                writer.write((uint32_t)set.subObjects.size());
+                for (const auto& subObject : set.subObjects)
+                {
+                    writer.write(subObject.resourceRangeIndexOfSubObject);
+                    writer.write(subObject.setIndexInSubObject);
+                }
+            }
+#endif
+
+            writer.writeIndices(pBlock->mRootDescriptorRangeIndices);
+            writer.writeIndices(pBlock->mParameterBlockSubObjectRangeIndices);
+
+            uint32_t index = (uint32_t)blockIndices.size();
+            blockIndices[pBlock] = index;
+            return index;
+        }
+
+        std::vector<uint8_t> serialize(const ProgramReflection& reflection)
+        {
+            writer.write(kSerializedMagic);
+            writer.write(kSerializedVersion);
+
+            for (const auto& pGroup : reflection.mEntryPointGroups) entryPointGroups.insert(pGroup.get());
+            uint32_t defaultBlockIndex = writeBlock(reflection.mpDefaultBlock.get());
+            std::vector<uint32_t> entryPointGroupIndices;
+            for (const auto& pGroup : reflection.mEntryPointGroups) entryPointGroupIndices.push_back(writeBlock(pGroup.get()));
+            writer.write(RecordTag::End);
+
+            writer.write(defaultBlockIndex);
+            writer.writeIndices(entryPointGroupIndices);
+            writer.write(reflection.mThreadGroupSize);
+            writer.write((uint8_t)reflection.mIsSampleFrequency);
+            writeVariableMap(writer, reflection.mPsOut);
+            writeVariableMap(writer, reflection.mVertAttr);
+            writeVariableMap(writer, reflection.mVertAttrBySemantic);
+
+            writer.write((uint32_t)reflection.mHashedStrings.size());
+            for (const auto& hashedString : reflection.mHashedStrings)
+            {
+                writer.write(hashedString.hash);
+                writer.writeString(hashedString.string);
+            }
+
+            return std::move(writer.getData());
+        }
+
+        // Reading
+
+        std::vector<ReflectionType::SharedPtr> types;
+        std::vector<ParameterBlockReflection::SharedPtr> blocks;
+        std::vector<bool> isEntryPointGroupBlock;
+
+        ReflectionType::SharedPtr getType(uint32_t index, bool required) const
+        {
+            if (index == kNullIndex && !required) return nullptr;
+            if (index >= types.size()) throw RuntimeError("Invalid type index in serialized reflection data.");
+            return types[index];
+        }
+
+        ParameterBlockReflection::SharedPtr getBlock(uint32_t index) const
+        {
+            if (index == kNullIndex) return nullptr;
+            if (index >= blocks.size()) throw RuntimeError("Invalid parameter block index in serialized reflection data.");
+            return blocks[index];
+        }
+
+        ReflectionType::SharedPtr readType(BlobReader& reader)
+        {
+            auto kind = reader.read<ReflectionType::Kind>();
+            auto byteSize = (ReflectionType::ByteSize)reader.read<uint64_t>();
+            std::vector<ReflectionType::ResourceRange> ranges(reader.readCount(3 * sizeof(uint32_t)));
+            for (auto& range : ranges)
+            {
+                range.descriptorType = reader.read<ShaderResourceType>();
+                range.count = reader.read<uint32_t>();
+                range.baseIndex = reader.read<uint32_t>();
+            }
+
+            ReflectionType::SharedPtr pType;
+            switch (kind)
+            {
+            case ReflectionType::Kind::Array:
+            {
+                uint32_t elementCount = reader.read<uint32_t>();
+                uint32_t elementByteStride = reader.read<uint32_t>();
+                auto pElementType = getType(reader.read<uint32_t>(), true);
+                pType = ReflectionArrayType::create(elementCount, elementByteStride, pElementType, byteSize, nullptr);
+                break;
+            }
+            case ReflectionType::Kind::Struct:
+            {
+                auto pStructType = ReflectionStructType::create(byteSize, reader.readString(), nullptr);
+                uint32_t memberCount = reader.readCount(1);
+                for (uint32_t i = 0; i < memberCount; i++)
+                {
+                    std::string name = reader.readString();
+                    auto pMemberType = getType(reader.read<uint32_t>(), true);
+                    UniformShaderVarOffset uniform(reader.read<UniformShaderVarOffset::ByteOffset>());
+                    auto rangeIndex = reader.read<ResourceShaderVarOffset::RangeIndex>();
+                    auto arrayIndex = reader.read<ResourceShaderVarOffset::ArrayIndex>();
+                    pStructType->mMembers.push_back(ReflectionVar::create(name, pMemberType, ShaderVarOffset(uniform, ResourceShaderVarOffset(rangeIndex, arrayIndex))));
+                }
+                uint32_t nameCount = reader.readCount(1);
+                for (uint32_t i = 0; i < nameCount; i++)
+                {
+                    std::string name = reader.readString();
+                    int32_t index = reader.read<int32_t>();
+                    if (index < 0 || index >= (int32_t)memberCount) throw RuntimeError("Invalid member index in serialized reflection data.");
+                    pStructType->mNameToIndex[name] = index;
+                }
+                pType = pStructType;
+                break;
+            }
+            case ReflectionType::Kind::Basic:
+            {
+                auto type = reader.read<ReflectionBasicType::Type>();
+                bool isRowMajor = reader.read<uint8_t>() != 0;
+                pType = ReflectionBasicType::create(type, isRowMajor, byteSize, nullptr);
+                break;
+            }
+            case ReflectionType::Kind::Resource:
+            {
+                auto type = reader.read<ReflectionResourceType::Type>();
+                auto dims = reader.read<ReflectionResourceType::Dimensions>();
+                auto structuredType = reader.read<ReflectionResourceType::StructuredType>();
+                auto returnType = reader.read<ReflectionResourceType::ReturnType>();
+                auto shaderAccess = reader.read<ReflectionResourceType::ShaderAccess>();
+                auto pResourceType = ReflectionResourceType::create(type, dims, structuredType, returnType, shaderAccess, nullptr);
+                pResourceType->setStructType(getType(reader.read<uint32_t>(), false));
+                pResourceType->setParameterBlockReflector(getBlock(reader.read<uint32_t>()));
+                pType = pResourceType;
+                break;
+            }
+            case ReflectionType::Kind::Interface:
+            {
+                auto pInterfaceType = ReflectionInterfaceType::create(nullptr);
+                pInterfaceType->setParameterBlockReflector(getBlock(reader.read<uint32_t>()));
+                pType = pInterfaceType;
+                break;
+            }
+            default:
+                throw RuntimeError("Invalid type kind in serialized reflection data.");
+            }
+
+            // The resource ranges are stored as computed when the type was reflected.
+            pType->mResourceRanges = std::move(ranges);
+            return pType;
+        }
+
+        ParameterBlockReflection::SharedPtr readBlock(BlobReader& reader, ProgramVersion const* pProgramVersion, bool isEntryPointGroup)
+        {
+            ParameterBlockReflection::SharedPtr pBlock;
+            if (isEntryPointGroup) pBlock = EntryPointGroupReflection::SharedPtr(new EntryPointGroupReflection(pProgramVersion));
+            else pBlock = ParameterBlockReflection::createEmpty(pProgramVersion);
+            pBlock->mpElementType = getType(reader.read<uint32_t>(), true);
+
+            auto& cbInfo = pBlock->mDefaultConstantBufferBindingInfo;
+            cbInfo.regIndex = reader.read<uint32_t>();
+            cbInfo.regSpace = reader.read<uint32_t>();
+            cbInfo.descriptorSetIndex = reader.read<uint32_t>();
+            cbInfo.useRootConstants = reader.read<uint8_t>() != 0;
+
+            uint32_t rangeCount = reader.readCount(1);
+            if (rangeCount != pBlock->mpElementType->getResourceRangeCount()) throw RuntimeError("Mismatching resource range count in serialized reflection data.");
+            for (uint32_t i = 0; i < rangeCount; i++)
+            {
+                ParameterBlockReflection::ResourceRangeBindingInfo range;
+                range.flavor = reader.read<ParameterBlockReflection::ResourceRangeBindingInfo::Flavor>();
+                range.dimension = reader.read<ReflectionResourceType::Dimensions>();
+                range.regIndex = reader.read<uint32_t>();
+                range.regSpace = reader.read<uint32_t>();
+                range.descriptorSetIndex = reader.read<uint32_t>();
+                range.pSubObjectReflector = getBlock(reader.read<uint32_t>());
+                pBlock->mResourceRanges.push_back(range);
+            }
+
+#ifdef FALCOR_D3D12
+            uint32_t setCount = reader.readCount(1);
+            for (uint32_t i = 0; i < setCount; i++)
+            {
+                ParameterBlockReflection::DescriptorSetInfo set;
+                set.layout = D3D12DescriptorSet::Layout(reader.read<ShaderVisibility>());
+                uint32_t layoutRangeCount = reader.readCount(4 * sizeof(uint32_t));
+                for (uint32_t r = 0; r < layoutRangeCount; r++)
+                {
+                    auto type = reader.read<D3D12DescriptorSet::Type>();
+                    uint32_t baseRegIndex = reader.read<uint32_t>();
+                    uint32_t descCount = reader.read<uint32_t>();
+                    uint32_t regSpace = reader.read<uint32_t>();
+                    set.layout.addRange(type, baseRegIndex, descCount, regSpace);
+                }
+                set.resourceRangeIndices = reader.readIndices();
+                set.subObjects.resize(reader.readCount(2 * sizeof(uint32_t)));
+                for (auto& subObject : set.subObjects)
+                {
+                    subObject.resourceRangeIndexOfSubObject = reader.read<uint32_t>();
+                    subObject.setIndexInSubObject = reader.read<uint32_t>();
+                }
+                pBlock->mDescriptorSets.push_back(std::move(set));
+            }
+#endif
+
+            pBlock->mRootDescriptorRangeIndices = reader.readIndices();
+            pBlock->mParameterBlockSubObjectRangeIndices = reader.readIndices();
+            return pBlock;
+        }
+
+        ProgramReflection::SharedPtr deserialize(ProgramVersion const* pProgramVersion, const void* data, size_t size)
+        {
+            BlobReader reader(data, size);
+            if (reader.read<uint32_t>() != kSerializedMagic) throw RuntimeError("Data is not serialized reflection.");
+            if (reader.read<uint32_t>() != kSerializedVersion) throw RuntimeError("Unsupported serialized reflection version.");
+
+            for (bool done = false; !done;)
+            {
+                switch (reader.read<RecordTag>())
+                {
+                case RecordTag::Type:
+                    types.push_back(readType(reader));
+                    break;
+                case RecordTag::ParameterBlock:
+                    blocks.push_back(readBlock(reader, pProgramVersion, false));
+                    isEntryPointGroupBlock.push_back(false);
+                    break;
+                case RecordTag::EntryPointGroup:
+                    blocks.push_back(readBlock(reader, pProgramVersion, true));
+                    isEntryPointGroupBlock.push_back(true);
+                    break;
+                case RecordTag::End:
+                    done = true;
+                    break;
+                default:
+                    throw RuntimeError("Invalid record in serialized reflection data.");
+                }
+            }
+
+            auto pReflection = ProgramReflection::SharedPtr(new ProgramReflection(pProgramVersion));
+            pReflection->mpDefaultBlock = getBlock(reader.read<uint32_t>());
+            if (!pReflection->mpDefaultBlock) throw RuntimeError("Missing default parameter block in serialized reflection data.");
+            for (auto index : reader.readIndices())
+            {
+                if (index >= blocks.size() || !isEntryPointGroupBlock[index]) throw RuntimeError("Invalid entry point group in serialized reflection data.");
+                pReflection->mEntryPointGroups.push_back(std::static_pointer_cast<EntryPointGroupReflection>(blocks[index]));
+            }
+            pReflection->mThreadGroupSize = reader.read<uint3>();
+            pReflection->mIsSampleFrequency = reader.read<uint8_t>() != 0;
+            pReflection->mPsOut = readVariableMap(reader);
+            pReflection->mVertAttr = readVariableMap(reader);
+            pReflection->mVertAttrBySemantic = readVariableMap(reader);
+
+            uint32_t hashedStringCount = reader.readCount(sizeof(uint32_t));
+            for (uint32_t i = 0; i < hashedStringCount; i++)
+            {
+                uint32_t hash = reader.read<uint32_t>();
+                pReflection->mHashedStrings.push_back({ hash, reader.readString() });
+            }
+
+            return pReflection;
+        }
+    };
+
+    std::vector<uint8_t> ProgramReflection::serialize() const
+    {
+        return ProgramReflectionSerializer().serialize(*this);
+    }
+
+    ProgramReflection::SharedPtr ProgramReflection::deserialize(ProgramVersion const* pProgramVersion, const void* data, size_t size)
+    {
+        try
+        {
+            return ProgramReflectionSerializer().deserialize(pProgramVersion, data, size);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Failed to deserialize program reflection: {}", e.what());
+            return nullptr;
+        }
+    }
 }
@@ -44,6 +44,7 @@ namespace Falcor
     class ReflectionArrayType;
     class ReflectionInterfaceType;
     class ParameterBlockReflection;
+    struct ProgramReflectionSerializer;
 
     /** Represents the offset of a uniform shader variable relative to its enclosing type/buffer/block.
 
@@ -743,6 +744,8 @@ namespace Falcor
         slang::TypeLayoutReflection* getSlangTypeLayout() const { return mpSlangTypeLayout; }
 
     protected:
+        friend struct ProgramReflectionSerializer;
+
         ReflectionType(Kind kind, ByteSize byteSize, slang::TypeLayoutReflection* pSlangTypeLayout)
             : mKind(kind)
             , mByteSize(byteSize)
@@ -873,6 +876,8 @@ namespace Falcor
         int32_t addMemberIgnoringNameConflicts(const std::shared_ptr<const ReflectionVar>& pVar, BuildState& ioBuildState);
 
     private:
+        friend struct ProgramReflectionSerializer;
+
         ReflectionStructType(
             size_t size,
             const std::string& name,
@@ -1380,6 +1385,8 @@ namespace Falcor
             ProgramVersion const* pProgramVersion);
 
     private:
+        friend struct ProgramReflectionSerializer;
+
         /// The element type of the parameter block
         ///
         /// For a `ConstantBuffer<T>` or `ParameterBlock<T>`,
@@ -1443,6 +1450,8 @@ namespace Falcor
             std::vector<slang::EntryPointLayout*> const& pSlangEntryPointReflectors);
 
     private:
+        friend struct ProgramReflectionSerializer;
+
         EntryPointGroupReflection(
             ProgramVersion const* pProgramVersion);
     };
@@ -1535,7 +1544,26 @@ namespace Falcor
 
         std::vector<HashedString> const& getHashedStrings() const { return mHashedStrings; }
 
+        /** Serialize the reflection into a compact binary representation.
+            Used to store the reflection of compiled kernels in the shader cache.
+            \return Serialized data.
+        */
+        std::vector<uint8_t> serialize() const;
+
+        /** Create a reflection object from data written by serialize().
+            The reflection is not backed by Slang reflection objects: findType() runs the Slang front end of the
+            program version, and parameter blocks using it cannot be specialized. This is sufficient for the reflection
+            of program kernels, which is only used for binding, and of program versions without specialization parameters.
+            \param[in] pProgramVersion Program version the reflection belongs to.
+            \param[in] data Serialized data.
+            \param[in] size Size of the data in bytes.
+            \return New object, or nullptr if the data is invalid.
+        */
+        static SharedPtr deserialize(ProgramVersion const* pProgramVersion, const void* data, size_t size);
+
     private:
+        friend struct ProgramReflectionSerializer;
+
         ProgramReflection(
             ProgramVersion const* pProgramVersion,
             slang::ShaderReflection* pSlangReflector,
@@ -178,21 +178,7 @@ namespace Falcor
         // to specialization, and what argument type/value is bound to
         // those parameters.
         //
-        std::string specializationKey;
-
-        ParameterBlock::SpecializationArgs specializationArgs;
-        if (pVars)
-        {
-            pVars->collectSpecializationArgs(specializationArgs);
-        }
-
-        bool first = true;
-        for( auto specializationArg : specializationArgs )
-        {
-            if(!first) specializationKey += ",";
-            specializationKey += std::string(specializationArg.type->getName());
-            first = false;
-        }
+        std::string specializationKey = getSpecializationKey(pVars);
 
         auto foundKernels = mpKernels.find(specializationKey);
         if( foundKernels != mpKernels.end() )
@@ -230,6 +216,35 @@ namespace Falcor
         }
     }
 
+    std::string ProgramVersion::getSpecializationKey(ProgramVars const* pVars)
+    {
+        std::string specializationKey;
+
+        ParameterBlock::SpecializationArgs specializationArgs;
+        if (pVars)
+        {
+            pVars->collectSpecializationArgs(specializationArgs);
+        }
+
+        bool first = true;
+        for( auto specializationArg : specializationArgs )
+        {
+            if(!first) specializationKey += ",";
+            specializationKey += std::string(specializationArg.type->getName());
+            first = false;
+        }
+
+        return specializationKey;
+    }
+
+    uint32_t ProgramVersion::getSpecializationParamCount() const
+    {
+        // Versions are only restored from the shader cache if they have no specialization parameters,
+        // so the front end does not need to run to answer this.
+        std::lock_guard<std::mutex> lock(mSlangMutex);
+        return mpSlangGlobalScope ? (uint32_t)mpSlangGlobalScope->getSpecializationParamCount() : 0;
+    }
+
     slang::ISession* ProgramVersion::getSlangSession() const
     {
         return getSlangGlobalScope()->getSession();
@@ -237,11 +252,22 @@ namespace Falcor
 
     slang::IComponentType* ProgramVersion::getSlangGlobalScope() const
     {
+        std::lock_guard<std::mutex> lock(mSlangMutex);
+        if (!mpSlangGlobalScope)
+        {
+            std::string log;
+            std::vector<std::string> dependencyFiles;
+            if (!mpProgram->createSlangComponents(mDefines, mpSlangGlobalScope, mpSlangEntryPoints, dependencyFiles, log))
+            {
+                throw RuntimeError("Failed to create Slang program for '{}':\n{}", mName, log);
+            }
+        }
         return mpSlangGlobalScope;
     }
 
     slang::IComponentType* ProgramVersion::getSlangEntryPoint(uint32_t index) const
     {
+        getSlangGlobalScope();
         return mpSlangEntryPoints[index];
     }
 }
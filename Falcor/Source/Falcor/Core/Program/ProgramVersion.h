@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Core/Program/ProgramReflection.h"
+#include "Core/Program/ShaderCache.h"
 #include "Core/API/Shader.h"
 
 #ifdef FALCOR_D3D12
@@ -239,6 +240,19 @@ namespace Falcor
         */
         ProgramKernels::SharedConstPtr getKernels(ProgramVars const* pVars) const;
 
+        /** Get the shader cache key identifying this version.
+            The key covers everything affecting compilation except for specialization arguments.
+        */
+        const ShaderCache::Key& getCacheKey() const { return mCacheKey; }
+
+        /** Get the number of specialization parameters of the program.
+        */
+        uint32_t getSpecializationParamCount() const;
+
+        /** Get the Slang objects of this version.
+            Versions restored from the shader cache run the Slang front end on first use.
+            Throws a RuntimeError if the front end fails.
+        */
         slang::ISession* getSlangSession() const;
         slang::IComponentType* getSlangGlobalScope() const;
         slang::IComponentType* getSlangEntryPoint(uint32_t index) const;
@@ -249,6 +263,10 @@ namespace Falcor
 
         static SharedPtr createEmpty(Program* pProgram, slang::IComponentType* pSlangGlobalScope);
 
+        /** Get the key identifying the kernels specialized for the arguments bound in `pVars`.
+        */
+        static std::string getSpecializationKey(ProgramVars const* pVars);
+
         ProgramVersion(Program* pProgram, slang::IComponentType* pSlangGlobalScope);
 
         void init(
@@ -263,8 +281,10 @@ namespace Falcor
         TypeConformanceList             mTypeConformances;
         ProgramReflection::SharedPtr    mpReflector;
         std::string                     mName;
-        ComPtr<slang::IComponentType>   mpSlangGlobalScope;
-        std::vector<ComPtr<slang::IComponentType>> mpSlangEntryPoints;
+        mutable std::mutex              mSlangMutex;
+        mutable ComPtr<slang::IComponentType>   mpSlangGlobalScope;
+        mutable std::vector<ComPtr<slang::IComponentType>> mpSlangEntryPoints;
+        ShaderCache::Key                mCacheKey = {};
 
         // Cached version of compiled kernels for this program version
         mutable std::unordered_map<std::string, ProgramKernels::SharedPtr> mpKernels;
@@ -28,6 +28,7 @@
 #include "stdafx.h"
 #include "RtProgram.h"
 #include <slang/slang.h>
+#include <atomic>
 
 namespace Falcor
 {
@@ -98,7 +99,7 @@ namespace Falcor
         }
     }
 
-    static uint64_t sHitGroupID = 0;
+    static std::atomic<uint64_t> sHitGroupID = 0; // Kernels may be created concurrently, see Program::compilePrograms().
 
     EntryPointGroupKernels::SharedPtr RtProgram::createEntryPointGroupKernels(
         const std::vector<Shader::SharedPtr>& shaders,
@@ -0,0 +1,194 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShaderCache.h"
+#include <slang/slang.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBundleMagic = 0x43534346; // "FCSC"
+        const uint32_t kBundleVersion = 1;
+
+        /** Reference counted blob owning a copy of the kernel code.
+            The Slang blob interface shares its GUID with ID3DBlob, so these can be used wherever compiler output is.
+        */
+        class DataBlob : public ISlangBlob
+        {
+        public:
+            DataBlob(const void* data, size_t size)
+                : mData((const uint8_t*)data, (const uint8_t*)data + size)
+            {}
+
+            virtual ~DataBlob() = default;
+
+            SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+            {
+                static const SlangUUID kUnknownUUID = SLANG_UUID_ISlangUnknown;
+                static const SlangUUID kBlobUUID = SLANG_UUID_ISlangBlob;
+                if (std::memcmp(&uuid, &kUnknownUUID, sizeof(SlangUUID)) == 0 || std::memcmp(&uuid, &kBlobUUID, sizeof(SlangUUID)) == 0)
+                {
+                    addRef();
+                    *outObject = static_cast<ISlangBlob*>(this);
+                    return SLANG_OK;
+                }
+                *outObject = nullptr;
+                return SLANG_E_NO_INTERFACE;
+            }
+
+            SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override { return ++mRefCount; }
+
+            SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+            {
+                uint32_t count = --mRefCount;
+                if (count == 0) delete this;
+                return count;
+            }
+
+            SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override { return mData.data(); }
+            SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override { return mData.size(); }
+
+        private:
+            std::vector<uint8_t> mData;
+            std::atomic<uint32_t> mRefCount = 0;
+        };
+
+        template<typename T>
+        void write(std::ofstream& stream, const T& value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        bool read(std::ifstream& stream, T& value)
+        {
+            return bool(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+    }
+
+    ShaderCache::ShaderCache() = default;
+    ShaderCache::~ShaderCache() = default;
+
+    ShaderCache::SharedPtr ShaderCache::create()
+    {
+        return SharedPtr(new ShaderCache());
+    }
+
+    ShaderCache::SharedPtr ShaderCache::createFromFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) throw RuntimeError("Failed to open shader cache bundle '{}'.", path.string());
+
+        uint32_t magic = 0, version = 0;
+        uint64_t count = 0;
+        if (!read(stream, magic) || magic != kBundleMagic) throw RuntimeError("'{}' is not a shader cache bundle.", path.string());
+        if (!read(stream, version) || version != kBundleVersion) throw RuntimeError("Shader cache bundle '{}' has unsupported version {}.", path.string(), version);
+        if (!read(stream, count)) throw RuntimeError("Shader cache bundle '{}' is truncated.", path.string());
+
+        auto pCache = create();
+        std::vector<uint8_t> data;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            Key key;
+            uint64_t size = 0;
+            if (!read(stream, key) || !read(stream, size)) throw RuntimeError("Shader cache bundle '{}' is truncated.", path.string());
+            data.resize(size);
+            if (!stream.read(reinterpret_cast<char*>(data.data()), size)) throw RuntimeError("Shader cache bundle '{}' is truncated.", path.string());
+            pCache->mEntries[key] = createBlob(data.data(), data.size());
+        }
+
+        return pCache;
+    }
+
+    void ShaderCache::writeToFile(const std::filesystem::path& path) const
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if (!stream) throw RuntimeError("Failed to open shader cache bundle '{}' for writing.", path.string());
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        write(stream, kBundleMagic);
+        write(stream, kBundleVersion);
+        write(stream, (uint64_t)mEntries.size());
+        for (const auto& [key, blob] : mEntries)
+        {
+            write(stream, key);
+            write(stream, (uint64_t)blob->getBufferSize());
+            stream.write(reinterpret_cast<const char*>(blob->getBufferPointer()), blob->getBufferSize());
+        }
+
+        if (!stream) throw RuntimeError("Failed to write shader cache bundle '{}'.", path.string());
+    }
+
+    void ShaderCache::merge(const ShaderCache& other)
+    {
+        if (&other == this) return;
+        std::scoped_lock lock(mMutex, other.mMutex);
+        for (const auto& entry : other.mEntries) mEntries.insert(entry);
+    }
+
+    Shader::Blob ShaderCache::find(const Key& key) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if (it == mEntries.end())
+        {
+            mStats.misses++;
+            return nullptr;
+        }
+        mStats.hits++;
+        return it->second;
+    }
+
+    void ShaderCache::add(const Key& key, const Shader::Blob& blob)
+    {
+        FALCOR_ASSERT(blob);
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries[key] = blob;
+    }
+
+    size_t ShaderCache::getEntryCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mEntries.size();
+    }
+
+    ShaderCache::Stats ShaderCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+    Shader::Blob ShaderCache::createBlob(const void* data, size_t size)
+    {
+        return Shader::Blob(new DataBlob(data, size));
+    }
+}
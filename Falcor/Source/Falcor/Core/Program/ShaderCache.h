@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Shader.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+namespace Falcor
+{
+    /** Cache of compiled shader kernels.
+
+        Kernels are identified by a hash of everything affecting their compilation: program sources and all
+        included files, defines, type conformances, specialization arguments and compiler options.
+        When a cache is set using Program::setShaderCache(), programs look up the kernel code in the cache before
+        invoking the downstream compiler, and add newly compiled kernels to it.
+
+        Besides kernel code, the cache stores the reflection of program versions and kernels, and the list of files
+        each program version depends on. Programs are looked up before running the Slang front end: if none of the
+        dependencies has changed, the version and its kernels are created from the cache without invoking Slang.
+        Kernels with specialization arguments are restored the same way, keyed by their arguments.
+
+        Limitations:
+        - Only the D3D12 (DXIL) backend uses the cache. CUDA programs and the GFX backend always compile.
+        - Program versions with specialization parameters (interface-typed shader parameters) are not restored,
+          as their parameter blocks need the Slang type layouts to be specialized. Their front end always runs,
+          but their kernels are still restored.
+        - Restored versions run the front end on demand when Slang objects are needed, e.g. for
+          ProgramReflection::findType() or when a kernel is missing from the cache.
+
+        The cache contents can be written to a bundle file and loaded at startup, which allows shipping
+        precompiled kernels for a deployment (see the ShaderPrecompiler tool).
+
+        The cache is thread-safe.
+    */
+    class FALCOR_API ShaderCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ShaderCache>;
+        using Key = SHA1::MD;
+
+        struct Stats
+        {
+            size_t hits = 0;    ///< Number of lookups that found a kernel.
+            size_t misses = 0;  ///< Number of lookups that did not find a kernel.
+        };
+
+        ~ShaderCache();
+
+        /** Create an empty cache.
+        */
+        static SharedPtr create();
+
+        /** Create a cache from a bundle file.
+            Throws a RuntimeError if the file cannot be read or is not a valid bundle.
+            \param[in] path File path.
+            \return New object.
+        */
+        static SharedPtr createFromFile(const std::filesystem::path& path);
+
+        /** Write the cache contents to a bundle file.
+            Throws a RuntimeError if the file cannot be written.
+            \param[in] path File path.
+        */
+        void writeToFile(const std::filesystem::path& path) const;
+
+        /** Add the entries of another cache. Existing entries are kept.
+            \param[in] other Cache to merge.
+        */
+        void merge(const ShaderCache& other);
+
+        /** Look up a kernel.
+            \param[in] key Kernel key.
+            \return The kernel code, or nullptr if not in the cache.
+        */
+        Shader::Blob find(const Key& key) const;
+
+        /** Add a kernel. An existing entry with the same key is replaced.
+            \param[in] key Kernel key.
+            \param[in] blob Kernel code.
+        */
+        void add(const Key& key, const Shader::Blob& blob);
+
+        /** Get the number of cached kernels.
+        */
+        size_t getEntryCount() const;
+
+        /** Get the lookup statistics.
+        */
+        Stats getStats() const;
+
+        /** Create a blob holding a copy of the given data.
+            \param[in] data Data to copy.
+            \param[in] size Size of data in bytes.
+            \return New blob.
+        */
+        static Shader::Blob createBlob(const void* data, size_t size);
+
+    private:
+        ShaderCache();
+
+        mutable std::mutex mMutex;
+        std::map<Key, Shader::Blob> mEntries;
+        mutable Stats mStats;
+    };
+}
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "ShaderVar.h"
+#include "ShaderVarHandle.h"
 
 namespace Falcor
 {
@@ -212,6 +213,11 @@ namespace Falcor
         return ShaderVar(mpBlock, TypedShaderVarOffset(offset.getType().get(), mOffset + offset));
     }
 
+    ShaderVar ShaderVar::operator[](ShaderVarHandle const& handle) const
+    {
+        return handle.apply(*this);
+    }
+
     ShaderVar ShaderVar::operator[](UniformShaderVarOffset const& loc) const
     {
         if (!isValid()) return *this;
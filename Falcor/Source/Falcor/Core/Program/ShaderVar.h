@@ -35,6 +35,7 @@
 namespace Falcor
 {
     class ParameterBlock;
+    class ShaderVarHandle;
     template<typename T>
     class ParameterBlockSharedPtr;
 
@@ -329,6 +330,13 @@ namespace Falcor
         */
         ShaderVar operator[](UniformShaderVarOffset const& offset) const;
 
+        /** Create a shader variable from a pre-resolved path relative to this one.
+
+            The handle resolves its path against the type of this variable on first use, and again
+            whenever the type changes (e.g. after the program has been relinked). See `ShaderVarHandle`.
+        */
+        ShaderVar operator[](ShaderVarHandle const& handle) const;
+
         /** Implicit conversion from a shader variable to a texture.
             This operation allows a bound texture to be queried using the `[]` syntax:
                 pTexture = pVars["someTexture"];
@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "ShaderVarHandle.h"
+
+namespace Falcor
+{
+    ShaderVarHandle::ShaderVarHandle(const std::string& path)
+        : mPath(path)
+    {
+        mNames = splitString(path, ".");
+        if (mNames.empty()) throw ArgumentError("Invalid shader variable path '{}'.", path);
+    }
+
+    bool ShaderVarHandle::resolve(const ReflectionType::SharedConstPtr& pRootType) const
+    {
+        mpRootType = pRootType;
+        mOffsets.clear();
+        if (!pRootType || mNames.empty()) return false;
+
+        std::vector<TypedShaderVarOffset> offsets;
+        const ReflectionType* pType = pRootType.get();
+        ShaderVarOffset offset = ShaderVarOffset::kZero;
+        bool atRoot = true;
+
+        for (const auto& name : mNames)
+        {
+            // Looking up a member of a constant buffer implicitly dereferences the buffer (see `ShaderVar::findMember()`).
+            // The offset up to the buffer is stored, and the lookup continues relative to the buffer's own parameter block.
+            if (auto pResourceType = pType->asResourceType(); pResourceType && pResourceType->getType() == ReflectionResourceType::Type::ConstantBuffer)
+            {
+                if (!atRoot) offsets.push_back(TypedShaderVarOffset(pType, offset));
+                auto pBlockReflector = pResourceType->getParameterBlockReflector();
+                if (!pBlockReflector) return false;
+                pType = pBlockReflector->getElementType().get();
+                offset = ShaderVarOffset::kZero;
+            }
+
+            auto pMember = pType->findMember(name);
+            if (!pMember) return false;
+            offset = offset + pMember->getBindLocation();
+            pType = pMember->getType().get();
+            atRoot = false;
+        }
+
+        offsets.push_back(TypedShaderVarOffset(pType, offset));
+        mOffsets = std::move(offsets);
+        return true;
+    }
+
+    ShaderVar ShaderVarHandle::apply(const ShaderVar& root) const
+    {
+        if (!root.isValid()) return ShaderVar();
+
+        auto pRootType = root.getType();
+        if (pRootType != mpRootType)
+        {
+            if (!resolve(pRootType))
+            {
+                logWarning("No shader variable named '{}' found.", mPath);
+                return ShaderVar();
+            }
+        }
+        else if (mOffsets.empty())
+        {
+            // Previously failed to resolve against this type, warning has already been issued.
+            return ShaderVar();
+        }
+
+        ShaderVar var = root;
+        for (const auto& offset : mOffsets) var = var[offset];
+        return var;
+    }
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ShaderVar.h"
+
+namespace Falcor
+{
+    /** A pre-resolved path to a shader variable.
+
+        Looking up a shader variable by name (e.g. `var["CB"]["frameCount"]`) walks the reflection
+        data by string at every step. A `ShaderVarHandle` resolves a dotted path such as
+        "CB.frameCount" once against the reflection type of the root variable and caches the
+        resulting offsets. Subsequent lookups apply the cached offsets directly:
+
+            ShaderVarHandle mFrameCount = ShaderVarHandle("CB.frameCount");
+            ...
+            var[mFrameCount] = frameCount;
+
+        Offsets into nested constant buffers are stored per buffer, as a `TypedShaderVarOffset`
+        is only valid relative to the parameter block it was computed for.
+
+        The handle remembers the root type it was resolved against. If the program is relinked
+        (e.g. after a define change) the program vars get a new reflection type and the handle
+        is re-resolved on the next lookup.
+    */
+    class FALCOR_API ShaderVarHandle
+    {
+    public:
+        /** Create an empty handle.
+        */
+        ShaderVarHandle() = default;
+
+        /** Create a handle for a dotted member path.
+            \param[in] path Path to the variable relative to the root variable, e.g. "CB.frameCount".
+        */
+        explicit ShaderVarHandle(const std::string& path);
+
+        /** Get the path of the variable.
+        */
+        const std::string& getPath() const { return mPath; }
+
+        /** Resolve the path against a root reflection type.
+            \param[in] pRootType Type of the root variable the handle will be applied to.
+            \return True if the path was found.
+        */
+        bool resolve(const ReflectionType::SharedConstPtr& pRootType) const;
+
+        /** Check if the handle is resolved against the given root type.
+        */
+        bool isResolvedFor(const ReflectionType* pRootType) const { return pRootType && mpRootType.get() == pRootType && !mOffsets.empty(); }
+
+        /** Look up the variable relative to a root variable.
+            The path is (re-)resolved if the handle has not yet been resolved against the type of `root`.
+            \param[in] root Root variable.
+            \return The shader variable, or an invalid shader variable if the path was not found.
+        */
+        ShaderVar apply(const ShaderVar& root) const;
+
+    private:
+        std::string mPath;                                          ///< Dotted path to the variable.
+        std::vector<std::string> mNames;                            ///< Path split into member names.
+
+        mutable ReflectionType::SharedConstPtr mpRootType;          ///< Root type the handle was last resolved against.
+        mutable std::vector<TypedShaderVarOffset> mOffsets;         ///< Offsets per parameter block along the path. Empty if unresolved.
+    };
+}
@@ -65,6 +65,7 @@
 #include "Core/BufferTypes/VariablesBufferUI.h"
 
 // Core/Platform
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Core/Platform/OS.h"
 #include "Core/Platform/ProgressBar.h"
 
@@ -76,7 +77,9 @@
 #include "Core/Program/ProgramReflection.h"
 #include "Core/Program/ProgramVars.h"
 #include "Core/Program/ProgramVersion.h"
+#include "Core/Program/ShaderCache.h"
 #include "Core/Program/ShaderLibrary.h"
+#include "Core/Program/ShaderVarHandle.h"
 
 // Core/State
 #include "Core/State/ComputeState.h"
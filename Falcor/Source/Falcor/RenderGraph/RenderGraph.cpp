@@ -72,6 +72,7 @@ namespace Falcor
         for (auto& it : mNodeData)
         {
             it.second.pPass->setScene(gpDevice->getRenderContext(), pScene);
+            mDirtyPasses.insert(it.first);
         }
         mRecompile = true;
     }
@@ -91,7 +92,7 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, passIndex]() { mRecompile = true; mDirtyPasses.insert(passIndex); };
         pPass->mName = passName;
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -143,7 +144,7 @@ namespace Falcor
         std::string passTypeName = pOldPass->getType();
         auto pPass = RenderPassLibrary::instance().createPass(pRenderContext, passTypeName.c_str(), dict);
         pPassIt->second.pPass = pPass;
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, index]() { mRecompile = true; mDirtyPasses.insert(index); };
         pPass->mName = pOldPass->getName();
 
         if (mpScene) pPass->setScene(gpDevice->getRenderContext(), mpScene);
@@ -384,12 +385,28 @@ namespace Falcor
     bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
     {
         if (!mRecompile) return true;
+        FALCOR_PROFILE("RenderGraph::compile()");
+
+        auto pPrevExe = std::move(mpExe);
         mpExe = nullptr;
 
         try
         {
-            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            RenderGraphCompiler::Mode mode;
+            mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps, pPrevExe, mDirtyPasses, mode);
             mRecompile = false;
+            mDirtyPasses.clear();
+
+            double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+            mCompileStats.lastTime = time;
+            mCompileStats.totalTime += time;
+            switch (mode)
+            {
+            case RenderGraphCompiler::Mode::Full: mCompileStats.fullCount++; break;
+            case RenderGraphCompiler::Mode::Incremental: mCompileStats.incrementalCount++; break;
+            case RenderGraphCompiler::Mode::Reuse: mCompileStats.reuseCount++; break;
+            }
             return true;
         }
         catch (const std::exception& e)
@@ -640,6 +657,13 @@ namespace Falcor
 
     void RenderGraph::renderUI(Gui::Widgets& widget)
     {
+        if (auto group = widget.group("Graph Compilation"))
+        {
+            std::string text = fmt::format("Full compilations: {}\nIncremental compilations: {}\nReused compilations: {}\n", mCompileStats.fullCount, mCompileStats.incrementalCount, mCompileStats.reuseCount);
+            text += fmt::format("Last compile time: {:.2f} ms\nTotal compile time: {:.2f} ms", mCompileStats.lastTime * 1e3, mCompileStats.totalTime * 1e3);
+            group.text(text);
+        }
+
         if (mpExe) mpExe->renderUI(widget);
     }
 
@@ -658,6 +682,17 @@ namespace Falcor
         if (mpExe) mpExe->onHotReload(reloaded);
     }
 
+    pybind11::dict RenderGraph::CompileStats::toPython() const
+    {
+        pybind11::dict d;
+        d["fullCount"] = fullCount;
+        d["incrementalCount"] = incrementalCount;
+        d["reuseCount"] = reuseCount;
+        d["lastTime"] = lastTime;
+        d["totalTime"] = totalTime;
+        return d;
+    }
+
     FALCOR_SCRIPT_BINDING(RenderGraph)
     {
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Formats);
@@ -665,6 +700,7 @@ namespace Falcor
         pybind11::class_<RenderGraph, RenderGraph::SharedPtr> renderGraph(m, "RenderGraph");
         renderGraph.def(pybind11::init(&RenderGraph::create));
         renderGraph.def_property("name", &RenderGraph::getName, &RenderGraph::setName);
+        renderGraph.def_property_readonly("compileStats", [](const RenderGraph* pGraph) { return pGraph->getCompileStats().toPython(); });
         renderGraph.def(RenderGraphIR::kAddPass, &RenderGraph::addPass, "pass"_a, "name"_a);
         renderGraph.def(RenderGraphIR::kRemovePass, &RenderGraph::removePass, "name"_a);
         renderGraph.def(RenderGraphIR::kAddEdge, &RenderGraph::addEdge, "src"_a, "dst"_a);
@@ -223,6 +223,23 @@ namespace Falcor
         bool compile(RenderContext* pRenderContext, std::string& log);
         bool compile(RenderContext* pRenderContext) { std::string s; return compile(pRenderContext, s); }
 
+        /** Graph compilation statistics.
+        */
+        struct CompileStats
+        {
+            uint32_t fullCount = 0;             ///< Number of full compilations.
+            uint32_t incrementalCount = 0;      ///< Number of compilations that only compiled the changed passes.
+            uint32_t reuseCount = 0;            ///< Number of compilations that reused the previous result as is.
+            double lastTime = 0.0;              ///< Time of the last compilation in seconds.
+            double totalTime = 0.0;             ///< Total compilation time in seconds.
+
+            pybind11::dict toPython() const;
+        };
+
+        /** Get the graph compilation statistics.
+        */
+        const CompileStats& getCompileStats() const { return mCompileStats; }
+
     private:
         RenderGraph(const std::string& name);
 
@@ -274,6 +291,8 @@ namespace Falcor
         RenderGraphExe::SharedPtr mpExe;                            ///< Helper for allocating resources and executing the graph.
         RenderGraphCompiler::Dependencies mCompilerDeps;            ///< Data needed by the graph compiler.
         bool mRecompile = false;                                    ///< Set to true to trigger a recompilation after any graph changes (topology/scene/size/passes/etc.)
+        std::unordered_set<uint32_t> mDirtyPasses;                  ///< Node IDs of passes that requested a recompile since the last compilation.
+        CompileStats mCompileStats;                                 ///< Graph compilation statistics.
 
         friend class RenderGraphUI;
         friend class RenderGraphExporter;
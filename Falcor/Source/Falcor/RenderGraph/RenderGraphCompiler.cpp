@@ -29,6 +29,7 @@
 #include "RenderGraphCompiler.h"
 #include "RenderGraph.h"
 #include "RenderPasses/ResolvePass.h"
+#include <numeric>
 
 namespace Falcor
 {
@@ -38,23 +39,93 @@ namespace Falcor
         {
             return src.getSampleCount() > 1 && dst.getSampleCount() == 1;
         }
+
+        template<typename T>
+        void hashValue(SHA1& sha1, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            sha1.update(&value, sizeof(value));
+        }
+
+        void hashString(SHA1& sha1, const std::string& str)
+        {
+            hashValue(sha1, str.size());
+            sha1.update(str.data(), str.size());
+        }
+
+        void hashReflection(SHA1& sha1, const RenderPassReflection& reflection)
+        {
+            hashValue(sha1, reflection.getFieldCount());
+            for (size_t i = 0; i < reflection.getFieldCount(); i++)
+            {
+                const auto& f = *reflection.getField(i);
+                hashString(sha1, f.getName());
+                hashValue(sha1, f.getType());
+                hashValue(sha1, f.getWidth());
+                hashValue(sha1, f.getHeight());
+                hashValue(sha1, f.getDepth());
+                hashValue(sha1, f.getSampleCount());
+                hashValue(sha1, f.getMipCount());
+                hashValue(sha1, f.getArraySize());
+                hashValue(sha1, f.getFormat());
+                hashValue(sha1, f.getBindFlags());
+                hashValue(sha1, f.getFlags());
+                hashValue(sha1, f.getVisibility());
+            }
+        }
     }
 
     RenderGraphCompiler::RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies) : mGraph(graph), mDependencies(dependencies) {}
 
     RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies)
+    {
+        Mode mode;
+        return compile(graph, pRenderContext, dependencies, nullptr, {}, mode);
+    }
+
+    RenderGraphExe::SharedPtr RenderGraphCompiler::compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies,
+        const RenderGraphExe::SharedPtr& pPrevExe, const std::unordered_set<uint32_t>& dirtyPasses, Mode& mode)
     {
         RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
 
+        {
+            FALCOR_PROFILE("resolveExecutionOrder");
+            c.resolveExecutionOrder();
+        }
+
+        // Reuse the previous compilation if none of its inputs changed. Only passes that requested a recompile are compiled again.
+        const SHA1::MD hash = c.computeHash();
+        if (pPrevExe && pPrevExe->mCompileHash == hash)
+        {
+            size_t compiledPassCount = 0;
+            if (c.recompileChangedPasses(pRenderContext, *pPrevExe, dirtyPasses, compiledPassCount))
+            {
+                mode = compiledPassCount > 0 ? Mode::Incremental : Mode::Reuse;
+                return pPrevExe;
+            }
+        }
+        mode = Mode::Full;
+
         // Register the external resources
         auto pResourcesCache = ResourceCache::create();
         for (const auto&[name, pRes] : dependencies.externalResources) pResourcesCache->registerExternalResource(name, pRes);
 
-        c.resolveExecutionOrder();
-        c.compilePasses(pRenderContext);
+        {
+            FALCOR_PROFILE("compilePasses");
+            c.compilePasses(pRenderContext);
+        }
         if (c.insertAutoPasses()) c.resolveExecutionOrder();
         c.validateGraph();
-        c.allocateResources(pResourcesCache.get());
+        {
+            FALCOR_PROFILE("allocateResources");
+            c.allocateResources(pResourcesCache.get());
+        }
+        {
+            FALCOR_PROFILE("compilePrograms");
+            std::vector<size_t> passIndices(c.mExecutionList.size());
+            std::iota(passIndices.begin(), passIndices.end(), 0);
+            c.compilePrograms(pResourcesCache, passIndices);
+        }
 
         auto pExe = RenderGraphExe::create();
         pExe->mExecutionList.reserve(c.mExecutionList.size());
@@ -65,9 +136,93 @@ namespace Falcor
         }
         c.restoreCompilationChanges();
         pExe->mpResourceCache = pResourcesCache;
+        pExe->mCompileHash = hash;
         return pExe;
     }
 
+    SHA1::MD RenderGraphCompiler::computeHash() const
+    {
+        SHA1 sha1;
+
+        hashValue(sha1, mDependencies.defaultResourceProps.dims);
+        hashValue(sha1, mDependencies.defaultResourceProps.format);
+
+        std::map<std::string, const Resource*> externalResources;
+        for (const auto& [name, pRes] : mDependencies.externalResources) externalResources[name] = pRes.get();
+        for (const auto& [name, pRes] : externalResources)
+        {
+            hashString(sha1, name);
+            hashValue(sha1, pRes);
+        }
+
+        // The passes in execution order with their reflection.
+        for (const auto& p : mExecutionList)
+        {
+            hashValue(sha1, p.index);
+            hashString(sha1, p.name);
+            hashReflection(sha1, p.reflector);
+        }
+
+        // Edges are hashed by their end points rather than their IDs, which change when the graph is rebuilt.
+        std::vector<std::string> edges;
+        for (const auto& [id, edgeData] : mGraph.mEdgeData)
+        {
+            const auto& pEdge = mGraph.mpGraph->getEdge(id);
+            edges.push_back(std::to_string(pEdge->getSourceNode()) + '.' + edgeData.srcField + "->" + std::to_string(pEdge->getDestNode()) + '.' + edgeData.dstField);
+        }
+        std::sort(edges.begin(), edges.end());
+        for (const auto& e : edges) hashString(sha1, e);
+
+        // Graph outputs, ignoring the channel masks which don't affect compilation.
+        std::vector<std::string> outputs;
+        for (const auto& o : mGraph.mOutputs) outputs.push_back(std::to_string(o.nodeId) + '.' + o.field);
+        std::sort(outputs.begin(), outputs.end());
+        for (const auto& o : outputs) hashString(sha1, o);
+
+        return sha1.final();
+    }
+
+    bool RenderGraphCompiler::recompileChangedPasses(RenderContext* pRenderContext, RenderGraphExe& exe, const std::unordered_set<uint32_t>& dirtyPasses, size_t& compiledPassCount)
+    {
+        // Passes inserted by the compiler (e.g. MSAA resolve) are not part of the graph, so such graphs are always fully compiled.
+        if (exe.mExecutionList.size() != mExecutionList.size()) return false;
+
+        // Passes that requested a recompile, or were replaced with a new instance, need to be compiled.
+        std::vector<size_t> passIndices;
+        for (size_t i = 0; i < mExecutionList.size(); i++)
+        {
+            if (exe.mExecutionList[i].name != mExecutionList[i].name) return false;
+            if (exe.mExecutionList[i].pPass != mExecutionList[i].pPass || dirtyPasses.count(mExecutionList[i].index)) passIndices.push_back(i);
+        }
+        compiledPassCount = passIndices.size();
+        if (passIndices.empty()) return true;
+
+        {
+            FALCOR_PROFILE("compilePasses");
+            for (auto i : passIndices)
+            {
+                const auto& p = mExecutionList[i];
+                try
+                {
+                    p.pPass->compile(pRenderContext, prepPassCompilationData(p));
+                }
+                catch (const std::exception& e)
+                {
+                    logDebug("Incremental compilation of render pass '{}' failed, compiling the whole graph. {}", p.name, e.what());
+                    return false;
+                }
+            }
+        }
+
+        for (auto i : passIndices) exe.mExecutionList[i].pPass = mExecutionList[i].pPass;
+
+        {
+            FALCOR_PROFILE("compilePrograms");
+            compilePrograms(exe.mpResourceCache, passIndices);
+        }
+        return true;
+    }
+
     void RenderGraphCompiler::validateGraph() const
     {
         std::string err;
@@ -400,6 +555,32 @@ namespace Falcor
         return compileData;
     }
 
+    void RenderGraphCompiler::compilePrograms(const ResourceCache::SharedPtr& pResourceCache, const std::vector<size_t>& passIndices)
+    {
+        // Collect the programs the passes will use and compile them concurrently, instead of serially during the first execute().
+        std::vector<Program::CompileRequest> requests;
+        for (auto i : passIndices)
+        {
+            const auto& p = mExecutionList[i];
+            RenderData renderData(p.name, pResourceCache, mGraph.mpPassDictionary, mDependencies.defaultResourceProps.dims, mDependencies.defaultResourceProps.format);
+            p.pPass->collectPrograms(renderData, requests);
+        }
+        if (requests.empty()) return;
+
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        auto results = Program::compilePrograms(requests);
+        if (results.empty()) return;
+        double time = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) * 1e-3;
+
+        double totalTime = 0.0;
+        for (const auto& r : results)
+        {
+            totalTime += r.versionTime + r.kernelsTime;
+            if (r.success) logDebug("Compiled program in {:.3f} s (version {:.3f} s, kernels {:.3f} s): {}", r.versionTime + r.kernelsTime, r.versionTime, r.kernelsTime, r.name);
+        }
+        logInfo("Compiled {} render graph programs in {:.3f} s ({:.3f} s serial).", results.size(), time, totalTime);
+    }
+
     void RenderGraphCompiler::compilePasses(RenderContext* pRenderContext)
     {
         while(1)
@@ -41,8 +41,31 @@ namespace Falcor
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
         };
+
+        /** How a graph was compiled.
+        */
+        enum class Mode
+        {
+            Full,           ///< All passes were compiled and the resources allocated.
+            Incremental,    ///< The previous compilation was reused, and only the passes that changed were compiled.
+            Reuse,          ///< The previous compilation was reused as is.
+        };
+
         static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
 
+        /** Compile the graph, reusing the previous compilation if possible.
+            The previous compilation is reused if the graph topology, the pass reflections and the dependencies are unchanged.
+            \param[in] graph The graph to compile.
+            \param[in] pRenderContext Render context.
+            \param[in] dependencies Data needed by the compiler.
+            \param[in] pPrevExe Result of the previous compilation, or nullptr.
+            \param[in] dirtyPasses Node IDs of the passes that requested a recompile since the previous compilation.
+            \param[out] mode How the graph was compiled.
+            \return The compiled graph.
+        */
+        static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies,
+            const RenderGraphExe::SharedPtr& pPrevExe, const std::unordered_set<uint32_t>& dirtyPasses, Mode& mode);
+
     private:
         RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies);
         RenderGraph& mGraph;
@@ -68,6 +91,9 @@ namespace Falcor
         void compilePasses(RenderContext* pRenderContext);
         bool insertAutoPasses();
         void allocateResources(ResourceCache* pResourceCache);
+        void compilePrograms(const ResourceCache::SharedPtr& pResourceCache, const std::vector<size_t>& passIndices);
+        SHA1::MD computeHash() const;
+        bool recompileChangedPasses(RenderContext* pRenderContext, RenderGraphExe& exe, const std::unordered_set<uint32_t>& dirtyPasses, size_t& compiledPassCount);
         void validateGraph() const;
         void restoreCompilationChanges();
         RenderPass::CompileData prepPassCompilationData(const PassData& passData);
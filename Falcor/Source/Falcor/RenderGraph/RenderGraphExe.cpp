@@ -34,6 +34,9 @@ namespace Falcor
     {
         FALCOR_PROFILE("RenderGraphExe::execute()");
 
+        // Make the resources written in the previous frame available as history resources.
+        mpResourceCache->swapHistoryResources();
+
         for (const auto& pass : mExecutionList)
         {
             FALCOR_PROFILE(pass.name);
@@ -29,6 +29,7 @@
 #include "ResourceCache.h"
 #include "Utils/InternalDictionary.h"
 #include "RenderPass.h"
+#include "Utils/CryptoUtils.h"
 
 namespace Falcor
 {
@@ -98,5 +99,6 @@ namespace Falcor
 
         std::vector<Pass> mExecutionList;
         ResourceCache::SharedPtr mpResourceCache;
+        SHA1::MD mCompileHash = {};     ///< Hash of the compiler inputs, used to detect if the graph needs to be compiled again.
     };
 }
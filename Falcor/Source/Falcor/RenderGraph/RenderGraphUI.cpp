@@ -742,23 +742,16 @@ namespace Falcor
         ImGui::TextUnformatted(to_string(field.getBindFlags()).c_str());
 
         ImGui::TextUnformatted("Flags: ");
-        switch (field.getFlags())
+        ImGui::SameLine();
+        std::string flags;
+        auto addFlag = [&](RenderPassReflection::Field::Flags flag, const std::string& name)
         {
-        case RenderPassReflection::Field::Flags::None:
-            ImGui::SameLine();
-            ImGui::TextUnformatted("None");
-            break;
-        case RenderPassReflection::Field::Flags::Optional:
-            ImGui::SameLine();
-            ImGui::TextUnformatted("Optional");
-            break;
-        case RenderPassReflection::Field::Flags::Persistent:
-            ImGui::SameLine();
-            ImGui::TextUnformatted("Persistent");
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-        }
+            if (is_set(field.getFlags(), flag)) flags += (flags.empty() ? "" : " | ") + name;
+        };
+        addFlag(RenderPassReflection::Field::Flags::Optional, "Optional");
+        addFlag(RenderPassReflection::Field::Flags::Persistent, "Persistent");
+        addFlag(RenderPassReflection::Field::Flags::History, "History");
+        ImGui::TextUnformatted(flags.empty() ? "None" : flags.c_str());
     }
 
     void RenderPassUI::PinUI::renderUI(const RenderPassReflection::Field& field, RenderGraphUI* pGraphUI, const std::string& passName)
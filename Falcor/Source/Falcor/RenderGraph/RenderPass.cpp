@@ -44,4 +44,9 @@ namespace Falcor
     {
         return mpResources->getResource(mName + '.' + name);
     }
+
+    const Resource::SharedPtr& RenderData::getHistoryResource(const std::string& name) const
+    {
+        return mpResources->getHistoryResource(mName + '.' + name);
+    }
 }
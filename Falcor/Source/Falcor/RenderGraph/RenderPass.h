@@ -55,6 +55,12 @@ namespace Falcor
         */
         const Resource::SharedPtr& getResource(const std::string& name) const;
 
+        /** Get the resource holding the previous frame's contents of a field marked with RenderPassReflection::Field::Flags::History
+            \param[in] name The name of the pass' resource (i.e. "outputColor"). No need to specify the pass' name
+            \return If the field is a history field and a previous frame was rendered, a pointer to the history resource. Otherwise, nullptr
+        */
+        const Resource::SharedPtr& getHistoryResource(const std::string& name) const;
+
         /** Get the global dictionary. You can use it to pass data between different passes
         */
         InternalDictionary& getDictionary() const { return (*mpDictionary); }
@@ -81,6 +87,7 @@ namespace Falcor
         ResourceFormat mDefaultTexFormat;
 
         friend class RenderGraphExe;
+        friend class RenderGraphCompiler;
     };
 
     /** Base class for render passes.
@@ -141,6 +148,14 @@ namespace Falcor
         */
         virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) = 0;
 
+        /** Called at the end of graph compilation to collect the programs the pass will use in execute().
+            The render graph compiles the collected programs concurrently instead of serially on the first frame.
+            Passes that create their programs lazily should create them here, with the defines they will use for the given resources.
+            \param[in] renderData The render data the pass will be executed with.
+            \param[out] requests Programs to compile. The pass appends its programs to the list.
+        */
+        virtual void collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests) {}
+
         /** Get a dictionary that can be used to reconstruct the object
         */
         virtual Dictionary getScriptingDictionary() { return {}; }
@@ -245,6 +245,7 @@ namespace Falcor
         FALCOR_ASSERT(is_set(mVisibility, RenderPassReflection::Field::Visibility::Internal) == false); // We can't alias/merge internal fields
         mVisibility = mVisibility | other.mVisibility;
         mBindFlags = mBindFlags | other.mBindFlags;
+        if (is_set(other.mFlags, Flags::History)) mFlags = mFlags | Flags::History;
         return *this;
     }
 
@@ -52,6 +52,7 @@ namespace Falcor
                 None = 0x0,         ///< None
                 Optional = 0x1,     ///< Mark that field as optional. For output resources, it means that they don't have to be bound unless their result is required by the caller. For input resources, it means that the pass can function correctly without them being bound (but the behavior might be different)
                 Persistent = 0x2,   ///< The resource bound to this field must not change between execute() calls (not the pointer nor the data). It can change only during the RenderGraph recompilation.
+                History = 0x4,      ///< The render graph double-buffers the resource. The contents written in the previous frame are available through RenderData::getHistoryResource(). Marking an input as history double-buffers the output it is connected to.
             };
 
             /** Field type
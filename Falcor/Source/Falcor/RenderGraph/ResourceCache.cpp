@@ -31,9 +31,19 @@
 
 namespace Falcor
 {
-    ResourceCache::SharedPtr ResourceCache::create()
+    namespace
     {
-        return SharedPtr(new ResourceCache());
+        bool isHistoryField(const RenderPassReflection::Field& field)
+        {
+            return is_set(field.getFlags(), RenderPassReflection::Field::Flags::History);
+        }
+    }
+
+    Resource::SharedPtr createResourceForPass(const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName);
+
+    ResourceCache::SharedPtr ResourceCache::create(const ResourceFactory& factory)
+    {
+        return SharedPtr(new ResourceCache(factory ? factory : ResourceFactory(createResourceForPass)));
     }
 
     void ResourceCache::reset()
@@ -58,6 +68,27 @@ namespace Falcor
         return extIt->second;
     }
 
+    const Resource::SharedPtr& ResourceCache::getHistoryResource(const std::string& name) const
+    {
+        static const Resource::SharedPtr pNull;
+        const auto& it = mNameToIndex.find(name);
+        if (it == mNameToIndex.end()) return pNull;
+
+        // The history resource only holds valid data once a frame was rendered into it.
+        const auto& data = mResourceData[it->second];
+        return data.historyFrameCount > 1 ? data.pHistoryResource : pNull;
+    }
+
+    void ResourceCache::swapHistoryResources()
+    {
+        for (auto& data : mResourceData)
+        {
+            if (!data.pHistoryResource) continue;
+            if (data.historyFrameCount > 0) std::swap(data.pResource, data.pHistoryResource);
+            data.historyFrameCount = std::min(data.historyFrameCount + 1, 2u);
+        }
+    }
+
     const RenderPassReflection::Field& ResourceCache::getResourceReflection(const std::string& name) const
     {
         uint32_t i = mNameToIndex.at(name);
@@ -111,6 +142,7 @@ namespace Falcor
             mResourceData[index].field.merge(field);
             mergeTimePoint(mResourceData[index].lifetime, timePoint);
             mResourceData[index].pResource = nullptr;
+            mResourceData[index].pHistoryResource = nullptr;
             mResourceData[index].resolveBindFlags = mResourceData[index].resolveBindFlags || (field.getBindFlags() == ResourceBindFlags::None);
         }
     }
@@ -185,7 +217,11 @@ namespace Falcor
         {
             if ((data.pResource == nullptr) && (data.field.isValid()))
             {
-                data.pResource = createResourceForPass(params, data.field, data.resolveBindFlags, data.name);
+                data.pResource = mFactory(params, data.field, data.resolveBindFlags, data.name);
+
+                // History fields are double-buffered. The resources are swapped at the start of each frame.
+                if (isHistoryField(data.field)) data.pHistoryResource = mFactory(params, data.field, data.resolveBindFlags, data.name + ".history");
+                data.historyFrameCount = 0;
             }
         }
     }
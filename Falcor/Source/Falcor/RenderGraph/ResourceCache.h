@@ -28,6 +28,7 @@
 #pragma once
 #include "RenderGraph/RenderPassReflection.h"
 #include "Core/API/Resource.h"
+#include <functional>
 
 namespace Falcor
 {
@@ -37,10 +38,6 @@ namespace Falcor
         using SharedPtr = std::shared_ptr<ResourceCache>;
         using ResourcesMap = std::unordered_map<std::string, Resource::SharedPtr>;
 
-        /** Create a new object
-        */
-        static SharedPtr create();
-
         /** Properties to use during resource creation when its property has not been fully specified.
         */
         struct DefaultProperties
@@ -49,6 +46,16 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::Unknown;    ///< Format to use for texture creation
         };
 
+        /** Function creating the resource for a field.
+            The arguments are the default properties, the field, whether the bind flags should be resolved from the field's visibility, and the resource name.
+        */
+        using ResourceFactory = std::function<Resource::SharedPtr(const DefaultProperties&, const RenderPassReflection::Field&, bool, const std::string&)>;
+
+        /** Create a new object
+            \param[in] factory Optional function creating the resources. By default, GPU resources are created according to the field properties.
+        */
+        static SharedPtr create(const ResourceFactory& factory = {});
+
         /** Add/Remove reference to a graph input resource not owned by the cache
             \param[in] name The resource's name
             \param[in] pResource The resource to register. If this is null, will unregister the resource
@@ -68,6 +75,17 @@ namespace Falcor
         */
         const Resource::SharedPtr& getResource(const std::string& name) const;
 
+        /** Get the resource holding the previous frame of a history field.
+            \param[in] name The resource's name.
+            \return The history resource, or nullptr if the field is not a history field or no previous frame was rendered since the resource was allocated.
+        */
+        const Resource::SharedPtr& getHistoryResource(const std::string& name) const;
+
+        /** Swap the current and history resources of all history fields.
+            Called by the render graph at the start of each frame, so the resources written in the previous frame become the history resources.
+        */
+        void swapHistoryResources();
+
         /** Get the field-reflection of a resource
         */
         const RenderPassReflection::Field& getResourceReflection(const std::string& name) const;
@@ -82,7 +100,7 @@ namespace Falcor
         void reset();
 
     private:
-        ResourceCache() = default;
+        ResourceCache(const ResourceFactory& factory) : mFactory(factory) {}
 
         struct ResourceData
         {
@@ -91,8 +109,12 @@ namespace Falcor
             Resource::SharedPtr pResource;          // The resource
             bool resolveBindFlags;                  // Whether or not we should resolve the field's bind-flags before creating the resource
             std::string name;                       // Full name of the resource, including the pass name
+            Resource::SharedPtr pHistoryResource;   // For history fields, the resource holding the previous frame
+            uint32_t historyFrameCount = 0;         // For history fields, the number of frames started since the resources were allocated
         };
 
+        ResourceFactory mFactory;
+
         // Resources and properties for fields within (and therefore owned by) a render graph
         std::unordered_map<std::string, uint32_t> mNameToIndex;
         std::vector<ResourceData> mResourceData;
@@ -27,7 +27,14 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "EnvMapSampler.h"
+#include "Utils/CacheFiles.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/NumericRange.h"
 #include "glm/gtc/integer.hpp"
+#include <execution>
+#include <fstream>
 
 namespace Falcor
 {
@@ -35,14 +42,276 @@ namespace Falcor
     {
         const char kShaderFilenameSetup[] = "Rendering/Lights/EnvMapSamplerSetup.cs.slang";
 
-        // The defaults are 512x512 @ 64spp in the resampling step.
-        const uint32_t kDefaultDimension = 512;
-        const uint32_t kDefaultSpp = 64;
+        /** Specifies the current cache file version.
+            This needs to be incremented every time the importance map computation or the file format changes!
+        */
+        const uint32_t kCacheVersion = 1;
+
+        /** Importance map cache directory (subdirectory in the application data directory).
+        */
+        const std::string kCacheDirectory = "NVIDIA/Falcor/EnvMapCache";
+
+        const char* kCacheMagic = "FalcorE$";
+        struct CacheHeader
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+            uint32_t dimension{};
+            uint32_t samples{};
+
+            bool isValid(uint32_t dimension_, uint32_t samples_) const
+            {
+                return std::memcmp(magic, kCacheMagic, sizeof(CacheHeader::magic)) == 0 && version == kCacheVersion && dimension == dimension_ && samples == samples_;
+            }
+        };
+
+        // Host-side equivalents of the mapping functions in Utils/Math/MathHelpers.slang used by the setup pass.
+
+        float3 octToDirEqualAreaUnorm(float2 p)
+        {
+            p = p * 2.f - 1.f;
+
+            // Compute radius r without branching. The radius r=0 at +z (center) and at -z (corners).
+            float d = 1.f - (std::abs(p.x) + std::abs(p.y));
+            float r = 1.f - std::abs(d);
+
+            // Compute phi in [0,pi/2] (first quadrant) and sin/cos(phi).
+            float phi = (r > 0.f) ? ((std::abs(p.y) - std::abs(p.x)) / r + 1.f) * (float)M_PI_4 : 0.f;
+
+            // Convert to Cartesian coordinates. Note that sign(x)=0 for x=0, but that's fine here.
+            float f = r * std::sqrt(2.f - r * r);
+            float x = f * glm::sign(p.x) * std::cos(phi);
+            float y = f * glm::sign(p.y) * std::sin(phi);
+            float z = glm::sign(d) * (1.f - r * r);
+
+            return float3(x, y, z);
+        }
+
+        float2 worldToLatLongMap(float3 dir)
+        {
+            float3 p = glm::normalize(dir);
+            float2 uv;
+            uv.x = std::atan2(p.x, -p.z) * (float)M_1_PI * 0.5f + 0.5f;
+            uv.y = std::acos(glm::clamp(p.y, -1.f, 1.f)) * (float)M_1_PI;
+            return uv;
+        }
+
+        /** Convert the bitmap to a tightly packed luminance image.
+            Luminance is linear in RGB, so bilinear filtering of the luminance image gives the same result as
+            computing the luminance of bilinearly filtered colors, which is what the setup pass does.
+        */
+        template<typename ReadTexel>
+        std::vector<float> computeLuminance(const Bitmap& bitmap, ReadTexel readTexel)
+        {
+            const uint32_t width = bitmap.getWidth();
+            const uint32_t height = bitmap.getHeight();
+            const uint32_t texelSize = getFormatBytesPerBlock(bitmap.getFormat());
+
+            std::vector<float> luminanceMap((size_t)width * height);
+            NumericRange<uint32_t> rows(0, height);
+            std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+            {
+                const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+                float* pDst = luminanceMap.data() + (size_t)y * width;
+                for (uint32_t x = 0; x < width; x++) pDst[x] = luminance(readTexel(pRow + (size_t)x * texelSize));
+            });
+            return luminanceMap;
+        }
+
+        std::vector<float> computeLuminance(const Bitmap& bitmap)
+        {
+            switch (bitmap.getFormat())
+            {
+            case ResourceFormat::RGBA32Float:
+            case ResourceFormat::RGB32Float:
+                return computeLuminance(bitmap, [](const uint8_t* p) { const float* c = reinterpret_cast<const float*>(p); return float3(c[0], c[1], c[2]); });
+            case ResourceFormat::RGBA16Float:
+            case ResourceFormat::RGB16Float:
+                return computeLuminance(bitmap, [](const uint8_t* p) { const float16_t* c = reinterpret_cast<const float16_t*>(p); return float3(float(c[0]), float(c[1]), float(c[2])); });
+            case ResourceFormat::RGBA8Unorm:
+                return computeLuminance(bitmap, [](const uint8_t* p) { return float3(p[0], p[1], p[2]) * (1.f / 255.f); });
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRX8Unorm:
+                return computeLuminance(bitmap, [](const uint8_t* p) { return float3(p[2], p[1], p[0]) * (1.f / 255.f); });
+            default:
+                return {};
+            }
+        }
+
+        /** Bilinearly sample an image with wrap addressing (matches the default sampler used by the setup pass).
+        */
+        float sampleBilinearWrap(const std::vector<float>& image, uint32_t width, uint32_t height, float2 uv)
+        {
+            float fx = uv.x * width - 0.5f;
+            float fy = uv.y * height - 0.5f;
+            float x0 = std::floor(fx);
+            float y0 = std::floor(fy);
+            float tx = fx - x0;
+            float ty = fy - y0;
+
+            auto wrap = [](int64_t i, uint32_t n) { int64_t m = i % (int64_t)n; return (size_t)(m < 0 ? m + n : m); };
+            size_t ix0 = wrap((int64_t)x0, width), ix1 = wrap((int64_t)x0 + 1, width);
+            size_t iy0 = wrap((int64_t)y0, height), iy1 = wrap((int64_t)y0 + 1, height);
+
+            float v00 = image[iy0 * width + ix0];
+            float v10 = image[iy0 * width + ix1];
+            float v01 = image[iy1 * width + ix0];
+            float v11 = image[iy1 * width + ix1];
+
+            return glm::mix(glm::mix(v00, v10, tx), glm::mix(v01, v11, tx), ty);
+        }
+
+        bool hashFile(const std::string& path, SHA1& sha1)
+        {
+            std::ifstream fs(path, std::ios_base::binary);
+            if (!fs.good()) return false;
+
+            std::vector<char> buffer(1 << 20);
+            while (fs)
+            {
+                fs.read(buffer.data(), buffer.size());
+                sha1.update(buffer.data(), (size_t)fs.gcount());
+            }
+            return fs.eof();
+        }
+
+        std::filesystem::path getCachePath(const SHA1::MD& key)
+        {
+            std::stringstream ss;
+            ss << std::hex << std::setfill('0');
+            for (auto c : key) ss << std::setw(2) << (int)c;
+            return EnvMapSampler::getCacheDirectory() / ss.str();
+        }
+
+        bool readCache(const std::filesystem::path& cachePath, uint32_t dimension, uint32_t samples, EnvMapSampler::ImportanceMips& mips)
+        {
+            if (!std::filesystem::exists(cachePath)) return false;
+
+            std::ifstream fs(cachePath, std::ios_base::binary);
+            if (!fs.good()) return false;
+
+            CacheHeader header;
+            fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!fs.good() || !header.isValid(dimension, samples)) return false;
+
+            mips.clear();
+            for (uint32_t dim = dimension; dim > 0; dim /= 2)
+            {
+                auto& mip = mips.emplace_back((size_t)dim * dim);
+                fs.read(reinterpret_cast<char*>(mip.data()), mip.size() * sizeof(float));
+            }
+            if (!fs.good()) return false;
+
+            touchCacheFile(cachePath);
+            return true;
+        }
+
+        void writeCache(const std::filesystem::path& cachePath, uint32_t dimension, uint32_t samples, const EnvMapSampler::ImportanceMips& mips, uint64_t maxCacheSizeInBytes)
+        {
+            // Write to a uniquely named temporary file first, so that concurrent writers never write to the same file and readers never see a partial cache file.
+            const std::filesystem::path tempPath = createCacheTempFile(cachePath);
+            if (tempPath.empty()) return;
+
+            bool success = false;
+            {
+                std::ofstream fs(tempPath, std::ios_base::binary);
+                if (fs.good())
+                {
+                    CacheHeader header;
+                    std::memcpy(header.magic, kCacheMagic, sizeof(CacheHeader::magic));
+                    header.version = kCacheVersion;
+                    header.dimension = dimension;
+                    header.samples = samples;
+                    fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                    for (const auto& mip : mips) fs.write(reinterpret_cast<const char*>(mip.data()), mip.size() * sizeof(float));
+                    success = fs.good();
+                }
+            }
+
+            if (!success)
+            {
+                logWarning("Failed to write env map cache file '{}'.", tempPath.string());
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+
+            if (commitCacheFile(tempPath, cachePath)) trimCacheDirectory(cachePath.parent_path(), maxCacheSizeInBytes);
+        }
     }
 
-    EnvMapSampler::SharedPtr EnvMapSampler::create(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap)
+    EnvMapSampler::SharedPtr EnvMapSampler::create(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap, const Options& options)
     {
-        return SharedPtr(new EnvMapSampler(pRenderContext, pEnvMap));
+        return SharedPtr(new EnvMapSampler(pRenderContext, pEnvMap, options));
+    }
+
+    EnvMapSampler::ImportanceMips EnvMapSampler::computeImportanceMap(const Bitmap& envMap, uint32_t dimension, uint32_t samples)
+    {
+        checkArgument(isPowerOf2(dimension), "'dimension' ({}) must be a power of two.", dimension);
+        checkArgument(isPowerOf2(samples), "'samples' ({}) must be a power of two.", samples);
+
+        std::vector<float> luminanceMap = computeLuminance(envMap);
+        if (luminanceMap.empty()) return {};
+
+        const uint32_t width = envMap.getWidth();
+        const uint32_t height = envMap.getHeight();
+
+        // Use the same sample layout as the setup pass.
+        const uint32_t samplesX = std::max(1u, (uint32_t)std::sqrt(samples));
+        const uint32_t samplesY = samples / samplesX;
+        FALCOR_ASSERT(samples == samplesX * samplesY);
+        const float2 invDimInSamples = 1.f / float2(dimension * samplesX, dimension * samplesY);
+        const float invSamples = 1.f / (samplesX * samplesY);
+
+        ImportanceMips mips;
+        mips.reserve(glm::log2(dimension) + 1);
+
+        // Compute the base mip by resampling the env map into an equal-area octahedral map.
+        auto& baseMip = mips.emplace_back((size_t)dimension * dimension);
+        NumericRange<uint32_t> rows(0, dimension);
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t py)
+        {
+            for (uint32_t px = 0; px < dimension; px++)
+            {
+                float L = 0.f;
+                for (uint32_t y = 0; y < samplesY; y++)
+                {
+                    for (uint32_t x = 0; x < samplesX; x++)
+                    {
+                        float2 p = (float2(px * samplesX + x, py * samplesY + y) + 0.5f) * invDimInSamples;
+                        float2 uv = worldToLatLongMap(octToDirEqualAreaUnorm(p));
+                        L += sampleBilinearWrap(luminanceMap, width, height, uv);
+                    }
+                }
+                baseMip[(size_t)py * dimension + px] = L * invSamples;
+            }
+        });
+
+        // Reduce into the mip hierarchy using a 2x2 box filter (equivalent to the GPU mip generation for power-of-two sizes).
+        for (uint32_t dim = dimension / 2; dim > 0; dim /= 2)
+        {
+            const auto& src = mips.back();
+            std::vector<float> dst((size_t)dim * dim);
+            const size_t srcDim = (size_t)dim * 2;
+            NumericRange<uint32_t> mipRows(0, dim);
+            std::for_each(std::execution::par, mipRows.begin(), mipRows.end(), [&](uint32_t y)
+            {
+                const float* pSrc0 = src.data() + (2 * (size_t)y) * srcDim;
+                const float* pSrc1 = pSrc0 + srcDim;
+                for (uint32_t x = 0; x < dim; x++)
+                {
+                    dst[(size_t)y * dim + x] = 0.25f * (pSrc0[2 * x] + pSrc0[2 * x + 1] + pSrc1[2 * x] + pSrc1[2 * x + 1]);
+                }
+            });
+            mips.push_back(std::move(dst));
+        }
+
+        return mips;
+    }
+
+    std::filesystem::path EnvMapSampler::getCacheDirectory()
+    {
+        return std::filesystem::path(getAppDataDirectory()) / kCacheDirectory;
     }
 
     void EnvMapSampler::setShaderData(const ShaderVar& var) const
@@ -59,13 +328,12 @@ namespace Falcor
         var["importanceSampler"] = mpImportanceSampler;
     }
 
-    EnvMapSampler::EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap)
+    EnvMapSampler::EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap, const Options& options)
         : mpEnvMap(pEnvMap)
     {
         FALCOR_ASSERT(pEnvMap);
-
-        // Create compute program for the setup phase.
-        mpSetupPass = ComputePass::create(kShaderFilenameSetup, "main");
+        checkArgument(isPowerOf2(options.dimension), "'dimension' ({}) must be a power of two.", options.dimension);
+        checkArgument(isPowerOf2(options.samples), "'samples' ({}) must be a power of two.", options.samples);
 
         // Create sampler.
         Sampler::Desc samplerDesc;
@@ -74,7 +342,9 @@ namespace Falcor
         mpImportanceSampler = Sampler::create(samplerDesc);
 
         // Create hierarchical importance map for sampling.
-        if (!createImportanceMap(pRenderContext, kDefaultDimension, kDefaultSpp))
+        // The CPU builder is used when the env map source image is available, otherwise we fall back to the GPU setup pass.
+        bool created = options.useCPUBuilder && createImportanceMapCPU(pRenderContext, options);
+        if (!created && !createImportanceMap(pRenderContext, options.dimension, options.samples))
         {
             throw RuntimeError("Failed to create importance map");
         }
@@ -94,6 +364,9 @@ namespace Falcor
         mpImportanceMap = Texture::create2D(dimension, dimension, ResourceFormat::R32Float, 1, mips, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::RenderTarget | Resource::BindFlags::UnorderedAccess);
         FALCOR_ASSERT(mpImportanceMap);
 
+        // Create compute program for the setup phase.
+        if (!mpSetupPass) mpSetupPass = ComputePass::create(kShaderFilenameSetup, "main");
+
         mpSetupPass["gEnvMap"] = mpEnvMap->getEnvMap();
         mpSetupPass["gImportanceMap"] = mpImportanceMap;
 
@@ -115,4 +388,58 @@ namespace Falcor
         return true;
     }
 
+    bool EnvMapSampler::createImportanceMapCPU(RenderContext* pRenderContext, const Options& options)
+    {
+        const uint32_t dimension = options.dimension;
+        const uint32_t samples = options.samples;
+        FALCOR_ASSERT(isPowerOf2(dimension));
+        FALCOR_ASSERT(isPowerOf2(samples));
+
+        // The CPU builder works on the source image. DDS files may be block compressed and are left to the GPU path.
+        const std::string& filename = mpEnvMap->getFilename();
+        if (filename.empty() || hasSuffix(filename, ".dds", false) || !std::filesystem::exists(filename)) return false;
+
+        // Textures loaded as sRGB are linearized by the sampler, which the CPU builder does not replicate.
+        if (isSrgbFormat(mpEnvMap->getEnvMap()->getFormat())) return false;
+
+        // Key the cache on the file content and the importance map parameters.
+        std::filesystem::path cachePath;
+        if (options.useCache)
+        {
+            SHA1 sha1;
+            if (hashFile(filename, sha1))
+            {
+                sha1.update(&kCacheVersion, sizeof(kCacheVersion));
+                sha1.update(&dimension, sizeof(dimension));
+                sha1.update(&samples, sizeof(samples));
+                cachePath = getCachePath(sha1.final());
+            }
+        }
+
+        ImportanceMips mips;
+        if (cachePath.empty() || !readCache(cachePath, dimension, samples, mips))
+        {
+            Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, true);
+            if (!pBitmap) return false;
+
+            mips = computeImportanceMap(*pBitmap, dimension, samples);
+            if (mips.empty()) return false;
+
+            if (!cachePath.empty()) writeCache(cachePath, dimension, samples, mips, options.maxCacheSizeInBytes);
+        }
+
+        uint32_t mipCount = (uint32_t)mips.size();
+        FALCOR_ASSERT((1u << (mipCount - 1)) == dimension);
+        FALCOR_ASSERT(mipCount > 1 && mipCount <= 12);     // Shader constant limits max resolution, increase if needed.
+
+        mpImportanceMap = Texture::create2D(dimension, dimension, ResourceFormat::R32Float, 1, mipCount, nullptr, Resource::BindFlags::ShaderResource);
+        FALCOR_ASSERT(mpImportanceMap);
+
+        for (uint32_t mip = 0; mip < mipCount; mip++)
+        {
+            pRenderContext->updateSubresourceData(mpImportanceMap.get(), mpImportanceMap->getSubresourceIndex(0, mip), mips[mip].data());
+        }
+
+        return true;
+    }
 }
@@ -28,6 +28,8 @@
 #pragma once
 
 #include "Scene/Lights/EnvMap.h"
+#include "Utils/Image/Bitmap.h"
+#include <filesystem>
 
 namespace Falcor
 {
@@ -39,13 +41,48 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<EnvMapSampler>;
 
+        /** Importance map mip chain stored on the CPU.
+            Entry 0 is the NxN base level, the last entry is the 1x1 average.
+        */
+        using ImportanceMips = std::vector<std::vector<float>>;
+
+        static const uint32_t kDefaultDimension = 512;  ///< Default importance map resolution.
+        static const uint32_t kDefaultSamples = 64;     ///< Default number of samples per importance map texel.
+
+        /** Importance map creation options.
+        */
+        struct Options
+        {
+            uint32_t    dimension = kDefaultDimension;  ///< Importance map resolution (NxN). Must be a power of two.
+            uint32_t    samples = kDefaultSamples;      ///< Number of samples per texel in the resampling step. Must be a power of two.
+            bool        useCPUBuilder = true;           ///< Build the importance map on the CPU when the env map source image can be read. Otherwise the GPU setup pass is used.
+            bool        useCache = true;                ///< Load/store CPU-built importance maps in the env map cache.
+            uint64_t    maxCacheSizeInBytes = 1ull << 30; ///< Size limit of the env map cache directory. The least recently used importance maps are removed when adding one exceeds it. Zero disables the limit.
+        };
+
         virtual ~EnvMapSampler() = default;
 
         /** Create a new object.
             \param[in] pRenderContext A render-context that will be used for processing.
             \param[in] pEnvMap The environment map.
+            \param[in] options Importance map creation options.
+        */
+        static SharedPtr create(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap, const Options& options = Options());
+
+        /** Compute the hierarchical importance map for an environment map on the CPU.
+            This produces the same result as the GPU setup pass: the lat-long map is resampled into an
+            equal-area octahedral map of luminance values and reduced into a full mip chain by 2x2 box filtering.
+            The work is distributed over all available cores.
+            \param[in] envMap Environment map in lat-long layout (top-down). Supported formats are 3/4-channel float32/float16 and 8-bit RGBA/BGRA/BGRX unorm.
+            \param[in] dimension Importance map resolution (NxN). Must be a power of two.
+            \param[in] samples Number of samples per texel. Must be a power of two.
+            \return Importance map mip chain, or an empty vector if the bitmap format is not supported.
+        */
+        static ImportanceMips computeImportanceMap(const Bitmap& envMap, uint32_t dimension, uint32_t samples);
+
+        /** Get the path of the cache directory for CPU-built importance maps.
         */
-        static SharedPtr create(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap);
+        static std::filesystem::path getCacheDirectory();
 
         /** Bind the environment map sampler to a given shader variable.
             \param[in] var Shader variable.
@@ -57,13 +94,14 @@ namespace Falcor
         const Texture::SharedPtr& getImportanceMap() const { return mpImportanceMap; }
 
     protected:
-        EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap);
+        EnvMapSampler(RenderContext* pRenderContext, EnvMap::SharedPtr pEnvMap, const Options& options);
 
         bool createImportanceMap(RenderContext* pRenderContext, uint32_t dimension, uint32_t samples);
+        bool createImportanceMapCPU(RenderContext* pRenderContext, const Options& options);
 
         EnvMap::SharedPtr       mpEnvMap;           ///< Environment map.
 
-        ComputePass::SharedPtr  mpSetupPass;        ///< Compute pass for creating the importance map.
+        ComputePass::SharedPtr  mpSetupPass;        ///< Compute pass for creating the importance map. Only created if the GPU path is used.
 
         Texture::SharedPtr      mpImportanceMap;    ///< Hierarchical importance map (luminance).
         Sampler::SharedPtr      mpImportanceSampler;
@@ -77,8 +77,9 @@ namespace Falcor
         */
         static SharedPtr create(const LightCollection::SharedConstPtr& pLightCollection);
 
-        /** Refit all the BVH nodes to the underlying geometry, without changing the hierarchy.
+        /** Refit all the BVH nodes to the underlying geometry on the GPU, without changing the hierarchy.
             The BVH needs to have been built before trying to refit it.
+            See LightBVHBuilder::refit() for refitting only the nodes affected by updated triangles on the CPU.
             \param[in] pRenderContext The render context.
         */
         void refit(RenderContext* pRenderContext);
@@ -107,6 +108,10 @@ namespace Falcor
         */
         const BVHStats& getStats() const { return mBVHStats; }
 
+        /** Returns the BVH nodes. The CPU-side copy is synced with the GPU buffer if needed.
+        */
+        const std::vector<PackedNode>& getNodes() const { syncDataToCPU(); return mNodes; }
+
         /** Is the BVH valid.
             \return true if the BVH is ready for use.
         */
@@ -129,7 +134,7 @@ namespace Falcor
         void updateNodeIndices();
         void renderStats(Gui::Widgets& widget, const BVHStats& stats) const;
 
-        void uploadCPUBuffers(const std::vector<uint32_t>& triangleIndices, const std::vector<uint64_t>& triangleBitmasks);
+        void uploadCPUBuffers(std::vector<uint32_t> triangleIndices, std::vector<uint64_t> triangleBitmasks);
         void syncDataToCPU() const;
 
         /** Invalidate the BVH.
@@ -150,9 +155,13 @@ namespace Falcor
 
         // CPU resources
         mutable std::vector<PackedNode>       mNodes;                   ///< CPU-side copy of packed BVH nodes.
+        std::vector<AABB>                     mNodeBounds;              ///< Full precision bounds for each node, used for refitting on the CPU as the packed node extents are stored at half precision. Empty if out-of-date.
+        std::vector<uint32_t>                 mTriangleIndices;         ///< CPU-side copy of the triangle indices sorted by leaf node.
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU-side copy of the per triangle bit patterns retracing the tree traversal to reach the triangle.
         std::vector<uint32_t>                 mNodeIndices;             ///< Array of all node indices sorted by tree depth.
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset into 'mpNodeIndicesBuffer'; the very last entry contains the same data, but for all leaf nodes instead.
         uint32_t                              mMaxTriangleCountPerLeaf = 0; ///< After the BVH is built, this contains the maximum light count per leaf node.
+        float                                 mBuildCost = 0.f;         ///< Cost of the BVH after the last build, see LightBVHBuilder::evalCost().
         BVHStats                              mBVHStats;
         bool                                  mIsValid = false;         ///< True when the BVH has been built.
         mutable bool                          mIsCpuDataValid = false;  ///< Indicates whether the CPU-side data matches the GPU buffers.
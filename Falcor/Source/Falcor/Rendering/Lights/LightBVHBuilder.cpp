@@ -27,7 +27,11 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "LightBVHBuilder.h"
+#include "Utils/NumericRange.h"
+#include "Utils/Algorithm/DirtyRangeTracker.h"
 #include <algorithm>
+#include <execution>
+#include <numeric>
 
 namespace
 {
@@ -41,6 +45,15 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Bitmask of triangles that are not included in the BVH.
+    const uint64_t kInvalidBitmask = std::numeric_limits<uint64_t>::max();
+
+    // When refitting on the CPU, the subtrees rooted at this depth are refit in parallel.
+    const uint32_t kParallelRefitDepth = 8;
+
+    // When uploading refit nodes, ranges of modified nodes separated by at most this many nodes are merged.
+    const size_t kRefitUploadMergeGap = 16;
+
     inline float safeACos(float v)
     {
         return std::acos(glm::clamp(v, -1.0f, 1.0f));
@@ -285,10 +298,10 @@ namespace Falcor
         // TODO: Better estimate of how many nodes we will need.
         data.nodes.clear();
         data.nodes.reserve(2 * data.trianglesData.size());
+        data.nodeBounds.reserve(2 * data.trianglesData.size());
         data.triangleIndices.reserve(data.trianglesData.size());
 
-        const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
-        data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
+        data.triangleBitmasks.resize(triangles.size(), kInvalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
@@ -297,7 +310,7 @@ namespace Falcor
 
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
-            if (mask != invalidBitmask) numValid++;
+            if (mask != kInvalidBitmask) numValid++;
         FALCOR_ASSERT(numValid == data.trianglesData.size());
 
         // Compute per-node light bounding cones.
@@ -307,10 +320,176 @@ namespace Falcor
         // The BVH is ready, mark it as valid and upload the data.
         bvh.mIsValid = true;
         bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
-        bvh.uploadCPUBuffers(data.triangleIndices, data.triangleBitmasks);
+        bvh.mNodeBounds = std::move(data.nodeBounds);
+        bvh.uploadCPUBuffers(std::move(data.triangleIndices), std::move(data.triangleBitmasks));
 
         // Computate metadata.
         bvh.finalize();
+        bvh.mBuildCost = evalCost(bvh);
+    }
+
+    bool LightBVHBuilder::refit(LightBVH& bvh, const std::vector<uint32_t>& updatedTriangles)
+    {
+        FALCOR_PROFILE("LightBVHBuilder::refit()");
+
+        FALCOR_ASSERT(bvh.isValid());
+        FALCOR_ASSERT(bvh.mpLightCollection);
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles();
+        auto& nodes = bvh.mNodes;
+        auto& nodeBounds = bvh.mNodeBounds;
+
+        // Mark the nodes that need to be refit. If the full precision bounds are out-of-date (after a refit on the GPU),
+        // all nodes are refit. Otherwise we follow the path from the root to the leaf of each updated triangle.
+        std::vector<uint8_t> dirty(nodes.size(), 0);
+        const bool fullRefit = nodeBounds.size() != nodes.size();
+        if (fullRefit)
+        {
+            nodeBounds.resize(nodes.size());
+            std::fill(dirty.begin(), dirty.end(), 1);
+        }
+        else
+        {
+            for (uint32_t triangleIndex : updatedTriangles)
+            {
+                FALCOR_ASSERT(triangleIndex < bvh.mTriangleBitmasks.size());
+                const uint64_t bitmask = bvh.mTriangleBitmasks[triangleIndex];
+                if (bitmask == kInvalidBitmask) continue; // The triangle is not in the BVH.
+
+                uint32_t nodeIndex = 0;
+                for (uint32_t depth = 0; !nodes[nodeIndex].isLeaf(); ++depth)
+                {
+                    dirty[nodeIndex] = 1;
+                    nodeIndex = ((bitmask >> depth) & 1) ? nodes[nodeIndex].getInternalNode().rightChildIdx : nodeIndex + 1;
+                }
+                dirty[nodeIndex] = 1;
+            }
+            if (!dirty[0]) return true;
+
+            // The nodes that are not refit need to be up-to-date on the CPU.
+            bvh.syncDataToCPU();
+        }
+
+        auto refitLeafNode = [&](uint32_t nodeIndex)
+        {
+            LeafNode node = nodes[nodeIndex].getLeafNode();
+
+            AABB bounds;
+            float flux = 0.f;
+            float3 coneDirectionSum = float3(0.f);
+            for (uint32_t i = 0; i < node.triangleCount; ++i)
+            {
+                const auto& tri = triangles[bvh.mTriangleIndices[node.triangleOffset + i]];
+                for (uint32_t j = 0; j < 3; j++) bounds |= tri.vtx[j].pos;
+                flux += tri.flux;
+                coneDirectionSum += tri.normal;
+            }
+
+            // Compute the lighting cone the same way as computeLightingCone().
+            float3 coneDirection = float3(0.f);
+            float cosConeAngle = kInvalidCosConeAngle;
+            if (glm::length(coneDirectionSum) >= FLT_MIN)
+            {
+                coneDirection = glm::normalize(coneDirectionSum);
+                cosConeAngle = 1.f;
+                for (uint32_t i = 0; i < node.triangleCount; ++i)
+                {
+                    const auto& tri = triangles[bvh.mTriangleIndices[node.triangleOffset + i]];
+                    cosConeAngle = computeCosConeAngle(coneDirection, cosConeAngle, tri.normal, 1.f);
+                }
+            }
+
+            nodeBounds[nodeIndex] = bounds;
+            node.attribs.setAABB(bounds.minPoint, bounds.maxPoint);
+            node.attribs.flux = flux;
+            node.attribs.coneDirection = coneDirection;
+            node.attribs.cosConeAngle = cosConeAngle;
+            nodes[nodeIndex].setLeafNode(node);
+        };
+
+        auto refitInternalNode = [&](uint32_t nodeIndex)
+        {
+            InternalNode node = nodes[nodeIndex].getInternalNode();
+            const uint32_t leftIndex = nodeIndex + 1;
+            const uint32_t rightIndex = node.rightChildIdx;
+            const SharedNodeAttributes leftAttribs = nodes[leftIndex].getNodeAttributes();
+            const SharedNodeAttributes rightAttribs = nodes[rightIndex].getNodeAttributes();
+
+            const AABB bounds = nodeBounds[leftIndex] | nodeBounds[rightIndex];
+            nodeBounds[nodeIndex] = bounds;
+            node.attribs.setAABB(bounds.minPoint, bounds.maxPoint);
+            node.attribs.flux = leftAttribs.flux + rightAttribs.flux;
+            node.attribs.coneDirection = coneUnionOld(leftAttribs.coneDirection, leftAttribs.cosConeAngle,
+                rightAttribs.coneDirection, rightAttribs.cosConeAngle, node.attribs.cosConeAngle);
+            nodes[nodeIndex].setInternalNode(node);
+        };
+
+        // Collects the dirty nodes below 'rootIndex' in pre-order. Traversal stops at leaves and at 'maxDepth'.
+        // Children always come after their parents, so refitting the nodes in reverse order is bottom-up.
+        auto gatherDirtyNodes = [&](uint32_t rootIndex, uint32_t maxDepth, std::vector<uint32_t>& internalNodes, std::vector<uint32_t>& subtreeRoots)
+        {
+            std::vector<LightBVH::NodeLocation> stack = { LightBVH::NodeLocation{ rootIndex, 0 } };
+            while (!stack.empty())
+            {
+                const LightBVH::NodeLocation location = stack.back();
+                stack.pop_back();
+                if (!dirty[location.nodeIndex]) continue;
+
+                if (nodes[location.nodeIndex].isLeaf() || location.depth == maxDepth)
+                {
+                    subtreeRoots.push_back(location.nodeIndex);
+                }
+                else
+                {
+                    internalNodes.push_back(location.nodeIndex);
+                    stack.push_back(LightBVH::NodeLocation{ location.nodeIndex + 1, location.depth + 1 });
+                    stack.push_back(LightBVH::NodeLocation{ nodes[location.nodeIndex].getInternalNode().rightChildIdx, location.depth + 1 });
+                }
+            }
+        };
+
+        // Split the dirty nodes into the subtrees at kParallelRefitDepth and the nodes above them.
+        std::vector<uint32_t> topNodes;
+        std::vector<uint32_t> subtreeRoots;
+        gatherDirtyNodes(0, kParallelRefitDepth, topNodes, subtreeRoots);
+
+        // Refit the subtrees in parallel. They are disjoint, so no synchronization is needed.
+        std::for_each(std::execution::par, subtreeRoots.begin(), subtreeRoots.end(), [&](uint32_t subtreeRoot)
+        {
+            std::vector<uint32_t> internalNodes;
+            std::vector<uint32_t> leafNodes;
+            gatherDirtyNodes(subtreeRoot, std::numeric_limits<uint32_t>::max(), internalNodes, leafNodes);
+            for (uint32_t nodeIndex : leafNodes) refitLeafNode(nodeIndex);
+            for (auto it = internalNodes.rbegin(); it != internalNodes.rend(); ++it) refitInternalNode(*it);
+        });
+
+        // Refit the nodes above the subtrees.
+        for (auto it = topNodes.rbegin(); it != topNodes.rend(); ++it) refitInternalNode(*it);
+
+        // Upload the modified nodes.
+        if (fullRefit)
+        {
+            bvh.mpBVHNodesBuffer->setBlob(nodes.data(), 0, nodes.size() * sizeof(nodes[0]));
+        }
+        else
+        {
+            DirtyRangeTracker dirtyRanges(kRefitUploadMergeGap * sizeof(nodes[0]));
+            for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+            {
+                if (dirty[nodeIndex]) dirtyRanges.markDirty(nodeIndex * sizeof(nodes[0]), sizeof(nodes[0]));
+            }
+            for (const auto& range : dirtyRanges.getRanges())
+            {
+                bvh.mpBVHNodesBuffer->setBlob(reinterpret_cast<const uint8_t*>(nodes.data()) + range.offset, range.offset, range.size);
+            }
+        }
+        bvh.mIsCpuDataValid = true;
+
+        // Check if the quality of the BVH has degraded too much.
+        if (mOptions.rebuildCostRatio > 0.f && bvh.mBuildCost > 0.f)
+        {
+            if (evalCost(bvh) > bvh.mBuildCost * mOptions.rebuildCostRatio) return false;
+        }
+        return true;
     }
 
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
@@ -324,6 +503,11 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.var("Rebuild cost ratio", options.rebuildCostRatio, 0.f, FLT_MAX, 0.1f);
+            widget.tooltip("When refitting on the CPU, the BVH is rebuilt if its SAOH cost has grown by more than this factor since the last build. Zero disables rebuilding.");
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
 
@@ -390,6 +574,7 @@ namespace Falcor
             FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
             const uint32_t nodeIndex = (uint32_t)data.nodes.size();
             data.nodes.push_back({});
+            data.nodeBounds.push_back(nodeBounds);
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,6 +605,7 @@ namespace Falcor
             FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
             const uint32_t nodeIndex = (uint32_t)data.nodes.size();
             data.nodes.push_back({});
+            data.nodeBounds.push_back(nodeBounds);
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -874,6 +1060,28 @@ namespace Falcor
         return overallBestSplit.second;
     }
 
+    float LightBVHBuilder::evalCost(const LightBVH& bvh) const
+    {
+        if (!bvh.isValid()) return 0.f;
+        bvh.syncDataToCPU();
+        const auto& nodes = bvh.mNodes;
+
+        auto evalNodeCost = [&](uint32_t nodeIndex)
+        {
+            SharedNodeAttributes attribs = nodes[nodeIndex].getNodeAttributes();
+            AABB bounds;
+            attribs.getAABB(bounds.minPoint, bounds.maxPoint);
+            return (double)evalSAOH(bounds, attribs.flux, attribs.cosConeAngle, mOptions);
+        };
+
+        const double rootCost = evalNodeCost(0);
+        if (rootCost <= 0.0) return 0.f;
+
+        NumericRange<uint32_t> nodeRange(1, (uint32_t)nodes.size());
+        const double cost = std::transform_reduce(std::execution::par, nodeRange.begin(), nodeRange.end(), 0.0, std::plus<>(), evalNodeCost);
+        return (float)(cost / rootCost);
+    }
+
     LightBVHBuilder::SplitHeuristicFunction LightBVHBuilder::getSplitFunction(SplitHeuristic heuristic)
     {
         switch (heuristic)
@@ -910,6 +1118,7 @@ namespace Falcor
         options.field(allowRefitting);
         options.field(usePreintegration);
         options.field(useLightingCones);
+        options.field(rebuildCostRatio);
 #undef field
     }
 }
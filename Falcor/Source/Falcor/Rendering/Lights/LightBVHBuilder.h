@@ -71,6 +71,7 @@ namespace Falcor
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            float          rebuildCostRatio = 1.5f;                              ///< When refitting on the CPU, rebuild the BVH instead if its cost (see evalCost()) has grown by more than this factor since the last build. Zero disables the check.
         };
 
         /** Creates a new object.
@@ -83,6 +84,25 @@ namespace Falcor
         */
         void build(LightBVH& bvh);
 
+        /** Refit the BVH on the CPU, without changing the hierarchy.
+            Only the leaf nodes holding the updated triangles and their ancestors are refit, which are found by
+            following the per-triangle traversal bitmasks from the root. Independent subtrees are refit in parallel
+            and only the modified nodes are uploaded to the GPU.
+            The mesh light triangles of the light collection need to be up-to-date on the CPU.
+            \param[in,out] bvh The light BVH to refit. It needs to have been built before.
+            \param[in] updatedTriangles Global indices of the emissive triangles that changed since the last build or refit.
+            \return False if the cost of the refit BVH exceeds the cost after the last build by more than Options::rebuildCostRatio, in which case it should be rebuilt.
+        */
+        bool refit(LightBVH& bvh, const std::vector<uint32_t>& updatedTriangles);
+
+        /** Evaluate the quality of a BVH using the SAOH metric.
+            The cost is the sum of the SAOH costs of all nodes below the root, relative to the cost of the root node.
+            Lower values are better. Refitting an animated BVH typically makes the nodes overlap more, which increases the cost.
+            \param[in] bvh The light BVH.
+            \return The relative cost, or zero if the BVH is invalid or the root node has zero cost.
+        */
+        float evalCost(const LightBVH& bvh) const;
+
         virtual bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -126,6 +146,7 @@ namespace Falcor
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
+            std::vector<AABB> nodeBounds;                   ///< Full precision bounds for each node in 'nodes'.
             float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
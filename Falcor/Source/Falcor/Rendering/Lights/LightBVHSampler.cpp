@@ -72,7 +72,23 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            const auto& pLightCollection = mpScene->getLightCollection(pRenderContext);
+            if (pLightCollection->hasCPUTriangleData())
+            {
+                // The triangles are updated on the CPU, so refit only the parts of the BVH affected by the updated lights.
+                // The BVH is rebuilt if refitting has degraded its quality too much.
+                std::vector<uint32_t> updatedTriangles;
+                for (uint32_t lightIdx : pLightCollection->getUpdatedLights())
+                {
+                    const auto& meshLight = pLightCollection->getMeshLights()[lightIdx];
+                    for (uint32_t i = 0; i < meshLight.triangleCount; i++) updatedTriangles.push_back(meshLight.triangleOffset + i);
+                }
+                if (!mpBVHBuilder->refit(*mpBVH, updatedTriangles)) mpBVHBuilder->build(*mpBVH);
+            }
+            else
+            {
+                mpBVH->refit(pRenderContext);
+            }
             samplerChanged = true;
         }
 
@@ -0,0 +1,327 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "EmissiveTexture.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Host-side equivalents of the clipping functions in Utils/Geometry/GeometryHelpers.slang used by the GPU integrator.
+
+        int classifyPointPlane2D(const float2 p, const uint32_t axis, const float sign, const float c, const float planeThickness = 1e-6f)
+        {
+            float d = sign * (p[axis] - c);
+            if (d > planeThickness) return 1;
+            else if (d < -planeThickness) return -1;
+            else return 0;
+        }
+
+        void clipPolygonPlane2D(float2 p[7], uint32_t& n, const uint32_t axis, const float sign, const float c)
+        {
+            if (n <= 1)
+            {
+                n = 0;
+                return;
+            }
+
+            float2 q[7];
+            uint32_t k = 0;
+            bool fullyOnPlane = true;
+
+            float2 p1 = p[n - 1];
+            int d1 = classifyPointPlane2D(p1, axis, sign, c);
+
+            // Iterate over all polygon edges (p1,p2) in order.
+            for (uint32_t i = 0; i < n; i++)
+            {
+                float2 p2 = p[i];
+                int d2 = classifyPointPlane2D(p2, axis, sign, c);
+
+                if (d2 == 0) // p2 lies on the plane
+                {
+                    if (d1 != 0) q[k++] = p2;
+                }
+                else // p2 is on either side
+                {
+                    fullyOnPlane = false;
+
+                    if (d1 == 0) // p1 lies on the plane
+                    {
+                        if (k == 0 || q[k - 1] != p1) q[k++] = p1;
+                    }
+                    else if (d1 != d2) // p1 and p2 are on opposite sides => clip
+                    {
+                        float alpha = (p2[axis] - c) / (p2[axis] - p1[axis]);
+                        q[k++] = glm::mix(p2, p1, alpha);
+                    }
+
+                    if (d2 > 0) q[k++] = p2;
+                }
+
+                p1 = p2;
+                d1 = d2;
+            }
+
+            if (fullyOnPlane) return;
+
+            n = k;
+            for (uint32_t i = 0; i < k; i++) p[i] = q[i];
+        }
+
+        float computeClippedTriangleArea2D(const float2 pos[3], const float2 minPoint, const float2 maxPoint)
+        {
+            // Clip triangle to axis-aligned box.
+            uint32_t n = 3;
+            float2 p[7] = {};
+
+            p[0] = pos[0];
+            p[1] = pos[1];
+            p[2] = pos[2];
+
+            clipPolygonPlane2D(p, n, 0, +1.f, minPoint.x);
+            clipPolygonPlane2D(p, n, 0, -1.f, maxPoint.x);
+            clipPolygonPlane2D(p, n, 1, +1.f, minPoint.y);
+            clipPolygonPlane2D(p, n, 1, -1.f, maxPoint.y);
+
+            if (n < 3) return 0.f;
+
+            // Compute area of convex polygon.
+            float area = 0.f;
+            for (uint32_t i = 0; i < n; i++)
+            {
+                uint32_t j = i + 1 < n ? i + 1 : 0;
+                area += p[i].x * p[j].y - p[i].y * p[j].x;
+            }
+
+            return 0.5f * area;
+        }
+
+        /** Maps an unbounded texel coordinate into [0,n) according to the address mode.
+            Returns -1 if the coordinate is outside the texture and the border color should be used.
+        */
+        int64_t applyAddressMode(int64_t i, int64_t n, Sampler::AddressMode mode)
+        {
+            switch (mode)
+            {
+            case Sampler::AddressMode::Wrap:
+                return ((i % n) + n) % n;
+            case Sampler::AddressMode::Mirror:
+            {
+                int64_t m = ((i % (2 * n)) + 2 * n) % (2 * n);
+                return m < n ? m : 2 * n - 1 - m;
+            }
+            case Sampler::AddressMode::Clamp:
+                return std::clamp(i, (int64_t)0, n - 1);
+            case Sampler::AddressMode::Border:
+                return (i < 0 || i >= n) ? -1 : i;
+            case Sampler::AddressMode::MirrorOnce:
+                return std::clamp(i < 0 ? -i - 1 : i, (int64_t)0, n - 1);
+            default:
+                FALCOR_UNREACHABLE();
+                return 0;
+            }
+        }
+
+        template<typename DecodeTexel>
+        std::vector<float3> decodeTexels(const Bitmap& bitmap, DecodeTexel decodeTexel)
+        {
+            const uint32_t width = bitmap.getWidth();
+            const uint32_t texelSize = getFormatBytesPerBlock(bitmap.getFormat());
+
+            std::vector<float3> texels((size_t)width * bitmap.getHeight());
+            NumericRange<uint32_t> rows(0, bitmap.getHeight());
+            std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+            {
+                const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+                for (uint32_t x = 0; x < width; x++) texels[(size_t)y * width + x] = decodeTexel(pRow + (size_t)x * texelSize);
+            });
+            return texels;
+        }
+
+        /** Decode the bitmap to linear RGB as returned by a texture sample (missing channels are zero).
+            Returns an empty vector if the format is not supported.
+        */
+        std::vector<float3> decodeTexels(const Bitmap& bitmap, bool isSrgb)
+        {
+            auto unorm8 = [isSrgb](uint8_t v) { float f = v * (1.f / 255.f); return isSrgb ? sRGBToLinear(f) : f; };
+
+            switch (bitmap.getFormat())
+            {
+            case ResourceFormat::RGBA32Float:
+            case ResourceFormat::RGB32Float:
+                return decodeTexels(bitmap, [](const uint8_t* p) { const float* c = reinterpret_cast<const float*>(p); return float3(c[0], c[1], c[2]); });
+            case ResourceFormat::RGBA16Float:
+            case ResourceFormat::RGB16Float:
+                return decodeTexels(bitmap, [](const uint8_t* p) { const float16_t* c = reinterpret_cast<const float16_t*>(p); return float3(float(c[0]), float(c[1]), float(c[2])); });
+            case ResourceFormat::RGBA8Unorm:
+                return decodeTexels(bitmap, [&](const uint8_t* p) { return float3(unorm8(p[0]), unorm8(p[1]), unorm8(p[2])); });
+            case ResourceFormat::BGRA8Unorm:
+            case ResourceFormat::BGRX8Unorm:
+                return decodeTexels(bitmap, [&](const uint8_t* p) { return float3(unorm8(p[2]), unorm8(p[1]), unorm8(p[0])); });
+            case ResourceFormat::RG8Unorm:
+                return decodeTexels(bitmap, [](const uint8_t* p) { return float3(p[0] / 255.f, p[1] / 255.f, 0.f); });
+            case ResourceFormat::R8Unorm:
+                return decodeTexels(bitmap, [](const uint8_t* p) { return float3(p[0] / 255.f, 0.f, 0.f); });
+            case ResourceFormat::R16Unorm:
+                return decodeTexels(bitmap, [](const uint8_t* p) { return float3(*reinterpret_cast<const uint16_t*>(p) / 65535.f, 0.f, 0.f); });
+            default:
+                return {};
+            }
+        }
+
+        /** Edge function. Positive if p is to the left of the edge a->b.
+        */
+        float edgeFunction(const float2& a, const float2& b, const float2& p)
+        {
+            return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+        }
+    }
+
+    EmissiveTexture::SharedPtr EmissiveTexture::create(uint32_t width, uint32_t height, std::vector<float3> texels, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, float3 borderColor)
+    {
+        checkArgument(width > 0 && height > 0, "Texture dimensions must be non-zero.");
+        checkArgument(texels.size() == (size_t)width * height, "Texel count ({}) does not match texture dimensions ({}x{}).", texels.size(), width, height);
+        return SharedPtr(new EmissiveTexture(width, height, std::move(texels), addressModeU, addressModeV, borderColor));
+    }
+
+    EmissiveTexture::SharedPtr EmissiveTexture::createFromTexture(const Texture::SharedPtr& pTexture, const Sampler::SharedPtr& pSampler)
+    {
+        if (!pTexture || pTexture->getType() != Texture::Type::Texture2D) return nullptr;
+
+        // DDS files may be block compressed. We leave those to the GPU integrator.
+        const std::string& filename = pTexture->getSourceFilename();
+        if (filename.empty() || hasSuffix(filename, ".dds", false)) return nullptr;
+
+        // Textures are loaded top-down (see Texture::createFromFile()).
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, true);
+        if (!pBitmap || pBitmap->getWidth() != pTexture->getWidth() || pBitmap->getHeight() != pTexture->getHeight()) return nullptr;
+
+        std::vector<float3> texels = decodeTexels(*pBitmap, isSrgbFormat(pTexture->getFormat()));
+        if (texels.empty()) return nullptr;
+
+        Sampler::AddressMode addressModeU = pSampler ? pSampler->getAddressModeU() : Sampler::AddressMode::Wrap;
+        Sampler::AddressMode addressModeV = pSampler ? pSampler->getAddressModeV() : Sampler::AddressMode::Wrap;
+        float3 borderColor = pSampler ? float3(pSampler->getBorderColor()) : float3(0.f);
+
+        return create(pBitmap->getWidth(), pBitmap->getHeight(), std::move(texels), addressModeU, addressModeV, borderColor);
+    }
+
+    EmissiveTexture::EmissiveTexture(uint32_t width, uint32_t height, std::vector<float3> texels, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, float3 borderColor)
+        : mWidth(width)
+        , mHeight(height)
+        , mTexels(std::move(texels))
+        , mAddressModeU(addressModeU)
+        , mAddressModeV(addressModeV)
+        , mBorderColor(borderColor)
+    {}
+
+    float3 EmissiveTexture::fetch(int64_t x, int64_t y) const
+    {
+        int64_t ix = applyAddressMode(x, mWidth, mAddressModeU);
+        int64_t iy = applyAddressMode(y, mHeight, mAddressModeV);
+        if (ix < 0 || iy < 0) return mBorderColor;
+        return mTexels[(size_t)iy * mWidth + (size_t)ix];
+    }
+
+    float3 EmissiveTexture::samplePoint(float2 uv) const
+    {
+        return fetch((int64_t)std::floor(uv.x * mWidth), (int64_t)std::floor(uv.y * mHeight));
+    }
+
+    float3 EmissiveTexture::integrateTriangle(const float2 texCoords[3]) const
+    {
+        // Place the triangle in texture space with one unit per texel.
+        // As in the GPU integrator, we offset the texture coordinates so that they are always positive.
+        const float2 uvMin = glm::min(glm::min(texCoords[0], texCoords[1]), texCoords[2]);
+        const float2 uvMax = glm::max(glm::max(texCoords[0], texCoords[1]), texCoords[2]);
+        const float2 uvOffset = glm::floor(uvMin);
+        const float2 dim = float2(mWidth, mHeight);
+
+        float2 p[3];
+        for (uint32_t i = 0; i < 3; i++) p[i] = (texCoords[i] - uvOffset) * dim;
+
+        const int64_t offsetX = (int64_t)uvOffset.x * mWidth;
+        const int64_t offsetY = (int64_t)uvOffset.y * mHeight;
+
+        const int64_t x0 = (int64_t)std::floor(glm::min(glm::min(p[0].x, p[1].x), p[2].x));
+        const int64_t y0 = (int64_t)std::floor(glm::min(glm::min(p[0].y, p[1].y), p[2].y));
+        const int64_t x1 = (int64_t)std::ceil((uvMax.x - uvOffset.x) * dim.x);
+        const int64_t y1 = (int64_t)std::ceil((uvMax.y - uvOffset.y) * dim.y);
+
+        // Texels whose four corners are inside the triangle are fully covered, which avoids the clipping for interior texels.
+        const float signedArea = edgeFunction(p[0], p[1], p[2]);
+        const float orientation = signedArea >= 0.f ? 1.f : -1.f;
+        auto isInside = [&](const float2& q)
+        {
+            return signedArea != 0.f &&
+                orientation * edgeFunction(p[0], p[1], q) >= 0.f &&
+                orientation * edgeFunction(p[1], p[2], q) >= 0.f &&
+                orientation * edgeFunction(p[2], p[0], q) >= 0.f;
+        };
+
+        glm::dvec3 texelSum = glm::dvec3(0.0);
+        double weightSum = 0.0;
+
+        for (int64_t y = y0; y < std::max(y1, y0 + 1); y++)
+        {
+            for (int64_t x = x0; x < std::max(x1, x0 + 1); x++)
+            {
+                const float2 texelMin = float2(x, y);
+                const float2 texelMax = texelMin + 1.f;
+
+                float weight = 1.f;
+                if (!isInside(texelMin) || !isInside(texelMax) || !isInside(float2(texelMin.x, texelMax.y)) || !isInside(float2(texelMax.x, texelMin.y)))
+                {
+                    // For partially covered texels, clip the triangle to the texel and compute the area analytically.
+                    float area = computeClippedTriangleArea2D(p, texelMin, texelMax);
+                    weight = std::min(std::abs(area), 1.f); // The area may be negative due to winding.
+                }
+
+                if (weight > 0.f)
+                {
+                    texelSum += glm::dvec3(fetch(offsetX + x, offsetY + y)) * (double)weight;
+                    weightSum += weight;
+                }
+            }
+        }
+
+        if (weightSum > 0.0) return float3(texelSum / weightSum);
+
+        // The triangle is degenerate in texture space (line or point).
+        // The emission is approximated as the average emission sampled at the three vertices.
+        float3 average = float3(0.f);
+        for (uint32_t i = 0; i < 3; i++) average += samplePoint(texCoords[i]);
+        return average / 3.f;
+    }
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/API/Sampler.h"
+#include "Core/API/Texture.h"
+
+namespace Falcor
+{
+    /** CPU copy of an emissive texture for pre-integrating textured mesh lights on the CPU.
+
+        The integration matches the raster-based integrator in EmissiveIntegrator.3d.slang:
+        the triangle is placed in texture space at mip 0, each texel it touches is fetched
+        with nearest filtering and weighted by the analytically computed texel coverage.
+        Triangles that are degenerate in texture space use the average of the three vertex samples.
+    */
+    class FALCOR_API EmissiveTexture
+    {
+    public:
+        using SharedPtr = std::shared_ptr<EmissiveTexture>;
+        using SharedConstPtr = std::shared_ptr<const EmissiveTexture>;
+
+        /** Create from texel data.
+            \param[in] width Width in texels.
+            \param[in] height Height in texels.
+            \param[in] texels Linear RGB texel values in top-down row order (width * height elements).
+            \param[in] addressModeU Address mode in U direction.
+            \param[in] addressModeV Address mode in V direction.
+            \param[in] borderColor Border color used with AddressMode::Border.
+            \return A new object, or throws an exception if the arguments are invalid.
+        */
+        static SharedPtr create(uint32_t width, uint32_t height, std::vector<float3> texels,
+            Sampler::AddressMode addressModeU = Sampler::AddressMode::Wrap, Sampler::AddressMode addressModeV = Sampler::AddressMode::Wrap, float3 borderColor = float3(0.f));
+
+        /** Create from the source image of a texture.
+            The image is reloaded from disk and decoded to linear RGB the same way the GPU samples the texture.
+            \param[in] pTexture Texture.
+            \param[in] pSampler Sampler used for sampling the texture, or nullptr to use the default sampler state.
+            \return A new object, or nullptr if the texture has no source image or its format is not supported (e.g. block compressed).
+        */
+        static SharedPtr createFromTexture(const Texture::SharedPtr& pTexture, const Sampler::SharedPtr& pSampler);
+
+        /** Fetch a texel. The coordinates are mapped to the texture using the sampler's address modes.
+            \param[in] x Texel x coordinate (unbounded).
+            \param[in] y Texel y coordinate (unbounded).
+            \return Texel value.
+        */
+        float3 fetch(int64_t x, int64_t y) const;
+
+        /** Sample the texture with nearest filtering.
+            \param[in] uv Texture coordinate.
+            \return Texel value.
+        */
+        float3 samplePoint(float2 uv) const;
+
+        /** Compute the average value over a triangle in texture space.
+            \param[in] texCoords Texture coordinates of the three vertices.
+            \return Average texel value over the triangle.
+        */
+        float3 integrateTriangle(const float2 texCoords[3]) const;
+
+        uint32_t getWidth() const { return mWidth; }
+        uint32_t getHeight() const { return mHeight; }
+
+    private:
+        EmissiveTexture(uint32_t width, uint32_t height, std::vector<float3> texels, Sampler::AddressMode addressModeU, Sampler::AddressMode addressModeV, float3 borderColor);
+
+        uint32_t mWidth;
+        uint32_t mHeight;
+        std::vector<float3> mTexels;                ///< Linear RGB texel values of mip 0.
+        Sampler::AddressMode mAddressModeU;
+        Sampler::AddressMode mAddressModeV;
+        float3 mBorderColor;
+    };
+}
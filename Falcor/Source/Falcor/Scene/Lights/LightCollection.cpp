@@ -27,8 +27,11 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "LightCollection.h"
-#include "LightCollectionShared.slang"
+#include "EmissiveTexture.h"
 #include "Scene/Scene.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/NumericRange.h"
+#include <execution>
 #include <sstream>
 
 namespace Falcor
@@ -58,16 +61,8 @@ namespace Falcor
         // Setup the lights.
         setupMeshLights(*pScene);
 
-        // Create program for integrating emissive textures.
-        // This should be done after lights are setup, so that we know which sampler state etc. to use.
-        initIntegrator(*pScene);
-
-        // Create programs for building/updating the mesh lights.
-        Shader::DefineList defines = pScene->getSceneDefines();
-        mpTriangleListBuilder = ComputePass::create(kBuildTriangleListFile, "buildTriangleList", defines);
-        mpTrianglePositionUpdater = ComputePass::create(kUpdateTriangleVerticesFile, "updateTriangleVertices", defines);
-        mpFinalizeIntegration = ComputePass::create(kFinalizeIntegrationFile, "finalizeIntegration", defines);
-
+        // The GPU programs for building/updating the mesh lights and integrating emissive textures are
+        // created on demand, only if the data is not available for pre-processing on the CPU.
         mpStagingFence = GpuFence::create();
 
         // Now build the mesh light data.
@@ -90,7 +85,6 @@ namespace Falcor
         // Update transform matrices and check for updates.
         // TODO: Move per-mesh instance update flags into Scene. Return just a list of mesh lights that have changed.
         std::vector<uint32_t> updatedLights;
-        updatedLights.reserve(mMeshLights.size());
 
         for (uint32_t lightIdx = 0; lightIdx < mMeshLights.size(); ++lightIdx)
         {
@@ -106,9 +100,10 @@ namespace Falcor
         }
 
         // Update light data if needed.
-        if (!updatedLights.empty())
+        mUpdatedLights = std::move(updatedLights);
+        if (!mUpdatedLights.empty())
         {
-            updateTrianglePositions(pRenderContext, *pScene, updatedLights);
+            updateTrianglePositions(pRenderContext, *pScene, mUpdatedLights);
             return true;
         }
 
@@ -247,8 +242,8 @@ namespace Falcor
             timeReport.measure("LightCollection::build integrate emissive");
 
             // Build list of active triangles.
-            mCPUInvalidData = CPUOutOfDateFlags::All;
-            mStagingBufferValid = false;
+            // Data computed on the GPU has to be read back first. The flags are set by the steps above.
+            mStagingBufferValid = mCPUInvalidData == CPUOutOfDateFlags::None;
             mStatsValid = false;
 
             prepareSyncCPUData(pRenderContext);
@@ -264,13 +259,11 @@ namespace Falcor
         FALCOR_ASSERT(mTriangleCount > 0);
 
         // Create GPU buffers.
-        mpTriangleData = Buffer::createStructured(mpTriangleListBuilder["gTriangleData"], mTriangleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
+        mpTriangleData = Buffer::createStructured(sizeof(PackedEmissiveTriangle), mTriangleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
         mpTriangleData->setName("LightCollection::mpTriangleData");
-        if (mpTriangleData->getStructSize() != sizeof(PackedEmissiveTriangle)) throw RuntimeError("Struct PackedEmissiveTriangle size mismatch between CPU/GPU");
 
-        mpFluxData = Buffer::createStructured(mpFinalizeIntegration["gFluxData"], mTriangleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
+        mpFluxData = Buffer::createStructured(sizeof(EmissiveFlux), mTriangleCount, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess, Buffer::CpuAccess::None, nullptr, false);
         mpFluxData->setName("LightCollection::mpFluxData");
-        if (mpFluxData->getStructSize() != sizeof(EmissiveFlux)) throw RuntimeError("Struct EmissiveFlux size mismatch between CPU/GPU");
 
         // Compute triangle data (vertices, uv-coordinates, materialID) for all mesh lights.
         buildTriangleList(pRenderContext, scene);
@@ -282,15 +275,11 @@ namespace Falcor
         if (!mMeshLights.empty())
         {
             mpMeshData = Buffer::createStructured(
-                mpTrianglePositionUpdater["gMeshData"],
+                sizeof(MeshLightData),
                 uint32_t(mMeshLights.size()),
                 ResourceBindFlags::ShaderResource,
                 Buffer::CpuAccess::None, nullptr, false);
             mpMeshData->setName("LightCollection::mpMeshData");
-            if (mpMeshData->getStructSize() != sizeof(MeshLightData))
-            {
-                throw RuntimeError("Size mismatch for structured buffer of MeshLightData");
-            }
             size_t meshDataSize = mMeshLights.size() * sizeof(mMeshLights[0]);
             FALCOR_ASSERT(mpMeshData->getSize() == meshDataSize);
             mpMeshData->setBlob(mMeshLights.data(), 0, meshDataSize);
@@ -318,6 +307,16 @@ namespace Falcor
         FALCOR_ASSERT(mTriangleCount > 0);
         FALCOR_ASSERT(mMeshLights.size() > 0);
 
+        // Integrate on the CPU if the triangle data and all emissive textures are available there.
+        mCPUFluxData = mCPUTriangleData && integrateEmissiveCPU(scene);
+        if (mCPUFluxData) return;
+
+        // Create the GPU programs on first use.
+        // The integrator should be created after lights are setup, so that we know which sampler state etc. to use.
+        if (!mIntegrator.pProgram) initIntegrator(scene);
+        if (!mpFinalizeIntegration) mpFinalizeIntegration = ComputePass::create(kFinalizeIntegrationFile, "finalizeIntegration", scene.getSceneDefines());
+        if (mpFinalizeIntegration["gFluxData"].getType()->asResourceType()->getStructType()->getByteSize() != sizeof(EmissiveFlux)) throw RuntimeError("Struct EmissiveFlux size mismatch between CPU/GPU");
+
         // Prepare program vars.
         mIntegrator.pVars = GraphicsVars::create(mIntegrator.pProgram.get());
         mIntegrator.pVars["gScene"] = scene.getParameterBlock();
@@ -383,6 +382,9 @@ namespace Falcor
             uint32_t rows = div_round_up(mTriangleCount, mpFinalizeIntegration->getThreadGroupSize().x);
             mpFinalizeIntegration->execute(pRenderContext, mpFinalizeIntegration->getThreadGroupSize().x, rows);
         }
+
+        mCPUInvalidData |= CPUOutOfDateFlags::FluxData;
+
 #if 0
         // Output a list of per-triangle results to file for debugging purposes.
         std::ofstream ofs("flux.txt");
@@ -462,6 +464,20 @@ namespace Falcor
     {
         FALCOR_ASSERT(mMeshLights.size() > 0);
 
+        // Build on the CPU if the geometry of all mesh lights is available there.
+        mCPUTriangleData = canBuildTriangleListOnCPU(scene);
+        if (mCPUTriangleData)
+        {
+            buildTriangleListCPU(scene);
+            return;
+        }
+
+        // Create the GPU programs on first use.
+        Shader::DefineList defines = scene.getSceneDefines();
+        if (!mpTriangleListBuilder) mpTriangleListBuilder = ComputePass::create(kBuildTriangleListFile, "buildTriangleList", defines);
+        if (!mpTrianglePositionUpdater) mpTrianglePositionUpdater = ComputePass::create(kUpdateTriangleVerticesFile, "updateTriangleVertices", defines);
+        if (mpTriangleListBuilder["gTriangleData"].getType()->asResourceType()->getStructType()->getByteSize() != sizeof(PackedEmissiveTriangle)) throw RuntimeError("Struct PackedEmissiveTriangle size mismatch between CPU/GPU");
+
         // Bind scene.
         mpTriangleListBuilder["gScene"] = scene.getParameterBlock();
 
@@ -484,6 +500,8 @@ namespace Falcor
             // Each kernel writes to non-overlapping parts of the output buffers, but currently Falcor inserts barriers between each dispatch.
             mpTriangleListBuilder->execute(pRenderContext, meshLight.triangleCount, 1u, 1u);
         }
+
+        mCPUInvalidData |= CPUOutOfDateFlags::TriangleData;
     }
 
     void LightCollection::updateActiveTriangleList()
@@ -535,6 +553,12 @@ namespace Falcor
         // Alternatively, upload the list of updated meshes and early out unnecessary threads at runtime.
         FALCOR_ASSERT(!updatedLights.empty());
 
+        if (mCPUTriangleData)
+        {
+            updateTrianglePositionsCPU(scene, updatedLights);
+            return;
+        }
+
         // Bind scene.
         mpTrianglePositionUpdater["gScene"] = scene.getParameterBlock();
 
@@ -681,6 +705,176 @@ namespace Falcor
         mCPUInvalidData = CPUOutOfDateFlags::None;
     }
 
+    bool LightCollection::canBuildTriangleListOnCPU(const Scene& scene) const
+    {
+        for (const auto& meshLight : mMeshLights)
+        {
+            const GeometryInstanceData& instance = scene.getGeometryInstance(meshLight.instanceID);
+            const Scene::EmissiveMeshGeometry* pGeometry = scene.getEmissiveMeshGeometry(instance.geometryID);
+            if (!pGeometry || pGeometry->indices.size() != (size_t)meshLight.triangleCount * 3) return false;
+        }
+        return true;
+    }
+
+    PackedEmissiveTriangle LightCollection::computeTriangle(const Scene& scene, uint32_t lightIdx, uint32_t triangleIndex) const
+    {
+        // This mirrors BuildTriangleList.cs.slang and UpdateTriangleVertices.cs.slang.
+        const MeshLightData& meshLight = mMeshLights[lightIdx];
+        const GeometryInstanceData& instance = scene.getGeometryInstance(meshLight.instanceID);
+        const Scene::EmissiveMeshGeometry* pGeometry = scene.getEmissiveMeshGeometry(instance.geometryID);
+        FALCOR_ASSERT(pGeometry);
+        const glm::mat4& worldMat = scene.getAnimationController()->getGlobalMatrices()[instance.globalMatrixID];
+
+        // Fetch vertex data.
+        EmissiveTriangle tri;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            uint32_t vtxIdx = pGeometry->indices[triangleIndex * 3 + i];
+            tri.posW[i] = float3(worldMat * float4(pGeometry->positions[vtxIdx], 1.f));
+            tri.texCoords[i] = pGeometry->texCrds[vtxIdx];
+        }
+
+        // Compute face normal and area in world space. Flip the normal depending on the final winding order in world space.
+        float3 N = glm::cross(tri.posW[1] - tri.posW[0], tri.posW[2] - tri.posW[0]);
+        tri.area = 0.5f * glm::length(N);
+        if ((instance.flags & (uint32_t)GeometryInstanceFlags::IsWorldFrontFaceCW) != 0) N = -N;
+        tri.normal = glm::normalize(N);
+        tri.materialID = meshLight.materialID;
+        tri.lightIdx = lightIdx;
+
+        PackedEmissiveTriangle packedTri;
+        packedTri.pack(tri);
+        return packedTri;
+    }
+
+    void LightCollection::buildTriangleListCPU(const Scene& scene)
+    {
+        // Compute the triangle data for all mesh lights in parallel.
+        // The CPU-side triangles are unpacked from the packed data so that they are identical to data read back from the GPU.
+        std::vector<PackedEmissiveTriangle> triangleData(mTriangleCount);
+        mMeshLightTriangles.resize(mTriangleCount);
+
+        NumericRange<uint32_t> lights(0, (uint32_t)mMeshLights.size());
+        std::for_each(std::execution::par, lights.begin(), lights.end(), [&](uint32_t lightIdx)
+        {
+            const MeshLightData& meshLight = mMeshLights[lightIdx];
+            NumericRange<uint32_t> triangles(0, meshLight.triangleCount);
+            std::for_each(std::execution::par, triangles.begin(), triangles.end(), [&](uint32_t triangleIndex)
+            {
+                const uint32_t triIdx = meshLight.triangleOffset + triangleIndex;
+                triangleData[triIdx] = computeTriangle(scene, lightIdx, triangleIndex);
+
+                const EmissiveTriangle tri = triangleData[triIdx].unpack();
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
+                meshLightTri.lightIdx = tri.lightIdx;
+                meshLightTri.normal = tri.normal;
+                meshLightTri.area = tri.area;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    meshLightTri.vtx[j].pos = tri.posW[j];
+                    meshLightTri.vtx[j].uv = tri.texCoords[j];
+                }
+            });
+        });
+
+        mpTriangleData->setBlob(triangleData.data(), 0, triangleData.size() * sizeof(PackedEmissiveTriangle));
+    }
+
+    bool LightCollection::integrateEmissiveCPU(const Scene& scene)
+    {
+        // This mirrors the raster-based integrator (EmissiveIntegrator.3d.slang) followed by FinalizeIntegration.cs.slang.
+        // Mesh lights are grouped by emissive texture so that only one CPU texture copy is resident at a time.
+        std::map<Texture::SharedPtr, std::vector<uint32_t>> lightsByTexture;
+        for (uint32_t lightIdx = 0; lightIdx < (uint32_t)mMeshLights.size(); lightIdx++)
+        {
+            auto pMaterial = scene.getMaterial(mMeshLights[lightIdx].materialID)->toBasicMaterial();
+            FALCOR_ASSERT(pMaterial);
+            lightsByTexture[pMaterial->getEmissiveTexture()].push_back(lightIdx);
+        }
+
+        for (const auto& [pTexture, lightIndices] : lightsByTexture)
+        {
+            EmissiveTexture::SharedConstPtr pEmissiveTexture;
+            if (pTexture)
+            {
+                pEmissiveTexture = EmissiveTexture::createFromTexture(pTexture, mpSamplerState);
+                if (!pEmissiveTexture)
+                {
+                    logInfo("LightCollection: Emissive texture '{}' is not readable on the CPU. Integrating on the GPU.", pTexture->getSourceFilename());
+                    return false;
+                }
+            }
+
+            for (uint32_t lightIdx : lightIndices)
+            {
+                const MeshLightData& meshLight = mMeshLights[lightIdx];
+                const BasicMaterialData& materialData = scene.getMaterial(meshLight.materialID)->toBasicMaterial()->getData();
+
+                NumericRange<uint32_t> triangles(meshLight.triangleOffset, meshLight.triangleOffset + meshLight.triangleCount);
+                std::for_each(std::execution::par, triangles.begin(), triangles.end(), [&](uint32_t triIdx)
+                {
+                    auto& tri = mMeshLightTriangles[triIdx];
+
+                    float3 averageEmissiveColor = (float3)materialData.emissive;
+                    if (pEmissiveTexture)
+                    {
+                        const float2 texCoords[3] = { tri.vtx[0].uv, tri.vtx[1].uv, tri.vtx[2].uv };
+                        averageEmissiveColor = pEmissiveTexture->integrateTriangle(texCoords);
+                    }
+                    tri.averageRadiance = averageEmissiveColor * materialData.emissiveFactor;
+
+                    // Pre-compute the luminous flux emitted assuming diffuse emitters (see FinalizeIntegration.cs.slang).
+                    tri.flux = luminance(tri.averageRadiance) * tri.area * (float)M_PI;
+                });
+            }
+        }
+
+        std::vector<EmissiveFlux> fluxData(mTriangleCount);
+        for (uint32_t triIdx = 0; triIdx < mTriangleCount; triIdx++)
+        {
+            fluxData[triIdx].flux = mMeshLightTriangles[triIdx].flux;
+            fluxData[triIdx].averageRadiance = mMeshLightTriangles[triIdx].averageRadiance;
+        }
+        mpFluxData->setBlob(fluxData.data(), 0, fluxData.size() * sizeof(EmissiveFlux));
+
+        return true;
+    }
+
+    void LightCollection::updateTrianglePositionsCPU(const Scene& scene, const std::vector<uint32_t>& updatedLights)
+    {
+        // Unlike the GPU pass, only the triangles of updated lights are recomputed.
+        // Lights are stored consecutively, so runs of updated lights are uploaded with a single copy.
+        FALCOR_ASSERT(std::is_sorted(updatedLights.begin(), updatedLights.end()));
+
+        std::vector<PackedEmissiveTriangle> triangleData;
+        for (size_t first = 0; first < updatedLights.size();)
+        {
+            size_t last = first + 1;
+            while (last < updatedLights.size() && updatedLights[last] == updatedLights[last - 1] + 1) last++;
+
+            const uint32_t triangleOffset = mMeshLights[updatedLights[first]].triangleOffset;
+            const uint32_t triangleEnd = mMeshLights[updatedLights[last - 1]].triangleOffset + mMeshLights[updatedLights[last - 1]].triangleCount;
+            triangleData.resize(triangleEnd - triangleOffset);
+
+            NumericRange<uint32_t> triangles(triangleOffset, triangleEnd);
+            std::for_each(std::execution::par, triangles.begin(), triangles.end(), [&](uint32_t triIdx)
+            {
+                auto& meshLightTri = mMeshLightTriangles[triIdx];
+                const uint32_t lightIdx = meshLightTri.lightIdx;
+                auto& packedTri = triangleData[triIdx - triangleOffset];
+                packedTri = computeTriangle(scene, lightIdx, triIdx - mMeshLights[lightIdx].triangleOffset);
+
+                const EmissiveTriangle tri = packedTri.unpack();
+                meshLightTri.normal = tri.normal;
+                meshLightTri.area = tri.area;
+                for (uint32_t j = 0; j < 3; j++) meshLightTri.vtx[j].pos = tri.posW[j];
+            });
+
+            mpTriangleData->setBlob(triangleData.data(), triangleOffset * sizeof(PackedEmissiveTriangle), triangleData.size() * sizeof(PackedEmissiveTriangle));
+            first = last;
+        }
+    }
+
     uint64_t LightCollection::getMemoryUsageInBytes() const
     {
         uint64_t m = 0;
@@ -28,6 +28,7 @@
 #pragma once
 #include "RenderGraph/BasePasses/ComputePass.h"
 #include "MeshLightData.slang"
+#include "LightCollectionShared.slang"
 
 namespace Falcor
 {
@@ -40,6 +41,11 @@ namespace Falcor
         This class has utility functions for updating and pre-processing the mesh lights.
         The LightCollection can be used standalone, but more commonly it will be wrapped
         by an emissive light sampler.
+
+        Pre-processing runs on the CPU when the emissive geometry and textures are available
+        on the CPU (see Scene::getEmissiveMeshGeometry() and EmissiveTexture). In that case the
+        CPU data is valid right away and no GPU readback is needed. Otherwise the GPU passes
+        are used and the results are read back on demand.
     */
     class FALCOR_API LightCollection
     {
@@ -149,6 +155,10 @@ namespace Falcor
         */
         const std::vector<MeshLightData>& getMeshLights() const { return mMeshLights; }
 
+        /** Returns the sorted indices of the mesh lights that were updated by the last call to update().
+        */
+        const std::vector<uint32_t>& getUpdatedLights() const { return mUpdatedLights; }
+
         /** Prepare for syncing the CPU data.
             If the mesh light triangles will be accessed with getMeshLightTriangles()
             performance can be improved by calling this function ahead of time.
@@ -160,6 +170,14 @@ namespace Falcor
         */
         uint64_t getMemoryUsageInBytes() const;
 
+        /** Returns true if the triangle data is built and updated on the CPU.
+        */
+        bool hasCPUTriangleData() const { return mCPUTriangleData; }
+
+        /** Returns true if the emissive flux was integrated on the CPU.
+        */
+        bool hasCPUFluxData() const { return mCPUFluxData; }
+
         // Internal update flags. This only public for FALCOR_ENUM_CLASS_OPERATORS() to work.
         enum class CPUOutOfDateFlags : uint32_t
         {
@@ -184,6 +202,13 @@ namespace Falcor
         void updateActiveTriangleList();
         void updateTrianglePositions(RenderContext* pRenderContext, const Scene& scene, const std::vector<uint32_t>& updatedLights);
 
+        // CPU pre-processing
+        bool canBuildTriangleListOnCPU(const Scene& scene) const;
+        PackedEmissiveTriangle computeTriangle(const Scene& scene, uint32_t lightIdx, uint32_t triangleIndex) const;
+        void buildTriangleListCPU(const Scene& scene);
+        bool integrateEmissiveCPU(const Scene& scene);
+        void updateTrianglePositionsCPU(const Scene& scene, const std::vector<uint32_t>& updatedLights);
+
         void copyDataToStagingBuffer(RenderContext* pRenderContext) const;
         void syncCPUData() const;
 
@@ -192,6 +217,7 @@ namespace Falcor
 
         std::vector<MeshLightData>              mMeshLights;            ///< List of all mesh lights.
         uint32_t                                mTriangleCount = 0;     ///< Total number of triangles in all mesh lights (= mMeshLightTriangles.size()). This may include culled triangles.
+        std::vector<uint32_t>                   mUpdatedLights;         ///< List of mesh lights updated by the last call to update().
 
         mutable std::vector<MeshLightTriangle>  mMeshLightTriangles;    ///< List of all pre-processed mesh light triangles.
         mutable std::vector<uint32_t>           mActiveTriangleList;    ///< List of active (non-culled) emissive triangles.
@@ -224,6 +250,8 @@ namespace Falcor
         ComputePass::SharedPtr                  mpTrianglePositionUpdater;
         ComputePass::SharedPtr                  mpFinalizeIntegration;
 
+        bool                                    mCPUTriangleData = false;                   ///< True if the triangle data is built and updated on the CPU.
+        bool                                    mCPUFluxData = false;                       ///< True if the flux data is integrated on the CPU.
         mutable CPUOutOfDateFlags               mCPUInvalidData = CPUOutOfDateFlags::None;  ///< Flags indicating which CPU data is valid.
         mutable bool                            mStagingBufferValid = true;                 ///< Flag to indicate if the contents of the staging buffer is up-to-date.
     };
@@ -177,6 +177,21 @@ namespace Falcor
         return mTextureSlotData[(size_t)slot].pTexture;
     }
 
+    void Material::replaceTexture(const Texture::SharedPtr& pOldTexture, const Texture::SharedPtr& pNewTexture)
+    {
+        bool replaced = false;
+        for (auto& slotData : mTextureSlotData)
+        {
+            if (slotData.pTexture && slotData.pTexture == pOldTexture)
+            {
+                slotData.pTexture = pNewTexture;
+                replaced = true;
+            }
+        }
+
+        if (replaced) markUpdates(UpdateFlags::ResourcesChanged);
+    }
+
     void Material::loadTexture(TextureSlot slot, const std::string& filename, bool useSrgb)
     {
         if (!hasTextureSlot(slot))
@@ -223,6 +223,14 @@ namespace Falcor
         */
         virtual Texture::SharedPtr getTexture(const TextureSlot slot) const;
 
+        /** Replace all references to a texture by another texture with the same content at a different resolution.
+            This is used when the texture manager changes the number of resident mip levels of a texture.
+            Unlike setTexture(), material properties derived from the texture content are left unchanged.
+            \param[in] pOldTexture The texture to replace.
+            \param[in] pNewTexture The replacement texture.
+        */
+        void replaceTexture(const Texture::SharedPtr& pOldTexture, const Texture::SharedPtr& pNewTexture);
+
         /** Optimize texture usage for the given texture slot.
             This function may replace constant textures by uniform material parameters etc.
             \param[in] slot The texture slot.
@@ -67,9 +67,17 @@ namespace Falcor
 #endif // FALCOR_D3D12
 
         mpFence = GpuFence::create();
+        mpUploader = StagedBufferUploader::create();
         mpTextureManager = TextureManager::create(kMaxTextureCount);
         mMaterialCountByType.resize((size_t)MaterialType::Count, 0);
 
+        // Materials hold references to their textures. Replace them when the texture manager changes the residency of a texture,
+        // so that memory of non-resident mip levels is released.
+        mpTextureManager->setTextureReplacedCallback([this](const Texture::SharedPtr& pOldTexture, const Texture::SharedPtr& pNewTexture)
+        {
+            for (const auto& pMaterial : mMaterials) pMaterial->replaceTexture(pOldTexture, pNewTexture);
+        });
+
         // Create a default texture sampler.
         Sampler::Desc desc;
         desc.setFilterMode(Sampler::Filter::Linear, Sampler::Filter::Linear, Sampler::Filter::Linear);
@@ -77,6 +85,12 @@ namespace Falcor
         mpDefaultTextureSampler = Sampler::create(desc);
     }
 
+    MaterialSystem::~MaterialSystem()
+    {
+        // The texture manager may outlive the material system.
+        mpTextureManager->setTextureReplacedCallback({});
+    }
+
     void MaterialSystem::finalize()
     {
         // Pre-allocate texture and buffer descriptors based on final material count. This count will be reported by getDefines().
@@ -98,6 +112,23 @@ namespace Falcor
             }
         };
 
+        if (auto budgetGroup = widget.group("Texture budget"))
+        {
+            auto options = mpTextureManager->getResidencyOptions();
+            uint32_t budgetMB = (uint32_t)(options.budget >> 20);
+            bool changed = budgetGroup.var("Budget (MB)", budgetMB);
+            budgetGroup.tooltip("Memory budget for textures loaded from file. 0 means unlimited.");
+            changed |= budgetGroup.var("Eviction frame count", options.evictionFrameCount, 1u);
+            changed |= budgetGroup.var("Max dropped mips", options.maxDroppedMipCount, 0u, 16u);
+            if (changed)
+            {
+                options.budget = (uint64_t)budgetMB << 20;
+                mpTextureManager->setResidencyOptions(options);
+            }
+            budgetGroup.text("Resident: " + formatByteSize(mpTextureManager->getResidentBytes()));
+            budgetGroup.text("Not resident: " + formatByteSize(mpTextureManager->getEvictedBytes()));
+        }
+
         widget.checkbox("Sort by name", mSortMaterialsByName);
         if (mSortMaterialsByName)
         {
@@ -346,10 +377,23 @@ namespace Falcor
         if (stats.constantNormalMaps > 0) logWarning("Scene has {} normal maps of constant value. Please update the asset to optimize performance.", stats.constantNormalMaps);
     }
 
+    void MaterialSystem::markMaterialUsed(uint32_t materialID)
+    {
+        const auto& pMaterial = getMaterial(materialID);
+        for (uint32_t slot = 0; slot < (uint32_t)Material::TextureSlot::Count; slot++)
+        {
+            mpTextureManager->markTextureUsed(pMaterial->getTexture((Material::TextureSlot)slot).get());
+        }
+    }
+
     Material::UpdateFlags MaterialSystem::update(bool forceUpdate)
     {
         Material::UpdateFlags flags = Material::UpdateFlags::None;
 
+        // Update texture residency to fit the texture memory budget. Replaced textures mark the materials that use them as updated.
+        // The owner marks the materials used in this frame with markMaterialUsed() before calling update().
+        mpTextureManager->updateResidency(gpDevice->getRenderContext());
+
         // Update metadata if materials changed.
         if (mMaterialsChanged)
         {
@@ -413,6 +457,9 @@ namespace Falcor
             for (size_t i = 0; i < mBuffers.size(); i++) var[i] = mBuffers[i];
         }
 
+        // Upload all material changes (including edits made through the UI) in one batch.
+        mpUploader->flush(gpDevice->getRenderContext());
+
         mSamplersChanged = false;
         mBuffersChanged = false;
         mMaterialsChanged = false;
@@ -540,9 +587,8 @@ namespace Falcor
         const auto& pMaterial = mMaterials[materialID];
         FALCOR_ASSERT(pMaterial);
 
-        // TODO: On initial upload of materials, we could improve this by not having separate calls to setElement()
-        // but instead prepare a buffer containing all data.
+        // The data is staged and uploaded together with all other material changes in update().
         FALCOR_ASSERT(mpMaterialDataBuffer);
-        mpMaterialDataBuffer->setElement(materialID, pMaterial->getDataBlob());
+        mpUploader->setElement(mpMaterialDataBuffer, materialID, pMaterial->getDataBlob());
     }
 }
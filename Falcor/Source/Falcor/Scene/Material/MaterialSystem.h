@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Material.h"
+#include "Core/BufferTypes/StagedBufferUploader.h"
 #include "Utils/Image/TextureManager.h"
 
 namespace Falcor
@@ -79,6 +80,12 @@ namespace Falcor
         */
         void renderUI(Gui::Widgets& widget);
 
+        /** Mark the textures of a material as used in the current frame.
+            Textures that are not marked are the first to lose mip levels or be evicted when the texture memory budget is exceeded.
+            \param[in] materialID The material ID.
+        */
+        void markMaterialUsed(uint32_t materialID);
+
         /** Update material system. This prepares all resources for rendering.
         */
         Material::UpdateFlags update(bool forceUpdate);
@@ -177,6 +184,12 @@ namespace Falcor
         */
         const TextureManager::SharedPtr& getTextureManager() { return mpTextureManager; }
 
+        /** Get statistics of the material data uploaded in the last update.
+        */
+        const StagedBufferUploader::Stats& getUploadStats() const { return mpUploader->getLastFlushStats(); }
+
+        ~MaterialSystem();
+
     private:
         MaterialSystem();
 
@@ -198,6 +211,7 @@ namespace Falcor
 
         // GPU resources
         GpuFence::SharedPtr mpFence;
+        StagedBufferUploader::SharedPtr mpUploader;                 ///< Batches material data uploads.
         ParameterBlock::SharedPtr mpMaterialsBlock;                 ///< Parameter block for binding all material resources.
         Buffer::SharedPtr mpMaterialDataBuffer;                     ///< GPU buffer holding all material data.
         Sampler::SharedPtr mpDefaultTextureSampler;                 ///< Default texture sampler to use for all materials.
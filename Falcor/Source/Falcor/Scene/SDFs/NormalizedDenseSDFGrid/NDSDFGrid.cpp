@@ -30,6 +30,11 @@
 
 namespace Falcor
 {
+    namespace
+    {
+        const uint32_t kCoarsestAllowedGridWidth = 8;
+    }
+
     Sampler::SharedPtr NDSDFGrid::spNDSDFGridSampler;
     Buffer::SharedPtr NDSDFGrid::spNDSDFGridUnitAABBBuffer;
 
@@ -123,8 +128,6 @@ namespace Falcor
 
     void NDSDFGrid::setValuesInternal(const std::vector<float>& cornerValues)
     {
-        const uint32_t kCoarsestAllowedGridWidth = 8;
-
         if (kCoarsestAllowedGridWidth > mGridWidth)
         {
             throw RuntimeError("NDSDFGrid::setValues() grid width must be larger than {}.", kCoarsestAllowedGridWidth);
@@ -167,6 +170,12 @@ namespace Falcor
         }
     }
 
+    float NDSDFGrid::getMaxRepresentedDistance(uint32_t gridWidth) const
+    {
+        // The coarsest LOD has the widest narrow band.
+        return calculateNormalizationFactor(std::min(gridWidth, kCoarsestAllowedGridWidth));
+    }
+
     float NDSDFGrid::calculateNormalizationFactor(uint32_t gridWidth) const
     {
         return 0.5f * glm::root_three<float>() * mNarrowBandThickness / gridWidth;
@@ -57,6 +57,7 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual float getMaxRepresentedDistance(uint32_t gridWidth) const override;
 
         float calculateNormalizationFactor(uint32_t gridWidth) const;
 
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "SDFGrid.h"
+#include "SDFPrimitiveEvaluator.h"
+#include "SDFGridFile.h"
 #include "Scene/SDFs/NormalizedDenseSDFGrid/NDSDFGrid.h"
 #include "Scene/SDFs/SparseVoxelSet/SDFSVS.h"
 #include "Scene/SDFs/SparseBrickSet/SDFSBS.h"
@@ -36,13 +38,13 @@
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/error/en.h"
+#include "Utils/NumericRange.h"
+#include <execution>
 
 namespace Falcor
 {
     namespace
     {
-        const std::string kEvaluateSDFPrimitivesShaderName = "Scene/SDFs/EvaluateSDFPrimitives.cs.slang";
-
         const char kPrimitiveShapeTypeJSONKey[] = "shape_type";
         const char kPrimitiveShapeDataJSONKey[] = "shape_data";
         const char kPrimitiveShapeBlobbingJSONKey[] = "shape_blobbing";
@@ -53,6 +55,45 @@ namespace Falcor
         const char kPrimitiveTranslationJSONKey[] = "translation";
         const char kPrimitiveInvRotationScaleJSONKey[] = "inv_rot_scale";
 
+        const uint32_t kValueBrickWidth = 8;
+
+        /** Evaluates all bricks of values of a grid in parallel and gathers them into a dense grid.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] getBrickValues Function evaluating the values of a brick.
+            \param[in] convert Function converting a signed distance to the value stored in the dense grid.
+            \return The dense grid of (gridWidth + 1)^3 values, stored with x changing fastest.
+        */
+        template<typename T, typename ConvertFunc>
+        std::vector<T> gatherValueBricks(uint32_t gridWidth, const SDFGrid::BrickValuesFunc& getBrickValues, ConvertFunc convert)
+        {
+            const uint32_t gridWidthInValues = gridWidth + 1;
+            const uint32_t bricksPerAxis = div_round_up(gridWidthInValues, kValueBrickWidth);
+            std::vector<T> values((size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+            auto range = NumericRange<uint32_t>(0, bricksPerAxis * bricksPerAxis * bricksPerAxis);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickID)
+            {
+                const uint3 brickCoords = uint3(brickID % bricksPerAxis, (brickID / bricksPerAxis) % bricksPerAxis, brickID / (bricksPerAxis * bricksPerAxis));
+                const uint3 firstValueCoords = brickCoords * kValueBrickWidth;
+                const uint3 valueCount = glm::min(uint3(kValueBrickWidth), uint3(gridWidthInValues) - firstValueCoords);
+
+                float brickValues[kValueBrickWidth * kValueBrickWidth * kValueBrickWidth];
+                getBrickValues(firstValueCoords, valueCount, brickValues);
+
+                for (uint32_t z = 0; z < valueCount.z; z++)
+                {
+                    for (uint32_t y = 0; y < valueCount.y; y++)
+                    {
+                        T* pDst = values.data() + firstValueCoords.x + gridWidthInValues * (firstValueCoords.y + y + (size_t)gridWidthInValues * (firstValueCoords.z + z));
+                        const float* pSrc = brickValues + valueCount.x * (y + valueCount.y * z);
+                        for (uint32_t x = 0; x < valueCount.x; x++) pDst[x] = convert(pSrc[x]);
+                    }
+                }
+            });
+
+            return values;
+        }
+
         void serializeUint(const char* pKey, uint32_t value, rapidjson::PrettyWriter<rapidjson::StringBuffer>& jsonWriter)
         {
             jsonWriter.String(pKey);
@@ -206,6 +247,33 @@ namespace Falcor
         updatePrimitivesBuffer();
     }
 
+    void SDFGrid::bakePrimitives(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth)
+    {
+        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+
+        SDFPrimitiveEvaluator evaluator(primitives);
+        const float maxDistance = getMaxRepresentedDistance(gridWidth);
+
+        // The grid is defined by the baked values from now on, not by primitives.
+        mPrimitives.clear();
+        setValuesFromBricks(gridWidth, [&](const uint3& firstValueCoords, const uint3& valueCount, float* pValues)
+        {
+            // Bricks that are conservatively farther away from the surface than the grid represents are filled with the bound of their distances.
+            const float3 pMin = -0.5f + float3(firstValueCoords) / float(gridWidth);
+            const float3 pMax = -0.5f + float3(firstValueCoords + valueCount - 1u) / float(gridWidth);
+            const float2 bounds = evaluator.evalInterval(0.5f * (pMin + pMax), 0.5f * (pMax - pMin));
+
+            if (bounds.x > maxDistance || bounds.y < -maxDistance)
+            {
+                std::fill(pValues, pValues + valueCount.x * valueCount.y * valueCount.z, bounds.x > maxDistance ? bounds.x : bounds.y);
+            }
+            else
+            {
+                evaluator.evalBox(gridWidth, firstValueCoords, valueCount, pValues);
+            }
+        });
+    }
+
     void SDFGrid::setValues(const std::vector<float>& cornerValues, uint32_t gridWidth)
     {
         checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
@@ -216,30 +284,43 @@ namespace Falcor
         setValuesInternal(cornerValues);
     }
 
+    void SDFGrid::setValuesFromBricks(uint32_t gridWidth, const BrickValuesFunc& getBrickValues)
+    {
+        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+
+        mOriginalGridWidth = gridWidth;
+        mGridWidth = gridWidth;
+
+        setValuesFromBricksInternal(getBrickValues);
+    }
+
     bool SDFGrid::loadValuesFromFile(const std::string& filename)
     {
         std::string filePath;
-        if (findFileInDataDirectories(filename, filePath))
+        if (!findFileInDataDirectories(filename, filePath))
         {
-            std::ifstream file(filePath, std::ios::in | std::ios::binary);
+            logWarning("SDFGrid::loadValues() file '{}' could not be opened!", filename);
+            return false;
+        }
 
-            if (file.is_open())
-            {
-                uint32_t gridWidth;
-                file.read(reinterpret_cast<char*>(&gridWidth), sizeof(uint32_t));
+        uint32_t gridWidth = 0;
+        BrickValuesFunc getBrickValues;
 
-                uint32_t totalValueCount = (gridWidth + 1) * (gridWidth + 1) * (gridWidth + 1);
-                std::vector<float> cornerValues(totalValueCount, 0.0f);
-                file.read(reinterpret_cast<char*>(cornerValues.data()), totalValueCount * sizeof(float));
+        if (SDFGridFile::isSDFGridFile(filePath))
+        {
+            SDFGridFile::SharedPtr pFile = SDFGridFile::open(filePath);
+            if (!pFile) return false;
 
-                file.close();
-                setValues(cornerValues, gridWidth);
-                return true;
-            }
+            gridWidth = pFile->getGridWidth();
+            getBrickValues = [pFile](const uint3& firstValueCoords, const uint3& valueCount, float* pValues) { pFile->readValues(firstValueCoords, valueCount, pValues); };
+        }
+        else if (!SDFGridFile::openLegacyFile(filePath, gridWidth, getBrickValues))
+        {
+            return false;
         }
 
-        logWarning("SDFGrid::loadValues() file '{}' could not be opened!", filename);
-        return false;
+        setValuesFromBricks(gridWidth, getBrickValues);
+        return true;
     }
 
     void SDFGrid::generateCheeseValues(uint32_t gridWidth, uint32_t seed)
@@ -261,7 +342,8 @@ namespace Falcor
         uint32_t totalValueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         std::vector<float> cornerValues(totalValueCount, 0.0f);
 
-        for (uint32_t z = 0; z < gridWidthInValues; z++)
+        auto range = NumericRange<uint32_t>(0, gridWidthInValues);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t z)
         {
             for (uint32_t y = 0; y < gridWidthInValues; y++)
             {
@@ -289,58 +371,31 @@ namespace Falcor
                     cornerValues[x + gridWidthInValues * (y + gridWidthInValues * z)] = glm::clamp(sd, -glm::root_three<float>(), glm::root_three<float>());
                 }
             }
-        }
+        });
 
         setValues(cornerValues, gridWidth);
     }
 
-    bool SDFGrid::writeValuesFromPrimitivesToFile(const std::string& filePath, RenderContext* pRenderContext)
+    bool SDFGrid::writeValuesFromPrimitivesToFile(const std::string& filePath)
     {
-        if (!pRenderContext) pRenderContext = gpDevice->getRenderContext();
-
-        if (!mpEvaluatePrimitivesPass)
-        {
-            Program::Desc desc;
-            desc.addShaderLibrary(kEvaluateSDFPrimitivesShaderName).csEntry("main").setShaderModel("6_5");
-            mpEvaluatePrimitivesPass = ComputePass::create(desc);
-        }
-
-        if (!mpPrimitivesBuffer || mpPrimitivesBuffer->getElementCount() < (uint32_t)mPrimitives.size())
-        {
-            mpPrimitivesBuffer = Buffer::createStructured(sizeof(SDF3DPrimitive), (uint32_t)mPrimitives.size(), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mPrimitives.data(), false);
-        }
-
-        uint32_t gridWidthInValues = mOriginalGridWidth + 1;
-        uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
-        Buffer::SharedPtr pValuesBuffer = Buffer::createTyped<float>(valueCount);
-        Buffer::SharedPtr pValuesStagingBuffer = Buffer::createTyped<float>(valueCount, Resource::BindFlags::None, Buffer::CpuAccess::Read);
-        GpuFence::SharedPtr pFence = GpuFence::create();
-
-        mpEvaluatePrimitivesPass["CB"]["gGridWidth"] = mOriginalGridWidth;
-        mpEvaluatePrimitivesPass["CB"]["gPrimitiveCount"] = (uint32_t)mPrimitives.size();
-        mpEvaluatePrimitivesPass["gPrimitives"] = mpPrimitivesBuffer;
-        mpEvaluatePrimitivesPass["gValues"] = pValuesBuffer;
-        mpEvaluatePrimitivesPass->execute(pRenderContext, uint3(mOriginalGridWidth + 1));
-        pRenderContext->copyResource(pValuesStagingBuffer.get(), pValuesBuffer.get());
-        pRenderContext->flush(false);
-        pFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
-        pFence->syncCpu();
-        const float* pValues = reinterpret_cast<const float*>(pValuesStagingBuffer->map(Buffer::MapType::Read));
+        SDFPrimitiveEvaluator evaluator(mPrimitives);
+        std::vector<float> values = evaluator.evalGrid(mOriginalGridWidth);
 
         std::ofstream file(filePath, std::ios::out | std::ios::binary);
 
-        if (file.is_open())
+        if (!file.is_open())
         {
-            file.write(reinterpret_cast<const char*>(&mOriginalGridWidth), sizeof(uint32_t));
-            file.write(reinterpret_cast<const char*>(pValues), valueCount * sizeof(float));
-            file.close();
+            logWarning("SDFGrid::writeValuesFromPrimitivesToFile() file '{}' could not be opened!", filePath);
+            return false;
         }
 
-        pValuesStagingBuffer->unmap();
+        file.write(reinterpret_cast<const char*>(&mOriginalGridWidth), sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+        file.close();
         return true;
     }
 
-    uint32_t SDFGrid::loadPrimitivesFromFile(const std::string& filename, uint32_t gridWidth, const std::string& dir)
+    uint32_t SDFGrid::loadPrimitivesFromFile(const std::string& filename, uint32_t gridWidth, const std::string& dir, bool bake)
     {
         std::string filePath;
         if (dir.empty())
@@ -397,9 +452,10 @@ namespace Falcor
             if (!deserializeFloat3x3(kPrimitiveInvRotationScaleJSONKey, jsonPrimitive, primitive.invRotationScale)) return 0;
         }
 
-        setPrimitives(primitives, gridWidth);
+        if (bake) bakePrimitives(primitives, gridWidth);
+        else setPrimitives(primitives, gridWidth);
 
-        return (uint32_t)mPrimitives.size();
+        return (uint32_t)primitives.size();
     }
 
     FALCOR_SCRIPT_BINDING(SDFGrid)
@@ -435,11 +491,27 @@ namespace Falcor
         sdfGrid.def_static("createSBS", createSBS);
         sdfGrid.def_static("createSVO", []() { return SDFGrid::SharedPtr(SDFSVO::create()); });
         sdfGrid.def("loadValuesFromFile", &SDFGrid::loadValuesFromFile, "filename"_a);
-        sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "filename"_a, "gridWidth"_a, "dir"_a = "");
+        sdfGrid.def("loadPrimitivesFromFile", &SDFGrid::loadPrimitivesFromFile, "filename"_a, "gridWidth"_a, "dir"_a = "", "bake"_a = false);
+        sdfGrid.def("writeValuesFromPrimitivesToFile", &SDFGrid::writeValuesFromPrimitivesToFile, "filePath"_a);
         sdfGrid.def("generateCheeseValues", &SDFGrid::generateCheeseValues, "gridWidth"_a, "seed"_a);
         sdfGrid.def_property("name", &SDFGrid::getName, &SDFGrid::setName);
     }
 
+    void SDFGrid::setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues)
+    {
+        setValuesInternal(gatherValueBricks<float>(mGridWidth, getBrickValues, [](float value) { return value; }));
+    }
+
+    std::vector<int8_t> SDFGrid::quantizeValuesFromBricks(const BrickValuesFunc& getBrickValues) const
+    {
+        const float normalizationMultipler = 2.0f * mGridWidth / glm::root_three<float>();
+        return gatherValueBricks<int8_t>(mGridWidth, getBrickValues, [normalizationMultipler](float value)
+        {
+            float integerScale = glm::clamp(value * normalizationMultipler, -1.0f, 1.0f) * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        });
+    }
+
     void SDFGrid::updatePrimitivesBuffer()
     {
         if (!mpPrimitivesBuffer || mpPrimitivesBuffer->getElementCount() < (uint32_t)mPrimitives.size())
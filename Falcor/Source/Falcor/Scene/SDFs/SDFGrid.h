@@ -75,13 +75,38 @@ namespace Falcor
         */
         void setPrimitives(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth);
 
+        /** Function that evaluates the signed distances at a box of voxel corners.
+            Values that are farther away from the surface than the SDF grid represents may be replaced by any value of the same sign that is also beyond that distance.
+            \param[in] firstValueCoords Coords of the first value in the grid.
+            \param[in] valueCount Number of values along each axis.
+            \param[out] pValues Signed distances in grid space, stored with x changing fastest.
+        */
+        using BrickValuesFunc = std::function<void(const uint3& firstValueCoords, const uint3& valueCount, float* pValues)>;
+
+        /** Evaluate SDF primitives on the CPU and set the resulting signed distance values of the SDF grid.
+            Evaluation is multithreaded and does not require a GPU. Regions of the grid that are far away from the surface,
+            i.e., where all distances are clamped by the SDF grid representation, are not evaluated per value.
+            \param[in] primitives The SDF primitives, applied in order.
+            \param[in] gridWidth The grid width in voxels, must be a power of 2.
+        */
+        void bakePrimitives(const std::vector<SDF3DPrimitive>& primitives, uint32_t gridWidth);
+
         /** Set the signed distance values of the SDF grid, values are expected to be at the corners of voxels.
             \param[in] cornerValues The corner values for all voxels in the grid.
             \param[in] gridWidth The grid width, note that this represents the grid width in voxels, not in values, i.e., cornerValues should have a size of (gridWidth + 1)^3.
         */
         void setValues(const std::vector<float>& cornerValues, uint32_t gridWidth);
 
+        /** Set the signed distance values of the SDF grid from a function that is evaluated one brick of values at a time.
+            Bricks are evaluated in parallel. Sparse SDF grids quantize the values of each brick directly, so no dense grid of float values is created.
+            \param[in] gridWidth The grid width in voxels, must be a power of 2.
+            \param[in] getBrickValues Function that evaluates the values of a brick. Called concurrently from multiple threads.
+        */
+        void setValuesFromBricks(uint32_t gridWidth, const BrickValuesFunc& getBrickValues);
+
         /** Set the signed distance values of the SDF grid from a file.
+            Both compressed SDF grid files (see SDFGridFile) and the legacy format of uncompressed floats are supported.
+            The file is memory-mapped and values are streamed into the SDF grid brick by brick.
             \param[in] filename The name of a .sdfg file.
             \return true if the values could be set, otherwise false.
         */
@@ -93,19 +118,20 @@ namespace Falcor
         */
         void generateCheeseValues(uint32_t gridWidth, uint32_t seed);
 
-        /** Evaluates the SDF grid primitives on to a grid and writes the grid to a file.
+        /** Evaluates the SDF grid primitives on to a grid on the CPU and writes the grid to a file.
             \param[in] filepath A path to the file that should store the values.
             \return true if the values could be written, otherwise false.
         */
-        bool writeValuesFromPrimitivesToFile(const std::string& filePath, RenderContext* pRenderContext = nullptr);
+        bool writeValuesFromPrimitivesToFile(const std::string& filePath);
 
         /** Reads primitives from file and initializes the SDF grid.
             \param[in] filename The name to the input file.
             \param[in] gridWidth The targeted width of the SDF grid, the resulting grid may have a larger width.
             \param[in] dir A directory path, if this is empty, the file will be searched for in data directories.
+            \param[in] bake If true, the primitives are baked into grid values on the CPU using bakePrimitives(), otherwise they are set using setPrimitives().
             \return The number of primitives loaded.
         */
-        uint32_t loadPrimitivesFromFile(const std::string& filename, uint32_t gridWidth, const std::string& dir = "");
+        uint32_t loadPrimitivesFromFile(const std::string& filename, uint32_t gridWidth, const std::string& dir = "", bool bake = false);
 
         /** Get the name of the SDF grid.
             \return Returns the name.
@@ -152,6 +178,21 @@ namespace Falcor
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) = 0;
 
+        /** Sets the values from a function evaluating bricks of values, see setValuesFromBricks().
+            The default implementation gathers the bricks into a dense grid of values and calls setValuesInternal().
+        */
+        virtual void setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues);
+
+        /** Evaluates all bricks of values and quantizes them to a dense grid of int8 values, normalized to [-1, 1] where 1 represents half of a voxel diagonal.
+        */
+        std::vector<int8_t> quantizeValuesFromBricks(const BrickValuesFunc& getBrickValues) const;
+
+        /** Returns the largest signed distance magnitude (in grid space) that is represented by the SDF grid for a given grid width.
+            Larger distances are clamped when values are set, so they do not need to be evaluated exactly when baking primitives.
+            The default is half of a voxel diagonal.
+        */
+        virtual float getMaxRepresentedDistance(uint32_t gridWidth) const { return 0.5f * glm::root_three<float>() / float(gridWidth); }
+
         void updatePrimitivesBuffer();
 
         std::string mName;
@@ -161,7 +202,5 @@ namespace Falcor
         // Primitive data.
         std::vector<SDF3DPrimitive> mPrimitives;
         Buffer::SharedPtr mpPrimitivesBuffer;
-
-        ComputePass::SharedPtr mpEvaluatePrimitivesPass;
     };
 }
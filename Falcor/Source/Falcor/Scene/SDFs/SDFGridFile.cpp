@@ -0,0 +1,380 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SDFGridFile.h"
+#include "Utils/NumericRange.h"
+#include <lz4.h>
+#include <execution>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x46445346; // "FSDF"
+        const uint32_t kVersion = 1;
+        const size_t kMaxCachedChunkCount = 1024;
+
+        int32_t getMaxQuantizedValue(uint32_t bitsPerValue)
+        {
+            return (1 << (bitsPerValue - 1)) - 1;
+        }
+
+        int32_t quantizeValue(float value, float maxDistance, int32_t maxQuantizedValue)
+        {
+            float integerScale = glm::clamp(value / maxDistance, -1.0f, 1.0f) * float(maxQuantizedValue);
+            return integerScale >= 0.0f ? int32_t(integerScale + 0.5f) : int32_t(integerScale - 0.5f);
+        }
+
+        uint3 getChunkValueCount(uint32_t gridWidth, const uint3& chunkCoords)
+        {
+            return glm::min(uint3(SDFGridFile::kChunkWidth), uint3(gridWidth + 1) - chunkCoords * SDFGridFile::kChunkWidth);
+        }
+
+        uint3 getChunkCoords(uint32_t chunkID, uint32_t chunksPerAxis)
+        {
+            return uint3(chunkID % chunksPerAxis, (chunkID / chunksPerAxis) % chunksPerAxis, chunkID / (chunksPerAxis * chunksPerAxis));
+        }
+    }
+
+    SDFGridFile::SDFGridFile(const MemoryMappedFile::SharedPtr& pMappedFile, const Header& header, const ChunkDesc* pChunks)
+        : mpMappedFile(pMappedFile)
+        , mHeader(header)
+        , mpChunks(pChunks)
+        , mChunksPerAxis(div_round_up(header.gridWidth + 1, kChunkWidth))
+    {
+    }
+
+    SDFGridFile::SharedPtr SDFGridFile::open(const std::filesystem::path& path)
+    {
+        auto pMappedFile = MemoryMappedFile::create(path);
+        if (!pMappedFile)
+        {
+            logWarning("SDFGridFile::open() file '{}' could not be opened!", path.string());
+            return nullptr;
+        }
+
+        Header header = {};
+        const size_t fileSize = pMappedFile->getSize();
+        if (fileSize >= sizeof(Header)) std::memcpy(&header, pMappedFile->getData(), sizeof(Header));
+
+        const uint32_t chunksPerAxis = div_round_up(header.gridWidth + 1, kChunkWidth);
+        bool valid = fileSize >= sizeof(Header) && header.magic == kMagic && header.version == kVersion;
+        valid = valid && header.gridWidth > 0 && isPowerOf2(header.gridWidth) && header.chunkWidth == kChunkWidth;
+        valid = valid && (header.bitsPerValue == 8 || header.bitsPerValue == 16) && header.maxDistance > 0.0f;
+        valid = valid && header.chunkCount == chunksPerAxis * chunksPerAxis * chunksPerAxis;
+        valid = valid && fileSize >= sizeof(Header) + (size_t)header.chunkCount * sizeof(ChunkDesc);
+
+        if (!valid)
+        {
+            logWarning("SDFGridFile::open() file '{}' is not a valid SDF grid file!", path.string());
+            return nullptr;
+        }
+
+        // Validate the chunk table once, so chunks can be decoded without further checks.
+        const ChunkDesc* pChunks = reinterpret_cast<const ChunkDesc*>(static_cast<const uint8_t*>(pMappedFile->getData()) + sizeof(Header));
+        for (uint32_t chunkID = 0; chunkID < header.chunkCount; chunkID++)
+        {
+            const ChunkDesc& chunk = pChunks[chunkID];
+            if (chunk.compressedSize > 0 && (chunk.offset > fileSize || chunk.compressedSize > fileSize - chunk.offset))
+            {
+                logWarning("SDFGridFile::open() chunk {} of file '{}' is out of bounds!", chunkID, path.string());
+                return nullptr;
+            }
+        }
+
+        return SharedPtr(new SDFGridFile(pMappedFile, header, pChunks));
+    }
+
+    bool SDFGridFile::isSDFGridFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        uint32_t magic = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+        return file.good() && magic == kMagic;
+    }
+
+    bool SDFGridFile::write(const std::filesystem::path& path, uint32_t gridWidth, const SDFGrid::BrickValuesFunc& getBrickValues, const Options& options)
+    {
+        checkArgument(gridWidth > 0 && isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+        checkArgument(options.bitsPerValue == 8 || options.bitsPerValue == 16, "'bitsPerValue' ({}) must be 8 or 16.", options.bitsPerValue);
+        checkArgument(options.narrowBandThickness > 0.0f, "'narrowBandThickness' ({}) must be positive.", options.narrowBandThickness);
+
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        if (!file.is_open())
+        {
+            logWarning("SDFGridFile::write() file '{}' could not be opened!", path.string());
+            return false;
+        }
+
+        Header header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.gridWidth = gridWidth;
+        header.chunkWidth = kChunkWidth;
+        header.bitsPerValue = options.bitsPerValue;
+        header.maxDistance = options.narrowBandThickness * 0.5f * glm::root_three<float>() / float(gridWidth);
+
+        const uint32_t chunksPerAxis = div_round_up(gridWidth + 1, kChunkWidth);
+        const uint32_t chunksPerSlab = chunksPerAxis * chunksPerAxis;
+        header.chunkCount = chunksPerSlab * chunksPerAxis;
+
+        const int32_t maxQuantizedValue = getMaxQuantizedValue(header.bitsPerValue);
+        const uint32_t bytesPerValue = header.bitsPerValue / 8;
+
+        // The chunk table is written after all chunks have been compressed.
+        std::vector<ChunkDesc> chunks(header.chunkCount, ChunkDesc{});
+        uint64_t offset = sizeof(Header) + chunks.size() * sizeof(ChunkDesc);
+        file.seekp(offset);
+
+        // Compress one slab of chunks at a time to bound the memory used for compressed chunks that have not been written yet.
+        std::vector<std::vector<char>> compressedChunks(chunksPerSlab);
+        auto range = NumericRange<uint32_t>(0, chunksPerSlab);
+        for (uint32_t z = 0; z < chunksPerAxis; z++)
+        {
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t slabChunkID)
+            {
+                const uint3 chunkCoords = uint3(slabChunkID % chunksPerAxis, slabChunkID / chunksPerAxis, z);
+                const uint3 valueCount = getChunkValueCount(gridWidth, chunkCoords);
+                const size_t chunkValueCount = (size_t)valueCount.x * valueCount.y * valueCount.z;
+
+                std::vector<float> values(chunkValueCount);
+                getBrickValues(chunkCoords * kChunkWidth, valueCount, values.data());
+
+                std::vector<char> quantizedValues(chunkValueCount * bytesPerValue);
+                int32_t firstValue = quantizeValue(values[0], header.maxDistance, maxQuantizedValue);
+                bool uniform = true;
+                for (size_t i = 0; i < chunkValueCount; i++)
+                {
+                    int32_t value = quantizeValue(values[i], header.maxDistance, maxQuantizedValue);
+                    uniform = uniform && value == firstValue;
+                    if (bytesPerValue == 1) quantizedValues[i] = char(value);
+                    else reinterpret_cast<int16_t*>(quantizedValues.data())[i] = int16_t(value);
+                }
+
+                ChunkDesc& chunk = chunks[slabChunkID + z * chunksPerSlab];
+                std::vector<char>& compressed = compressedChunks[slabChunkID];
+                compressed.clear();
+
+                if (uniform)
+                {
+                    chunk.uniformValue = firstValue;
+                    return;
+                }
+
+                compressed.resize(LZ4_compressBound((int)quantizedValues.size()));
+                int compressedSize = LZ4_compress_default(quantizedValues.data(), compressed.data(), (int)quantizedValues.size(), (int)compressed.size());
+                FALCOR_ASSERT(compressedSize > 0);
+                compressed.resize(compressedSize);
+                chunk.compressedSize = (uint32_t)compressedSize;
+            });
+
+            for (uint32_t slabChunkID = 0; slabChunkID < chunksPerSlab; slabChunkID++)
+            {
+                const std::vector<char>& compressed = compressedChunks[slabChunkID];
+                if (compressed.empty()) continue;
+
+                chunks[slabChunkID + z * chunksPerSlab].offset = offset;
+                file.write(compressed.data(), compressed.size());
+                offset += compressed.size();
+            }
+        }
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(ChunkDesc));
+        file.close();
+
+        if (file.fail())
+        {
+            logWarning("SDFGridFile::write() file '{}' could not be written!", path.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SDFGridFile::openLegacyFile(const std::filesystem::path& path, uint32_t& gridWidth, SDFGrid::BrickValuesFunc& getBrickValues)
+    {
+        auto pMappedFile = MemoryMappedFile::create(path);
+        if (!pMappedFile)
+        {
+            logWarning("SDFGridFile::openLegacyFile() file '{}' could not be opened!", path.string());
+            return false;
+        }
+
+        uint32_t fileGridWidth = 0;
+        if (pMappedFile->getSize() >= sizeof(uint32_t)) std::memcpy(&fileGridWidth, pMappedFile->getData(), sizeof(uint32_t));
+
+        const uint64_t gridWidthInValues = uint64_t(fileGridWidth) + 1;
+        if (fileGridWidth == 0 || !isPowerOf2(fileGridWidth) || pMappedFile->getSize() < sizeof(uint32_t) + gridWidthInValues * gridWidthInValues * gridWidthInValues * sizeof(float))
+        {
+            logWarning("SDFGridFile::openLegacyFile() file '{}' is not a valid SDF grid file!", path.string());
+            return false;
+        }
+
+        gridWidth = fileGridWidth;
+        getBrickValues = [pMappedFile, gridWidthInValues](const uint3& firstValueCoords, const uint3& valueCount, float* pValues)
+        {
+            const float* pFileValues = reinterpret_cast<const float*>(static_cast<const uint8_t*>(pMappedFile->getData()) + sizeof(uint32_t));
+            for (uint32_t z = 0; z < valueCount.z; z++)
+            {
+                for (uint32_t y = 0; y < valueCount.y; y++)
+                {
+                    const float* pSrc = pFileValues + firstValueCoords.x + gridWidthInValues * (firstValueCoords.y + y + gridWidthInValues * (firstValueCoords.z + z));
+                    std::memcpy(pValues + valueCount.x * (y + valueCount.y * z), pSrc, valueCount.x * sizeof(float));
+                }
+            }
+        };
+
+        return true;
+    }
+
+    bool SDFGridFile::convertLegacyFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, const Options& options)
+    {
+        uint32_t gridWidth = 0;
+        SDFGrid::BrickValuesFunc getBrickValues;
+        if (!openLegacyFile(srcPath, gridWidth, getBrickValues)) return false;
+
+        return write(dstPath, gridWidth, getBrickValues, options);
+    }
+
+    void SDFGridFile::readValues(const uint3& firstValueCoords, const uint3& valueCount, float* pValues) const
+    {
+        const uint3 endValueCoords = firstValueCoords + valueCount;
+        FALCOR_ASSERT(glm::all(glm::lessThanEqual(endValueCoords, uint3(mHeader.gridWidth + 1))));
+        if (valueCount.x == 0 || valueCount.y == 0 || valueCount.z == 0) return;
+
+        const uint3 firstChunkCoords = firstValueCoords / kChunkWidth;
+        const uint3 lastChunkCoords = (endValueCoords - 1u) / kChunkWidth;
+        const float scale = mHeader.maxDistance / float(getMaxQuantizedValue(mHeader.bitsPerValue));
+
+        for (uint32_t chunkZ = firstChunkCoords.z; chunkZ <= lastChunkCoords.z; chunkZ++)
+        {
+            for (uint32_t chunkY = firstChunkCoords.y; chunkY <= lastChunkCoords.y; chunkY++)
+            {
+                for (uint32_t chunkX = firstChunkCoords.x; chunkX <= lastChunkCoords.x; chunkX++)
+                {
+                    const uint3 chunkCoords = uint3(chunkX, chunkY, chunkZ);
+                    const uint32_t chunkID = chunkX + mChunksPerAxis * (chunkY + mChunksPerAxis * chunkZ);
+                    const uint3 chunkFirstValueCoords = chunkCoords * kChunkWidth;
+                    const uint3 chunkValueCount = getChunkValueCount(mHeader.gridWidth, chunkCoords);
+
+                    // Region of the box covered by this chunk.
+                    const uint3 regionMin = glm::max(firstValueCoords, chunkFirstValueCoords);
+                    const uint3 regionMax = glm::min(endValueCoords, chunkFirstValueCoords + chunkValueCount);
+                    const uint32_t rowLength = regionMax.x - regionMin.x;
+
+                    const ChunkDesc& chunk = mpChunks[chunkID];
+                    std::shared_ptr<const DecodedChunk> pDecodedChunk;
+                    if (chunk.compressedSize > 0) pDecodedChunk = getDecodedChunk(chunkID);
+                    const float uniformValue = float(chunk.uniformValue) * scale;
+
+                    for (uint32_t z = regionMin.z; z < regionMax.z; z++)
+                    {
+                        for (uint32_t y = regionMin.y; y < regionMax.y; y++)
+                        {
+                            float* pDst = pValues + (regionMin.x - firstValueCoords.x) + valueCount.x * ((y - firstValueCoords.y) + valueCount.y * (z - firstValueCoords.z));
+
+                            if (pDecodedChunk)
+                            {
+                                const float* pSrc = pDecodedChunk->data() + (regionMin.x - chunkFirstValueCoords.x) + chunkValueCount.x * ((y - chunkFirstValueCoords.y) + chunkValueCount.y * (z - chunkFirstValueCoords.z));
+                                std::memcpy(pDst, pSrc, rowLength * sizeof(float));
+                            }
+                            else
+                            {
+                                std::fill(pDst, pDst + rowLength, uniformValue);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<const SDFGridFile::DecodedChunk> SDFGridFile::getDecodedChunk(uint32_t chunkID) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(mCacheMutex);
+            auto it = mCache.find(chunkID);
+            if (it != mCache.end())
+            {
+                mCacheOrder.splice(mCacheOrder.begin(), mCacheOrder, it->second.second);
+                return it->second.first;
+            }
+        }
+
+        // Decode outside of the lock. A chunk that is decoded by several threads at once is only inserted once.
+        auto pDecodedChunk = decodeChunk(chunkID);
+
+        std::lock_guard<std::mutex> lock(mCacheMutex);
+        auto [it, inserted] = mCache.try_emplace(chunkID);
+        if (!inserted) return it->second.first;
+
+        mCacheOrder.push_front(chunkID);
+        it->second = { pDecodedChunk, mCacheOrder.begin() };
+
+        while (mCache.size() > kMaxCachedChunkCount)
+        {
+            mCache.erase(mCacheOrder.back());
+            mCacheOrder.pop_back();
+        }
+
+        return pDecodedChunk;
+    }
+
+    std::shared_ptr<const SDFGridFile::DecodedChunk> SDFGridFile::decodeChunk(uint32_t chunkID) const
+    {
+        const ChunkDesc& chunk = mpChunks[chunkID];
+        const uint3 valueCount = getChunkValueCount(mHeader.gridWidth, getChunkCoords(chunkID, mChunksPerAxis));
+        const size_t chunkValueCount = (size_t)valueCount.x * valueCount.y * valueCount.z;
+        const uint32_t bytesPerValue = mHeader.bitsPerValue / 8;
+
+        std::vector<char> quantizedValues(chunkValueCount * bytesPerValue);
+        const char* pCompressed = static_cast<const char*>(mpMappedFile->getData()) + chunk.offset;
+        int size = LZ4_decompress_safe(pCompressed, quantizedValues.data(), (int)chunk.compressedSize, (int)quantizedValues.size());
+
+        auto pDecodedChunk = std::make_shared<DecodedChunk>(chunkValueCount);
+        if (size != (int)quantizedValues.size())
+        {
+            // This is called from parallel loops, so corrupted chunks are reported but treated as empty space instead of throwing.
+            logError("SDFGridFile: chunk {} of file '{}' is corrupted.", chunkID, mpMappedFile->getPath().string());
+            std::fill(pDecodedChunk->begin(), pDecodedChunk->end(), mHeader.maxDistance);
+            return pDecodedChunk;
+        }
+
+        const float scale = mHeader.maxDistance / float(getMaxQuantizedValue(mHeader.bitsPerValue));
+        for (size_t i = 0; i < chunkValueCount; i++)
+        {
+            int32_t value = bytesPerValue == 1 ? int32_t(int8_t(quantizedValues[i])) : int32_t(reinterpret_cast<const int16_t*>(quantizedValues.data())[i]);
+            (*pDecodedChunk)[i] = float(value) * scale;
+        }
+
+        return pDecodedChunk;
+    }
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/SDFs/SDFGrid.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Falcor
+{
+    /** Compressed file format for SDF grid values.
+
+        The values at the voxel corners are split into chunks of kChunkWidth^3 values. Each chunk stores quantized distances,
+        normalized to [-1, 1] where 1 represents the largest distance stored in the file, and is compressed separately using LZ4.
+        Chunks in which all quantized values are equal, e.g., chunks far away from the surface, are not stored at all.
+
+        Files are memory-mapped when opened and chunks are decompressed on demand, so values can be streamed brick by brick
+        into SDF grids using SDFGrid::setValuesFromBricks() without reading the whole file or allocating a dense grid of values.
+        Recently used chunks are kept decompressed in a cache of bounded size.
+    */
+    class FALCOR_API SDFGridFile
+    {
+    public:
+        using SharedPtr = std::shared_ptr<SDFGridFile>;
+
+        static const uint32_t kChunkWidth = 16;     ///< Number of values along each axis of a chunk.
+
+        struct Options
+        {
+            uint32_t bitsPerValue = 8;              ///< Bits per quantized value, either 8 or 16.
+            float narrowBandThickness = 1.f;        ///< Largest stored distance in half voxel diagonals. A thickness of 1 with 8 bits per value matches the precision of sparse SDF grids, larger values preserve more of the distance field for NDSDFGrid.
+        };
+
+        /** Open an SDF grid file.
+            \param[in] path Path of the file.
+            \return A new object, or nullptr if the file could not be opened or is not a valid SDF grid file.
+        */
+        static SharedPtr open(const std::filesystem::path& path);
+
+        /** Check if a file starts with the header of an SDF grid file.
+        */
+        static bool isSDFGridFile(const std::filesystem::path& path);
+
+        /** Write an SDF grid file. Chunks are evaluated and compressed in parallel, one slab of chunks at a time.
+            \param[in] path Path of the file.
+            \param[in] gridWidth The grid width in voxels, must be a power of 2.
+            \param[in] getBrickValues Function that evaluates the values of a chunk. Called concurrently from multiple threads.
+            \param[in] options Options selecting the quantization.
+            \return true if the file was written, otherwise false.
+        */
+        static bool write(const std::filesystem::path& path, uint32_t gridWidth, const SDFGrid::BrickValuesFunc& getBrickValues, const Options& options = {});
+
+        /** Open a file in the legacy SDF grid format, a uint32_t grid width followed by (gridWidth + 1)^3 floats.
+            The file is memory-mapped, the returned function reads values from the mapped file and keeps it mapped while referenced.
+            \param[in] path Path of the file.
+            \param[out] gridWidth The grid width in voxels.
+            \param[out] getBrickValues Function reading values from the file.
+            \return true if the file could be opened, otherwise false.
+        */
+        static bool openLegacyFile(const std::filesystem::path& path, uint32_t& gridWidth, SDFGrid::BrickValuesFunc& getBrickValues);
+
+        /** Convert a file in the legacy SDF grid format to an SDF grid file.
+            \param[in] srcPath Path of the legacy file.
+            \param[in] dstPath Path of the SDF grid file to write.
+            \param[in] options Options selecting the quantization.
+            \return true if the file was converted, otherwise false.
+        */
+        static bool convertLegacyFile(const std::filesystem::path& srcPath, const std::filesystem::path& dstPath, const Options& options = {});
+
+        /** Read a box of values. Safe to call concurrently from multiple threads.
+            \param[in] firstValueCoords Coords of the first value of the box in the grid.
+            \param[in] valueCount Number of values of the box along each axis.
+            \param[out] pValues Signed distances in grid space, stored with x changing fastest. Distances are clamped to getMaxDistance().
+        */
+        void readValues(const uint3& firstValueCoords, const uint3& valueCount, float* pValues) const;
+
+        /** Returns the width of the grid in voxels.
+        */
+        uint32_t getGridWidth() const { return mHeader.gridWidth; }
+
+        /** Returns the number of bits per quantized value.
+        */
+        uint32_t getBitsPerValue() const { return mHeader.bitsPerValue; }
+
+        /** Returns the largest distance stored in the file, in grid space.
+        */
+        float getMaxDistance() const { return mHeader.maxDistance; }
+
+        /** Returns the number of chunks, including chunks that are not stored because all their values are equal.
+        */
+        uint32_t getChunkCount() const { return mHeader.chunkCount; }
+
+        /** Returns the size of the file in bytes.
+        */
+        size_t getFileSize() const { return mpMappedFile->getSize(); }
+
+    private:
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t gridWidth;             ///< Grid width in voxels.
+            uint32_t chunkWidth;            ///< Chunk width in values.
+            uint32_t bitsPerValue;          ///< Bits per quantized value.
+            float maxDistance;              ///< Distance in grid space represented by the largest quantized value.
+            uint32_t chunkCount;            ///< Number of chunks, the chunk table follows the header.
+            uint32_t reserved;
+        };
+
+        struct ChunkDesc
+        {
+            uint64_t offset;                ///< Offset of the compressed values in the file.
+            uint32_t compressedSize;        ///< Size of the compressed values in bytes, 0 if the chunk is uniform.
+            int32_t uniformValue;           ///< Quantized value of all values in the chunk if the chunk is uniform.
+        };
+
+        using DecodedChunk = std::vector<float>;
+
+        SDFGridFile(const MemoryMappedFile::SharedPtr& pMappedFile, const Header& header, const ChunkDesc* pChunks);
+        std::shared_ptr<const DecodedChunk> getDecodedChunk(uint32_t chunkID) const;
+        std::shared_ptr<const DecodedChunk> decodeChunk(uint32_t chunkID) const;
+
+        MemoryMappedFile::SharedPtr mpMappedFile;
+        Header mHeader;
+        const ChunkDesc* mpChunks;
+        uint32_t mChunksPerAxis;
+
+        // Cache of decoded chunks, ordered from most to least recently used.
+        mutable std::mutex mCacheMutex;
+        mutable std::list<uint32_t> mCacheOrder;
+        mutable std::unordered_map<uint32_t, std::pair<std::shared_ptr<const DecodedChunk>, std::list<uint32_t>::iterator>> mCache;
+    };
+}
@@ -0,0 +1,440 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "SDFPrimitiveEvaluator.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kBrickWidth = 8; ///< Width of the bricks of values evaluated together by evalGrid().
+        const uint32_t kBrickValueCount = kBrickWidth * kBrickWidth * kBrickWidth;
+        const float kMaxDistance = std::numeric_limits<float>::max();
+
+        float saturate(float x) { return std::clamp(x, 0.f, 1.f); }
+        float sign(float x) { return float((0.f < x) - (x < 0.f)); }
+        float length(float x, float y) { return std::sqrt(x * x + y * y); }
+        float length(float x, float y, float z) { return std::sqrt(x * x + y * y + z * z); }
+
+        // Shapes, mirroring Utils/SDF/SDF3DShapes.slang.
+
+        float sdfSphere(float x, float y, float z, float r)
+        {
+            return length(x, y, z) - r;
+        }
+
+        float sdfEllipsoid(float x, float y, float z, const float3& r)
+        {
+            float k0 = length(x / r.x, y / r.y, z / r.z);
+            float k1 = length(x / (r.x * r.x), y / (r.y * r.y), z / (r.z * r.z));
+            return k0 * (k0 - 1.f) / k1;
+        }
+
+        float sdfBox(float x, float y, float z, const float3& b)
+        {
+            float qx = std::abs(x) - b.x;
+            float qy = std::abs(y) - b.y;
+            float qz = std::abs(z) - b.z;
+            return length(std::max(qx, 0.f), std::max(qy, 0.f), std::max(qz, 0.f)) + std::min(std::max(std::max(qx, qy), qz), 0.f);
+        }
+
+        float sdfTorus(float x, float y, float z, float r)
+        {
+            return length(length(x, z) - r, y);
+        }
+
+        float sdfCone(float x, float y, float z, float tan, float h)
+        {
+            float qx = h * tan;
+            float qy = -h;
+            float wx = length(x, z);
+            float wy = y - 0.5f * h;
+            float t = saturate((wx * qx + wy * qy) / (qx * qx + qy * qy));
+            float ax = wx - qx * t;
+            float ay = wy - qy * t;
+            float bx = wx - qx * saturate(wx / qx);
+            float by = wy - qy;
+            float k = sign(qy);
+            float d = std::min(ax * ax + ay * ay, bx * bx + by * by);
+            float s = std::max(k * (wx * qy - wy * qx), k * (wy - qy));
+            return std::sqrt(d) * sign(s);
+        }
+
+        float sdfCapsule(float x, float y, float z, float hl)
+        {
+            y -= std::clamp(y, -hl, hl);
+            return length(x, y, z);
+        }
+
+        // Operations, mirroring Utils/SDF/SDFOperations.slang.
+
+        float smin(float a, float b, float k)
+        {
+            float h = std::max(k - std::abs(a - b), 0.f);
+            return std::min(a, b) - h * h * 0.25f / k;
+        }
+
+        float smax(float a, float b, float k)
+        {
+            float h = std::max(k - std::abs(a - b), 0.f);
+            return std::max(a, b) + h * h * 0.25f / k;
+        }
+
+        // Interval arithmetic, mirroring Utils/Math/IntervalArithmetic.slang. Intervals are stored as (min, max).
+
+        float2 ivlMin(float2 a, float2 b) { return glm::min(a, b); }
+        float2 ivlMin(float2 a, float s) { return glm::min(a, float2(s)); }
+        float2 ivlMax(float2 a, float2 b) { return glm::max(a, b); }
+        float2 ivlMax(float2 a, float s) { return glm::max(a, float2(s)); }
+        float2 ivlClamp(float2 a, float lo, float hi) { return glm::clamp(a, float2(lo), float2(hi)); }
+        float2 ivlSaturate(float2 a) { return ivlClamp(a, 0.f, 1.f); }
+        float2 ivlAdd(float2 a, float s) { return a + s; }
+        float2 ivlAdd(float2 a, float2 b) { return a + b; }
+        float2 ivlSub(float2 a, float s) { return a - s; }
+        float2 ivlSub(float2 a, float2 b) { return float2(a.x - b.y, a.y - b.x); }
+        float2 ivlNegate(float2 a) { return float2(-a.y, -a.x); }
+        float2 ivlSqrt(float2 a) { return float2(std::sqrt(a.x), std::sqrt(a.y)); }
+        float2 ivlPosSquare(float2 a) { return a * a; }
+
+        float2 ivlMul(float2 a, float s)
+        {
+            float2 p = a * s;
+            return float2(std::min(p.x, p.y), std::max(p.x, p.y));
+        }
+
+        float2 ivlMul(float2 a, float2 b)
+        {
+            float p0 = a.x * b.x, p1 = a.y * b.y, p2 = a.y * b.x, p3 = a.x * b.y;
+            return float2(std::min(std::min(p0, p1), std::min(p2, p3)), std::max(std::max(p0, p1), std::max(p2, p3)));
+        }
+
+        float2 ivlPosMul(float2 a, float2 b)
+        {
+            return float2(std::min(a.x * b.x, a.y * b.x), std::max(a.y * b.y, a.x * b.y));
+        }
+
+        float2 ivlDiv(float2 a, float s)
+        {
+            float2 f = a / s;
+            return float2(std::min(f.x, f.y), std::max(f.x, f.y));
+        }
+
+        float2 ivlDiv(float2 a, float2 b)
+        {
+            bool containsZero = b.x <= 0.f && b.y >= 0.f;
+            return ivlMul(a, containsZero ? float2(-kMaxDistance, kMaxDistance) : 1.f / b);
+        }
+
+        float2 ivlAbs(float2 a)
+        {
+            return float2(std::max(std::max(a.x, -a.y), 0.f), std::max(-a.x, a.y));
+        }
+
+        float2 ivlSquare(float2 a)
+        {
+            a = ivlAbs(a);
+            return a * a;
+        }
+
+        float2 ivlLength(float2 x, float2 y)
+        {
+            return ivlSqrt(ivlAdd(ivlSquare(x), ivlSquare(y)));
+        }
+
+        float2 ivlLength(float2 x, float2 y, float2 z)
+        {
+            return ivlSqrt(ivlAdd(ivlAdd(ivlSquare(x), ivlSquare(y)), ivlSquare(z)));
+        }
+
+        float2 ivlSMin(float2 a, float2 b, float k)
+        {
+            float2 h = ivlMax(ivlAdd(ivlNegate(ivlAbs(ivlSub(a, b))), k), 0.f);
+            h = ivlDiv(ivlMul(ivlPosSquare(h), 0.25f), k);
+            return ivlSub(ivlMin(a, b), h);
+        }
+
+        float2 ivlSMax(float2 a, float2 b, float k)
+        {
+            float2 h = ivlMax(ivlAdd(ivlNegate(ivlAbs(ivlSub(a, b))), k), 0.f);
+            h = ivlDiv(ivlMul(ivlPosSquare(h), 0.25f), k);
+            return ivlAdd(ivlMax(a, b), h);
+        }
+
+        float2 evalIntervalShape(SDF3DShapeType shapeType, const float3& shapeData, float2 x, float2 y, float2 z)
+        {
+            switch (shapeType)
+            {
+            case SDF3DShapeType::Sphere:
+                return ivlSub(ivlLength(x, y, z), shapeData.x);
+            case SDF3DShapeType::Ellipsoid:
+            {
+                const float3 r = shapeData;
+                const float3 rSqrd = r * r;
+                float2 k0 = ivlLength(ivlDiv(x, r.x), ivlDiv(y, r.y), ivlDiv(z, r.z));
+                float2 k1 = ivlLength(ivlDiv(x, rSqrd.x), ivlDiv(y, rSqrd.y), ivlDiv(z, rSqrd.z));
+                return ivlDiv(ivlPosMul(k0, ivlSub(k0, 1.f)), k1);
+            }
+            case SDF3DShapeType::Box:
+            {
+                float2 qx = ivlSub(ivlAbs(x), shapeData.x);
+                float2 qy = ivlSub(ivlAbs(y), shapeData.y);
+                float2 qz = ivlSub(ivlAbs(z), shapeData.z);
+                return ivlAdd(ivlLength(ivlMax(qx, 0.f), ivlMax(qy, 0.f), ivlMax(qz, 0.f)), ivlMin(ivlMax(ivlMax(qx, qy), qz), 0.f));
+            }
+            case SDF3DShapeType::Torus:
+                return ivlLength(ivlSub(ivlLength(x, z), shapeData.x), y);
+            case SDF3DShapeType::Cone:
+            {
+                const float tan = shapeData.x;
+                const float h = shapeData.y;
+                y = ivlSub(y, 0.5f * h);
+                float2 q = h * float2(tan, -1.f);
+                float2 wX = ivlLength(x, z);
+
+                float dotQQ = glm::dot(q, q);
+                float2 dotWQ = ivlAdd(ivlMul(wX, q.x), ivlMul(y, q.y));
+                float2 satDotWQDivDotQQ = ivlSaturate(ivlDiv(dotWQ, dotQQ));
+                float2 satWxDivQx = ivlSaturate(ivlDiv(wX, q.x));
+
+                float2 aX = ivlSub(wX, ivlMul(satDotWQDivDotQQ, q.x));
+                float2 aY = ivlSub(y, ivlMul(satDotWQDivDotQQ, q.y));
+                float2 bX = ivlSub(wX, ivlMul(satWxDivQx, q.x));
+                float2 bY = ivlSub(y, q.y);
+
+                float k = sign(q.y);
+                float2 d = ivlMin(ivlAdd(ivlSquare(aX), ivlSquare(aY)), ivlAdd(ivlSquare(bX), ivlSquare(bY)));
+                float2 s = ivlMax(ivlMul(ivlSub(ivlMul(wX, q.y), ivlMul(y, q.x)), k), ivlMul(ivlSub(y, q.y), k));
+                return ivlMul(ivlSqrt(d), float2(sign(s.x), sign(s.y)));
+            }
+            case SDF3DShapeType::Capsule:
+                y = ivlSub(y, ivlClamp(y, -shapeData.x, shapeData.x));
+                return ivlLength(x, y, z);
+            default:
+                return float2(kMaxDistance);
+            }
+        }
+
+        float2 evalIntervalOperation(SDFOperationType operationType, float2 d, float2 dShape, float smoothing)
+        {
+            switch (operationType)
+            {
+            case SDFOperationType::Union:               return ivlMin(d, dShape);
+            case SDFOperationType::Subtraction:         return ivlMax(d, ivlNegate(dShape));
+            case SDFOperationType::Intersection:        return ivlMax(d, dShape);
+            case SDFOperationType::SmoothUnion:         return ivlSMin(d, dShape, smoothing);
+            case SDFOperationType::SmoothSubtraction:   return ivlSMax(d, ivlNegate(dShape), smoothing);
+            case SDFOperationType::SmoothIntersection:  return ivlSMax(d, dShape, smoothing);
+            default:                                    return d;
+            }
+        }
+
+        // Batched evaluation helpers. These are plain loops over arrays without branches on the primitive,
+        // which the compiler can vectorize once the lambda is inlined.
+
+        template<typename ShapeFunc>
+        void evalShapeBatch(uint32_t count, const float* pX, const float* pY, const float* pZ, float blobbing, float* pD, ShapeFunc shape)
+        {
+            for (uint32_t i = 0; i < count; i++) pD[i] = shape(pX[i], pY[i], pZ[i]) - blobbing;
+        }
+
+        template<typename OperationFunc>
+        void evalOperationBatch(uint32_t count, const float* pShapeD, float* pD, OperationFunc operation)
+        {
+            for (uint32_t i = 0; i < count; i++) pD[i] = operation(pD[i], pShapeD[i]);
+        }
+    }
+
+    SDFPrimitiveEvaluator::SDFPrimitiveEvaluator(const std::vector<SDF3DPrimitive>& primitives)
+        : mPrimitives(primitives)
+    {
+    }
+
+    float SDFPrimitiveEvaluator::eval(const float3& p) const
+    {
+        float d;
+        evalPoints(&p.x, &p.y, &p.z, 1, &d);
+        return d;
+    }
+
+    float2 SDFPrimitiveEvaluator::evalInterval(const float3& pCenter, const float3& pHalfExtent) const
+    {
+        float2 d(kMaxDistance);
+
+        for (const auto& primitive : mPrimitives)
+        {
+            // Transform the box into the local space of the primitive, see evalPoints().
+            // Unlike the shader, the half extent is transformed as well so that the bounds stay conservative for rotated and scaled primitives.
+            const float3x3& m = primitive.invRotationScale;
+            const float3 center = (pCenter - primitive.translation) * m;
+            const float3 halfExtent = float3(
+                glm::dot(glm::abs(m[0]), pHalfExtent),
+                glm::dot(glm::abs(m[1]), pHalfExtent),
+                glm::dot(glm::abs(m[2]), pHalfExtent));
+            const float3 pMin = center - halfExtent;
+            const float3 pMax = center + halfExtent;
+
+            float2 dShape = evalIntervalShape(primitive.shapeType, primitive.shapeData, float2(pMin.x, pMax.x), float2(pMin.y, pMax.y), float2(pMin.z, pMax.z));
+            dShape = ivlSub(dShape, primitive.shapeBlobbing);
+            d = evalIntervalOperation(primitive.operationType, d, dShape, primitive.operationSmoothing);
+        }
+
+        return d;
+    }
+
+    std::vector<float> SDFPrimitiveEvaluator::evalGrid(uint32_t gridWidth, float narrowBandDistance) const
+    {
+        const uint32_t gridWidthInValues = gridWidth + 1;
+        const uint32_t gridWidthInBricks = div_round_up(gridWidthInValues, kBrickWidth);
+        std::vector<float> values((size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+        auto range = NumericRange<uint32_t>(0, gridWidthInBricks * gridWidthInBricks * gridWidthInBricks);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickIndex)
+        {
+            const uint3 brickCoords = uint3(brickIndex % gridWidthInBricks, (brickIndex / gridWidthInBricks) % gridWidthInBricks, brickIndex / (gridWidthInBricks * gridWidthInBricks));
+            const uint3 first = brickCoords * kBrickWidth;
+            const uint3 last = glm::min(first + kBrickWidth, uint3(gridWidthInValues)) - 1u;
+
+            const uint3 valueCount = last - first + 1u;
+            auto forEachValue = [&](auto func)
+            {
+                size_t i = 0;
+                for (uint32_t z = first.z; z <= last.z; z++)
+                {
+                    for (uint32_t y = first.y; y <= last.y; y++)
+                    {
+                        for (uint32_t x = first.x; x <= last.x; x++) func(x + gridWidthInValues * (y + (size_t)gridWidthInValues * z), i++);
+                    }
+                }
+            };
+
+            // Fill bricks that are conservatively outside the narrow band with a bound of the distance instead of evaluating every value.
+            if (narrowBandDistance < kMaxDistance)
+            {
+                const float3 pMin = -0.5f + float3(first) / float(gridWidth);
+                const float3 pMax = -0.5f + float3(last) / float(gridWidth);
+                const float2 bounds = evalInterval(0.5f * (pMin + pMax), 0.5f * (pMax - pMin));
+                if (bounds.x > narrowBandDistance || bounds.y < -narrowBandDistance)
+                {
+                    const float fillValue = bounds.x > narrowBandDistance ? bounds.x : bounds.y;
+                    forEachValue([&](size_t index, size_t) { values[index] = fillValue; });
+                    return;
+                }
+            }
+
+            float distances[kBrickValueCount];
+            evalBox(gridWidth, first, valueCount, distances);
+            forEachValue([&](size_t index, size_t i) { values[index] = distances[i]; });
+        });
+
+        return values;
+    }
+
+    void SDFPrimitiveEvaluator::evalBox(uint32_t gridWidth, const uint3& firstValueCoords, const uint3& valueCount, float* pValues) const
+    {
+        const uint32_t totalCount = valueCount.x * valueCount.y * valueCount.z;
+
+        float pX[kBrickValueCount];
+        float pY[kBrickValueCount];
+        float pZ[kBrickValueCount];
+
+        // Evaluate the values in batches of at most kBrickValueCount points.
+        for (uint32_t batchStart = 0; batchStart < totalCount; batchStart += kBrickValueCount)
+        {
+            const uint32_t batchCount = std::min(kBrickValueCount, totalCount - batchStart);
+            for (uint32_t i = 0; i < batchCount; i++)
+            {
+                const uint32_t index = batchStart + i;
+                const uint3 coords = firstValueCoords + uint3(index % valueCount.x, (index / valueCount.x) % valueCount.y, index / (valueCount.x * valueCount.y));
+
+                // Values are located at voxel corners in grid space, matching the GPU evaluation of primitives.
+                pX[i] = -0.5f + float(coords.x) / float(gridWidth);
+                pY[i] = -0.5f + float(coords.y) / float(gridWidth);
+                pZ[i] = -0.5f + float(coords.z) / float(gridWidth);
+            }
+
+            evalPoints(pX, pY, pZ, batchCount, pValues + batchStart);
+        }
+    }
+
+    void SDFPrimitiveEvaluator::evalPoints(const float* pX, const float* pY, const float* pZ, uint32_t count, float* pDistances) const
+    {
+        FALCOR_ASSERT(count <= kBrickValueCount);
+
+        float localX[kBrickValueCount];
+        float localY[kBrickValueCount];
+        float localZ[kBrickValueCount];
+        float shapeDistances[kBrickValueCount];
+
+        for (uint32_t i = 0; i < count; i++) pDistances[i] = kMaxDistance;
+
+        for (const auto& primitive : mPrimitives)
+        {
+            // Transform the points into the local space of the primitive.
+            // The shader computes mul(invRotationScale, p), where the matrix is the transpose of the host matrix
+            // as matrices are uploaded as-is into row-major shader matrices. This corresponds to p * invRotationScale on the host.
+            const float3x3& m = primitive.invRotationScale;
+            const float3& t = primitive.translation;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const float x = pX[i] - t.x;
+                const float y = pY[i] - t.y;
+                const float z = pZ[i] - t.z;
+                localX[i] = m[0][0] * x + m[0][1] * y + m[0][2] * z;
+                localY[i] = m[1][0] * x + m[1][1] * y + m[1][2] * z;
+                localZ[i] = m[2][0] * x + m[2][1] * y + m[2][2] * z;
+            }
+
+            const float3 s = primitive.shapeData;
+            const float blobbing = primitive.shapeBlobbing;
+            switch (primitive.shapeType)
+            {
+            case SDF3DShapeType::Sphere:    evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfSphere(x, y, z, s.x); }); break;
+            case SDF3DShapeType::Ellipsoid: evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfEllipsoid(x, y, z, s); }); break;
+            case SDF3DShapeType::Box:       evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfBox(x, y, z, s); }); break;
+            case SDF3DShapeType::Torus:     evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfTorus(x, y, z, s.x); }); break;
+            case SDF3DShapeType::Cone:      evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfCone(x, y, z, s.x, s.y); }); break;
+            case SDF3DShapeType::Capsule:   evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float x, float y, float z) { return sdfCapsule(x, y, z, s.x); }); break;
+            default:                        evalShapeBatch(count, localX, localY, localZ, blobbing, shapeDistances, [&](float, float, float) { return kMaxDistance; }); break;
+            }
+
+            const float k = primitive.operationSmoothing;
+            switch (primitive.operationType)
+            {
+            case SDFOperationType::Union:               evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return std::min(a, b); }); break;
+            case SDFOperationType::Subtraction:         evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return std::max(a, -b); }); break;
+            case SDFOperationType::Intersection:        evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return std::max(a, b); }); break;
+            case SDFOperationType::SmoothUnion:         evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return smin(a, b, k); }); break;
+            case SDFOperationType::SmoothSubtraction:   evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return smax(a, -b, k); }); break;
+            case SDFOperationType::SmoothIntersection:  evalOperationBatch(count, shapeDistances, pDistances, [&](float a, float b) { return smax(a, b, k); }); break;
+            default: break;
+            }
+        }
+    }
+}
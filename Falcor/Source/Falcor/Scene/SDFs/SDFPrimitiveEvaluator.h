@@ -0,0 +1,82 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Scene/SDFs/SDF3DPrimitive.slang"
+
+namespace Falcor
+{
+    /** Evaluates lists of SDF primitives on the CPU.
+        Evaluation mirrors SDF3DPrimitive::eval() in SDF3DPrimitive.slang, so grids evaluated on the CPU match grids evaluated on the GPU.
+        This allows SDF grids to be baked from primitives without a GPU.
+    */
+    class FALCOR_API SDFPrimitiveEvaluator
+    {
+    public:
+        /** Constructor.
+            \param[in] primitives The SDF primitives, applied in order starting from an empty SDF.
+        */
+        SDFPrimitiveEvaluator(const std::vector<SDF3DPrimitive>& primitives);
+
+        /** Evaluate the signed distance at a point.
+            \param[in] p Position in grid space, i.e., in [-0.5, 0.5]^3.
+            \return The signed distance.
+        */
+        float eval(const float3& p) const;
+
+        /** Evaluate conservative bounds of the signed distance over an axis-aligned box using interval arithmetic.
+            \param[in] pCenter Center of the box in grid space.
+            \param[in] pHalfExtent Half extent of the box in grid space.
+            \return Interval (min, max) containing all signed distances in the box.
+        */
+        float2 evalInterval(const float3& pCenter, const float3& pHalfExtent) const;
+
+        /** Evaluate the signed distances at the corners of all voxels in a grid.
+            Bricks of values are evaluated in parallel. Bricks that are conservatively known to lie farther than
+            narrowBandDistance from the surface are not evaluated per value, but are filled with a bound of the signed
+            distance over the brick. That bound has the correct sign and a magnitude of at least narrowBandDistance,
+            so the result is exact for consumers that clamp distances to the narrow band.
+            \param[in] gridWidth The grid width in voxels. The result has (gridWidth + 1)^3 values.
+            \param[in] narrowBandDistance Distance in grid space beyond which values may be approximated. The default evaluates all values exactly.
+            \return The corner values, stored with x changing fastest.
+        */
+        std::vector<float> evalGrid(uint32_t gridWidth, float narrowBandDistance = std::numeric_limits<float>::max()) const;
+
+        /** Evaluate the signed distances at the corners of the voxels in a box of a grid.
+            \param[in] gridWidth The grid width in voxels.
+            \param[in] firstValueCoords Coords of the first value of the box in the grid.
+            \param[in] valueCount Number of values of the box along each axis.
+            \param[out] pValues The values, stored with x changing fastest. Must have room for valueCount.x * valueCount.y * valueCount.z values.
+        */
+        void evalBox(uint32_t gridWidth, const uint3& firstValueCoords, const uint3& valueCount, float* pValues) const;
+
+    private:
+        void evalPoints(const float* pX, const float* pY, const float* pZ, uint32_t count, float* pDistances) const;
+
+        std::vector<SDF3DPrimitive> mPrimitives;
+    };
+}
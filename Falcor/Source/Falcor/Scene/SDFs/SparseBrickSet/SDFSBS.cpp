@@ -29,6 +29,8 @@
 #include "SDFSBS.h"
 #include "Scene/SDFs/SDFVoxelTypes.slang"
 #include "Utils/Math/MathHelpers.h"
+#include "Utils/NumericRange.h"
+#include <execution>
 
 namespace Falcor
 {
@@ -45,6 +47,181 @@ namespace Falcor
         const std::string kCompactifyChunksShaderName = "Scene/SDFs/SparseBrickSet/SDFSBSCompactifyChunks.cs.slang";
         const std::string kPruneEmptyBricksShaderName = "Scene/SDFs/SparseBrickSet/SDFSBSPruneEmptyBricks.cs.slang";
         const std::string kCreateBricksFromChunksShaderName = "Scene/SDFs/SparseBrickSet/SDFSBSCreateBricksFromChunks.cs.slang";
+
+        const uint32_t kInvalidBrickID = std::numeric_limits<uint32_t>::max();
+        const uint32_t kCompressionWidth = 4;
+
+        int8_t quantizeNormalizedValue(float normalizedValue)
+        {
+            float integerScale = glm::clamp(normalizedValue, -1.0f, 1.0f) * float(INT8_MAX);
+            return integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+        }
+
+        uint3 getVirtualBrickCoords(uint32_t virtualBrickID, uint32_t virtualBricksPerAxis)
+        {
+            return uint3(virtualBrickID % virtualBricksPerAxis, (virtualBrickID / virtualBricksPerAxis) % virtualBricksPerAxis, virtualBrickID / (virtualBricksPerAxis * virtualBricksPerAxis));
+        }
+
+        /** Returns true if any voxel in a box of quantized values contains the surface, mirroring SDFVoxelCommon::containsSurface().
+        */
+        bool containsSurface(const std::vector<int8_t>& values, const uint3& valueCount)
+        {
+            auto getValue = [&](uint32_t x, uint32_t y, uint32_t z) { return values[x + valueCount.x * (y + valueCount.y * z)]; };
+
+            for (uint32_t z = 0; z + 1 < valueCount.z; z++)
+            {
+                for (uint32_t y = 0; y + 1 < valueCount.y; y++)
+                {
+                    for (uint32_t x = 0; x + 1 < valueCount.x; x++)
+                    {
+                        bool hasInside = false;
+                        bool hasOutside = false;
+                        for (uint32_t c = 0; c < 8; c++)
+                        {
+                            int8_t value = getValue(x + (c & 1), y + ((c >> 1) & 1), z + (c >> 2));
+                            hasInside |= value <= 0;
+                            hasOutside |= value >= 0;
+                        }
+                        if (hasInside && hasOutside) return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        // BC4 compression of 4x4 blocks of snorm8 values, mirroring BC4Encode.slang.
+
+        void fixRange(int& minValue, int& maxValue, int steps)
+        {
+            if (maxValue - minValue < steps)
+            {
+                maxValue = std::min(minValue + steps, 127);
+                minValue = maxValue - minValue < steps ? std::max(-128, maxValue - steps) : minValue;
+            }
+        }
+
+        int fitCodes(const int8_t block[16], const int codes[8], uint32_t indices[16])
+        {
+            // Fit each alpha value to the codebook.
+            int err = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                // Find the least error and corresponding index.
+                int least = std::numeric_limits<int>::max();
+                uint32_t index = 0;
+                for (uint32_t j = 0; j < 8; ++j)
+                {
+                    int dist = int(block[i]) - codes[j];
+                    dist *= dist;
+                    if (dist < least)
+                    {
+                        least = dist;
+                        index = j;
+                    }
+                }
+
+                indices[i] = index;
+                err += least;
+            }
+
+            return err;
+        }
+
+        uint64_t writeAlphaBlock(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            uint64_t compressedBlock = 0;
+            compressedBlock |= uint64_t(alpha0 & 0xff);
+            compressedBlock |= uint64_t(alpha1 & 0xff) << 8;
+
+            // Pack the indices with 3 bits each.
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                compressedBlock |= uint64_t(indices[i] & 0x7) << (3 * (i % 8) + 24 * (i / 8) + 16);
+            }
+
+            return compressedBlock;
+        }
+
+        uint64_t writeAlphaBlock5(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 <= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swappedIndices[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0)         swappedIndices[i] = 1;
+                else if (index == 1)    swappedIndices[i] = 0;
+                else if (index <= 5)    swappedIndices[i] = 7 - index;
+                else                    swappedIndices[i] = index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swappedIndices);
+        }
+
+        uint64_t writeAlphaBlock7(int alpha0, int alpha1, const uint32_t indices[16])
+        {
+            if (alpha0 >= alpha1) return writeAlphaBlock(alpha0, alpha1, indices);
+
+            // Swap the endpoints and remap the indices.
+            uint32_t swappedIndices[16];
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                uint32_t index = indices[i];
+                if (index == 0)         swappedIndices[i] = 1;
+                else if (index == 1)    swappedIndices[i] = 0;
+                else                    swappedIndices[i] = 9 - index;
+            }
+            return writeAlphaBlock(alpha1, alpha0, swappedIndices);
+        }
+
+        /** Compresses a 4x4 block of snorm8 values, stored row by row.
+        */
+        uint64_t compressBC4Block(const int8_t block[16])
+        {
+            // Get the range for 5-alpha and 7-alpha interpolation.
+            int min5 = 127;
+            int max5 = -128;
+            int min7 = 127;
+            int max7 = -128;
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                int value = block[i];
+                min7 = std::min(min7, value);
+                max7 = std::max(max7, value);
+                if (value != -128 && value < min5) min5 = value;
+                if (value != 127 && value > max5) max5 = value;
+            }
+
+            min5 = std::min(min5, max5);
+            min7 = std::min(min7, max7);
+
+            // Fix the range to be the minimum in each case.
+            fixRange(min5, max5, 5);
+            fixRange(min7, max7, 7);
+
+            // Set up the 5-alpha and 7-alpha code books.
+            int codes5[8];
+            codes5[0] = min5;
+            codes5[1] = max5;
+            for (int i = 1; i < 5; ++i) codes5[1 + i] = ((5 - i) * min5 + i * max5) / 5;
+            codes5[6] = -128;
+            codes5[7] = 127;
+
+            int codes7[8];
+            codes7[0] = min7;
+            codes7[1] = max7;
+            for (int i = 1; i < 7; ++i) codes7[1 + i] = ((7 - i) * min7 + i * max7) / 7;
+
+            // Fit the data to both code books and return the block with least error.
+            uint32_t indices5[16];
+            uint32_t indices7[16];
+            int err5 = fitCodes(block, codes5, indices5);
+            int err7 = fitCodes(block, codes7, indices7);
+            return err5 <= err7 ? writeAlphaBlock5(min5, max5, indices5) : writeAlphaBlock7(min7, max7, indices7);
+        }
     }
 
     SDFSBS::SharedPtr SDFSBS::create(uint32_t brickWidth, bool compressed)
@@ -90,9 +267,13 @@ namespace Falcor
         {
             createResourcesFromValues(pRenderContext, deleteScratchData);
         }
+        else if (isBuiltOnCPU())
+        {
+            createResourcesFromBricks();
+        }
         else
         {
-            throw RuntimeError("SDFSBS::setValues() or SDFSBS::setPrimitives() must be called prior to calling SDFSBS::construct()");
+            throw RuntimeError("SDFSBS::setValues(), SDFSBS::setPrimitives() or SDFSBS::setValuesFromBricks() must be called prior to calling SDFSBS::construct()");
         }
 
         allocatePrimitiveBits();
@@ -628,6 +809,173 @@ namespace Falcor
         }
     }
 
+    void SDFSBS::setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues)
+    {
+        const float normalizationMultipler = 2.0f * mGridWidth / glm::root_three<float>();
+
+        buildBricks(mGridWidth, [&](const uint3& firstValueCoords, const uint3& valueCount, int8_t* pValues)
+        {
+            std::vector<float> values(valueCount.x * valueCount.y * valueCount.z);
+            getBrickValues(firstValueCoords, valueCount, values.data());
+
+            for (size_t i = 0; i < values.size(); i++) pValues[i] = quantizeNormalizedValue(values[i] * normalizationMultipler);
+        });
+    }
+
+    void SDFSBS::buildOnCPU()
+    {
+        if (!mValues.empty())
+        {
+            // Stream bricks from the quantized values, which already have the format used in bricks.
+            std::vector<int8_t> values = std::move(mValues);
+            const uint32_t gridWidthInValues = mOriginalGridWidth + 1;
+
+            buildBricks(mOriginalGridWidth, [&](const uint3& firstValueCoords, const uint3& valueCount, int8_t* pValues)
+            {
+                for (uint32_t z = 0; z < valueCount.z; z++)
+                {
+                    for (uint32_t y = 0; y < valueCount.y; y++)
+                    {
+                        const int8_t* pSrc = values.data() + firstValueCoords.x + gridWidthInValues * (firstValueCoords.y + y + (size_t)gridWidthInValues * (firstValueCoords.z + z));
+                        std::memcpy(pValues + valueCount.x * (y + valueCount.y * z), pSrc, valueCount.x);
+                    }
+                }
+            });
+        }
+        else if (!mPrimitives.empty())
+        {
+            std::vector<SDF3DPrimitive> primitives = std::move(mPrimitives);
+            bakePrimitives(primitives, mOriginalGridWidth);
+        }
+        else if (!mBuiltOnCPU)
+        {
+            throw RuntimeError("SDFSBS::setValues() or SDFSBS::setPrimitives() must be called prior to calling SDFSBS::buildOnCPU()");
+        }
+    }
+
+    void SDFSBS::buildBricks(uint32_t gridWidth, const QuantizedBrickValuesFunc& getBrickValues)
+    {
+        checkArgument(isPowerOf2(gridWidth), "'gridWidth' ({}) must be a power of 2.", gridWidth);
+
+        mOriginalGridWidth = gridWidth;
+        mGridWidth = gridWidth;
+        mValues.clear();
+        mPrimitives.clear();
+
+        const uint32_t brickWidthInValues = mBrickWidth + 1;
+        const uint32_t gridWidthInValues = mGridWidth + 1;
+        mVirtualBricksPerAxis = div_round_up(mGridWidth, mBrickWidth);
+        const uint32_t virtualBrickCount = mVirtualBricksPerAxis * mVirtualBricksPerAxis * mVirtualBricksPerAxis;
+
+        // Evaluate all virtual bricks in parallel, only keeping the values of bricks that contain the surface.
+        std::vector<std::vector<int8_t>> brickValues(virtualBrickCount);
+        auto range = NumericRange<uint32_t>(0, virtualBrickCount);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t virtualBrickID)
+        {
+            const uint3 firstValueCoords = getVirtualBrickCoords(virtualBrickID, mVirtualBricksPerAxis) * mBrickWidth;
+            const uint3 valueCount = glm::min(uint3(brickWidthInValues), uint3(gridWidthInValues) - firstValueCoords);
+
+            std::vector<int8_t> values(valueCount.x * valueCount.y * valueCount.z);
+            getBrickValues(firstValueCoords, valueCount, values.data());
+            if (containsSurface(values, valueCount)) brickValues[virtualBrickID] = std::move(values);
+        });
+
+        // Assign brick IDs in virtual brick order, which is the same order as the prefix sum used when building on the GPU.
+        mIndirection.assign(virtualBrickCount, kInvalidBrickID);
+        mBrickCount = 0;
+        for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; virtualBrickID++)
+        {
+            if (!brickValues[virtualBrickID].empty()) mIndirection[virtualBrickID] = mBrickCount++;
+        }
+
+        // Lay out the bricks in the brick texture the same way as createResourcesFromValues().
+        const uint32_t bricksAlongX = (uint32_t)std::ceilf(std::sqrtf((float)mBrickCount / brickWidthInValues));
+        const uint32_t bricksAlongY = bricksAlongX > 0 ? (uint32_t)std::ceilf((float)mBrickCount / bricksAlongX) : 0;
+        mBricksPerAxis = uint2(bricksAlongX, bricksAlongY);
+        mBrickTextureDimensions = uint2(brickWidthInValues * brickWidthInValues * bricksAlongX, brickWidthInValues * bricksAlongY);
+
+        const uint32_t blocksPerRow = mBrickTextureDimensions.x / kCompressionWidth;
+        mBrickAABBs.resize(mBrickCount);
+        mBrickData.assign(mCompressed ? (size_t)blocksPerRow * (mBrickTextureDimensions.y / kCompressionWidth) * sizeof(uint64_t) : (size_t)mBrickTextureDimensions.x * mBrickTextureDimensions.y, 0);
+
+        // Write the bricks and their AABBs in parallel. Each brick covers a separate region of the brick texture.
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t virtualBrickID)
+        {
+            const uint32_t brickID = mIndirection[virtualBrickID];
+            if (brickID == kInvalidBrickID) return;
+
+            const std::vector<int8_t>& values = brickValues[virtualBrickID];
+            const uint3 virtualBrickCoords = getVirtualBrickCoords(virtualBrickID, mVirtualBricksPerAxis);
+            const uint3 valueCount = glm::min(uint3(brickWidthInValues), uint3(gridWidthInValues) - virtualBrickCoords * mBrickWidth);
+
+            const float3 brickAABBMin = -0.5f + float3(virtualBrickCoords * mBrickWidth) / float(mGridWidth);
+            const float3 brickAABBMax = glm::min(brickAABBMin + float(mBrickWidth) / float(mGridWidth), float3(0.5f));
+            mBrickAABBs[brickID] = AABB(brickAABBMin, brickAABBMax);
+
+            // Values outside of the grid are set to the largest distance.
+            auto getValue = [&](uint32_t x, uint32_t y, uint32_t z)
+            {
+                return x < valueCount.x && y < valueCount.y && z < valueCount.z ? values[x + valueCount.x * (y + valueCount.y * z)] : int8_t(INT8_MAX);
+            };
+
+            // Calculate the min corner of the brick in the brick texture.
+            const uint2 brickTextureCoords = uint2(brickID % mBricksPerAxis.x, brickID / mBricksPerAxis.x) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+
+            for (uint32_t z = 0; z < brickWidthInValues; z++)
+            {
+                if (mCompressed)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y += kCompressionWidth)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x += kCompressionWidth)
+                        {
+                            int8_t block[kCompressionWidth * kCompressionWidth];
+                            for (uint32_t bY = 0; bY < kCompressionWidth; bY++)
+                            {
+                                for (uint32_t bX = 0; bX < kCompressionWidth; bX++) block[bX + kCompressionWidth * bY] = getValue(x + bX, y + bY, z);
+                            }
+
+                            const uint2 blockCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / kCompressionWidth;
+                            const uint64_t compressedBlock = compressBC4Block(block);
+                            std::memcpy(mBrickData.data() + (blockCoords.x + (size_t)blocksPerRow * blockCoords.y) * sizeof(uint64_t), &compressedBlock, sizeof(uint64_t));
+                        }
+                    }
+                }
+                else
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y++)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x++)
+                        {
+                            const uint2 texelCoords = brickTextureCoords + uint2(x + z * brickWidthInValues, y);
+                            mBrickData[texelCoords.x + (size_t)mBrickTextureDimensions.x * texelCoords.y] = uint8_t(getValue(x, y, z));
+                        }
+                    }
+                }
+            }
+        });
+
+        mBuiltOnCPU = true;
+    }
+
+    void SDFSBS::createResourcesFromBricks()
+    {
+        const ResourceFormat brickFormat = mCompressed ? ResourceFormat::BC4Snorm : ResourceFormat::R8Snorm;
+        mpIndirectionTexture = Texture::create3D(mVirtualBricksPerAxis, mVirtualBricksPerAxis, mVirtualBricksPerAxis, ResourceFormat::R32Uint, 1, mIndirection.data(), ResourceBindFlags::ShaderResource);
+
+        if (mBrickCount == 0)
+        {
+            // The grid contains no surface, so no AABBs are traced and all indirection entries are invalid.
+            // Allocate a single AABB and an empty brick texture so that the brick set can still be bound.
+            mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), 1, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, nullptr, false);
+            mpBrickTexture = Texture::create2D(kCompressionWidth, kCompressionWidth, brickFormat, 1, 1, nullptr, ResourceBindFlags::ShaderResource);
+            return;
+        }
+
+        mpBrickAABBsBuffer = Buffer::createStructured(sizeof(AABB), mBrickCount, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, mBrickAABBs.data(), false);
+        mpBrickTexture = Texture::create2D(mBrickTextureDimensions.x, mBrickTextureDimensions.y, brickFormat, 1, 1, mBrickData.data(), ResourceBindFlags::ShaderResource);
+    }
+
     void SDFSBS::allocatePrimitiveBits()
     {
         // Calculate bits required to encode brick coords and brick local voxel coords.
@@ -637,6 +985,12 @@ namespace Falcor
 
     void SDFSBS::setValuesInternal(const std::vector<float>& cornerValues)
     {
+        // Bricks previously built on the CPU are replaced by the new values.
+        mBrickAABBs.clear();
+        mIndirection.clear();
+        mBrickData.clear();
+        mBuiltOnCPU = false;
+
         uint32_t gridWidthInValues = mGridWidth + 1;
         uint32_t valueCount = gridWidthInValues * gridWidthInValues * gridWidthInValues;
         mValues.resize(valueCount);
@@ -644,10 +998,7 @@ namespace Falcor
         float normalizationMultipler = 2.0f * mGridWidth / glm::root_three<float>();
         for (uint32_t v = 0; v < valueCount; v++)
         {
-            float normalizedValue = glm::clamp(cornerValues[v] * normalizationMultipler, -1.0f, 1.0f);
-
-            float integerScale = normalizedValue * float(INT8_MAX);
-            mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
+            mValues[v] = quantizeNormalizedValue(cornerValues[v] * normalizationMultipler);
         }
     }
 
@@ -29,10 +29,13 @@
 
 #include "Scene/SDFs/SDFGrid.h"
 #include "Utils/Algorithm/PrefixSum.h"
+#include "Utils/Math/AABB.h"
 
 namespace Falcor
 {
     /** A single SDF Sparse Brick Set. Can only be utilized on the GPU.
+        The brick set can either be built on the GPU from values or primitives when calling createResources(),
+        or built on the CPU beforehand using setValuesFromBricks(), bakePrimitives() or buildOnCPU(), in which case createResources() only uploads the bricks. Only brick sets built on the CPU can be serialized.
     */
     class FALCOR_API SDFSBS : public SDFGrid
     {
@@ -46,10 +49,21 @@ namespace Falcor
         */
         static SharedPtr create(uint32_t brickWidth = 7, bool compressed = false);
 
+        /** Build the sparse brick set on the CPU from the values or primitives that are currently set, unless it has already been built on the CPU.
+        */
+        void buildOnCPU();
+
+        /** Returns true if the sparse brick set has been built on the CPU.
+        */
+        bool isBuiltOnCPU() const { return mBuiltOnCPU && mValues.empty() && mPrimitives.empty(); }
+
         uint32_t getVirtualBrickCoordsBitCount() const { return mVirtualBrickCoordsBitCount; }
         uint32_t getBrickLocalVoxelCoordsBrickCount() const { return mBrickLocalVoxelCoordsBitCount; }
         bool isCompressed() const { return mCompressed; }
 
+        const Texture::SharedPtr& getIndirectionTexture() const { return mpIndirectionTexture; }
+        const Texture::SharedPtr& getBrickTexture() const { return mpBrickTexture; }
+
         virtual size_t getSize() const override;
         virtual uint32_t getMaxPrimitiveIDBits() const override;
         virtual Type getType() const override { return Type::SparseBrickSet; }
@@ -64,17 +78,33 @@ namespace Falcor
     protected:
         void createResourcesFromPrimitives(RenderContext* pRenderContext, bool deleteScratchData);
         void createResourcesFromValues(RenderContext* pRenderContext, bool deleteScratchData);
+        void createResourcesFromBricks();
 
         void allocatePrimitiveBits();
 
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
 
+        /** Builds the sparse brick set on the CPU, one brick at a time, without creating a dense grid of values.
+            Bricks are evaluated in parallel and only bricks that contain the surface are kept.
+            The built bricks have the same layout as bricks built on the GPU and are uploaded by createResources().
+        */
+        virtual void setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues) override;
+
     private:
         SDFSBS(uint32_t brickWidth, bool compressed);
 
+        using QuantizedBrickValuesFunc = std::function<void(const uint3& firstValueCoords, const uint3& valueCount, int8_t* pValues)>;
+        void buildBricks(uint32_t gridWidth, const QuantizedBrickValuesFunc& getBrickValues);
+
         // CPU data.
         std::vector<int8_t> mValues;
 
+        // CPU data of a brick set built on the CPU.
+        std::vector<AABB> mBrickAABBs;                  ///< AABBs for each brick.
+        std::vector<uint32_t> mIndirection;             ///< Maps virtual brick IDs to brick IDs, contains UINT32_MAX for virtual bricks without surface.
+        std::vector<uint8_t> mBrickData;                ///< Brick texture data, either R8Snorm texels or BC4 blocks.
+        bool mBuiltOnCPU = false;                       ///< True if the above data has been built, it may still contain no bricks if the grid has no surface.
+
         // Specs.
         uint32_t mVirtualBricksPerAxis = 0;
         uint32_t mVoxelCount = 0;
@@ -122,5 +152,7 @@ namespace Falcor
         Buffer::SharedPtr mpSubChunkValidityBuffer;
         Buffer::SharedPtr mpSubChunkCoordsBuffer;
         Buffer::SharedPtr mpSubdivisionArgBuffer;
+
+        friend class SceneCache;
     };
 }
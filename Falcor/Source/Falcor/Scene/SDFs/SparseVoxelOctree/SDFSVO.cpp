@@ -403,4 +403,10 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVO::setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues)
+    {
+        mLevelCount = bitScanReverse(mGridWidth) + 1;
+        mValues = quantizeValuesFromBricks(getBrickValues);
+    }
 }
@@ -61,6 +61,7 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues) override;
 
     private:
         SDFSVO() = default;
@@ -186,4 +186,9 @@ namespace Falcor
             mValues[v] = integerScale >= 0.0f ? int8_t(integerScale + 0.5f) : int8_t(integerScale - 0.5f);
         }
     }
+
+    void SDFSVS::setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues)
+    {
+        mValues = quantizeValuesFromBricks(getBrickValues);
+    }
 }
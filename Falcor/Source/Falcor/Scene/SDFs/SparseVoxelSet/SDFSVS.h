@@ -58,6 +58,7 @@ namespace Falcor
 
     protected:
         virtual void setValuesInternal(const std::vector<float>& cornerValues) override;
+        virtual void setValuesFromBricksInternal(const BrickValuesFunc& getBrickValues) override;
 
     private:
         SDFSVS() = default;
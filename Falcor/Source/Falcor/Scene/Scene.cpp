@@ -74,6 +74,7 @@ namespace Falcor
         const std::string kUpdateCallback = "updateCallback";
         const std::string kEnvMap = "envMap";
         const std::string kMaterials = "materials";
+        const std::string kTextureMemoryBudget = "textureMemoryBudget";
         const std::string kGridVolumes = "gridVolumes";
         const std::string kGetLight = "getLight";
         const std::string kGetMaterial = "getMaterial";
@@ -154,6 +155,9 @@ namespace Falcor
         // Set default SDF grid config.
         setSDFGridConfig();
 
+        // Keep a CPU copy of the emissive geometry for preprocessing mesh lights.
+        retainEmissiveMeshGeometry(sceneData);
+
         // Create vertex array objects for meshes and curves.
         createMeshVao(sceneData.meshDrawCount, sceneData.meshIndexData, sceneData.meshStaticData, sceneData.meshDynamicData);
         createCurveVao(mCurveIndexData, mCurveStaticData);
@@ -164,6 +168,9 @@ namespace Falcor
         // Must be placed after curve data/AABB creation.
         mpAnimationController->addAnimatedVertexCaches(std::move(sceneData.cachedCurves), std::move(sceneData.cachedMeshes));
 
+        // Create uploader for batching per-frame updates of the light and volume buffers.
+        mpBufferUploader = StagedBufferUploader::create();
+
         // Finalize scene.
         finalize();
     }
@@ -320,6 +327,59 @@ namespace Falcor
         pContext->raytrace(pProgram, pVars.get(), dispatchDims.x, dispatchDims.y, dispatchDims.z);
     }
 
+    const Scene::EmissiveMeshGeometry* Scene::getEmissiveMeshGeometry(uint32_t meshID) const
+    {
+        auto it = mEmissiveMeshGeometry.find(meshID);
+        return it != mEmissiveMeshGeometry.end() ? &it->second : nullptr;
+    }
+
+    void Scene::retainEmissiveMeshGeometry(const SceneData& sceneData)
+    {
+        // Meshes with vertex animations are updated on the GPU. Their static vertex data is not representative.
+        std::unordered_set<uint32_t> animatedMeshIDs;
+        for (const auto& cachedMesh : sceneData.cachedMeshes) animatedMeshIDs.insert(cachedMesh.meshID);
+
+        for (const auto& instance : mGeometryInstanceData)
+        {
+            if (instance.getType() != GeometryType::TriangleMesh) continue;
+
+            auto pMaterial = getMaterial(instance.materialID)->toBasicMaterial();
+            if (!pMaterial || !pMaterial->isEmissive()) continue;
+
+            const uint32_t meshID = instance.geometryID;
+            const MeshDesc& mesh = mMeshDesc[meshID];
+            if (mesh.hasDynamicData() || animatedMeshIDs.count(meshID) > 0 || mEmissiveMeshGeometry.count(meshID) > 0) continue;
+
+            EmissiveMeshGeometry geometry;
+            geometry.positions.resize(mesh.vertexCount);
+            geometry.texCrds.resize(mesh.vertexCount);
+            for (uint32_t i = 0; i < mesh.vertexCount; i++)
+            {
+                const auto& v = sceneData.meshStaticData[mesh.vbOffset + i];
+                geometry.positions[i] = v.position;
+                geometry.texCrds[i] = v.texCrd;
+            }
+
+            geometry.indices.resize(mesh.getTriangleCount() * 3);
+            if (mesh.indexCount == 0)
+            {
+                std::iota(geometry.indices.begin(), geometry.indices.end(), 0u);
+            }
+            else if (mesh.use16BitIndices())
+            {
+                const uint16_t* pIndices = reinterpret_cast<const uint16_t*>(sceneData.meshIndexData.data() + mesh.ibOffset);
+                std::copy(pIndices, pIndices + geometry.indices.size(), geometry.indices.begin());
+            }
+            else
+            {
+                const uint32_t* pIndices = sceneData.meshIndexData.data() + mesh.ibOffset;
+                std::copy(pIndices, pIndices + geometry.indices.size(), geometry.indices.begin());
+            }
+
+            mEmissiveMeshGeometry.emplace(meshID, std::move(geometry));
+        }
+    }
+
     void Scene::createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<DynamicVertexData>& dynamicData)
     {
         if (drawCount == 0) return;
@@ -694,6 +754,35 @@ namespace Falcor
         }
     }
 
+    void Scene::markUsedMaterials()
+    {
+        const auto& globalMatrices = mpAnimationController->getGlobalMatrices();
+        const Camera* pCamera = mCameras.empty() ? nullptr : getCamera().get();
+
+        for (const auto& inst : mGeometryInstanceData)
+        {
+            bool used = true;
+            if (pCamera)
+            {
+                const glm::mat4& transform = globalMatrices[inst.globalMatrixID];
+                switch (inst.getType())
+                {
+                case GeometryType::TriangleMesh:
+                case GeometryType::DisplacedTriangleMesh:
+                    used = !pCamera->isObjectCulled(mMeshBBs[inst.geometryID].transform(transform));
+                    break;
+                case GeometryType::Curve:
+                    used = !pCamera->isObjectCulled(mCurveBBs[inst.geometryID].transform(transform));
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (used || mpMaterials->getMaterial(inst.materialID)->isEmissive()) mpMaterials->markMaterialUsed(inst.materialID);
+        }
+    }
+
     void Scene::updateGeometryInstances(bool forceUpdate)
     {
         if (mGeometryInstanceData.empty()) return;
@@ -1002,6 +1091,7 @@ namespace Falcor
         updateGridVolumes(true);
         updateEnvMap(true);
         updateMaterials(true);
+        mpBufferUploader->flush(gpDevice->getRenderContext());
         uploadResources(); // Upload data after initialization is complete
 
         updateGeometryStats();
@@ -1341,8 +1431,7 @@ namespace Falcor
             auto changes = light->getChanges();
             if (changes != Light::Changes::None || is_set(combinedChanges, Light::Changes::Active) || forceUpdate)
             {
-                // TODO: This is slow since the buffer is not CPU writable. Copy into CPU buffer and upload once instead.
-                mpLightsBuffer->setElement(activeLightIndex, light->getData());
+                mpBufferUploader->setElement(mpLightsBuffer, activeLightIndex, light->getData());
             }
 
             activeLightIndex++;
@@ -1380,8 +1469,8 @@ namespace Falcor
         // Early out if no volumes have changed.
         if (!forceUpdate && combinedUpdates == GridVolume::UpdateFlags::None) return UpdateFlags::None;
 
-        // Upload grids.
-        if (forceUpdate)
+        // Upload grids. Grid resources change when the grids of a streamed sequence are made resident or evicted.
+        if (forceUpdate || is_set(combinedUpdates, GridVolume::UpdateFlags::GridsChanged))
         {
             auto var = mpSceneBlock["grids"];
             for (size_t i = 0; i < mGrids.size(); ++i)
@@ -1407,7 +1496,7 @@ namespace Falcor
                     data.transform = data.transform * densityGrid->getTransform();
                     data.invTransform = densityGrid->getInvTransform() * data.invTransform;
                 }
-                mpGridVolumesBuffer->setElement(volumeIndex, data);
+                mpBufferUploader->setElement(mpGridVolumesBuffer, volumeIndex, data);
             }
             pGridVolume->clearUpdates();
             volumeIndex++;
@@ -1450,7 +1539,8 @@ namespace Falcor
 
     Scene::UpdateFlags Scene::updateMaterials(bool forceUpdate)
     {
-        // Update material system.
+        // Update material system. Texture residency is based on the materials used in this frame if a texture memory budget is set.
+        if (mpMaterials->getTextureManager()->getResidencyOptions().budget > 0) markUsedMaterials();
         Material::UpdateFlags materialUpdates = mpMaterials->update(forceUpdate);
 
         UpdateFlags flags = UpdateFlags::None;
@@ -1526,6 +1616,7 @@ namespace Falcor
         mUpdates |= updateEnvMap(false);
         mUpdates |= updateMaterials(false);
         mUpdates |= updateGeometry(false);
+        mpBufferUploader->flush(pContext);
         pContext->flush();
 
         if (is_set(mUpdates, UpdateFlags::GeometryMoved))
@@ -1817,6 +1908,18 @@ namespace Falcor
                 << "  Analytic lights memory: " << formatByteSize(s.lightsMemoryInBytes) << std::endl
                 << std::endl;
 
+            // Buffer upload stats.
+            const auto& sceneUploads = mpBufferUploader->getLastFlushStats();
+            const auto& materialUploads = mpMaterials->getUploadStats();
+            oss << "Buffer upload stats (last frame):" << std::endl
+                << "  Scene buffer writes: " << sceneUploads.writeCount << std::endl
+                << "  Scene buffer copy ranges: " << sceneUploads.rangeCount << std::endl
+                << "  Scene buffer bytes uploaded: " << formatByteSize(sceneUploads.byteCount) << std::endl
+                << "  Material writes: " << materialUploads.writeCount << std::endl
+                << "  Material copy ranges: " << materialUploads.rangeCount << std::endl
+                << "  Material bytes uploaded: " << formatByteSize(materialUploads.byteCount) << std::endl
+                << std::endl;
+
             // Emissive light stats.
             oss << "Emissive light stats:" << std::endl;
             if (mpLightCollection)
@@ -3616,6 +3719,15 @@ namespace Falcor
         scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
         scene.def_property(kRenderSettings.c_str(), pybind11::overload_cast<void>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings);
         scene.def_property(kUpdateCallback.c_str(), &Scene::getUpdateCallback, &Scene::setUpdateCallback);
+        auto getTextureMemoryBudget = [](const Scene* pScene) { return pScene->getMaterialSystem()->getTextureManager()->getResidencyOptions().budget; };
+        auto setTextureMemoryBudget = [](Scene* pScene, uint64_t budget)
+        {
+            const auto& pTextureManager = pScene->getMaterialSystem()->getTextureManager();
+            auto options = pTextureManager->getResidencyOptions();
+            options.budget = budget;
+            pTextureManager->setResidencyOptions(options);
+        };
+        scene.def_property(kTextureMemoryBudget.c_str(), getTextureMemoryBudget, setTextureMemoryBudget);
 
         scene.def(kSetEnvMap.c_str(), &Scene::loadEnvMap, "filename"_a);
         scene.def(kGetLight.c_str(), &Scene::getLight, "index"_a);
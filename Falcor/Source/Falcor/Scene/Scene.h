@@ -28,6 +28,7 @@
 #pragma once
 #include "Core/API/VAO.h"
 #include "Core/API/RtAccelerationStructure.h"
+#include "Core/BufferTypes/StagedBufferUploader.h"
 #include "Animation/Animation.h"
 #include "Lights/Light.h"
 #include "Lights/LightCollection.h"
@@ -256,6 +257,17 @@ namespace Falcor
             bool isDisplaced = false;           ///< True if group uses displacement mapping.
         };
 
+        /** Mesh geometry retained on the CPU.
+            The scene keeps the vertex positions and texture coordinates of static meshes that have an emissive material,
+            so that mesh lights can be preprocessed without reading back GPU data.
+        */
+        struct EmissiveMeshGeometry
+        {
+            std::vector<uint32_t> indices;      ///< Vertex indices (three per triangle) relative to the first vertex of the mesh.
+            std::vector<float3> positions;      ///< Vertex positions in object space.
+            std::vector<float2> texCrds;        ///< Vertex texture coordinates.
+        };
+
         /** Scene graph node.
         */
         struct Node
@@ -631,6 +643,13 @@ namespace Falcor
         */
         const MeshDesc& getMesh(uint32_t meshID) const { return mMeshDesc[meshID]; }
 
+        /** Get the CPU copy of an emissive mesh's geometry.
+            This is only available for meshes without dynamic vertex data that are instanced with an emissive material at load time.
+            \param[in] meshID Mesh ID.
+            \return Pointer to the geometry, or nullptr if not available.
+        */
+        const EmissiveMeshGeometry* getEmissiveMeshGeometry(uint32_t meshID) const;
+
         /** Get the number of curves.
         */
         uint32_t getCurveCount() const { return (uint32_t)mCurveDesc.size(); }
@@ -993,6 +1012,7 @@ namespace Falcor
 
         void createMeshVao(uint32_t drawCount, const std::vector<uint32_t>& indexData, const std::vector<PackedStaticVertexData>& staticData, const std::vector<DynamicVertexData>& dynamicData);
         void createCurveVao(const std::vector<uint32_t>& indexData, const std::vector<StaticCurveVertexData>& staticData);
+        void retainEmissiveMeshGeometry(const SceneData& sceneData);
 
         Shader::DefineList getSceneSDFGridDefines() const;
 
@@ -1020,6 +1040,12 @@ namespace Falcor
         */
         void updateBounds();
 
+        /** Mark the materials used in the current frame for the texture memory budget.
+            These are the materials of geometry instances that are not culled by the selected camera, and all emissive materials
+            as they are sampled by light sampling regardless of visibility.
+        */
+        void markUsedMaterials();
+
         /** Update geometry instances.
         */
         void updateGeometryInstances(bool forceUpdate);
@@ -1177,6 +1203,7 @@ namespace Falcor
         // Scene metadata (CPU only)
         std::vector<AABB> mMeshBBs;                                 ///< Bounding boxes for meshes (not instances) in object space.
         std::vector<std::vector<uint32_t>> mMeshIdToInstanceIds;    ///< Mapping of what instances belong to which mesh. The instanceID are sorted in ascending order.
+        std::unordered_map<uint32_t, EmissiveMeshGeometry> mEmissiveMeshGeometry; ///< CPU copy of the geometry of static emissive meshes, indexed by mesh ID.
         std::vector<AABB> mCurveBBs;                                ///< Bounding boxes for curves (not instances) in object space.
         std::vector<std::vector<uint32_t>> mCurveIdToInstanceIds;   ///< Mapping of what instances belong to which curve.
         HitInfo mHitInfo;                                           ///< Geometry hit info requirements.
@@ -1195,6 +1222,7 @@ namespace Falcor
         Buffer::SharedPtr mpLightsBuffer;
         Buffer::SharedPtr mpGridVolumesBuffer;
         ParameterBlock::SharedPtr mpSceneBlock;
+        StagedBufferUploader::SharedPtr mpBufferUploader;           ///< Batches per-frame updates to the light and volume buffers.
 
         // Camera
         CameraControllerType mCamCtrlType = CameraControllerType::FirstPerson;
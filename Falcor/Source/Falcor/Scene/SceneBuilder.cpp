@@ -286,10 +286,21 @@ namespace Falcor
         mSceneData.useCompressedHitInfo = is_set(mFlags, Flags::UseCompressedHitInfo);
 
         // Write scene cache if requested.
+        // SDF grids can only be cached if they are sparse brick sets, which are then built on the CPU before writing.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
-            timeReport.measure("Writing cache");
+            bool hasUncacheableSDFGrids = std::any_of(mSceneData.sdfGrids.begin(), mSceneData.sdfGrids.end(),
+                [](const SDFGrid::SharedPtr& pSDFGrid) { return pSDFGrid->getType() != SDFGrid::Type::SparseBrickSet; });
+
+            if (hasUncacheableSDFGrids)
+            {
+                logWarning("Scene cache is not written as the scene contains SDF grids that are not sparse brick sets.");
+            }
+            else
+            {
+                SceneCache::writeCache(mSceneData, mSceneCacheKey);
+                timeReport.measure("Writing cache");
+            }
         }
 
         // Create the scene object.
@@ -38,7 +38,7 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 23;
+        const uint32_t kVersion = 26;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
@@ -355,6 +355,19 @@ namespace Falcor
         stream.write(sceneData.customPrimitiveDesc);
         stream.write(sceneData.customPrimitiveAABBs);
 
+        writeMarker(stream, "SDFGrids");
+        stream.write((uint32_t)sceneData.sdfGrids.size());
+        for (const auto& pSDFGrid : sceneData.sdfGrids) writeSDFGrid(stream, pSDFGrid);
+        stream.write((uint32_t)sceneData.sdfGridDesc.size());
+        for (const auto& desc : sceneData.sdfGridDesc)
+        {
+            stream.write(desc.sdfGridID);
+            stream.write(desc.materialID);
+            stream.write(desc.instances);
+        }
+        stream.write(sceneData.sdfGridInstances);
+        stream.write(sceneData.sdfGridMaxLODCount);
+
         writeMarker(stream, "End");
     }
 
@@ -475,6 +488,19 @@ namespace Falcor
         stream.read(sceneData.customPrimitiveDesc);
         stream.read(sceneData.customPrimitiveAABBs);
 
+        readMarker(stream, "SDFGrids");
+        sceneData.sdfGrids.resize(stream.read<uint32_t>());
+        for (auto& pSDFGrid : sceneData.sdfGrids) pSDFGrid = readSDFGrid(stream);
+        sceneData.sdfGridDesc.resize(stream.read<uint32_t>());
+        for (auto& desc : sceneData.sdfGridDesc)
+        {
+            stream.read(desc.sdfGridID);
+            stream.read(desc.materialID);
+            stream.read(desc.instances);
+        }
+        stream.read(sceneData.sdfGridInstances);
+        stream.read(sceneData.sdfGridMaxLODCount);
+
         readMarker(stream, "End");
 
         pMaterialTextureLoader.reset();
@@ -803,6 +829,8 @@ namespace Falcor
         }
         stream.write(pGridVolume->mGridFrame);
         stream.write(pGridVolume->mGridFrameCount);
+        stream.write(pGridVolume->isStreaming());
+        stream.write(pGridVolume->mStreamingOptions);
         stream.write(pGridVolume->mBounds);
         stream.write(pGridVolume->mData);
     }
@@ -827,9 +855,21 @@ namespace Falcor
         }
         stream.read(pGridVolume->mGridFrame);
         stream.read(pGridVolume->mGridFrameCount);
+        bool streaming = stream.read<bool>();
+        stream.read(pGridVolume->mStreamingOptions);
         stream.read(pGridVolume->mBounds);
         stream.read(pGridVolume->mData);
 
+        // Grids are read without device data. Create it now unless the volume streams its grids.
+        if (streaming)
+        {
+            pGridVolume->updateStreamer();
+        }
+        else
+        {
+            for (const auto& pGrid : pGridVolume->getAllGrids()) pGrid->createDeviceData();
+        }
+
         return pGridVolume;
     }
 
@@ -837,17 +877,82 @@ namespace Falcor
 
     void SceneCache::writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid)
     {
-        const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
-        stream.write((uint64_t)buffer.size());
-        stream.write(buffer.data(), buffer.size());
+        // Memory-mapped grids are stored by their location in the source file, so that they are mapped again instead of read into host memory.
+        stream.write(pGrid->isMemoryMapped());
+        if (pGrid->isMemoryMapped())
+        {
+            stream.write(pGrid->mpMappedFile->getPath().string());
+            stream.write(pGrid->getMappedOffset());
+            stream.write(pGrid->getHostDataSize());
+        }
+        else
+        {
+            stream.write(pGrid->getHostDataSize());
+            stream.write(pGrid->getHostData(), pGrid->getHostDataSize());
+        }
     }
 
     Grid::SharedPtr SceneCache::readGrid(InputStream& stream)
     {
+        if (stream.read<bool>())
+        {
+            auto path = stream.read<std::string>();
+            auto offset = stream.read<uint64_t>();
+            auto size = stream.read<uint64_t>();
+            auto pGrid = Grid::createMappedFromFile(path, offset, size);
+            if (!pGrid) throw RuntimeError("Failed to map grid from '{}'. The file has changed since the scene cache was written.", path);
+            return pGrid;
+        }
+
         uint64_t size = stream.read<uint64_t>();
         auto buffer = nanovdb::HostBuffer::create(size);
         stream.read(buffer.data(), buffer.size());
-        return Grid::SharedPtr(new Grid(nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer))));
+        return Grid::SharedPtr(new Grid(nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer)), false));
+    }
+
+    // SDFGrid
+
+    void SceneCache::writeSDFGrid(OutputStream& stream, const SDFGrid::SharedPtr& pSDFGrid)
+    {
+        // Only sparse brick sets can be serialized, as they can be built on the CPU.
+        auto pSBS = std::dynamic_pointer_cast<SDFSBS>(pSDFGrid);
+        if (!pSBS) throw RuntimeError("SDF grid '{}' can not be written to the scene cache, only SDF sparse brick sets are supported.", pSDFGrid->getName());
+
+        pSBS->buildOnCPU();
+
+        stream.write(pSBS->mName);
+        stream.write(pSBS->mBrickWidth);
+        stream.write(pSBS->mCompressed);
+        stream.write(pSBS->mOriginalGridWidth);
+        stream.write(pSBS->mGridWidth);
+        stream.write(pSBS->mVirtualBricksPerAxis);
+        stream.write(pSBS->mBrickCount);
+        stream.write(pSBS->mBricksPerAxis);
+        stream.write(pSBS->mBrickTextureDimensions);
+        stream.write(pSBS->mBrickAABBs);
+        stream.write(pSBS->mIndirection);
+        stream.write(pSBS->mBrickData);
+    }
+
+    SDFGrid::SharedPtr SceneCache::readSDFGrid(InputStream& stream)
+    {
+        auto name = stream.read<std::string>();
+        auto brickWidth = stream.read<uint32_t>();
+        auto compressed = stream.read<bool>();
+
+        auto pSBS = SDFSBS::create(brickWidth, compressed);
+        pSBS->setName(name);
+        stream.read(pSBS->mOriginalGridWidth);
+        stream.read(pSBS->mGridWidth);
+        stream.read(pSBS->mVirtualBricksPerAxis);
+        stream.read(pSBS->mBrickCount);
+        stream.read(pSBS->mBricksPerAxis);
+        stream.read(pSBS->mBrickTextureDimensions);
+        stream.read(pSBS->mBrickAABBs);
+        stream.read(pSBS->mIndirection);
+        stream.read(pSBS->mBrickData);
+        pSBS->mBuiltOnCPU = true;
+        return pSBS;
     }
 
     // EnvMap
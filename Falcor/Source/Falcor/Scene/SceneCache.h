@@ -95,6 +95,9 @@ namespace Falcor
         static void writeGrid(OutputStream& stream, const Grid::SharedPtr& pGrid);
         static Grid::SharedPtr readGrid(InputStream& stream);
 
+        static void writeSDFGrid(OutputStream& stream, const SDFGrid::SharedPtr& pSDFGrid);
+        static SDFGrid::SharedPtr readSDFGrid(InputStream& stream);
+
         static void writeEnvMap(OutputStream& stream, const EnvMap::SharedPtr& pEnvMap);
         static EnvMap::SharedPtr readEnvMap(InputStream& stream);
 
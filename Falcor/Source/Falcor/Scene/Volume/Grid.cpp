@@ -36,6 +36,7 @@
 #include <openvdb/openvdb.h>
 #pragma warning(pop)
 #include <glm/gtc/type_ptr.hpp>
+#include <fstream>
 #include "GridConverter.h"
 
 
@@ -43,6 +44,11 @@ namespace Falcor
 {
     namespace
     {
+        // Grids smaller than this are converted to bricks faster than the brick cache can be read.
+        const uint64_t kMinCachedGridSize = 16ull << 20;
+
+        using NanoVDBGridConverter = NanoVDBConverterBC4;
+
         float3 cast(const nanovdb::Vec3f& v)
         {
             return float3(v[0], v[1], v[2]);
@@ -57,8 +63,54 @@ namespace Falcor
         {
             return int3(c[0], c[1], c[2]);
         }
+
+        /** Find the location of a grid in a NanoVDB file.
+            \param[in] path Path of the NanoVDB file.
+            \param[in] gridname Name of the grid.
+            \param[out] offset Offset of the grid data in bytes from the start of the file.
+            \param[out] size Size of the grid data in bytes.
+            \return True if the grid was found and is stored uncompressed, false otherwise.
+        */
+        bool findUncompressedNanoVDBGrid(const std::string& path, const std::string& gridname, uint64_t& offset, uint64_t& size)
+        {
+            std::ifstream is(path, std::ios_base::binary);
+
+            // A NanoVDB file is a list of segments, each consisting of a header, the meta data of its grids and the grid data.
+            nanovdb::io::Header header;
+            while (is.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            {
+                if (header.magic != NANOVDB_MAGIC_NUMBER) return false;
+
+                std::vector<nanovdb::io::GridMetaData> metaData(header.gridCount);
+                for (auto& meta : metaData) meta.read(is);
+                if (!is.good()) return false;
+
+                uint64_t gridOffset = (uint64_t)is.tellg();
+                for (const auto& meta : metaData)
+                {
+                    if (meta.gridName == gridname)
+                    {
+                        if (header.codec != nanovdb::io::Codec::NONE) return false;
+                        offset = gridOffset;
+                        size = meta.gridSize;
+                        return true;
+                    }
+                    gridOffset += meta.fileSize;
+                }
+                is.seekg(gridOffset);
+            }
+
+            return false;
+        }
     }
 
+    struct Grid::StagedBricks
+    {
+        StagedBricks(const nanovdb::FloatGrid* pFloatGrid) : converter(pFloatGrid) {}
+
+        NanoVDBGridConverter converter;
+    };
+
     Grid::SharedPtr Grid::createSphere(float radius, float voxelSize, float blendRange)
     {
         auto handle = nanovdb::createFogVolumeSphere(radius, nanovdb::Vec3R(0.0), voxelSize, blendRange);
@@ -96,6 +148,35 @@ namespace Falcor
         }
     }
 
+    Grid::SharedPtr Grid::createStreamedFromFile(const std::string& filename, const std::string& gridname)
+    {
+        std::string fullpath;
+        if (!findFileInDataDirectories(filename, fullpath))
+        {
+            logWarning("Error when loading grid. Can't find grid file '{}'.", filename);
+            return nullptr;
+        }
+
+        auto ext = getExtensionFromFile(fullpath);
+        if (ext == "nvdb")
+        {
+            // Fall back to loading the grid into host memory if it cannot be used in place (e.g. compressed grids).
+            if (auto pGrid = createMappedFromNanoVDBFile(fullpath, gridname)) return pGrid;
+            return createFromNanoVDBFile(fullpath, gridname, false);
+        }
+        else if (ext == "vdb")
+        {
+            return createFromOpenVDBFile(fullpath, gridname, false);
+        }
+        else
+        {
+            logWarning("Error when loading grid. Unsupported grid file '{}'.", filename);
+            return nullptr;
+        }
+    }
+
+    Grid::~Grid() = default;
+
     void Grid::renderUI(Gui::Widgets& widget)
     {
         std::ostringstream oss;
@@ -154,6 +235,44 @@ namespace Falcor
         return nvdb + bricks;
     }
 
+    void Grid::stageDeviceData()
+    {
+        if (isResident() || mpStagedBricks) return;
+
+        mpStagedBricks = std::make_unique<StagedBricks>(mpFloatGrid);
+        mpStagedBricks->converter.convertBricks(getHostDataSize() >= kMinCachedGridSize);
+    }
+
+    uint64_t Grid::getStagedSizeInBytes() const
+    {
+        return mpStagedBricks ? mpStagedBricks->converter.getHostSizeInBytes() : 0;
+    }
+
+    void Grid::createDeviceData()
+    {
+        if (isResident()) return;
+
+        stageDeviceData();
+
+        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
+        mpBuffer = Buffer::createStructured(
+            sizeof(uint32_t),
+            uint32_t(div_round_up(getHostDataSize(), sizeof(uint32_t))),
+            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
+            Buffer::CpuAccess::None,
+            getHostData()
+        );
+        mBrickedGrid = mpStagedBricks->converter.createTextures();
+        mpStagedBricks.reset();
+    }
+
+    void Grid::releaseDeviceData()
+    {
+        mpStagedBricks.reset();
+        mpBuffer = nullptr;
+        mBrickedGrid = {};
+    }
+
     AABB Grid::getWorldBounds() const
     {
         auto bounds = mpFloatGrid->worldBBox();
@@ -172,7 +291,7 @@ namespace Falcor
 
     glm::mat4 Grid::getTransform() const
     {
-        const auto& gridMap = mGridHandle.gridMetaData()->map();
+        const auto& gridMap = mpFloatGrid->map();
         const float3x3 affine = glm::make_mat3(gridMap.mMatF);
         const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
         return glm::translate(float4x4(affine), translation);
@@ -180,35 +299,34 @@ namespace Falcor
 
     glm::mat4 Grid::getInvTransform() const
     {
-        const auto& gridMap = mGridHandle.gridMetaData()->map();
+        const auto& gridMap = mpFloatGrid->map();
         const float3x3 invAffine = glm::make_mat3(gridMap.mInvMatF);
         const float3 translation = float3(gridMap.mVecF[0], gridMap.mVecF[1], gridMap.mVecF[2]);
         return glm::translate(float4x4(invAffine), -translation);
     }
 
-    Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle)
+    Grid::Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool createDevice)
         : mGridHandle(std::move(gridHandle))
         , mpFloatGrid(mGridHandle.grid<float>())
         , mAccessor(mpFloatGrid->getAccessor())
     {
         if (!mpFloatGrid->hasMinMax())
         {
-            nanovdb::gridStats(*mpFloatGrid);
+            nanovdb::gridStats(*mGridHandle.grid<float>());
         }
 
-        // Keep both NanoVDB and brick textures resident in GPU memory for simplicity for now (~15% increased footprint).
-        mpBuffer = Buffer::createStructured(
-            sizeof(uint32_t),
-            uint32_t(div_round_up(mGridHandle.size(), sizeof(uint32_t))),
-            ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource,
-            Buffer::CpuAccess::None,
-            mGridHandle.data()
-        );
-        using NanoVDBGridConverter = NanoVDBConverterBC4;
-        mBrickedGrid = NanoVDBGridConverter(mpFloatGrid).convert();
+        if (createDevice) createDeviceData();
+    }
+
+    Grid::Grid(const MemoryMappedFile::SharedPtr& pMappedFile, const nanovdb::FloatGrid* pFloatGrid)
+        : mpMappedFile(pMappedFile)
+        , mpFloatGrid(pFloatGrid)
+        , mAccessor(mpFloatGrid->getAccessor())
+    {
+        FALCOR_ASSERT(mpFloatGrid->hasMinMax());
     }
 
-    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::string& path, const std::string& gridname)
+    Grid::SharedPtr Grid::createFromNanoVDBFile(const std::string& path, const std::string& gridname, bool createDevice)
     {
         if (!nanovdb::io::hasGrid(path, gridname))
         {
@@ -236,10 +354,10 @@ namespace Falcor
             return nullptr;
         }
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return SharedPtr(new Grid(std::move(handle), createDevice));
     }
 
-    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::string& path, const std::string& gridname)
+    Grid::SharedPtr Grid::createFromOpenVDBFile(const std::string& path, const std::string& gridname, bool createDevice)
     {
         openvdb::initialize();
 
@@ -279,7 +397,36 @@ namespace Falcor
         openvdb::FloatGrid::Ptr floatGrid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
         auto handle = nanovdb::openToNanoVDB(floatGrid);
 
-        return SharedPtr(new Grid(std::move(handle)));
+        return SharedPtr(new Grid(std::move(handle), createDevice));
+    }
+
+    Grid::SharedPtr Grid::createMappedFromNanoVDBFile(const std::string& path, const std::string& gridname)
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        if (!findUncompressedNanoVDBGrid(path, gridname, offset, size)) return nullptr;
+        return createMappedFromFile(path, offset, size);
+    }
+
+    Grid::SharedPtr Grid::createMappedFromFile(const std::filesystem::path& path, uint64_t offset, uint64_t size)
+    {
+        // Grids are not padded in the file, so only grids that happen to be suitably aligned can be used in place.
+        if (offset % NANOVDB_DATA_ALIGNMENT != 0) return nullptr;
+
+        auto pMappedFile = MemoryMappedFile::create(path);
+        if (!pMappedFile || offset + size > pMappedFile->getSize()) return nullptr;
+
+        // Grids without min/max statistics need to be modified and are loaded into host memory instead.
+        auto pFloatGrid = reinterpret_cast<const nanovdb::FloatGrid*>(static_cast<const uint8_t*>(pMappedFile->getData()) + offset);
+        if (pFloatGrid->gridType() != nanovdb::GridType::Float || pFloatGrid->gridSize() != size || pFloatGrid->isEmpty() || !pFloatGrid->hasMinMax()) return nullptr;
+
+        return SharedPtr(new Grid(pMappedFile, pFloatGrid));
+    }
+
+    uint64_t Grid::getMappedOffset() const
+    {
+        FALCOR_ASSERT(mpMappedFile);
+        return (uint64_t)(reinterpret_cast<const uint8_t*>(mpFloatGrid) - static_cast<const uint8_t*>(mpMappedFile->getData()));
     }
 
 
@@ -33,6 +33,7 @@
 #include <nanovdb/util/HostBuffer.h>
 #pragma warning(pop)
 #include "BrickedGrid.h"
+#include "Core/Platform/MemoryMappedFile.h"
 namespace Falcor
 {
     /** Voxel grid based on NanoVDB.
@@ -68,6 +69,18 @@ namespace Falcor
         */
         static SharedPtr createFromFile(const std::string& filename, const std::string& gridname);
 
+        /** Create a grid from a file without creating its device data.
+            Uncompressed NanoVDB grids are memory-mapped from the file, so host memory is only committed for the pages that are accessed.
+            Other grids are loaded into host memory. The device data has to be created with createDeviceData() before the grid is used
+            for rendering, which allows streaming grid sequences (see GridSequenceStreamer).
+            \param[in] filename Filename of the grid. Can also include a full path or relative path from a data directory.
+            \param[in] gridname Name of the grid to load.
+            \return A new grid, or nullptr if the grid failed to load.
+        */
+        static SharedPtr createStreamedFromFile(const std::string& filename, const std::string& gridname);
+
+        ~Grid();
+
         /** Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
@@ -101,6 +114,34 @@ namespace Falcor
         */
         uint64_t getGridSizeInBytes() const;
 
+        /** Check if the device data of the grid is resident in GPU memory.
+        */
+        bool isResident() const { return mpBuffer != nullptr; }
+
+        /** Check if the host data of the grid is memory-mapped from a file.
+        */
+        bool isMemoryMapped() const { return mpMappedFile != nullptr; }
+
+        /** Convert the grid to bricks in host memory in preparation for creating the device data.
+            This does not create any GPU resources and may be called from a worker thread,
+            but not concurrently with any other call that stages, creates or releases device data of the same grid.
+        */
+        void stageDeviceData();
+
+        /** Get the size of the bricks staged in host memory by stageDeviceData().
+        */
+        uint64_t getStagedSizeInBytes() const;
+
+        /** Create the device data of the grid, using the staged bricks if available.
+            This does nothing if the device data is already resident.
+        */
+        void createDeviceData();
+
+        /** Release the device data of the grid and any staged bricks.
+            The device data can be recreated later using createDeviceData().
+        */
+        void releaseDeviceData();
+
         /** Get the grid's bounds in world space.
         */
         AABB getWorldBounds() const;
@@ -112,6 +153,7 @@ namespace Falcor
         float getValue(const int3& ijk) const;
 
         /** Get the raw NanoVDB grid handle.
+            Note: The handle is empty for memory-mapped grids.
         */
         const nanovdb::GridHandle<nanovdb::HostBuffer>& getGridHandle() const;
 
@@ -124,15 +166,36 @@ namespace Falcor
         glm::mat4 getInvTransform() const;
 
     private:
-        Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle);
+        struct StagedBricks;
+
+        Grid(nanovdb::GridHandle<nanovdb::HostBuffer> gridHandle, bool createDevice = true);
+        Grid(const MemoryMappedFile::SharedPtr& pMappedFile, const nanovdb::FloatGrid* pFloatGrid);
+
+        static SharedPtr createFromNanoVDBFile(const std::string& path, const std::string& gridname, bool createDevice = true);
+        static SharedPtr createFromOpenVDBFile(const std::string& path, const std::string& gridname, bool createDevice = true);
+        static SharedPtr createMappedFromNanoVDBFile(const std::string& path, const std::string& gridname);
+
+        /** Create a grid memory-mapped from a known location in a NanoVDB file.
+            \param[in] path Path of the file.
+            \param[in] offset Offset of the grid data in the file.
+            \param[in] size Size of the grid data in bytes.
+            \return A new grid, or nullptr if no suitable grid is stored at the given location.
+        */
+        static SharedPtr createMappedFromFile(const std::filesystem::path& path, uint64_t offset, uint64_t size);
+
+        /** Get the offset of the grid data in the memory-mapped file.
+        */
+        uint64_t getMappedOffset() const;
 
-        static SharedPtr createFromNanoVDBFile(const std::string& path, const std::string& gridname);
-        static SharedPtr createFromOpenVDBFile(const std::string& path, const std::string& gridname);
+        const void* getHostData() const { return mpFloatGrid; }
+        uint64_t getHostDataSize() const { return mpFloatGrid->gridSize(); }
 
         // Host data.
         nanovdb::GridHandle<nanovdb::HostBuffer> mGridHandle;
-        nanovdb::FloatGrid* mpFloatGrid;
+        MemoryMappedFile::SharedPtr mpMappedFile;       ///< File the host data is mapped from, or nullptr if the host data is owned by mGridHandle.
+        const nanovdb::FloatGrid* mpFloatGrid;
         nanovdb::FloatGrid::AccessorType mAccessor;
+        std::unique_ptr<StagedBricks> mpStagedBricks;   ///< Bricks converted by stageDeviceData() that have not been uploaded yet.
         // Device data.
         Buffer::SharedPtr mpBuffer;
         BrickedGrid mBrickedGrid;
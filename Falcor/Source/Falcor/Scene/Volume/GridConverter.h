@@ -27,12 +27,16 @@
  **************************************************************************/
 #pragma once
 #include <execution>
+#include <filesystem>
+#include <fstream>
 #pragma warning(push)
 #pragma warning(disable : 4244 4267)
 #include <nanovdb/NanoVDB.h>
 #pragma warning(pop)
 #include "BC4Encode.h"
 #include "Utils/NumericRange.h"
+#include "Utils/CacheFiles.h"
+#include "Utils/CryptoUtils.h"
 #include "BrickedGrid.h"
 
 namespace Falcor
@@ -49,20 +53,101 @@ namespace Falcor
         NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid);
         NanoVDBToBricksConverter(const NanoVDBToBricksConverter& rhs) = delete;
 
-        BrickedGrid convert();
+        /** Convert the grid to bricks.
+            \param[in] useCache If true, the bricks are loaded from the brick cache if the grid has been converted before,
+                        and written to the cache otherwise. The cache is keyed on the content of the grid.
+            \return The bricked grid.
+        */
+        BrickedGrid convert(bool useCache = false);
+
+        /** Convert the grid to bricks in host memory without creating any GPU resources.
+            This can be called from a worker thread. Use createTextures() to create the textures afterwards.
+            \param[in] useCache If true, the bricks are loaded from or written to the brick cache. See convert().
+        */
+        void convertBricks(bool useCache = false);
+
+        /** Create the brick textures from the converted bricks.
+            \return The bricked grid.
+        */
+        BrickedGrid createTextures() const;
+
+        /** Get the size of the converted bricks in host memory.
+        */
+        uint64_t getHostSizeInBytes() const { return mRangeData.size() * sizeof(mRangeData[0]) + mPtrData.size() * sizeof(mPtrData[0]) + mAtlasData.size() * sizeof(mAtlasData[0]); }
+
+        /** Get the directory used for caching converted bricks.
+        */
+        static std::filesystem::path getCacheDirectory() { return std::filesystem::path(getAppDataDirectory()) / "NVIDIA/Falcor/BrickCache"; }
 
     private:
         const static uint kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int kBC4Compress = kBitsPerTexel == 4;
+        const static uint32_t kCacheVersion = 1;
+        const static uint64_t kMaxCacheSizeInBytes = 16ull << 30; ///< Size limit of the brick cache directory. The least recently used files are removed when adding a file exceeds it.
+
+        using LeafNodeType = nanovdb::NanoLeaf<float>;
 
-        void convertSlice(int z);
+        /** The 3x3x3 neighbourhood of leaf nodes around a brick.
+            Used for gathering the 1-voxel halo of a brick with direct voxel reads instead of one tree lookup per voxel.
+        */
+        struct NeighbourLeafCache
+        {
+            const LeafNodeType* leaves[27];
+            float tileValues[27];   ///< Value of the tile covering the neighbour if there is no leaf node.
+
+            template <typename AccessorType>
+            void fetch(AccessorType& a, const nanovdb::Coord& ijk)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    for (int j = 0; j < 3; ++j)
+                    {
+                        for (int i = 0; i < 3; ++i)
+                        {
+                            const nanovdb::Coord neighbour = ijk + nanovdb::Coord((i - 1) * kBrickSize, (j - 1) * kBrickSize, (k - 1) * kBrickSize);
+                            const int index = i + 3 * j + 9 * k;
+                            leaves[index] = a.probeLeaf(neighbour);
+                            tileValues[index] = leaves[index] ? 0.f : a.getValue(neighbour);
+                        }
+                    }
+                }
+            }
+
+            /** Get a value at a brick-local position in [-1, kBrickSize]^3.
+            */
+            float getValue(int x, int y, int z) const
+            {
+                auto neighbourIndex = [](int c) { return c < 0 ? 0 : (c < (int)kBrickSize ? 1 : 2); };
+                const int index = neighbourIndex(x) + 3 * neighbourIndex(y) + 9 * neighbourIndex(z);
+                if (!leaves[index]) return tileValues[index];
+                const int mask = kBrickSize - 1;
+                return leaves[index]->voxels()[(x & mask) * kBrickSize * kBrickSize + (y & mask) * kBrickSize + (z & mask)];
+            }
+        };
+
+        struct CacheHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t bitsPerTexel;
+            int32_t leafDim[3];
+            uint32_t atlasSizeBricks[3];
+            uint32_t nonEmptyCount;
+        };
+
+        void convertRow(int y, int z);
         void computeMip(int mip);
 
+        std::filesystem::path getCachePath() const;
+        bool readCache(const std::filesystem::path& cachePath);
+        void writeCache(const std::filesystem::path& cachePath) const;
+        CacheHeader getCacheHeader() const;
+
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
         inline uint getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
 
-        inline ResourceFormat getAtlasFormat() {
+        inline ResourceFormat getAtlasFormat() const {
             switch (kBitsPerTexel) {
             case 4: return ResourceFormat::BC4Unorm;
             case 8: return ResourceFormat::R8Unorm;
@@ -126,118 +211,118 @@ namespace Falcor
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertRow(int y, int z)
     {
         uint3 atlasSizePixels = getAtlasSizePixels();
         uint brickMax = getAtlasMaxBrick();
         uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
         uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
 
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
+        size_t offset = ((size_t)z * mLeafDim[0].y + y) * mLeafDim[0].x;
         uint32_t* rangedst = mRangeData.data() + offset;
         uint32_t* ptrdst = mPtrData.data() + offset;
         auto a = mpFloatGrid->getAccessor();
-        for (int y = 0; y < mLeafDim[0].y; ++y)
+        NeighbourLeafCache neighbours;
+        for (int x = 0; x < mLeafDim[0].x; ++x)
         {
-            for (int x = 0; x < mLeafDim[0].x; ++x)
+            nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+            auto val = a.getValue(ijk);
+            auto leaf = a.probeLeaf(ijk);
+            float minorant = val, majorant = val;
+            uint myleaf = 0;
+            if (leaf)
             {
-                nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
-                auto val = a.getValue(ijk);
-                auto leaf = a.probeLeaf(ijk);
-                float minorant = val, majorant = val;
-                uint myleaf = 0;
-                if (leaf)
+                // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
+                const float* data = leaf->voxels();
+                for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
+                // We also need the 1-halo from neighbouring bricks. Look up the neighbouring leaves once and read the halo from them directly.
+                neighbours.fetch(a, ijk);
+                for (int k = -1; k <= (int)kBrickSize; ++k)
                 {
-                    // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
-                    const float* data = leaf->voxels();
-                    for (int i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i) expandMinorantMajorant(data[i], minorant, majorant);
-                    // We also need the 1-halo from neighbouring bricks. Fetch them in an order that maximises nanovdb's internal cache reuse.
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, j, kBrickSize)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, -1, j)), minorant, majorant);
-                    for (int j = 0; j < kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(i, kBrickSize, j)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) for (int i = 0; i < kBrickSize; ++i) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, i)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
-                    for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
-                }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
-                {
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
-                    *ptrdst++ = 0;
+                    for (int j = -1; j <= (int)kBrickSize; ++j)
+                    {
+                        for (int i = -1; i <= (int)kBrickSize; ++i)
+                        {
+                            const bool interior = i >= 0 && i < (int)kBrickSize && j >= 0 && j < (int)kBrickSize && k >= 0 && k < (int)kBrickSize;
+                            if (!interior) expandMinorantMajorant(neighbours.getValue(i, j, k), minorant, majorant);
+                        }
+                    }
                 }
-                else
-                {
-                    const float* data = leaf->voxels();
-                    majorant = f16tof32(f32tof16(majorant) + 1);
-                    minorant = f16tof32(f32tof16(minorant));
-                    *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+
+                if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
+            }
+            if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+            {
+                *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
+                *ptrdst++ = 0;
+            }
+            else
+            {
+                const float* data = leaf->voxels();
+                majorant = f16tof32(f32tof16(majorant) + 1);
+                minorant = f16tof32(f32tof16(minorant));
+                *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
+                uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
+                uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+                uint32_t atlasz = myleaf / bricksPerSlice;
+                *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
+
+                if (!kBC4Compress) {
+                    float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
+                    TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+                    for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    {
+                        for (int pixy = 0; pixy < kBrickSize; ++pixy)
                         {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                            for (int pixx = 0; pixx < kBrickSize; ++pixx)
                             {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
-                                {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
-                                }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                                float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
+                                *atlasdst++ = TexelType((f - minorant) * invRange);
                             }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+                            atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
                         }
+                        atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
                     }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                }
+                else {
+                    // BC4 compression:
+                    float invRange = (255.f) / (majorant - minorant);
+                    uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+                    for (int pixz = 0; pixz < kBrickSize; ++pixz)
+                    {
+                        for (int tiley = 0; tiley < kBrickSize; tiley += 4)
                         {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
+                            for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                                uint8_t tilevals[4][4];
+                                uint8_t tileminorant = 255, tilemajorant = 0;
+                                for (int pixy = 0; pixy < 4; ++pixy)
+                                {
+                                    for (int pixx = 0; pixx < 4; ++pixx)
                                     {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
+                                        float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
+                                        uint8_t voxel = uint8_t((f - minorant) * invRange);
+                                        tileminorant = std::min(tileminorant, voxel);
+                                        tilemajorant = std::max(tilemajorant, voxel);
+                                        tilevals[pixy][pixx] = voxel;
                                     }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
                                 }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                                CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                                atlasdst++;
                             }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
-            } // x brick loop
-        } // y brick loop
+                            atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                        }
+                        atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+                    } // z slice loop
+                } // bc4 compress?
+            } // non empty brick?
+        } // x brick loop
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
+        uint32_t* rangedstBase = mRangeData.data() + mLeafCount[mip - 1];
+        const uint32_t* rangesrcBase = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -246,10 +331,14 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        // Each target slice reads two source slices, so the slices can be reduced in parallel.
+        auto range = NumericRange<int>(0, leafdim_tgt.z);
+        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
+            uint32_t* rangedst = rangedstBase + (size_t)z * slicestride_tgt;
+            for (int y = 0; y < leafdim_tgt.y; ++y)
             {
+                const uint32_t* rangesrc = rangesrcBase + (size_t)(2 * z) * slicestride_src + (size_t)(2 * y) * rowstride_src;
                 for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
                 {
                     float2 majmin_dst = combineMajMin(
@@ -265,23 +354,140 @@ namespace Falcor
                     *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
                 } // x
             } // y
-        } // z
+        }); // z
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel> typename
-    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert()
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(bool useCache)
+    {
+        convertBricks(useCache);
+        return createTextures();
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertBricks(bool useCache)
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
-        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
+        const std::filesystem::path cachePath = useCache ? getCachePath() : std::filesystem::path();
+        if (!cachePath.empty() && readCache(cachePath))
+        {
+            double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+            logInfo("loaded cached bricks in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
+        }
+        else
+        {
+            // Convert rows of bricks in parallel. This gives more parallelism than slices for flat volumes.
+            auto range = NumericRange<int>(0, mLeafDim[0].y * mLeafDim[0].z);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](int row) { convertRow(row % mLeafDim[0].y, row / mLeafDim[0].y); });
+            for (int mip = 1; mip < 4; ++mip) computeMip(mip);
+            double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+            logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
 
+            if (!cachePath.empty()) writeCache(cachePath);
+        }
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::createTextures() const
+    {
         BrickedGrid bricks;
         bricks.range = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.indirection = Texture::create3D(mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.atlas = Texture::create3D(getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
         return bricks;
     }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    std::filesystem::path NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::getCachePath() const
+    {
+        // Key the cache on the raw grid data, which includes the grid's index bounding box and transform.
+        SHA1 sha1;
+        sha1.update(mpFloatGrid, mpFloatGrid->gridSize());
+        sha1.update(&kCacheVersion, sizeof(kCacheVersion));
+        const uint32_t bitsPerTexel = kBitsPerTexel;
+        sha1.update(&bitsPerTexel, sizeof(bitsPerTexel));
+
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (auto c : sha1.final()) ss << std::setw(2) << (int)c;
+        return getCacheDirectory() / ss.str();
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    typename NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::CacheHeader NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::getCacheHeader() const
+    {
+        CacheHeader header = {};
+        std::memcpy(header.magic, "FalcorB$", sizeof(header.magic));
+        header.version = kCacheVersion;
+        header.bitsPerTexel = kBitsPerTexel;
+        for (int i = 0; i < 3; ++i)
+        {
+            header.leafDim[i] = mLeafDim[0][i];
+            header.atlasSizeBricks[i] = mAtlasSizeBricks[i];
+        }
+        header.nonEmptyCount = mNonEmptyCount.load();
+        return header;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    bool NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::readCache(const std::filesystem::path& cachePath)
+    {
+        if (!std::filesystem::exists(cachePath)) return false;
+
+        std::ifstream fs(cachePath, std::ios_base::binary);
+        if (!fs.good()) return false;
+
+        // The brick layout is fully determined by the grid, so a matching header means the data fits our buffers.
+        CacheHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        CacheHeader expected = getCacheHeader();
+        expected.nonEmptyCount = header.nonEmptyCount;
+        if (!fs.good() || std::memcmp(&header, &expected, sizeof(header)) != 0) return false;
+
+        // Reject files that were truncated or not written by a single writer. Their size does not match the buffers.
+        std::error_code ec;
+        const uint64_t payloadSize = mRangeData.size() * sizeof(mRangeData[0]) + mPtrData.size() * sizeof(mPtrData[0]) + mAtlasData.size() * sizeof(mAtlasData[0]);
+        if (header.nonEmptyCount > getAtlasMaxBrick() || std::filesystem::file_size(cachePath, ec) != sizeof(header) + payloadSize || ec) return false;
+
+        fs.read(reinterpret_cast<char*>(mRangeData.data()), mRangeData.size() * sizeof(mRangeData[0]));
+        fs.read(reinterpret_cast<char*>(mPtrData.data()), mPtrData.size() * sizeof(mPtrData[0]));
+        fs.read(reinterpret_cast<char*>(mAtlasData.data()), mAtlasData.size() * sizeof(mAtlasData[0]));
+        if (!fs.good()) return false;
+
+        mNonEmptyCount.store(header.nonEmptyCount);
+        touchCacheFile(cachePath);
+        return true;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::writeCache(const std::filesystem::path& cachePath) const
+    {
+        // Write to a uniquely named temporary file first, so that concurrent writers never write to the same file and readers never see a partial cache file.
+        const std::filesystem::path tempPath = createCacheTempFile(cachePath);
+        if (tempPath.empty()) return;
+
+        bool success = false;
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            if (fs.good())
+            {
+                const CacheHeader header = getCacheHeader();
+                fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                fs.write(reinterpret_cast<const char*>(mRangeData.data()), mRangeData.size() * sizeof(mRangeData[0]));
+                fs.write(reinterpret_cast<const char*>(mPtrData.data()), mPtrData.size() * sizeof(mPtrData[0]));
+                fs.write(reinterpret_cast<const char*>(mAtlasData.data()), mAtlasData.size() * sizeof(mAtlasData[0]));
+                success = fs.good();
+            }
+        }
+
+        if (!success)
+        {
+            logWarning("Failed to write brick cache file '{}'.", tempPath.string());
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+
+        if (commitCacheFile(tempPath, cachePath)) trimCacheDirectory(cachePath.parent_path(), kMaxCacheSizeInBytes);
+    }
 }
@@ -0,0 +1,349 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "GridSequenceStreamer.h"
+#include <iomanip>
+#include <map>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMaxWorkerCount = 16;
+    }
+
+    GridSequenceStreamer::SharedPtr GridSequenceStreamer::create(const std::vector<GridSequence>& sequences, const Options& options)
+    {
+        return SharedPtr(new GridSequenceStreamer(sequences, options));
+    }
+
+    GridSequenceStreamer::GridSequenceStreamer(const std::vector<GridSequence>& sequences, const Options& options)
+        : mOptions(options)
+    {
+        uint32_t frameCount = 0;
+        for (const auto& grids : sequences) frameCount = std::max(frameCount, (uint32_t)grids.size());
+
+        // Gather the grids used by each frame and count how many frames use each grid.
+        std::vector<std::vector<Grid::SharedPtr>> frameGrids(frameCount);
+        std::map<Grid::SharedPtr, uint32_t> frameUseCount;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            for (const auto& grids : sequences)
+            {
+                if (grids.empty()) continue;
+                const auto& pGrid = grids[std::min(frame, (uint32_t)grids.size() - 1)];
+                if (pGrid && frameUseCount[pGrid]++ == 0) frameGrids[frame].push_back(pGrid);
+            }
+        }
+
+        // Grids shared between frames are made resident up front. Everything else is streamed per frame.
+        mFrameGrids.resize(frameCount);
+        mFrameStates.resize(frameCount, FrameState::Evicted);
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            for (const auto& pGrid : frameGrids[frame])
+            {
+                if (frameUseCount[pGrid] > 1) mPinnedGrids.push_back(pGrid);
+                else mFrameGrids[frame].push_back(pGrid);
+            }
+
+            // Keep frames that are already fully resident, e.g. from a previous streamer.
+            bool resident = std::all_of(mFrameGrids[frame].begin(), mFrameGrids[frame].end(), [](const auto& pGrid) { return pGrid->isResident(); });
+            if (resident) mFrameStates[frame] = FrameState::Resident;
+            else releaseFrame(frame);
+        }
+        for (const auto& pGrid : mPinnedGrids) pGrid->createDeviceData();
+
+        runWorkers(mOptions.workerCount);
+    }
+
+    GridSequenceStreamer::~GridSequenceStreamer()
+    {
+        terminateWorkers();
+    }
+
+    bool GridSequenceStreamer::update(uint32_t frame)
+    {
+        const uint32_t frameCount = (uint32_t)mFrameStates.size();
+        if (frameCount == 0) return false;
+        frame = std::min(frame, frameCount - 1);
+
+        bool changed = false;
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        // Make sure the current frame is converted. If it is not, playback stalls until it is.
+        FrameState& currentState = mFrameStates[frame];
+        if (currentState == FrameState::Evicted || currentState == FrameState::Queued || currentState == FrameState::Converting)
+        {
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            if (currentState == FrameState::Converting)
+            {
+                mFrameConverted.wait(lock, [&]() { return currentState == FrameState::Staged || currentState == FrameState::Failed; });
+            }
+            else
+            {
+                // Convert the frame on the calling thread instead of waiting for a worker to pick it up.
+                // Marking it as converting makes workers skip it if it is still in the queue.
+                currentState = FrameState::Converting;
+                lock.unlock();
+                bool staged = stageFrame(frame);
+                lock.lock();
+                currentState = staged ? FrameState::Staged : FrameState::Failed;
+                if (!staged) mStats.failedCount++;
+            }
+            mStats.stallCount++;
+            mStats.stallTimeMs += CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        }
+
+        // Upload converted frames in the window, closest to the current frame first, and evict frames outside the window.
+        uint32_t uploadCount = 0;
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            const uint32_t f = (frame + i) % frameCount;
+            FrameState& state = mFrameStates[f];
+            if (isInWindow(f, frame))
+            {
+                if (state == FrameState::Staged && (f == frame || uploadCount < mOptions.maxUploadsPerUpdate))
+                {
+                    createFrame(f);
+                    state = FrameState::Resident;
+                    if (f != frame) uploadCount++;
+                    mStats.uploadCount++;
+                    changed = true;
+                }
+            }
+            else if (state == FrameState::Staged || state == FrameState::Resident)
+            {
+                if (state == FrameState::Resident)
+                {
+                    mStats.evictionCount++;
+                    changed = true;
+                }
+                releaseFrame(f);
+                state = FrameState::Evicted;
+            }
+            else if (state == FrameState::Queued || state == FrameState::Failed)
+            {
+                state = FrameState::Evicted;
+            }
+        }
+
+        // Queue the frames in the window that are not converted yet, closest to the current frame first.
+        // Frames behind the current frame are only needed when scrubbing backwards, so they come last.
+        mQueue.clear();
+        auto enqueue = [&](uint32_t f)
+        {
+            FrameState& state = mFrameStates[f];
+            if (state == FrameState::Evicted || state == FrameState::Queued)
+            {
+                state = FrameState::Queued;
+                mQueue.push_back(f);
+            }
+        };
+        for (uint32_t i = 1; i <= std::min(mOptions.lookAheadFrames, frameCount - 1); ++i) enqueue((frame + i) % frameCount);
+        for (uint32_t i = 1; i <= std::min(mOptions.lookBehindFrames, frameCount - 1); ++i) enqueue((frame + frameCount - i) % frameCount);
+
+        updateStats();
+        lock.unlock();
+        mCondition.notify_all();
+
+        return changed;
+    }
+
+    void GridSequenceStreamer::renderUI(Gui::Widgets& widget)
+    {
+        Options options = mOptions;
+        bool changed = false;
+        changed |= widget.var("Look-ahead frames", options.lookAheadFrames, 0u, std::numeric_limits<uint32_t>::max(), 1u);
+        widget.tooltip("Number of frames after the current frame to keep resident.");
+        changed |= widget.var("Look-behind frames", options.lookBehindFrames, 0u, std::numeric_limits<uint32_t>::max(), 1u);
+        widget.tooltip("Number of frames before the current frame to keep resident.");
+        changed |= widget.var("Max uploads per update", options.maxUploadsPerUpdate, 0u, std::numeric_limits<uint32_t>::max(), 1u);
+        changed |= widget.var("Worker count", options.workerCount, 1u, kMaxWorkerCount, 1u);
+        if (changed) setOptions(options);
+
+        std::ostringstream oss;
+        oss << "Resident frames: " << mStats.residentFrameCount << std::endl
+            << "Resident memory: " << formatByteSize(mStats.residentMemoryInBytes) << std::endl
+            << "Staged frames: " << mStats.stagedFrameCount << std::endl
+            << "Staged memory: " << formatByteSize(mStats.stagedMemoryInBytes) << std::endl
+            << "Uploads: " << mStats.uploadCount << std::endl
+            << "Evictions: " << mStats.evictionCount << std::endl
+            << "Failed frames: " << mStats.failedCount << std::endl
+            << "Stalls: " << mStats.stallCount << " (" << std::fixed << std::setprecision(2) << mStats.stallTimeMs << " ms)" << std::endl;
+        widget.text(oss.str());
+    }
+
+    void GridSequenceStreamer::setOptions(const Options& options)
+    {
+        const uint32_t workerCount = clamp(options.workerCount, 1u, kMaxWorkerCount);
+        if (workerCount != mOptions.workerCount)
+        {
+            terminateWorkers();
+            runWorkers(workerCount);
+        }
+        mOptions = options;
+        mOptions.workerCount = workerCount;
+    }
+
+    void GridSequenceStreamer::runWorkers(uint32_t workerCount)
+    {
+        mTerminate = false;
+        for (uint32_t i = 0; i < workerCount; ++i)
+        {
+            mThreads.emplace_back(&GridSequenceStreamer::runWorker, this);
+        }
+    }
+
+    void GridSequenceStreamer::runWorker()
+    {
+        // This function is the entry point for worker threads.
+        // The workers wait on the queue and convert the next frame when woken up.
+        // Uploading converted frames is left to the main thread.
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [&]() { return mTerminate || !mQueue.empty(); });
+
+            if (mTerminate) break;
+
+            // Frames that left the window or were converted by the main thread are skipped.
+            uint32_t frame = mQueue.front();
+            mQueue.pop_front();
+            if (mFrameStates[frame] != FrameState::Queued) continue;
+            mFrameStates[frame] = FrameState::Converting;
+
+            lock.unlock();
+
+            // Convert the frame (this part is running in parallel).
+            bool staged = stageFrame(frame);
+
+            lock.lock();
+
+            mFrameStates[frame] = staged ? FrameState::Staged : FrameState::Failed;
+            if (!staged) mStats.failedCount++;
+            mFrameConverted.notify_all();
+        }
+    }
+
+    void GridSequenceStreamer::terminateWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+        mThreads.clear();
+    }
+
+    bool GridSequenceStreamer::isInWindow(uint32_t frame, uint32_t currentFrame) const
+    {
+        const uint32_t frameCount = (uint32_t)mFrameStates.size();
+        const uint32_t distanceAhead = (frame + frameCount - currentFrame) % frameCount;
+        const uint32_t distanceBehind = (currentFrame + frameCount - frame) % frameCount;
+        return distanceAhead <= mOptions.lookAheadFrames || distanceBehind <= mOptions.lookBehindFrames;
+    }
+
+    bool GridSequenceStreamer::stageFrame(uint32_t frame)
+    {
+        try
+        {
+            for (const auto& pGrid : mFrameGrids[frame]) pGrid->stageDeviceData();
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to convert frame {} of grid sequence: {}", frame, e.what());
+            releaseFrame(frame);
+            return false;
+        }
+    }
+
+    void GridSequenceStreamer::createFrame(uint32_t frame)
+    {
+        for (const auto& pGrid : mFrameGrids[frame]) pGrid->createDeviceData();
+    }
+
+    void GridSequenceStreamer::releaseFrame(uint32_t frame)
+    {
+        for (const auto& pGrid : mFrameGrids[frame]) pGrid->releaseDeviceData();
+    }
+
+    void GridSequenceStreamer::updateStats()
+    {
+        mStats.residentFrameCount = 0;
+        mStats.stagedFrameCount = 0;
+        mStats.residentMemoryInBytes = 0;
+        mStats.stagedMemoryInBytes = 0;
+
+        for (const auto& pGrid : mPinnedGrids) mStats.residentMemoryInBytes += pGrid->getGridSizeInBytes();
+        for (uint32_t frame = 0; frame < (uint32_t)mFrameStates.size(); ++frame)
+        {
+            if (mFrameStates[frame] == FrameState::Resident)
+            {
+                mStats.residentFrameCount++;
+                for (const auto& pGrid : mFrameGrids[frame]) mStats.residentMemoryInBytes += pGrid->getGridSizeInBytes();
+            }
+            else if (mFrameStates[frame] == FrameState::Staged)
+            {
+                mStats.stagedFrameCount++;
+                for (const auto& pGrid : mFrameGrids[frame]) mStats.stagedMemoryInBytes += pGrid->getStagedSizeInBytes();
+            }
+        }
+    }
+
+    pybind11::dict GridSequenceStreamer::Stats::toPython() const
+    {
+        pybind11::dict d;
+        d["residentFrameCount"] = residentFrameCount;
+        d["stagedFrameCount"] = stagedFrameCount;
+        d["residentMemoryInBytes"] = residentMemoryInBytes;
+        d["stagedMemoryInBytes"] = stagedMemoryInBytes;
+        d["uploadCount"] = uploadCount;
+        d["evictionCount"] = evictionCount;
+        d["failedCount"] = failedCount;
+        d["stallCount"] = stallCount;
+        d["stallTimeMs"] = stallTimeMs;
+        return d;
+    }
+
+    FALCOR_SCRIPT_BINDING(GridSequenceStreamer)
+    {
+        using Options = GridSequenceStreamer::Options;
+        pybind11::class_<Options> options(m, "GridSequenceStreamerOptions");
+        options.def(pybind11::init<>());
+        options.def_readwrite("lookAheadFrames", &Options::lookAheadFrames);
+        options.def_readwrite("lookBehindFrames", &Options::lookBehindFrames);
+        options.def_readwrite("maxUploadsPerUpdate", &Options::maxUploadsPerUpdate);
+        options.def_readwrite("workerCount", &Options::workerCount);
+    }
+}
@@ -0,0 +1,154 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Grid.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+    /** Streams the device data of grid sequences during playback.
+        Only the frames in a window around the current frame are kept resident in GPU memory.
+        Frames ahead of the current frame are converted to bricks by worker threads and uploaded on the main thread
+        once they are ready, and frames that move out of the window are evicted.
+        Playback is assumed to loop, so the window wraps around at the end of the sequence.
+        Grids that are used by more than one frame are made resident once and never evicted.
+        Frames that fail to convert are skipped, i.e. their grids are not resident, until they move out of the window.
+    */
+    class FALCOR_API GridSequenceStreamer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GridSequenceStreamer>;
+        using GridSequence = std::vector<Grid::SharedPtr>;
+
+        /** Streaming options.
+        */
+        struct Options
+        {
+            uint32_t lookAheadFrames = 8;       ///< Number of frames after the current frame to keep resident.
+            uint32_t lookBehindFrames = 1;      ///< Number of frames before the current frame to keep resident.
+            uint32_t maxUploadsPerUpdate = 2;   ///< Maximum number of converted frames to upload per update, in addition to the current frame.
+            uint32_t workerCount = 2;           ///< Number of worker threads converting frames.
+        };
+
+        /** Streaming statistics.
+        */
+        struct Stats
+        {
+            uint32_t residentFrameCount = 0;    ///< Number of frames resident in GPU memory.
+            uint32_t stagedFrameCount = 0;      ///< Number of frames converted and waiting to be uploaded.
+            uint64_t residentMemoryInBytes = 0; ///< GPU memory used by resident grids.
+            uint64_t stagedMemoryInBytes = 0;   ///< Host memory used by converted frames waiting to be uploaded.
+            uint64_t uploadCount = 0;           ///< Total number of frames uploaded.
+            uint64_t evictionCount = 0;         ///< Total number of frames evicted.
+            uint64_t failedCount = 0;           ///< Total number of frames that failed to convert.
+            uint64_t stallCount = 0;            ///< Number of updates that had to wait for the current frame.
+            double stallTimeMs = 0.0;           ///< Total time spent waiting for the current frame in milliseconds.
+
+            pybind11::dict toPython() const;
+        };
+
+        /** Create a grid sequence streamer.
+            \param[in] sequences Grid sequences to stream. Frame i uses grid min(i, size - 1) of each sequence, matching GridVolume::getGrid().
+            \param[in] options Streaming options.
+            \return A new object.
+        */
+        static SharedPtr create(const std::vector<GridSequence>& sequences, const Options& options = Options());
+
+        /** Destructor.
+            Blocks until all worker threads have terminated.
+        */
+        ~GridSequenceStreamer();
+
+        /** Set the current frame.
+            This makes the current frame resident, blocking if it has not been converted yet, uploads frames
+            that have been converted since the last update, evicts frames outside the window and schedules
+            the remaining frames in the window for conversion. Should be called once per frame during playback.
+            \param[in] frame Current frame.
+            \return True if any grid was made resident or evicted, i.e. the grids need to be rebound.
+        */
+        bool update(uint32_t frame);
+
+        /** Render the UI.
+        */
+        void renderUI(Gui::Widgets& widget);
+
+        /** Set the streaming options.
+            Changing the number of workers waits for conversions in flight to finish.
+        */
+        void setOptions(const Options& options);
+
+        /** Get the streaming options.
+        */
+        const Options& getOptions() const { return mOptions; }
+
+        /** Get the streaming statistics.
+        */
+        const Stats& getStats() const { return mStats; }
+
+    private:
+        GridSequenceStreamer(const std::vector<GridSequence>& sequences, const Options& options);
+
+        enum class FrameState
+        {
+            Evicted,    ///< Device data is not resident.
+            Queued,     ///< Frame is queued for conversion.
+            Converting, ///< Frame is being converted.
+            Staged,     ///< Frame is converted and waiting to be uploaded.
+            Resident,   ///< Device data is resident.
+            Failed,     ///< Frame failed to convert. It is retried once it has moved out of the window.
+        };
+
+        void runWorkers(uint32_t workerCount);
+        void runWorker();
+        void terminateWorkers();
+
+        bool isInWindow(uint32_t frame, uint32_t currentFrame) const;
+        bool stageFrame(uint32_t frame);
+        void createFrame(uint32_t frame);
+        void releaseFrame(uint32_t frame);
+        void updateStats();
+
+        std::vector<std::vector<Grid::SharedPtr>> mFrameGrids;  ///< Streamed grids used by each frame.
+        std::vector<Grid::SharedPtr> mPinnedGrids;              ///< Grids used by more than one frame, which are always resident.
+        Options mOptions;
+        Stats mStats;
+
+        std::mutex mMutex;                          ///< Mutex for synchronizing access to shared state.
+        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
+        std::condition_variable mFrameConverted;    ///< Condition variable for waiting on a frame conversion to finish.
+        std::vector<std::thread> mThreads;          ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::vector<FrameState> mFrameStates;       ///< State of each frame.
+        std::deque<uint32_t> mQueue;                ///< Frames to convert, in order of priority.
+        bool mTerminate = false;                    ///< Flag to terminate worker threads.
+    };
+}
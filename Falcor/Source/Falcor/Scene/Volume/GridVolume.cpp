@@ -78,6 +78,15 @@ namespace Falcor
             if (widget.checkbox("Playback", playback)) setPlaybackEnabled(playback);
         }
 
+        if (mpStreamer)
+        {
+            if (auto group = widget.group("Streaming"))
+            {
+                mpStreamer->renderUI(group);
+                mStreamingOptions = mpStreamer->getOptions();
+            }
+        }
+
         if (const auto& densityGrid = getDensityGrid())
         {
             if (auto group = widget.group("Density Grid")) densityGrid->renderUI(group);
@@ -123,19 +132,19 @@ namespace Falcor
         return grid != nullptr;
     }
 
-    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::vector<std::string>& filenames, const std::string& gridname, bool keepEmpty)
+    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::vector<std::string>& filenames, const std::string& gridname, bool keepEmpty, bool streaming)
     {
         GridSequence grids;
         for (const auto& filename : filenames)
         {
-            auto grid = Grid::createFromFile(filename, gridname);
+            auto grid = streaming ? Grid::createStreamedFromFile(filename, gridname) : Grid::createFromFile(filename, gridname);
             if (keepEmpty || grid) grids.push_back(grid);
         }
         setGridSequence(slot, grids);
         return (uint32_t)grids.size();
     }
 
-    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::string& path, const std::string& gridname, bool keepEmpty)
+    uint32_t GridVolume::loadGridSequence(GridSlot slot, const std::string& path, const std::string& gridname, bool keepEmpty, bool streaming)
     {
         std::string fullpath;
         if (!findFileInDataDirectories(path, fullpath))
@@ -160,7 +169,7 @@ namespace Falcor
         auto cmp = [](const std::string& a, const std::string& b) { return a.length() != b.length() ? a.length() < b.length() : a < b; };
         std::sort(files.begin(), files.end(), cmp);
 
-        return loadGridSequence(slot, files, gridname, keepEmpty);
+        return loadGridSequence(slot, files, gridname, keepEmpty, streaming);
     }
 
     void GridVolume::setGridSequence(GridSlot slot, const GridSequence& grids)
@@ -171,6 +180,7 @@ namespace Falcor
         if (mGrids[slotIndex] != grids)
         {
             mGrids[slotIndex] = grids;
+            updateStreamer();
             updateSequence();
             updateBounds();
             markUpdates(UpdateFlags::GridsChanged);
@@ -217,6 +227,7 @@ namespace Falcor
         if (mGridFrame != gridFrame)
         {
             mGridFrame = gridFrame;
+            if (mpStreamer) mpStreamer->update(mGridFrame);
             markUpdates(UpdateFlags::GridsChanged);
             updateBounds();
         }
@@ -240,6 +251,20 @@ namespace Falcor
             uint32_t frameIndex = (uint32_t)std::floor(std::max(0.0, currentTime) * mFrameRate) % frameCount;
             setGridFrame(frameIndex);
         }
+
+        // Upload frames converted in the background and evict frames that playback has moved past.
+        if (mpStreamer && mpStreamer->update(mGridFrame)) markUpdates(UpdateFlags::GridsChanged);
+    }
+
+    void GridVolume::setStreamingOptions(const GridSequenceStreamer::Options& options)
+    {
+        mStreamingOptions = options;
+        if (mpStreamer) mpStreamer->setOptions(options);
+    }
+
+    GridSequenceStreamer::Stats GridVolume::getStreamingStats() const
+    {
+        return mpStreamer ? mpStreamer->getStats() : GridSequenceStreamer::Stats();
     }
 
     void GridVolume::setDensityScale(float densityScale)
@@ -321,6 +346,24 @@ namespace Falcor
         setGridFrame(std::min(mGridFrame, mGridFrameCount - 1));
     }
 
+    void GridVolume::updateStreamer()
+    {
+        // Grids that were created without device data are streamed. Keep streaming once enabled, as evicted grids are not resident either.
+        bool streaming = mpStreamer != nullptr;
+        for (const auto& grids : mGrids)
+        {
+            streaming |= std::any_of(grids.begin(), grids.end(), [](const auto& grid) { return grid && !grid->isResident(); });
+        }
+
+        // Release the previous streamer first so that its workers are done with the grids before a new streamer takes over.
+        mpStreamer = nullptr;
+        if (streaming)
+        {
+            mpStreamer = GridSequenceStreamer::create(std::vector<GridSequence>(mGrids.begin(), mGrids.end()), mStreamingOptions);
+            mpStreamer->update(mGridFrame);
+        }
+    }
+
     void GridVolume::updateBounds()
     {
         AABB bounds;
@@ -358,6 +401,7 @@ namespace Falcor
     {
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Animatable)
         FALCOR_SCRIPT_BINDING_DEPENDENCY(Grid)
+        FALCOR_SCRIPT_BINDING_DEPENDENCY(GridSequenceStreamer)
 
         pybind11::class_<GridVolume, Animatable, GridVolume::SharedPtr> volume(m, "GridVolume");
         volume.def_property("name", &GridVolume::getName, &GridVolume::setName);
@@ -365,6 +409,9 @@ namespace Falcor
         volume.def_property_readonly("gridFrameCount", &GridVolume::getGridFrameCount);
         volume.def_property("frameRate", &GridVolume::getFrameRate, &GridVolume::setFrameRate);
         volume.def_property("playbackEnabled", &GridVolume::isPlaybackEnabled, &GridVolume::setPlaybackEnabled);
+        volume.def_property_readonly("streaming", &GridVolume::isStreaming);
+        volume.def_property("streamingOptions", &GridVolume::getStreamingOptions, &GridVolume::setStreamingOptions);
+        volume.def_property_readonly("streamingStats", [](const GridVolume* pVolume) { return pVolume->getStreamingStats().toPython(); });
         volume.def_property("densityGrid", &GridVolume::getDensityGrid, &GridVolume::setDensityGrid);
         volume.def_property("densityScale", &GridVolume::getDensityScale, &GridVolume::setDensityScale);
         volume.def_property("emissionGrid", &GridVolume::getEmissionGrid, &GridVolume::setEmissionGrid);
@@ -376,11 +423,11 @@ namespace Falcor
         volume.def(pybind11::init(&GridVolume::create), "name"_a);
         volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "filename"_a, "gridname"_a);
         volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::string>&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "filenames"_a, "gridname"_a, "keepEmpty"_a = true);
+            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::string>&, const std::string&, bool, bool>(&GridVolume::loadGridSequence),
+            "slot"_a, "filenames"_a, "gridname"_a, "keepEmpty"_a = true, "streaming"_a = false);
         volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::string&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+            pybind11::overload_cast<GridVolume::GridSlot, const std::string&, const std::string&, bool, bool>(&GridVolume::loadGridSequence),
+            "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true, "streaming"_a = false);
 
         pybind11::enum_<GridVolume::GridSlot> gridSlot(volume, "GridSlot");
         gridSlot.value("Density", GridVolume::GridSlot::Density);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Grid.h"
+#include "GridSequenceStreamer.h"
 #include "GridVolumeData.slang"
 #include "Scene/Animation/Animatable.h"
 
@@ -115,9 +116,10 @@ namespace Falcor
             \param[in] filenames Filenames of the grids. Can also include a full path or relative path from a data directory.
             \param[in] gridname Name of the grid to load.
             \param[in] keepEmpty Add empty (nullptr) grids to the sequence if one cannot be loaded from the file.
+            \param[in] streaming Stream the grids during playback instead of keeping all frames resident (see GridSequenceStreamer).
             \return Returns the length of the loaded sequence.
         */
-        uint32_t loadGridSequence(GridSlot slot, const std::vector<std::string>& filenames, const std::string& gridname, bool keepEmpty = true);
+        uint32_t loadGridSequence(GridSlot slot, const std::vector<std::string>& filenames, const std::string& gridname, bool keepEmpty = true, bool streaming = false);
 
         /** Load a sequence of grids from a directory to a grid slot.
             Note: This will replace any existing grid sequence for that slot.
@@ -125,9 +127,10 @@ namespace Falcor
             \param[in] path Directory containing grid files. Can also include a full path or relative path from a data directory.
             \param[in] gridname Name of the grid to load.
             \param[in] keepEmpty Add empty (nullptr) grids to the sequence if one cannot be loaded from the file.
+            \param[in] streaming Stream the grids during playback instead of keeping all frames resident (see GridSequenceStreamer).
             \return Returns the length of the loaded sequence.
         */
-        uint32_t loadGridSequence(GridSlot slot, const std::string& path, const std::string& gridname, bool keepEmpty = true);
+        uint32_t loadGridSequence(GridSlot slot, const std::string& path, const std::string& gridname, bool keepEmpty = true, bool streaming = false);
 
         /** Set the grid sequence for the specified slot.
         */
@@ -180,9 +183,27 @@ namespace Falcor
         bool isPlaybackEnabled() const { return mPlaybackEnabled; }
 
         /** Update the selected grid frame based on global time in seconds.
+            This also advances streaming if the grids are streamed.
         */
         void updatePlayback(double curentTime);
 
+        /** Check if the grids are streamed during playback.
+            Streaming is enabled when grids without device data are assigned to the volume, e.g. using loadGridSequence() with streaming enabled.
+        */
+        bool isStreaming() const { return mpStreamer != nullptr; }
+
+        /** Set the options used for streaming grids.
+        */
+        void setStreamingOptions(const GridSequenceStreamer::Options& options);
+
+        /** Get the options used for streaming grids.
+        */
+        const GridSequenceStreamer::Options& getStreamingOptions() const { return mStreamingOptions; }
+
+        /** Get the streaming statistics. Returns zero statistics if the grids are not streamed.
+        */
+        GridSequenceStreamer::Stats getStreamingStats() const;
+
         /** Set the density grid.
         */
         void setDensityGrid(const Grid::SharedPtr& densityGrid) { setGrid(GridSlot::Density, densityGrid); };
@@ -261,6 +282,7 @@ namespace Falcor
         GridVolume(const std::string& name);
 
         void updateSequence();
+        void updateStreamer();
         void updateBounds();
 
         void markUpdates(UpdateFlags updates);
@@ -272,6 +294,8 @@ namespace Falcor
         uint32_t mGridFrameCount = 1;
         double mFrameRate = 30.f;
         bool mPlaybackEnabled = false;
+        GridSequenceStreamer::Options mStreamingOptions;
+        GridSequenceStreamer::SharedPtr mpStreamer;
         AABB mBounds;
         GridVolumeData mData;
         mutable UpdateFlags mUpdates = UpdateFlags::None;
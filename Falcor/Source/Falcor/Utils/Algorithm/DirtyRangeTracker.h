@@ -0,0 +1,157 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <algorithm>
+#include <vector>
+
+namespace Falcor
+{
+    /** Utility class for tracking dirty byte ranges of a buffer.
+
+        Ranges are recorded with markDirty() and coalesced into a sorted list
+        of disjoint ranges by getRanges(). Overlapping and adjacent ranges are
+        always merged. Optionally, ranges separated by a gap of at most
+        the merge gap are merged as well, which trades a few redundant bytes
+        for fewer copy commands. This is only valid if the source data in the
+        gaps is up-to-date.
+
+        The common pattern of marking consecutive elements in increasing order
+        is handled in O(1) per call by extending the last recorded range.
+    */
+    class DirtyRangeTracker
+    {
+    public:
+        struct Range
+        {
+            size_t offset = 0;      ///< Start of the range in bytes.
+            size_t size = 0;        ///< Size of the range in bytes.
+
+            size_t end() const { return offset + size; }
+            bool operator==(const Range& other) const { return offset == other.offset && size == other.size; }
+        };
+
+        /** Constructor.
+            \param[in] mergeGap Ranges separated by at most this many bytes are merged.
+        */
+        explicit DirtyRangeTracker(size_t mergeGap = 0) : mMergeGap(mergeGap) {}
+
+        /** Set the largest gap in bytes between two ranges that are merged into one.
+        */
+        void setMergeGap(size_t mergeGap)
+        {
+            if (mergeGap != mMergeGap) mCoalesced = false;
+            mMergeGap = mergeGap;
+        }
+
+        size_t getMergeGap() const { return mMergeGap; }
+
+        /** Mark a byte range as dirty.
+            \param[in] offset Start of the range in bytes.
+            \param[in] size Size of the range in bytes. Empty ranges are ignored.
+        */
+        void markDirty(size_t offset, size_t size)
+        {
+            if (size == 0) return;
+
+            if (!mRanges.empty())
+            {
+                Range& last = mRanges.back();
+                if (offset >= last.offset && offset <= last.end())
+                {
+                    last.size = std::max(last.end(), offset + size) - last.offset;
+                    mCoalesced = false;
+                    return;
+                }
+                if (offset < last.offset) mSorted = false;
+            }
+            mRanges.push_back({ offset, size });
+            mCoalesced = false;
+        }
+
+        /** Returns true if any range has been marked dirty since the last call to clear().
+        */
+        bool isDirty() const { return !mRanges.empty(); }
+
+        /** Get the coalesced list of dirty ranges, sorted by offset.
+            \return List of disjoint ranges.
+        */
+        const std::vector<Range>& getRanges()
+        {
+            if (mCoalesced) return mRanges;
+
+            if (!mSorted)
+            {
+                std::sort(mRanges.begin(), mRanges.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+                mSorted = true;
+            }
+
+            size_t dst = 0;
+            for (size_t i = 1; i < mRanges.size(); i++)
+            {
+                Range& cur = mRanges[dst];
+                const Range& next = mRanges[i];
+                if (next.offset <= cur.end() + mMergeGap)
+                {
+                    cur.size = std::max(cur.end(), next.end()) - cur.offset;
+                }
+                else
+                {
+                    mRanges[++dst] = next;
+                }
+            }
+            if (!mRanges.empty()) mRanges.resize(dst + 1);
+
+            mCoalesced = true;
+            return mRanges;
+        }
+
+        /** Get the total number of dirty bytes after coalescing.
+        */
+        size_t getDirtyByteCount()
+        {
+            size_t bytes = 0;
+            for (const auto& r : getRanges()) bytes += r.size;
+            return bytes;
+        }
+
+        /** Clear all dirty ranges.
+        */
+        void clear()
+        {
+            mRanges.clear();
+            mSorted = true;
+            mCoalesced = true;
+        }
+
+    private:
+        std::vector<Range> mRanges;
+        bool mSorted = true;        ///< True if mRanges is sorted by offset.
+        bool mCoalesced = true;     ///< True if mRanges is sorted and coalesced.
+        size_t mMergeGap = 0;       ///< Largest gap in bytes between ranges that are merged.
+    };
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "CacheFiles.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kTempSuffix = ".tmp";
+        const uint32_t kMaxTempFileAttempts = 16;
+        const auto kStaleTempFileAge = std::chrono::hours(24);
+
+        bool isTempFile(const std::filesystem::path& path)
+        {
+            return path.stem().extension() == kTempSuffix || path.extension() == kTempSuffix;
+        }
+    }
+
+    std::filesystem::path createCacheTempFile(const std::filesystem::path& cachePath)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+        thread_local std::mt19937_64 rng(std::random_device{}() ^ std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        for (uint32_t i = 0; i < kMaxTempFileAttempts; i++)
+        {
+            std::filesystem::path tempPath = cachePath;
+            tempPath.replace_extension(fmt::format(".{:016x}{}{}", rng(), kTempSuffix, cachePath.extension().string()));
+
+            // The 'x' mode fails if the file exists, so each temporary file has a single writer.
+            if (FILE* pFile = std::fopen(tempPath.string().c_str(), "wbx"))
+            {
+                std::fclose(pFile);
+                return tempPath;
+            }
+        }
+
+        logWarning("Failed to create a temporary file for cache file '{}'.", cachePath.string());
+        return {};
+    }
+
+    bool commitCacheFile(const std::filesystem::path& tempPath, const std::filesystem::path& cachePath)
+    {
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tempPath, ec);
+            return std::filesystem::exists(cachePath, ec);
+        }
+        return true;
+    }
+
+    void touchCacheFile(const std::filesystem::path& cachePath)
+    {
+        std::error_code ec;
+        std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), ec);
+    }
+
+    void trimCacheDirectory(const std::filesystem::path& directory, uint64_t maxSizeInBytes)
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            uint64_t size;
+        };
+
+        std::error_code ec;
+        const auto now = std::filesystem::file_time_type::clock::now();
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        for (const auto& dirEntry : std::filesystem::directory_iterator(directory, ec))
+        {
+            if (!dirEntry.is_regular_file(ec)) continue;
+
+            Entry entry{ dirEntry.path(), dirEntry.last_write_time(ec), dirEntry.file_size(ec) };
+            if (ec) continue;
+
+            if (isTempFile(entry.path))
+            {
+                if (now - entry.time > kStaleTempFileAge) std::filesystem::remove(entry.path, ec);
+                continue;
+            }
+
+            totalSize += entry.size;
+            entries.push_back(std::move(entry));
+        }
+
+        if (maxSizeInBytes == 0 || totalSize <= maxSizeInBytes) return;
+
+        // Remove the least recently used files first. Files that can't be removed, e.g. because they are open in another process, are skipped.
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= maxSizeInBytes) break;
+            if (std::filesystem::remove(entry.path, ec)) totalSize -= entry.size;
+        }
+    }
+}
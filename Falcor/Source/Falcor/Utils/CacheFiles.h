@@ -0,0 +1,68 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Helpers for persistent caches stored as individual files in a cache directory.
+
+        Cache files are written atomically: the data is written to a temporary file with a unique name,
+        created exclusively, which is then renamed to the cache path. Concurrently running threads or
+        processes that miss the same entry therefore never write to the same file and never read a
+        partially written one. The size of a cache directory is bounded by removing the least recently
+        used files, where using a cache file means writing it or calling touchCacheFile().
+    */
+
+    /** Create a new, empty temporary file next to a cache file.
+        The file name is unique and the file is created exclusively, so no other thread or process writes to it.
+        The extension of the cache path is kept, so that e.g. "<hash>.dds" is written to "<hash>.<suffix>.tmp.dds".
+        \param[in] cachePath Path of the cache file. The cache directory is created if needed.
+        \return Path of the temporary file, or an empty path if it could not be created.
+    */
+    FALCOR_API std::filesystem::path createCacheTempFile(const std::filesystem::path& cachePath);
+
+    /** Move a fully written temporary file to its cache path. The temporary file is removed on failure.
+        \param[in] tempPath Path returned by createCacheTempFile().
+        \param[in] cachePath Path of the cache file.
+        \return True if the cache file exists afterwards, either written by this call or by another writer.
+    */
+    FALCOR_API bool commitCacheFile(const std::filesystem::path& tempPath, const std::filesystem::path& cachePath);
+
+    /** Mark a cache file as recently used, so that trimCacheDirectory() keeps it.
+        \param[in] cachePath Path of the cache file.
+    */
+    FALCOR_API void touchCacheFile(const std::filesystem::path& cachePath);
+
+    /** Limit the size of a cache directory by removing the least recently used files.
+        Temporary files are not counted, and are removed once they are older than a day, as their writer has likely been terminated.
+        \param[in] directory The cache directory.
+        \param[in] maxSizeInBytes Maximum total size of the cache files. Zero disables the limit.
+    */
+    FALCOR_API void trimCacheDirectory(const std::filesystem::path& directory, uint64_t maxSizeInBytes);
+}
@@ -27,13 +27,60 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "AsyncTextureLoader.h"
-#include "Utils/Threading.h"
 
 namespace Falcor
 {
     namespace
     {
         constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+        constexpr bool kTopDown = true; ///< Memory layout when loading from file.
+        const std::string kTraceEventName = "loadTexture"; ///< Name of the profiler trace events following a load request across threads.
+
+        /** Create a low-resolution preview of an image by point sampling every n:th texel.
+            \return Preview image, or nullptr if the image is already small enough or its format is not supported.
+        */
+        Bitmap::UniqueConstPtr createPreview(const Bitmap& bitmap, uint32_t maxDimension)
+        {
+            const ResourceFormat format = bitmap.getFormat();
+            if (maxDimension == 0 || isCompressedFormat(format)) return nullptr;
+
+            const uint32_t width = bitmap.getWidth();
+            const uint32_t height = bitmap.getHeight();
+            uint32_t step = 1;
+            while (std::max(width, height) > (uint64_t)maxDimension * step) step *= 2;
+            if (step == 1) return nullptr;
+
+            const uint32_t previewWidth = std::max(width / step, 1u);
+            const uint32_t previewHeight = std::max(height / step, 1u);
+            const size_t texelSize = getFormatBytesPerBlock(format);
+
+            std::vector<uint8_t> data(previewWidth * previewHeight * texelSize);
+            for (uint32_t y = 0; y < previewHeight; y++)
+            {
+                const uint8_t* pSrcRow = bitmap.getData() + (size_t)y * step * bitmap.getRowPitch();
+                uint8_t* pDstRow = data.data() + (size_t)y * previewWidth * texelSize;
+                for (uint32_t x = 0; x < previewWidth; x++)
+                {
+                    std::memcpy(pDstRow + x * texelSize, pSrcRow + (size_t)x * step * texelSize, texelSize);
+                }
+            }
+
+            return Bitmap::create(previewWidth, previewHeight, format, data.data());
+        }
+
+        Texture::SharedPtr createTextureFromBitmap(const Bitmap& bitmap, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags)
+        {
+            ResourceFormat format = bitmap.getFormat();
+            if (loadAsSRGB) format = linearToSrgbFormat(format);
+            return Texture::create2D(bitmap.getWidth(), bitmap.getHeight(), format, 1, generateMipLevels ? Texture::kMaxPossible : 1, bitmap.getData(), bindFlags);
+        }
+
+        Texture::SharedPtr createTextureFromMipChain(const ImageIO::MipChain& mipChain, bool loadAsSRGB, Resource::BindFlags bindFlags)
+        {
+            ResourceFormat format = mipChain.format;
+            if (loadAsSRGB) format = linearToSrgbFormat(format);
+            return Texture::create2D(mipChain.width, mipChain.height, format, 1, mipChain.mipLevels, mipChain.data.data(), bindFlags);
+        }
     }
 
     AsyncTextureLoader::AsyncTextureLoader(size_t threadCount)
@@ -45,99 +92,300 @@ namespace Falcor
     {
         terminateWorkers();
 
+        // Complete the requests staged before the workers terminated.
+        uploadStagedTextures();
+
         gpDevice->flushAndSync();
     }
 
-    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback)
+    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback, const LoadOptions& options, RequestID* pRequestID)
     {
         std::lock_guard<std::mutex> lock(mMutex);
-        mLoadRequestQueue.push(LoadRequest{filename, generateMipLevels, loadAsSrgb, bindFlags, callback });
+        RequestID id = mNextRequestID++;
+        auto& request = mPendingRequests[id] = LoadRequest{ id, filename, generateMipLevels, loadAsSrgb, bindFlags, callback, options };
+        mLoadRequestQueue.insert(QueueEntry{ options.priority, id });
         mCondition.notify_one();
-        return mLoadRequestQueue.back().promise.get_future();
+        if (pRequestID) *pRequestID = id;
+        Profiler::instance().startAsyncEvent(kTraceEventName, id);
+        Profiler::instance().startFlow(kTraceEventName, id);
+        return request.promise.get_future();
+    }
+
+    bool AsyncTextureLoader::setPriority(RequestID requestID, float priority)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mPendingRequests.find(requestID);
+        if (it == mPendingRequests.end()) return false;
+
+        LoadRequest& request = it->second;
+        mLoadRequestQueue.erase(QueueEntry{ request.options.priority, requestID });
+        request.options.priority = priority;
+        mLoadRequestQueue.insert(QueueEntry{ priority, requestID });
+        return true;
+    }
+
+    bool AsyncTextureLoader::cancel(RequestID requestID)
+    {
+        LoadRequest request;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mPendingRequests.find(requestID);
+            if (it == mPendingRequests.end()) return false;
+
+            request = std::move(it->second);
+            mPendingRequests.erase(it);
+            mLoadRequestQueue.erase(QueueEntry{ request.options.priority, requestID });
+        }
+
+        // Complete the request outside the critical section, as the callback may issue new requests.
+        Profiler::instance().endAsyncEvent(kTraceEventName, requestID);
+        request.promise.set_value(nullptr);
+        if (request.callback) request.callback(nullptr);
+        return true;
+    }
+
+    size_t AsyncTextureLoader::getPendingRequestCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPendingRequests.size();
     }
 
     void AsyncTextureLoader::runWorkers(size_t threadCount)
     {
-        // Create a barrier to synchronize worker threads before issuing a global flush.
-        mFlushBarrier = std::make_shared<Barrier>(threadCount, [&]() {
-            gpDevice->flushAndSync();
-            mFlushPending = false;
-            mUploadCounter = 0;
-            });
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            mStagingQueues.push_back(std::make_unique<StagingQueue>());
+        }
 
         for (size_t i = 0; i < threadCount; ++i)
         {
-            mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
+            mThreads.emplace_back(&AsyncTextureLoader::runWorker, this, i);
         }
     }
 
-    void AsyncTextureLoader::runWorker()
+    void AsyncTextureLoader::runWorker(size_t workerIndex)
     {
         // This function is the entry point for worker threads.
-        // The workers wait on the load request queue and load a texture when woken up.
-        // To avoid the upload heap growing too large, we synchronize the threads and
-        // issue a global GPU flush at regular intervals.
+        // The workers wait on the load request queue and decode the highest priority texture when woken up.
+        // The decoded data is placed in the worker's staging queue, from where it is uploaded by uploadStagedTextures().
+
+        StagingQueue& stagingQueue = *mStagingQueues[workerIndex];
+        Profiler::instance().setThreadName("AsyncTextureLoader " + std::to_string(workerIndex));
 
         while (true)
         {
             // Wait on condition until more work is ready.
             std::unique_lock<std::mutex> lock(mMutex);
-            mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
-
-            // Sync thread if a flush is pending.
-            if (mFlushPending)
-            {
-                lock.unlock();
-                mFlushBarrier->wait();
-                mCondition.notify_one();
-                continue;
-            }
+            mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty(); });
 
             // Terminate thread unless there is more work to do.
-            if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending) break;
-
-            // Go back waiting if queue is currently empty.
-            if (mLoadRequestQueue.empty()) continue;
+            if (mLoadRequestQueue.empty()) break;
 
-            // Pop next load request from queue.
-            auto request = std::move(mLoadRequestQueue.front());
-            mLoadRequestQueue.pop();
+            // Pop highest priority load request from queue.
+            auto entryIt = mLoadRequestQueue.begin();
+            auto requestIt = mPendingRequests.find(entryIt->id);
+            FALCOR_ASSERT(requestIt != mPendingRequests.end());
+            LoadRequest request = std::move(requestIt->second);
+            mPendingRequests.erase(requestIt);
+            mLoadRequestQueue.erase(entryIt);
 
             lock.unlock();
 
-            // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(request.filename, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
-            request.promise.set_value(pTexture);
+            // Decode the texture (this part is running in parallel).
+            FALCOR_PROFILE("decodeTexture");
+            Profiler::instance().endFlow(kTraceEventName, request.id);
+            stageTexture(std::move(request), stagingQueue);
+        }
+    }
+
+    void AsyncTextureLoader::terminateWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+
+        // Complete requests that were never started (only possible without worker threads).
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto pendingRequests = std::move(mPendingRequests);
+        mLoadRequestQueue.clear();
+        lock.unlock();
+
+        for (auto& [id, request] : pendingRequests)
+        {
+            Profiler::instance().endAsyncEvent(kTraceEventName, id);
+            request.promise.set_value(nullptr);
+            if (request.callback) request.callback(nullptr);
+        }
+    }
+
+    void AsyncTextureLoader::stageTexture(LoadRequest&& request, StagingQueue& stagingQueue)
+    {
+        StagedTexture stagedTexture;
+        stagedTexture.request = std::move(request);
+        const LoadRequest& r = stagedTexture.request;
 
-            if (request.callback)
+        // Stages a preview right away, so that it can be uploaded while the full resolution data is loaded.
+        auto stagePreview = [&](StagedTexture&& preview)
+        {
+            preview.request.id = r.id;
+            preview.request.filename = r.filename;
+            preview.request.generateMipLevels = r.generateMipLevels;
+            preview.request.loadAsSRGB = r.loadAsSRGB;
+            preview.request.bindFlags = r.bindFlags;
+            preview.request.options = r.options;
+            preview.fullPath = stagedTexture.fullPath;
             {
-                request.callback(pTexture);
+                std::lock_guard<std::mutex> lock(stagingQueue.mutex);
+                stagingQueue.previews.push_back(std::move(preview));
             }
+            notifyStaged();
+        };
 
-            lock.lock();
-
-            // Issue a global flush if necessary.
-            // TODO: It would be better to check the size of the upload heap instead.
-            if (!mTerminate && pTexture != nullptr &&
-                ++mUploadCounter >= kUploadsPerFlush)
+        if (findFileInDataDirectories(r.filename, stagedTexture.fullPath) == false)
+        {
+            logWarning("Error when loading image file. Can't find image file '{}'.", r.filename);
+            stagedTexture.fullPath.clear();
+        }
+        else
+        {
+            const bool loadPreview = r.options.previewCallback && r.options.previewMaxDimension > 0;
+            try
             {
-                mFlushPending = true;
-                mCondition.notify_all();
+                if (hasSuffix(r.filename, ".dds"))
+                {
+                    // DDS files contain their mip levels, so the preview is read from the coarse levels without reading the rest of the file.
+                    StagedTexture preview;
+                    if (loadPreview && ImageIO::loadMipChainFromDDS(stagedTexture.fullPath, r.options.previewMaxDimension, preview.mipChain) && preview.mipChain.skippedMipLevels > 0)
+                    {
+                        stagePreview(std::move(preview));
+                    }
+                    ImageIO::loadMipChainFromDDS(stagedTexture.fullPath, std::numeric_limits<uint32_t>::max(), stagedTexture.mipChain);
+                }
+                else
+                {
+                    stagedTexture.pBitmap = Bitmap::createFromFile(stagedTexture.fullPath, kTopDown);
+                    if (stagedTexture.pBitmap && loadPreview)
+                    {
+                        StagedTexture preview;
+                        preview.pBitmap = createPreview(*stagedTexture.pBitmap, r.options.previewMaxDimension);
+                        if (preview.pBitmap) stagePreview(std::move(preview));
+                    }
+                }
             }
+            catch (const std::exception& e)
+            {
+                logWarning("Error when loading image file '{}': {}", r.filename, e.what());
+                stagedTexture.fullPath.clear();
+            }
+        }
 
-            mCondition.notify_one();
+        {
+            std::lock_guard<std::mutex> lock(stagingQueue.mutex);
+            stagingQueue.textures.push_back(std::move(stagedTexture));
         }
+        notifyStaged();
     }
 
-    void AsyncTextureLoader::terminateWorkers()
+    void AsyncTextureLoader::notifyStaged()
     {
         {
             std::lock_guard<std::mutex> lock(mMutex);
-            mTerminate = true;
+            mStagedCount++;
         }
+        mStagedCondition.notify_all();
+    }
 
-        mCondition.notify_all();
+    size_t AsyncTextureLoader::uploadStagedTextures(std::chrono::milliseconds timeout)
+    {
+        // Take the staged previews and textures of all workers.
+        std::vector<StagedTexture> previews;
+        std::vector<StagedTexture> textures;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (timeout.count() > 0) mStagedCondition.wait_for(lock, timeout, [&]() { return mStagedCount > 0; });
+            if (mStagedCount == 0) return 0;
 
-        for (auto& thread : mThreads) thread.join();
+            for (auto& pStagingQueue : mStagingQueues)
+            {
+                std::lock_guard<std::mutex> stagingLock(pStagingQueue->mutex);
+                std::move(pStagingQueue->previews.begin(), pStagingQueue->previews.end(), std::back_inserter(previews));
+                std::move(pStagingQueue->textures.begin(), pStagingQueue->textures.end(), std::back_inserter(textures));
+                pStagingQueue->previews.clear();
+                pStagingQueue->textures.clear();
+            }
+            mStagedCount = 0;
+        }
+
+        FALCOR_PROFILE("uploadTextures");
+
+        // Upload in priority order.
+        auto sortByPriority = [](std::vector<StagedTexture>& stagedTextures)
+        {
+            std::sort(stagedTextures.begin(), stagedTextures.end(), [](const StagedTexture& lhs, const StagedTexture& rhs)
+            {
+                return QueueEntry{ lhs.request.options.priority, lhs.request.id } < QueueEntry{ rhs.request.options.priority, rhs.request.id };
+            });
+        };
+        sortByPriority(previews);
+        sortByPriority(textures);
+
+        // Issue a global flush at regular intervals to keep the upload heap from growing.
+        // TODO: It would be better to check the size of the upload heap instead.
+        auto countUpload = [&]()
+        {
+            if (++mUploadCounter >= kUploadsPerFlush)
+            {
+                gpDevice->flushAndSync();
+                mUploadCounter = 0;
+            }
+        };
+
+        // Upload the previews first so that all textures can be rendered as soon as possible.
+        for (auto& preview : previews)
+        {
+            const LoadRequest& r = preview.request;
+            Texture::SharedPtr pPreview = preview.pBitmap
+                ? createTextureFromBitmap(*preview.pBitmap, r.generateMipLevels, r.loadAsSRGB, r.bindFlags)
+                : createTextureFromMipChain(preview.mipChain, r.loadAsSRGB, r.bindFlags);
+            pPreview->setSourceFilename(preview.fullPath);
+            r.options.previewCallback(pPreview);
+            countUpload();
+        }
+
+        // Upload the full resolution textures.
+        for (auto& stagedTexture : textures)
+        {
+            LoadRequest& r = stagedTexture.request;
+            Texture::SharedPtr pTexture;
+            if (stagedTexture.pBitmap)
+            {
+                pTexture = createTextureFromBitmap(*stagedTexture.pBitmap, r.generateMipLevels, r.loadAsSRGB, r.bindFlags);
+            }
+            else if (stagedTexture.mipChain.mipLevels > 0)
+            {
+                pTexture = createTextureFromMipChain(stagedTexture.mipChain, r.loadAsSRGB, r.bindFlags);
+            }
+            else if (!stagedTexture.fullPath.empty() && hasSuffix(r.filename, ".dds"))
+            {
+                pTexture = Texture::createFromFile(stagedTexture.fullPath, r.generateMipLevels, r.loadAsSRGB, r.bindFlags);
+            }
+            if (pTexture) pTexture->setSourceFilename(stagedTexture.fullPath);
+
+            // Release the decoded data before invoking the callback.
+            stagedTexture.pBitmap.reset();
+            stagedTexture.mipChain = {};
+
+            Profiler::instance().endAsyncEvent(kTraceEventName, r.id);
+            r.promise.set_value(pTexture);
+            if (r.callback) r.callback(pTexture);
+            if (pTexture) countUpload();
+        }
+
+        return previews.size() + textures.size();
     }
 }
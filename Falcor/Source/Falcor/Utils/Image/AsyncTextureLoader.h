@@ -26,18 +26,44 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include <chrono>
 #include <future>
+#include <set>
 
 namespace Falcor
 {
-    class Barrier;
-
     /** Utility class to load textures asynchronously using multiple worker threads.
+
+        Load requests are processed in order of decreasing priority. Pending requests can be
+        re-prioritized or cancelled. The worker threads decode the texture files in parallel and
+        place the decoded data in their own staging queues. The worker threads never access the GPU.
+        The textures are created and uploaded by uploadStagedTextures(), which drains the staging
+        queues of all workers in priority order and must be called from the thread owning the
+        device's render context, typically once per frame.
+
+        Optionally, a low-resolution preview of a texture is staged as soon as it is available and
+        uploaded before the full resolution texture, so that it can be rendered while the remaining
+        data is loaded. For DDS files the preview is read from the coarse mip levels before the
+        rest of the file.
     */
     class FALCOR_API AsyncTextureLoader
     {
     public:
         using LoadCallback = std::function<void(Texture::SharedPtr pTexture)>;
+        using RequestID = uint64_t;
+
+        static constexpr RequestID kInvalidRequestID = 0;
+
+        /** Options for a load request.
+        */
+        struct LoadOptions
+        {
+            float priority = 0.f;               ///< Requests with higher priority are loaded first. Requests of equal priority are loaded in the order they were issued.
+            uint32_t previewMaxDimension = 0;   ///< Maximum width/height of the preview texture, or zero to disable the preview.
+            LoadCallback previewCallback;       ///< Function called by uploadStagedTextures() after the preview texture has been uploaded, before the full texture is uploaded.
+        };
 
         /** Constructor.
             \param[in] threadCount Number of worker threads.
@@ -54,42 +80,116 @@ namespace Falcor
             \param[in] generateMipLevels Whether the full mip-chain should be generated.
             \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
             \param[in] bindFlags The bind flags for the texture resource.
-            \param[in] callback Function called after the texture load has finished.
-            \return A future to a new texture, or nullptr if the texture failed to load.
+            \param[in] callback Function called by uploadStagedTextures() after the texture load has finished. It is also called with nullptr by cancel().
+            \param[in] options Priority and preview options.
+            \param[out] pRequestID If not nullptr, the ID of the request is written here. It can be used to change the priority or cancel the request.
+            \return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
         */
         std::future<Texture::SharedPtr> loadFromFile(
             const std::string& filename,
             bool generateMipLevels,
             bool loadAsSRGB,
             Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-            LoadCallback callback = {}
+            LoadCallback callback = {},
+            const LoadOptions& options = {},
+            RequestID* pRequestID = nullptr
         );
 
+        /** Change the priority of a pending request.
+            \param[in] requestID Request ID.
+            \param[in] priority New priority.
+            \return True if the request was still pending, false if it has already been started or doesn't exist.
+        */
+        bool setPriority(RequestID requestID, float priority);
+
+        /** Cancel a pending request.
+            The future of the request is set to nullptr and the callback is invoked with nullptr.
+            \param[in] requestID Request ID.
+            \return True if the request was cancelled, false if it has already been started or doesn't exist.
+        */
+        bool cancel(RequestID requestID);
+
+        /** Get the number of requests that have not yet been started.
+        */
+        size_t getPendingRequestCount() const;
+
+        /** Create and upload the textures staged by the worker threads and complete their requests.
+            This uses the device's render context, so it must be called from the thread owning it.
+            Previews are uploaded before any full resolution texture.
+            \param[in] timeout Maximum time to wait for the workers to stage a texture if none is staged.
+            \return Number of previews and textures processed.
+        */
+        size_t uploadStagedTextures(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
     private:
         void runWorkers(size_t threadCount);
-        void runWorker();
+        void runWorker(size_t workerIndex);
         void terminateWorkers();
 
         struct LoadRequest
         {
+            RequestID id;
             std::string filename;
             bool generateMipLevels;
             bool loadAsSRGB;
             Resource::BindFlags bindFlags;
             LoadCallback callback;
+            LoadOptions options;
             std::promise<Texture::SharedPtr> promise;
         };
 
-        std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
+        /** Texture data decoded by a worker, waiting to be uploaded.
+            If neither a decoded image nor mip levels are staged, the texture failed to load, unless it is a DDS file
+            that can't be staged (e.g. a cube map), which is then read at upload time.
+        */
+        struct StagedTexture
+        {
+            LoadRequest request;                    ///< Load request. For previews, only the parameters and the preview callback are set.
+            std::string fullPath;                   ///< Full path of the texture file, or empty if the file was not found.
+            Bitmap::UniqueConstPtr pBitmap;         ///< Decoded image. Mip levels are generated at upload time if requested.
+            ImageIO::MipChain mipChain;             ///< Mip levels read from a DDS file, used if there is no decoded image.
+        };
+
+        /** Staging queue owned by a single worker thread.
+        */
+        struct StagingQueue
+        {
+            std::mutex mutex;
+            std::vector<StagedTexture> previews;
+            std::vector<StagedTexture> textures;
+        };
+
+        /** Entry in the priority ordered request queue.
+        */
+        struct QueueEntry
+        {
+            float priority;
+            RequestID id;
+
+            bool operator<(const QueueEntry& rhs) const
+            {
+                if (priority != rhs.priority) return priority > rhs.priority;
+                return id < rhs.id;
+            }
+        };
+
+        void stageTexture(LoadRequest&& request, StagingQueue& stagingQueue);
+        void notifyStaged();
+
+        mutable std::mutex mMutex;                  ///< Mutex for synchronizing access to shared resources.
         std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
-        std::shared_ptr<Barrier> mFlushBarrier;     ///< Barrier for flushing the GPU to upload textures.
+        std::condition_variable mStagedCondition;   ///< Condition variable for waiting on staged textures.
         std::vector<std::thread> mThreads;          ///< Worker threads.
+        std::vector<std::unique_ptr<StagingQueue>> mStagingQueues; ///< Staging queues, one per worker thread.
 
         // Internal state. Do not access outside of critical section.
-        std::queue<LoadRequest> mLoadRequestQueue;  ///< Texture loading request queue.
-
+        std::set<QueueEntry> mLoadRequestQueue;     ///< Texture loading request queue, ordered by decreasing priority.
+        std::unordered_map<RequestID, LoadRequest> mPendingRequests; ///< Requests that have not yet been started, indexed by ID.
+        RequestID mNextRequestID = kInvalidRequestID + 1; ///< ID of the next load request.
+        size_t mStagedCount = 0;                    ///< Number of previews and textures staged since the staging queues were last drained.
         bool mTerminate = false;                    ///< Flag to terminate worker threads.
-        bool mFlushPending = false;                 ///< Flag to indicate a GPU flush is pending.
+
+        // Upload state. Only accessed by uploadStagedTextures().
         uint32_t mUploadCounter = 0;                ///< Counter to issue a flush every few uploads.
     };
 }
@@ -31,7 +31,11 @@
 #include "dds_header/DDSHeader.h"
 #include "nvtt/nvtt.h"
 
+#include "Utils/NumericRange.h"
+
+#include <execution>
 #include <filesystem>
+#include <fstream>
 
 namespace Falcor
 {
@@ -315,7 +319,118 @@ namespace Falcor
             if (fillAlpha) fillAlphaChannel(surface);
         }
 
+        // Prepare image data of any supported format for being passed to NVTT. See setImage() above.
+        void setSurface(const void* pData, nvtt::Surface& surface, const ExportData& image, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcDepth)
+        {
+            FormatType type = getFormatType(image.format);
+            if (type == FormatType::Sint || type == FormatType::Snorm)
+            {
+                setImage<int8_t>(pData, surface, image, srcWidth, srcHeight, srcDepth);
+            }
+            else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
+            {
+                setImage<uint8_t>(pData, surface, image, srcWidth, srcHeight, srcDepth);
+            }
+            else if (type == FormatType::Float)
+            {
+                if (getNumChannelBits(image.format, 0) == 16)
+                {
+                    setImage<glm::detail::hdata>(pData, surface, image, srcWidth, srcHeight, srcDepth);
+                }
+                else if (getNumChannelBits(image.format, 0) == 32)
+                {
+                    setImage<float>(pData, surface, image, srcWidth, srcHeight, srcDepth);
+                }
+            }
+        }
+
+        const int kTileSize = 256; ///< Width and height in texels of the tiles that are block compressed in parallel. Must be a multiple of the block size.
+
+        // Output handler collecting the data written by NVTT in memory.
+        class MemoryOutputHandler : public nvtt::OutputHandler
+        {
+        public:
+            void beginImage(int size, int width, int height, int depth, int face, int miplevel) override {}
+            bool writeData(const void* data, int size) override
+            {
+                const uint8_t* pData = static_cast<const uint8_t*>(data);
+                mData.insert(mData.end(), pData, pData + size);
+                return true;
+            }
+            void endImage() override {}
+
+            std::vector<uint8_t> mData;
+        };
+
+        bool isBlockCompressed(nvtt::Format format)
+        {
+            return format != nvtt::Format::Format_RGBA;
+        }
+
+        uint32_t getBytesPerBlock(nvtt::Format format)
+        {
+            return (format == nvtt::Format::Format_BC1 || format == nvtt::Format::Format_BC4) ? 8 : 16;
+        }
+
+        // Block compresses a 2D surface by splitting it into block-aligned tiles that are compressed in parallel.
+        // Blocks are compressed independently, so the result is identical to compressing the whole surface at once.
+        std::vector<uint8_t> compressTiled(const nvtt::Surface& surface, const nvtt::CompressionOptions& compressionOptions, nvtt::Format format)
+        {
+            const int width = surface.width();
+            const int height = surface.height();
+            const uint32_t bytesPerBlock = getBytesPerBlock(format);
+            const uint32_t blocksX = div_round_up(width, 4);
+            const uint32_t blocksY = div_round_up(height, 4);
+            const uint32_t tilesX = div_round_up(width, kTileSize);
+            const uint32_t tilesY = div_round_up(height, kTileSize);
+
+            std::vector<uint8_t> data((size_t)blocksX * blocksY * bytesPerBlock);
+            std::atomic<bool> failed = false;
+
+            NumericRange<uint32_t> tiles(0, tilesX * tilesY);
+            std::for_each(std::execution::par, tiles.begin(), tiles.end(), [&](uint32_t tile)
+            {
+                const int x0 = (int)(tile % tilesX) * kTileSize;
+                const int y0 = (int)(tile / tilesX) * kTileSize;
+                const int x1 = std::min(x0 + kTileSize, width);
+                const int y1 = std::min(y0 + kTileSize, height);
+                nvtt::Surface tileSurface = surface.createSubImage(x0, x1 - 1, y0, y1 - 1, 0, 0);
+
+                MemoryOutputHandler handler;
+                nvtt::OutputOptions outputOptions;
+                outputOptions.setOutputHandler(&handler);
+                outputOptions.setOutputHeader(false);
+
+                nvtt::Context context;
+                context.enableCudaAcceleration(false);
+                if (!context.compress(tileSurface, 0, 0, compressionOptions, outputOptions))
+                {
+                    failed = true;
+                    return;
+                }
+
+                // Copy the rows of blocks of the tile into the surface data.
+                const uint32_t tileBlocksX = div_round_up(x1 - x0, 4);
+                const uint32_t tileBlocksY = div_round_up(y1 - y0, 4);
+                const size_t tileRowSize = (size_t)tileBlocksX * bytesPerBlock;
+                if (handler.mData.size() != tileRowSize * tileBlocksY)
+                {
+                    failed = true;
+                    return;
+                }
+                for (uint32_t row = 0; row < tileBlocksY; row++)
+                {
+                    const size_t dstOffset = (((size_t)y0 / 4 + row) * blocksX + x0 / 4) * bytesPerBlock;
+                    std::memcpy(&data[dstOffset], &handler.mData[row * tileRowSize], tileRowSize);
+                }
+            });
+
+            if (failed) throw RuntimeError("Failed to compress image.");
+            return data;
+        }
+
         // Saves image data to a DDS file using the specified compression mode. Optionally generates mips.
+        // Block compression of 2D images is done in parallel tiles, other images are compressed by NVTT on the calling thread.
         void exportDDS(const std::filesystem::path& path, ExportData& image, ImageIO::CompressionMode mode, bool generateMips)
         {
             nvtt::CompressionOptions compressionOptions;
@@ -342,9 +457,21 @@ namespace Falcor
                 compressionOptions.setPixelType(nvtt::PixelType::PixelType_Float);
             }
 
+            const bool compressTiles = isBlockCompressed(format) && image.depth == 1;
+
             nvtt::OutputOptions outputOptions;
             std::string pathStr = path.string();
-            outputOptions.setFileName(pathStr.c_str());
+            MemoryOutputHandler headerHandler;
+            std::ofstream fs;
+            if (compressTiles)
+            {
+                // The header is collected in memory and the file is written here, as the tiles are compressed separately.
+                outputOptions.setOutputHandler(&headerHandler);
+            }
+            else
+            {
+                outputOptions.setFileName(pathStr.c_str());
+            }
             if (format == nvtt::Format::Format_BC6S || format == nvtt::Format::Format_BC7)
             {
                 outputOptions.setContainer(nvtt::Container::Container_DDS10);
@@ -357,14 +484,32 @@ namespace Falcor
                 throw RuntimeError("Failed to output file header.");
             }
 
-            for (uint32_t f = 0; f < image.faceCount; ++f)
+            if (compressTiles)
             {
-                size_t faceIndex = f * image.mipLevels;
-                nvtt::Surface tmp = image.images[faceIndex];
-                if (!context.compress(tmp, f, 0, compressionOptions, outputOptions))
+                fs.open(path, std::ios::out | std::ios::binary);
+                fs.write(reinterpret_cast<const char*>(headerHandler.mData.data()), headerHandler.mData.size());
+                if (!fs.good()) throw RuntimeError("Failed to write file header.");
+            }
+
+            auto compress = [&](const nvtt::Surface& surface, uint32_t face, uint32_t mip)
+            {
+                if (compressTiles)
+                {
+                    std::vector<uint8_t> data = compressTiled(surface, compressionOptions, format);
+                    fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+                    if (!fs.good()) throw RuntimeError("Failed to write file.");
+                }
+                else if (!context.compress(surface, face, mip, compressionOptions, outputOptions))
                 {
                     throw RuntimeError("Failed to compress file.");
                 }
+            };
+
+            for (uint32_t f = 0; f < image.faceCount; ++f)
+            {
+                size_t faceIndex = f * image.mipLevels;
+                nvtt::Surface tmp = image.images[faceIndex];
+                compress(tmp, f, 0);
                 for (uint32_t m = 1; m < image.mipLevels; ++m)
                 {
                     if (generateMips)
@@ -376,10 +521,7 @@ namespace Falcor
                         tmp = image.images[faceIndex + m];
                     }
 
-                    if (!context.compress(tmp, f, m, compressionOptions, outputOptions))
-                    {
-                        throw RuntimeError("Failed to compress file.");
-                    }
+                    compress(tmp, f, m);
                 }
             }
         }
@@ -494,8 +636,8 @@ namespace Falcor
             }
         }
 
-        // Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
-        void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
+        // Opens a DDS file and reads its header. The returned stream is positioned at the start of the image data.
+        std::ifstream openDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data, size_t& imageSize)
         {
             std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
             if (!file)
@@ -534,25 +676,42 @@ namespace Falcor
 
             readDDSHeader(data, header, headerSize, loadAsSrgb);
 
-            // Save the rest of the data after the header
+            // Position the stream at the data after the header
             if (filesize <= headerSize)
             {
                 throw RuntimeError("No image data after DDS header.");
             }
 
-            size_t imageSize = filesize - headerSize;
-            data.imageData.resize(imageSize);
+            imageSize = filesize - headerSize;
             file.seekg(headerSize, std::ios::beg);
             if (file.fail())
             {
                 throw RuntimeError("Failed to set stream position.");
             }
+            return file;
+        }
+
+        // Loads the information and data for the specified image. This function does not handle creation of the texture for the image.
+        void loadDDS(const std::filesystem::path& path, bool loadAsSrgb, ImportData& data)
+        {
+            size_t imageSize = 0;
+            std::ifstream file = openDDS(path, loadAsSrgb, data, imageSize);
+
+            data.imageData.resize(imageSize);
             file.read(reinterpret_cast<char*>(data.imageData.data()), imageSize);
             if (file.fail())
             {
                 throw RuntimeError("Failed to read image data.");
             }
         }
+
+        // Returns the size in bytes of a mip level as stored in a DDS file.
+        size_t getDDSMipSize(ResourceFormat format, uint32_t width, uint32_t height)
+        {
+            size_t blocksX = div_round_up(width, getFormatWidthCompressionRatio(format));
+            size_t blocksY = div_round_up(height, getFormatHeightCompressionRatio(format));
+            return blocksX * blocksY * getFormatBytesPerBlock(format);
+        }
     }
 
     Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::string& filename)
@@ -634,6 +793,58 @@ namespace Falcor
         return pTex;
     }
 
+    bool ImageIO::loadMipChainFromDDS(const std::string& filename, uint32_t maxDimension, MipChain& mipChain)
+    {
+        std::string fullpath;
+        if (findFileInDataDirectories(filename, fullpath) == false)
+        {
+            logWarning("Failed to load DDS image from '{}': Can't find file.", filename);
+            return false;
+        }
+
+        ImportData data;
+        size_t imageSize = 0;
+        std::ifstream file = openDDS(fullpath, false, data, imageSize);
+        if (data.type != Resource::Type::Texture2D || data.arraySize != 1) return false;
+
+        // Skip the mip levels larger than the maximum dimension.
+        uint32_t firstMip = 0;
+        size_t offset = 0;
+        while (firstMip < data.mipLevels && std::max(data.width >> firstMip, data.height >> firstMip) > maxDimension)
+        {
+            offset += getDDSMipSize(data.format, std::max(data.width >> firstMip, 1u), std::max(data.height >> firstMip, 1u));
+            firstMip++;
+        }
+        if (firstMip == data.mipLevels) return false;
+
+        mipChain.width = std::max(data.width >> firstMip, 1u);
+        mipChain.height = std::max(data.height >> firstMip, 1u);
+        mipChain.mipLevels = data.mipLevels - firstMip;
+        mipChain.skippedMipLevels = firstMip;
+        mipChain.format = data.format;
+
+        size_t size = 0;
+        for (uint32_t mip = firstMip; mip < data.mipLevels; mip++)
+        {
+            size += getDDSMipSize(data.format, std::max(data.width >> mip, 1u), std::max(data.height >> mip, 1u));
+        }
+        if (offset + size > imageSize)
+        {
+            throw RuntimeError("Failed to load DDS image from '{}': File too small for its mip levels.", filename);
+        }
+
+        // Only the data of the loaded levels is read.
+        mipChain.data.resize(size);
+        file.seekg(offset, std::ios::cur);
+        file.read(reinterpret_cast<char*>(mipChain.data.data()), size);
+        if (file.fail())
+        {
+            throw RuntimeError("Failed to load DDS image from '{}': Failed to read image data.", filename);
+        }
+
+        return true;
+    }
+
     void ImageIO::saveToDDS(const std::string& filename, const Bitmap& bitmap, CompressionMode mode, bool generateMips)
     {
         if (getExtensionFromFile(filename) != "dds")
@@ -672,37 +883,77 @@ namespace Falcor
             uint32_t srcHeight = bitmap.getHeight();
 
             nvtt::Surface surface;
-            FormatType type = getFormatType(image.format);
-            if (type == FormatType::Sint || type == FormatType::Snorm)
+            setSurface(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+
+            image.images.push_back(surface);
+
+            // NVTT's Surface is designed to only hold uncompressed data, which means saving a compressed image as-is
+            // requires the data be re-compressed. The selected compression mode is updated here to reflect this.
+            if (isCompressedFormat(image.format) && mode == CompressionMode::None)
             {
-                setImage<int8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+                mode = convertFormatToMode(image.format);
             }
-            else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
+
+            exportDDS(filename, image, mode, generateMips);
+        }
+        catch (const RuntimeError& e)
+        {
+            throw RuntimeError("Failed to save DDS image to '{}': {}", filename, e.what());
+        }
+    }
+
+    void ImageIO::saveToDDS(const std::string& filename, const std::vector<Bitmap::UniqueConstPtr>& mips, CompressionMode mode)
+    {
+        if (getExtensionFromFile(filename) != "dds")
+        {
+            logWarning("Saving DDS image to '{}' which does not have 'dds' file extension.", filename);
+        }
+
+        try
+        {
+            if (mips.empty())
             {
-                setImage<uint8_t>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+                throw RuntimeError("No mip levels to save.");
             }
-            else if (type == FormatType::Float)
+
+            const Bitmap& base = *mips[0];
+            ExportData image;
+            image.type = nvtt::TextureType::TextureType_2D;
+            image.width = base.getWidth();
+            image.height = base.getHeight();
+            image.depth = 1;
+            image.format = base.getFormat();
+            image.faceCount = 1;
+            image.mipLevels = (uint32_t)mips.size();
+
+            if (getFormatChannelCount(image.format) == 2 && mode != CompressionMode::BC5)
             {
-                if (getNumChannelBits(image.format, 0) == 16)
-                {
-                    setImage<glm::detail::hdata>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
-                }
-                else if (getNumChannelBits(image.format, 0) == 32)
+                throw RuntimeError("Only BC5 compression is supported for two channel images.");
+            }
+
+            for (uint32_t m = 0; m < image.mipLevels; ++m)
+            {
+                const Bitmap& bitmap = *mips[m];
+                if (bitmap.getFormat() != image.format || bitmap.getWidth() != std::max(1u, image.width >> m) || bitmap.getHeight() != std::max(1u, image.height >> m))
                 {
-                    setImage<float>(bitmap.getData(), surface, image, srcWidth, srcHeight, image.depth);
+                    throw RuntimeError("Mip level {} does not match the format and dimensions of the base level.", m);
                 }
-            }
 
-            image.images.push_back(surface);
+                ExportData level = image;
+                level.width = bitmap.getWidth();
+                level.height = bitmap.getHeight();
+
+                nvtt::Surface surface;
+                setSurface(bitmap.getData(), surface, level, level.width, level.height, level.depth);
+                image.images.push_back(surface);
+            }
 
-            // NVTT's Surface is designed to only hold uncompressed data, which means saving a compressed image as-is
-            // requires the data be re-compressed. The selected compression mode is updated here to reflect this.
             if (isCompressedFormat(image.format) && mode == CompressionMode::None)
             {
                 mode = convertFormatToMode(image.format);
             }
 
-            exportDDS(filename, image, mode, generateMips);
+            exportDDS(filename, image, mode, false);
         }
         catch (const RuntimeError& e)
         {
@@ -768,30 +1019,10 @@ namespace Falcor
                     std::vector<uint8_t> subresourceData = pContext->readTextureSubresource(pTexture.get(), subresource);
 
                     nvtt::Surface surface;
-                    FormatType type = getFormatType(image.format);
                     uint32_t width = (uint32_t)pTexture->getWidth(m);
                     uint32_t height = (uint32_t)pTexture->getHeight(m);
                     uint32_t depth = (uint32_t)pTexture->getDepth(m);
-
-                    if (type == FormatType::Sint || type == FormatType::Snorm)
-                    {
-                        setImage<int8_t>(subresourceData.data(), surface, image, width, height, depth);
-                    }
-                    else if (type == FormatType::Uint || type == FormatType::Unorm || type == FormatType::UnormSrgb)
-                    {
-                        setImage<uint8_t>(subresourceData.data(), surface, image, width, height, depth);
-                    }
-                    else if (type == FormatType::Float)
-                    {
-                        if (getNumChannelBits(image.format, 0) == 16)
-                        {
-                            setImage<glm::detail::hdata>(subresourceData.data(), surface, image, width, height, depth);
-                        }
-                        else if (getNumChannelBits(image.format, 0) == 32)
-                        {
-                            setImage<float>(subresourceData.data(), surface, image, width, height, depth);
-                        }
-                    }
+                    setSurface(subresourceData.data(), surface, image, width, height, depth);
 
                     image.images.push_back(surface);
 
@@ -76,6 +76,18 @@ namespace Falcor
             None
         };
 
+        /** Mip levels of a 2D texture.
+        */
+        struct MipChain
+        {
+            uint32_t width = 0;                                 ///< Width of the most detailed level.
+            uint32_t height = 0;                                ///< Height of the most detailed level.
+            uint32_t mipLevels = 0;                             ///< Number of mip levels.
+            uint32_t skippedMipLevels = 0;                      ///< Number of more detailed mip levels in the file that were not loaded.
+            ResourceFormat format = ResourceFormat::Unknown;    ///< Format of the data.
+            std::vector<uint8_t> data;                          ///< Data of all levels back to back, starting with the most detailed level.
+        };
+
         /** Load a DDS file to a Bitmap. If the file contains an image array and/or mips, only the first image will be loaded.
             Throws an exception if the DDS file is malformed.
             \param[in] filename Path of file to load.
@@ -83,6 +95,16 @@ namespace Falcor
         */
         static Bitmap::UniqueConstPtr loadBitmapFromDDS(const std::string& filename); // top down = true
 
+        /** Load the mip levels of a 2D DDS file, skipping the levels that are larger than a given dimension.
+            Only the data of the loaded levels is read from the file, so loading a coarse mip tail of a large texture is cheap.
+            Throws an exception if the DDS file is malformed.
+            \param[in] filename Path of file to load.
+            \param[in] maxDimension Maximum width/height of the most detailed level to load.
+            \param[out] mipChain Loaded mip levels.
+            \return True if successful, false if the file was not found, is not a 2D texture without array slices or has no level that fits.
+        */
+        static bool loadMipChainFromDDS(const std::string& filename, uint32_t maxDimension, MipChain& mipChain);
+
         /** Load a DDS file to a Texture.
             Throws an exception if the DDS file is malformed.
             \param[in] filename Path of file to load.
@@ -100,6 +122,14 @@ namespace Falcor
         */
         static void saveToDDS(const std::string& filename, const Bitmap& bitmap, CompressionMode mode = CompressionMode::None, bool generateMips = false);
 
+        /** Saves a mip chain of bitmaps to a DDS file, for example generated by MipGenerator.
+            Throws an exception if filename is invalid, the mip levels don't match or the image cannot be saved.
+            \param[in] filename Filename to save to.
+            \param[in] mips Mip levels ordered from most to least detailed. All levels must have the same format, and each level half the dimensions of the previous.
+            \param[in] mode Block compression mode. By default, will save data as-is and will not decompress if already compressed.
+        */
+        static void saveToDDS(const std::string& filename, const std::vector<Bitmap::UniqueConstPtr>& mips, CompressionMode mode = CompressionMode::None);
+
         /** Saves a Texture to a DDS file. All mips and array images are saved.
             Throws an exception of filename is invalid or the image cannot be saved.
 
@@ -0,0 +1,371 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "MipGenerator.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+
+namespace Falcor
+{
+    namespace
+    {
+        constexpr uint32_t kChannelCount = 4;       ///< Number of channels of the floating-point working images.
+        constexpr float kFilterRadius = 3.f;        ///< Radius of the windowed sinc filters in destination texels.
+        constexpr float kKaiserAlpha = 4.f;         ///< Shape parameter of the Kaiser window.
+        constexpr float kMaxAlphaScale = 4.f;       ///< Maximum alpha scale when preserving alpha test coverage.
+        constexpr uint32_t kAlphaScaleSearchSteps = 12; ///< Number of bisection steps when searching for the alpha scale.
+
+        /** Downsampling filter taps for one image axis.
+            Each destination texel has the same number of taps. Source indices are clamped to the image.
+        */
+        struct FilterTaps
+        {
+            uint32_t tapCount = 0;
+            std::vector<uint32_t> indices;          ///< Source texel indices, tapCount per destination texel.
+            std::vector<float> weights;             ///< Normalized weights, tapCount per destination texel.
+        };
+
+        float sinc(float x)
+        {
+            if (std::abs(x) < 1e-5f) return 1.f;
+            x *= (float)M_PI;
+            return std::sin(x) / x;
+        }
+
+        /** Zeroth order modified Bessel function of the first kind.
+        */
+        float besselI0(float x)
+        {
+            float sum = 1.f;
+            float term = 1.f;
+            for (uint32_t k = 1; term > 1e-7f * sum; k++)
+            {
+                float f = x / (2.f * k);
+                term *= f * f;
+                sum += term;
+            }
+            return sum;
+        }
+
+        float getFilterRadius(MipGenerator::Filter filter)
+        {
+            return filter == MipGenerator::Filter::Box ? 0.5f : kFilterRadius;
+        }
+
+        /** Evaluate a filter at distance t measured in destination texels.
+        */
+        float evalFilter(MipGenerator::Filter filter, float t)
+        {
+            switch (filter)
+            {
+            case MipGenerator::Filter::Box:
+                return std::abs(t) <= 0.5f ? 1.f : 0.f;
+            case MipGenerator::Filter::Kaiser:
+            {
+                if (std::abs(t) >= kFilterRadius) return 0.f;
+                float r = t / kFilterRadius;
+                return sinc(t) * besselI0(kKaiserAlpha * std::sqrt(1.f - r * r)) / besselI0(kKaiserAlpha);
+            }
+            case MipGenerator::Filter::Lanczos:
+                if (std::abs(t) >= kFilterRadius) return 0.f;
+                return sinc(t) * sinc(t / kFilterRadius);
+            default:
+                FALCOR_UNREACHABLE();
+                return 0.f;
+            }
+        }
+
+        FilterTaps computeFilterTaps(uint32_t srcSize, uint32_t dstSize, MipGenerator::Filter filter)
+        {
+            const float scale = (float)srcSize / dstSize;
+            const float radius = getFilterRadius(filter) * scale;
+
+            FilterTaps taps;
+            taps.tapCount = (uint32_t)std::ceil(2.f * radius) + 1;
+            taps.indices.resize(dstSize * taps.tapCount);
+            taps.weights.resize(dstSize * taps.tapCount);
+
+            for (uint32_t d = 0; d < dstSize; d++)
+            {
+                const float center = (d + 0.5f) * scale;
+                const int first = (int)std::floor(center - radius);
+                uint32_t* pIndices = &taps.indices[d * taps.tapCount];
+                float* pWeights = &taps.weights[d * taps.tapCount];
+
+                float weightSum = 0.f;
+                for (uint32_t k = 0; k < taps.tapCount; k++)
+                {
+                    int i = first + (int)k;
+                    pIndices[k] = (uint32_t)std::clamp(i, 0, (int)srcSize - 1);
+                    pWeights[k] = evalFilter(filter, (i + 0.5f - center) / scale);
+                    weightSum += pWeights[k];
+                }
+
+                FALCOR_ASSERT(weightSum > 0.f);
+                for (uint32_t k = 0; k < taps.tapCount; k++) pWeights[k] /= weightSum;
+            }
+
+            return taps;
+        }
+
+        /** Downsample an image using a separable filter.
+            The horizontal pass is done first into a temporary image, followed by the vertical pass.
+            Both passes are parallelized over rows. The inner loops run over contiguous floats so that they can be vectorized.
+        */
+        void downsample(const std::vector<float>& src, uint32_t srcWidth, uint32_t srcHeight, std::vector<float>& dst, uint32_t dstWidth, uint32_t dstHeight, MipGenerator::Filter filter, std::vector<float>& tmp)
+        {
+            const FilterTaps tapsX = computeFilterTaps(srcWidth, dstWidth, filter);
+            const FilterTaps tapsY = computeFilterTaps(srcHeight, dstHeight, filter);
+            const size_t srcRowSize = (size_t)srcWidth * kChannelCount;
+            const size_t dstRowSize = (size_t)dstWidth * kChannelCount;
+
+            tmp.resize(dstRowSize * srcHeight);
+            dst.resize(dstRowSize * dstHeight);
+
+            NumericRange<uint32_t> srcRows(0, srcHeight);
+            std::for_each(std::execution::par, srcRows.begin(), srcRows.end(), [&](uint32_t y)
+            {
+                const float* pSrc = &src[y * srcRowSize];
+                float* pDst = &tmp[y * dstRowSize];
+                for (uint32_t x = 0; x < dstWidth; x++)
+                {
+                    const uint32_t* pIndices = &tapsX.indices[x * tapsX.tapCount];
+                    const float* pWeights = &tapsX.weights[x * tapsX.tapCount];
+                    float sum[kChannelCount] = {};
+                    for (uint32_t k = 0; k < tapsX.tapCount; k++)
+                    {
+                        const float* pTexel = pSrc + pIndices[k] * kChannelCount;
+                        for (uint32_t c = 0; c < kChannelCount; c++) sum[c] += pWeights[k] * pTexel[c];
+                    }
+                    for (uint32_t c = 0; c < kChannelCount; c++) pDst[x * kChannelCount + c] = sum[c];
+                }
+            });
+
+            NumericRange<uint32_t> dstRows(0, dstHeight);
+            std::for_each(std::execution::par, dstRows.begin(), dstRows.end(), [&](uint32_t y)
+            {
+                const uint32_t* pIndices = &tapsY.indices[y * tapsY.tapCount];
+                const float* pWeights = &tapsY.weights[y * tapsY.tapCount];
+                float* pDst = &dst[y * dstRowSize];
+                std::fill_n(pDst, dstRowSize, 0.f);
+                for (uint32_t k = 0; k < tapsY.tapCount; k++)
+                {
+                    const float* pSrc = &tmp[pIndices[k] * dstRowSize];
+                    const float w = pWeights[k];
+                    for (size_t i = 0; i < dstRowSize; i++) pDst[i] += w * pSrc[i];
+                }
+            });
+        }
+
+        float srgbToLinear(float v)
+        {
+            return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float v)
+        {
+            return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+        }
+
+        /** Convert a bitmap to a floating-point RGBA image.
+            Missing color channels are set to zero and a missing alpha channel to one.
+        */
+        std::vector<float> decodeBitmap(const Bitmap& bitmap, bool srgb)
+        {
+            static const auto kSrgbToLinear = []()
+            {
+                std::array<float, 256> table;
+                for (uint32_t i = 0; i < 256; i++) table[i] = srgbToLinear(i / 255.f);
+                return table;
+            }();
+
+            const ResourceFormat format = bitmap.getFormat();
+            const uint32_t width = bitmap.getWidth();
+            const uint32_t channelCount = getFormatChannelCount(format);
+            const uint32_t channelBits = getNumChannelBits(format, 0);
+            const uint32_t colorChannelCount = doesFormatHaveAlpha(format) ? channelCount - 1 : channelCount;
+
+            std::vector<float> image((size_t)width * bitmap.getHeight() * kChannelCount);
+
+            NumericRange<uint32_t> rows(0, bitmap.getHeight());
+            std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+            {
+                const uint8_t* pRow = bitmap.getData() + (size_t)y * bitmap.getRowPitch();
+                float* pDst = &image[(size_t)y * width * kChannelCount];
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float texel[kChannelCount] = { 0.f, 0.f, 0.f, 1.f };
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        const size_t i = (size_t)x * channelCount + c;
+                        const bool linearize = srgb && c < colorChannelCount && c < 3;
+                        if (channelBits == 8) texel[c] = linearize ? kSrgbToLinear[pRow[i]] : pRow[i] / 255.f;
+                        else if (channelBits == 16) texel[c] = (float)reinterpret_cast<const float16_t*>(pRow)[i];
+                        else texel[c] = reinterpret_cast<const float*>(pRow)[i];
+
+                        if (linearize && channelBits != 8) texel[c] = srgbToLinear(texel[c]);
+                    }
+                    std::copy_n(texel, kChannelCount, pDst + x * kChannelCount);
+                }
+            });
+
+            return image;
+        }
+
+        /** Convert a floating-point RGBA image to a bitmap.
+        */
+        Bitmap::UniqueConstPtr encodeBitmap(const std::vector<float>& image, uint32_t width, uint32_t height, ResourceFormat format, bool srgb, float alphaScale)
+        {
+            const uint32_t channelCount = getFormatChannelCount(format);
+            const uint32_t channelBits = getNumChannelBits(format, 0);
+            const bool hasAlpha = doesFormatHaveAlpha(format);
+            const uint32_t colorChannelCount = hasAlpha ? channelCount - 1 : channelCount;
+            const size_t rowPitch = (size_t)width * channelCount * channelBits / 8;
+
+            std::vector<uint8_t> data(rowPitch * height);
+
+            NumericRange<uint32_t> rows(0, height);
+            std::for_each(std::execution::par, rows.begin(), rows.end(), [&](uint32_t y)
+            {
+                const float* pSrc = &image[(size_t)y * width * kChannelCount];
+                uint8_t* pRow = &data[y * rowPitch];
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++)
+                    {
+                        const size_t i = (size_t)x * channelCount + c;
+                        float v = pSrc[x * kChannelCount + c];
+                        if (hasAlpha && c == 3 && alphaScale != 1.f) v = std::min(v * alphaScale, 1.f);
+                        if (srgb && c < colorChannelCount && c < 3) v = linearToSrgb(std::max(v, 0.f));
+
+                        if (channelBits == 8) pRow[i] = (uint8_t)(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+                        else if (channelBits == 16) reinterpret_cast<float16_t*>(pRow)[i] = float16_t(v);
+                        else reinterpret_cast<float*>(pRow)[i] = v;
+                    }
+                }
+            });
+
+            return Bitmap::create(width, height, format, data.data());
+        }
+
+        /** Compute the fraction of texels passing the alpha test when scaling alpha.
+        */
+        float computeAlphaCoverage(const std::vector<float>& image, float alphaCutoff, float alphaScale)
+        {
+            const size_t texelCount = image.size() / kChannelCount;
+            NumericRange<size_t> texels(0, texelCount);
+            size_t count = std::count_if(std::execution::par, texels.begin(), texels.end(), [&](size_t i)
+            {
+                return std::min(image[i * kChannelCount + 3] * alphaScale, 1.f) > alphaCutoff;
+            });
+            return (float)count / texelCount;
+        }
+
+        /** Find the alpha scale for which the alpha test coverage matches the desired coverage.
+        */
+        float findAlphaScale(const std::vector<float>& image, float alphaCutoff, float coverage)
+        {
+            float minScale = 0.f;
+            float maxScale = kMaxAlphaScale;
+            for (uint32_t i = 0; i < kAlphaScaleSearchSteps; i++)
+            {
+                float scale = 0.5f * (minScale + maxScale);
+                if (computeAlphaCoverage(image, alphaCutoff, scale) < coverage) minScale = scale;
+                else maxScale = scale;
+            }
+            return 0.5f * (minScale + maxScale);
+        }
+    }
+
+    bool MipGenerator::isFormatSupported(ResourceFormat format)
+    {
+        if (format == ResourceFormat::Unknown || isCompressedFormat(format) || isDepthStencilFormat(format)) return false;
+
+        const FormatType type = getFormatType(format);
+        const uint32_t bits = getNumChannelBits(format, 0);
+        for (uint32_t c = 1; c < getFormatChannelCount(format); c++)
+        {
+            if (getNumChannelBits(format, c) != bits) return false;
+        }
+
+        if (type == FormatType::Unorm || type == FormatType::UnormSrgb) return bits == 8;
+        if (type == FormatType::Float) return bits == 16 || bits == 32;
+        return false;
+    }
+
+    uint32_t MipGenerator::getMipCount(uint32_t width, uint32_t height)
+    {
+        FALCOR_ASSERT(width > 0 && height > 0);
+        return bitScanReverse(width | height) + 1;
+    }
+
+    std::vector<Bitmap::UniqueConstPtr> MipGenerator::generateMips(const Bitmap& bitmap, const Options& options)
+    {
+        const ResourceFormat format = bitmap.getFormat();
+        if (!isFormatSupported(format))
+        {
+            throw ArgumentError("Mip generation is not supported for format '{}'.", to_string(format));
+        }
+
+        uint32_t width = bitmap.getWidth();
+        uint32_t height = bitmap.getHeight();
+        uint32_t mipCount = getMipCount(width, height);
+        if (options.maxMipCount > 0) mipCount = std::min(mipCount, options.maxMipCount);
+
+        std::vector<Bitmap::UniqueConstPtr> mips;
+        mips.push_back(Bitmap::create(width, height, format, bitmap.getData()));
+        if (mipCount == 1) return mips;
+
+        const bool srgb = options.srgb || isSrgbFormat(format);
+        const bool preserveCoverage = options.alphaCutoff > 0.f && doesFormatHaveAlpha(format);
+
+        std::vector<float> src = decodeBitmap(bitmap, srgb);
+        std::vector<float> dst;
+        std::vector<float> tmp;
+        const float coverage = preserveCoverage ? computeAlphaCoverage(src, options.alphaCutoff, 1.f) : 0.f;
+
+        // Each level is computed from the previous level in floating-point.
+        // The alpha scale for preserving coverage is only applied to the stored levels.
+        for (uint32_t mip = 1; mip < mipCount; mip++)
+        {
+            const uint32_t dstWidth = std::max(width / 2, 1u);
+            const uint32_t dstHeight = std::max(height / 2, 1u);
+            downsample(src, width, height, dst, dstWidth, dstHeight, options.filter, tmp);
+
+            const float alphaScale = preserveCoverage ? findAlphaScale(dst, options.alphaCutoff, coverage) : 1.f;
+            mips.push_back(encodeBitmap(dst, dstWidth, dstHeight, format, srgb, alphaScale));
+
+            std::swap(src, dst);
+            width = dstWidth;
+            height = dstHeight;
+        }
+
+        return mips;
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+
+namespace Falcor
+{
+    /** Utility class for generating mip chains of bitmaps on the CPU.
+
+        The mip levels are computed by successively downsampling the previous level by a factor of two
+        using a separable filter. Filtering is done in floating-point, in linear space for sRGB encoded data.
+        The work is parallelized over image rows. No GPU is required, so it can be used for offline asset baking.
+        The generated mip chain can be saved using ImageIO::saveToDDS().
+    */
+    class FALCOR_API MipGenerator
+    {
+    public:
+        /** Downsampling filter.
+        */
+        enum class Filter
+        {
+            Box,        ///< Box filter. Averages 2x2 texels for even dimensions.
+            Kaiser,     ///< Kaiser windowed sinc filter (radius 3, alpha 4). Sharper than box with little ringing.
+            Lanczos,    ///< Lanczos filter (radius 3). Sharpest, but may produce ringing around edges.
+        };
+
+        struct Options
+        {
+            Filter filter = Filter::Box;    ///< Downsampling filter.
+            bool srgb = false;              ///< Filter the color channels in linear space, assuming sRGB encoded data. Always enabled for sRGB formats.
+            float alphaCutoff = 0.f;        ///< Alpha test threshold. If non-zero, the alpha of each mip level is scaled to preserve the alpha test coverage of the base level.
+            uint32_t maxMipCount = 0;       ///< Maximum number of mip levels including the base level, or zero for the full mip chain.
+        };
+
+        /** Check if mip generation is supported for a format.
+            Supported are uncompressed formats with 8-bit unorm, 16-bit float or 32-bit float channels.
+        */
+        static bool isFormatSupported(ResourceFormat format);
+
+        /** Get the number of mip levels of a full mip chain.
+        */
+        static uint32_t getMipCount(uint32_t width, uint32_t height);
+
+        /** Generate a mip chain.
+            Throws an exception if the format of the bitmap is not supported.
+            \param[in] bitmap Base level.
+            \param[in] options Generation options.
+            \return List of mip levels ordered from most to least detailed. The first entry is a copy of the base level.
+        */
+        static std::vector<Bitmap::UniqueConstPtr> generateMips(const Bitmap& bitmap, const Options& options = {});
+    };
+}
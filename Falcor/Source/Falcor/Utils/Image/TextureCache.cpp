@@ -0,0 +1,150 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TextureCache.h"
+#include "Utils/CacheFiles.h"
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kCacheDirectory = "NVIDIA/Falcor/TextureCache";
+        const uint32_t kCacheVersion = 1;
+        const bool kTopDown = true; // Memory layout when loading from file
+    }
+
+    bool TextureCache::hashFile(const std::filesystem::path& path, Hash& hash)
+    {
+        std::ifstream fs(path, std::ios_base::binary);
+        if (!fs.good()) return false;
+
+        SHA1 sha1;
+        std::vector<char> buffer(1 << 20);
+        while (fs)
+        {
+            fs.read(buffer.data(), buffer.size());
+            sha1.update(buffer.data(), (size_t)fs.gcount());
+        }
+        if (!fs.eof()) return false;
+
+        hash = sha1.final();
+        return true;
+    }
+
+    std::filesystem::path TextureCache::getCacheDirectory()
+    {
+        return std::filesystem::path(getAppDataDirectory()) / kCacheDirectory;
+    }
+
+    bool TextureCache::isCacheable(const std::filesystem::path& path, Resource::BindFlags bindFlags)
+    {
+        // Textures loaded from DDS files only support the default bind flags.
+        return !hasSuffix(path.string(), ".dds", false) && bindFlags == Resource::BindFlags::ShaderResource;
+    }
+
+    Texture::SharedPtr TextureCache::loadTexture(const std::filesystem::path& fullPath, const Hash& contentHash, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, const Options& options)
+    {
+        if (options.useDiskCache && isCacheable(fullPath, bindFlags))
+        {
+            const std::filesystem::path cachePath = getCachePath(contentHash, generateMipLevels, loadAsSRGB, options);
+            bool cached = std::filesystem::exists(cachePath);
+            if (cached) touchCacheFile(cachePath);
+            else cached = writeCacheFile(fullPath, cachePath, generateMipLevels, loadAsSRGB, options);
+
+            if (cached)
+            {
+                Texture::SharedPtr pTexture = ImageIO::loadTextureFromDDS(cachePath.string(), loadAsSRGB);
+                if (pTexture)
+                {
+                    pTexture->setSourceFilename(fullPath.string());
+                    return pTexture;
+                }
+                logWarning("Failed to load texture cache file '{}'. Loading texture from '{}'.", cachePath.string(), fullPath.string());
+            }
+        }
+
+        return Texture::createFromFile(fullPath.string(), generateMipLevels, loadAsSRGB, bindFlags);
+    }
+
+    std::filesystem::path TextureCache::getCachePath(const Hash& contentHash, bool generateMipLevels, bool loadAsSRGB, const Options& options)
+    {
+        SHA1 sha1;
+        auto update = [&](const auto& value) { sha1.update(&value, sizeof(value)); };
+        update(kCacheVersion);
+        sha1.update(contentHash.data(), contentHash.size());
+        update(generateMipLevels);
+        update(loadAsSRGB);
+        update(options.compression);
+        if (generateMipLevels) update(options.mipFilter);
+
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for (auto c : sha1.final()) ss << std::setw(2) << (int)c;
+        ss << ".dds";
+        return getCacheDirectory() / ss.str();
+    }
+
+    bool TextureCache::writeCacheFile(const std::filesystem::path& fullPath, const std::filesystem::path& cachePath, bool generateMipLevels, bool loadAsSRGB, const Options& options)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullPath.string(), kTopDown);
+        if (!pBitmap || !MipGenerator::isFormatSupported(pBitmap->getFormat())) return false;
+
+        std::filesystem::path tempPath;
+        try
+        {
+            MipGenerator::Options mipOptions;
+            mipOptions.filter = options.mipFilter;
+            // Filter in sRGB space only if the texture is loaded with an sRGB format. Formats without an sRGB variant are loaded as linear.
+            mipOptions.srgb = loadAsSRGB && isSrgbFormat(linearToSrgbFormat(pBitmap->getFormat()));
+            mipOptions.maxMipCount = generateMipLevels ? 0 : 1;
+            auto mips = MipGenerator::generateMips(*pBitmap, mipOptions);
+
+            // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4 at the base resolution.
+            ImageIO::CompressionMode mode = options.compression;
+            if (pBitmap->getWidth() % 4 != 0 || pBitmap->getHeight() % 4 != 0) mode = ImageIO::CompressionMode::None;
+
+            // Write to a uniquely named temporary file first, so that concurrent writers never write to the same file and readers never see a partial cache file.
+            tempPath = createCacheTempFile(cachePath);
+            if (tempPath.empty()) return false;
+            ImageIO::saveToDDS(tempPath.string(), mips, mode);
+
+            if (!commitCacheFile(tempPath, cachePath)) return false;
+            trimCacheDirectory(cachePath.parent_path(), options.maxDiskCacheSizeInBytes);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to write texture cache file for '{}': {}", fullPath.string(), e.what());
+            std::error_code ec;
+            if (!tempPath.empty()) std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+}
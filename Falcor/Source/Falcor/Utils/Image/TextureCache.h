@@ -0,0 +1,95 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "ImageIO.h"
+#include "MipGenerator.h"
+#include "Utils/CryptoUtils.h"
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Persistent cache of decoded textures.
+
+        Textures are identified by a hash of their file content, so that identical files stored under
+        different paths share one cache entry. A cache entry is a DDS file holding the decoded image
+        with its generated mip levels, optionally block compressed. Loading a texture from the cache
+        only reads the DDS file and uploads it, without decoding the image or generating mips.
+    */
+    class FALCOR_API TextureCache
+    {
+    public:
+        using Hash = SHA1::MD;
+
+        struct Options
+        {
+            bool deduplicate = true;                                                ///< Share one texture between files with identical content.
+            bool useDiskCache = true;                                               ///< Load textures from the cache, and add textures that are not yet cached.
+            ImageIO::CompressionMode compression = ImageIO::CompressionMode::None;  ///< Block compression of cached textures. Only applied if the dimensions are a multiple of 4.
+            MipGenerator::Filter mipFilter = MipGenerator::Filter::Box;             ///< Filter used for generating mip levels.
+            uint64_t maxDiskCacheSizeInBytes = 8ull << 30;                          ///< Size limit of the cache directory. The least recently used cache files are removed when adding a file exceeds it. Zero disables the limit.
+        };
+
+        /** Compute the hash of the content of a file.
+            \param[in] path File path.
+            \param[out] hash Content hash.
+            \return True if successful.
+        */
+        static bool hashFile(const std::filesystem::path& path, Hash& hash);
+
+        /** Get the directory holding the cache files.
+        */
+        static std::filesystem::path getCacheDirectory();
+
+        /** Check if a texture file can be cached. DDS files are loaded directly as they are not decoded.
+        */
+        static bool isCacheable(const std::filesystem::path& path, Resource::BindFlags bindFlags);
+
+        /** Load a texture from file, using the cache if possible.
+            If the texture is not cached yet, it is decoded, its mip levels are generated on the CPU and the result is added to the cache.
+            If the texture can't be cached, it is loaded using Texture::createFromFile().
+            \param[in] fullPath Full path of the texture file.
+            \param[in] contentHash Hash of the file content (see hashFile()).
+            \param[in] generateMipLevels Whether the full mip-chain should be generated.
+            \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
+            \param[in] bindFlags The bind flags for the texture resource.
+            \param[in] options Cache options.
+            \return A new texture, or nullptr if the texture failed to load.
+        */
+        static Texture::SharedPtr loadTexture(const std::filesystem::path& fullPath, const Hash& contentHash, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags, const Options& options);
+
+        /** Get the path of the cache file for a texture.
+            The path depends on the content hash and all settings affecting the cached data.
+        */
+        static std::filesystem::path getCachePath(const Hash& contentHash, bool generateMipLevels, bool loadAsSRGB, const Options& options);
+
+        /** Decode a texture file, generate its mip levels and write the result to a cache file.
+            \return True if successful.
+        */
+        static bool writeCacheFile(const std::filesystem::path& fullPath, const std::filesystem::path& cachePath, bool generateMipLevels, bool loadAsSRGB, const Options& options);
+    };
+}
@@ -27,9 +27,10 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "TextureManager.h"
+#include "Utils/CacheFiles.h"
 
-// Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
-// Until then `TextureManager` should only called from the main thread.
+// Temporarily disable asynchronous texture loader until the asynchronous path also adds textures to the texture cache.
+// `TextureManager` should only be called from the main thread, as textures are uploaded from there in either case.
 #define DISABLE_ASYNC_TEXTURE_LOADER
 
 namespace Falcor
@@ -37,7 +38,57 @@ namespace Falcor
     namespace
     {
         const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
+        const uint32_t kPreviewMaxDimension = 64; ///< Maximum width/height of the preview published while loading a texture asynchronously.
+        const std::chrono::milliseconds kUploadWaitTimeout(10); ///< Maximum time to wait for staged textures before checking the load state again.
         static_assert(TextureManager::TextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+        std::vector<uint64_t> getMipSizes(const Texture* pTexture)
+        {
+            const ResourceFormat format = pTexture->getFormat();
+            std::vector<uint64_t> mipSizes(pTexture->getMipCount());
+            for (uint32_t mip = 0; mip < pTexture->getMipCount(); mip++)
+            {
+                uint64_t blocksX = div_round_up(pTexture->getWidth(mip), getFormatWidthCompressionRatio(format));
+                uint64_t blocksY = div_round_up(pTexture->getHeight(mip), getFormatHeightCompressionRatio(format));
+                mipSizes[mip] = blocksX * blocksY * getFormatBytesPerBlock(format) * pTexture->getArraySize();
+            }
+            return mipSizes;
+        }
+
+        /** Returns the maximum number of most detailed mip levels that can be dropped from a texture.
+            The most detailed resident level must be a multiple of the block size for compressed formats.
+        */
+        uint32_t getMaxDroppedMipCount(const Texture* pTexture)
+        {
+            const ResourceFormat format = pTexture->getFormat();
+            uint32_t droppedMipCount = 0;
+            while (droppedMipCount + 1 < pTexture->getMipCount()
+                && pTexture->getWidth(droppedMipCount + 1) % getFormatWidthCompressionRatio(format) == 0
+                && pTexture->getHeight(droppedMipCount + 1) % getFormatHeightCompressionRatio(format) == 0)
+            {
+                droppedMipCount++;
+            }
+            return droppedMipCount;
+        }
+
+        /** Create a copy of a texture without its most detailed mip levels.
+        */
+        Texture::SharedPtr createDowngradedTexture(RenderContext* pRenderContext, const Texture::SharedPtr& pSrc, uint32_t droppedMipCount)
+        {
+            const uint32_t mipCount = pSrc->getMipCount() - droppedMipCount;
+            auto pTexture = Texture::create2D(pSrc->getWidth(droppedMipCount), pSrc->getHeight(droppedMipCount), pSrc->getFormat(), pSrc->getArraySize(), mipCount, nullptr, pSrc->getBindFlags());
+            pTexture->setSourceFilename(pSrc->getSourceFilename());
+
+            for (uint32_t arraySlice = 0; arraySlice < pSrc->getArraySize(); arraySlice++)
+            {
+                for (uint32_t mip = 0; mip < mipCount; mip++)
+                {
+                    pRenderContext->copySubresource(pTexture.get(), pTexture->getSubresourceIndex(arraySlice, mip), pSrc.get(), pSrc->getSubresourceIndex(arraySlice, mip + droppedMipCount));
+                }
+            }
+
+            return pTexture;
+        }
     }
 
     TextureManager::SharedPtr TextureManager::create(size_t maxTextureCount, size_t threadCount)
@@ -117,11 +168,32 @@ namespace Falcor
         std::unique_lock<std::mutex> lock(mMutex);
         const TextureKey textureKey(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
 
+        // Hash the file content if the texture is not already managed under this path.
+        // The hash is computed outside of the critical section, as it reads the entire file.
+        std::optional<TextureCache::Hash> contentHash;
+        const TextureCache::Options cacheOptions = mCacheOptions;
+        if (mKeyToHandle.find(textureKey) == mKeyToHandle.end() && (cacheOptions.deduplicate || cacheOptions.useDiskCache))
+        {
+            lock.unlock();
+            TextureCache::Hash hash;
+            if (TextureCache::hashFile(fullPath, hash)) contentHash = hash;
+            lock.lock();
+        }
+
+        std::optional<ContentKey> contentKey;
+        if (contentHash && cacheOptions.deduplicate) contentKey = ContentKey{ *contentHash, generateMipLevels, loadAsSRGB, bindFlags };
+
         if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
         {
             // Texture is already managed. Return its handle.
             handle = it->second;
         }
+        else if (auto it = contentKey ? mContentToHandle.find(*contentKey) : mContentToHandle.end(); it != mContentToHandle.end())
+        {
+            // Texture with identical content is already managed. Return its handle and add the path to the key-to-handle map.
+            handle = it->second;
+            mKeyToHandle[textureKey] = handle;
+        }
         else
         {
 #ifndef DISABLE_ASYNC_TEXTURE_LOADER
@@ -131,44 +203,86 @@ namespace Falcor
             TextureDesc desc = { TextureState::Referenced, nullptr };
             handle = addDesc(desc);
 
-            // Add to key-to-handle map.
+            // Add to key-to-handle and content-to-handle maps.
             mKeyToHandle[textureKey] = handle;
+            if (contentKey) mContentToHandle[*contentKey] = handle;
+
+            // Function called by the async texture loader when a low-resolution preview has been uploaded.
+            // The preview is used for rendering until the full texture is loaded, but the texture is not marked as loaded.
+            auto previewCallback = [=](Texture::SharedPtr pPreview)
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+
+                auto& desc = getDesc(handle);
+                desc.pTexture = pPreview;
+                mTextureToHandle[pPreview.get()] = handle;
+            };
 
             // Function called by the async texture loader when loading finishes.
-            // It's called by a worker thread so needs to acquire the mutex before changing any state.
+            // It's called from uploadStagedTextures() or cancel(), which are not synchronized with other calls, so it needs to acquire the mutex before changing any state.
             auto callback = [=](Texture::SharedPtr pTexture)
             {
                 std::unique_lock<std::mutex> lock(mMutex);
 
-                // Mark texture as loaded.
+                // Mark texture as loaded, replacing the preview if there is one.
                 auto& desc = getDesc(handle);
+                Texture::SharedPtr pPreview = desc.pTexture;
+                if (pPreview) mTextureToHandle.erase(pPreview.get());
                 desc.state = TextureState::Loaded;
                 desc.pTexture = pTexture;
 
                 // Add to texture-to-handle map.
-                if (pTexture) mTextureToHandle[pTexture.get()] = handle;
+                if (pTexture)
+                {
+                    pTexture->setSourceFilename(fullPath);
+                    mTextureToHandle[pTexture.get()] = handle;
+                }
+                addResidency(handle, textureKey, contentHash, pTexture);
+
+                // The texture-replaced callback is invoked from updateResidency() on the main thread, as holders of the preview are not thread-safe.
+                if (pPreview && pTexture) mPendingReplacements.emplace_back(pPreview, pTexture);
 
+                mLoadRequests.erase(handle.id);
                 mLoadRequestsInProgress--;
-                mCondition.notify_all();
             };
 
             // Issue load request to texture loader.
-            mAsyncTextureLoader.loadFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags, callback);
+            AsyncTextureLoader::LoadOptions options;
+            if (async)
+            {
+                options.previewMaxDimension = kPreviewMaxDimension;
+                options.previewCallback = previewCallback;
+            }
+            // Load from the texture cache if the texture has been cached before.
+            std::string loadPath = fullPath;
+            if (contentHash && cacheOptions.useDiskCache && TextureCache::isCacheable(fullPath, bindFlags))
+            {
+                auto cachePath = TextureCache::getCachePath(*contentHash, generateMipLevels, loadAsSRGB, cacheOptions);
+                if (std::filesystem::exists(cachePath))
+                {
+                    touchCacheFile(cachePath);
+                    loadPath = cachePath.string();
+                }
+            }
+
+            AsyncTextureLoader::RequestID requestID;
+            mAsyncTextureLoader.loadFromFile(loadPath, generateMipLevels, loadAsSRGB, bindFlags, callback, options, &requestID);
+            mLoadRequests[handle.id] = requestID;
 #else
             // Load texture from main thread.
-            Texture::SharedPtr pTexture = Texture::createFromFile(fullPath, generateMipLevels, loadAsSRGB, bindFlags);
+            Texture::SharedPtr pTexture = loadTextureFromFile(textureKey, contentHash, cacheOptions);
 
             // Add new texture desc.
             TextureDesc desc = { TextureState::Loaded, pTexture };
             handle = addDesc(desc);
 
-            // Add to key-to-handle map.
+            // Add to key-to-handle and content-to-handle maps.
             mKeyToHandle[textureKey] = handle;
+            if (contentKey) mContentToHandle[*contentKey] = handle;
 
             // Add to texture-to-handle map.
             if (pTexture) mTextureToHandle[pTexture.get()] = handle;
-
-            mCondition.notify_all();
+            addResidency(handle, textureKey, contentHash, pTexture);
 #endif
         }
 
@@ -182,13 +296,44 @@ namespace Falcor
         return handle;
     }
 
+    void TextureManager::setLoadPriority(const TextureHandle& handle, float priority)
+    {
+        if (!handle) return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto it = mLoadRequests.find(handle.id); it != mLoadRequests.end())
+        {
+            mAsyncTextureLoader.setPriority(it->second, priority);
+        }
+    }
+
+    bool TextureManager::cancelTextureLoading(const TextureHandle& handle)
+    {
+        if (!handle) return false;
+
+        AsyncTextureLoader::RequestID requestID = AsyncTextureLoader::kInvalidRequestID;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (auto it = mLoadRequests.find(handle.id); it != mLoadRequests.end()) requestID = it->second;
+        }
+
+        // Cancel outside of the critical section, as the load callback is invoked by the texture loader.
+        return requestID != AsyncTextureLoader::kInvalidRequestID && mAsyncTextureLoader.cancel(requestID);
+    }
+
     void TextureManager::waitForTextureLoading(const TextureHandle& handle)
     {
         if (!handle) return;
 
         // Acquire mutex and wait for texture state to change.
+        // The staged textures are uploaded on this thread while waiting, which invokes the load callbacks.
         std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return getDesc(handle).state == TextureState::Loaded; });
+        while (getDesc(handle).state != TextureState::Loaded)
+        {
+            lock.unlock();
+            mAsyncTextureLoader.uploadStagedTextures(kUploadWaitTimeout);
+            lock.lock();
+        }
 
         gpDevice->flushAndSync();
     }
@@ -196,8 +341,14 @@ namespace Falcor
     void TextureManager::waitForAllTexturesLoading()
     {
         // Acquire mutex and wait for all in-progress requests to finish.
+        // The staged textures are uploaded on this thread while waiting, which invokes the load callbacks.
         std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mLoadRequestsInProgress == 0; });
+        while (mLoadRequestsInProgress > 0)
+        {
+            lock.unlock();
+            mAsyncTextureLoader.uploadStagedTextures(kUploadWaitTimeout);
+            lock.lock();
+        }
 
         gpDevice->flushAndSync();
     }
@@ -215,9 +366,17 @@ namespace Falcor
         if (!desc.isValid()) return;
 
         // Remove handle from maps.
-        // Note not all handles exist in key-to-handle map so search for it. This can be optimized if needed.
-        auto it = std::find_if(mKeyToHandle.begin(), mKeyToHandle.end(), [handle](const auto& keyVal) { return keyVal.second == handle; });
-        if (it != mKeyToHandle.end()) mKeyToHandle.erase(it);
+        // Note not all handles exist in key-to-handle map, and handles of deduplicated textures exist multiple times, so search for it. This can be optimized if needed.
+        auto eraseHandle = [handle](auto& map)
+        {
+            for (auto it = map.begin(); it != map.end();)
+            {
+                if (it->second == handle) it = map.erase(it);
+                else ++it;
+            }
+        };
+        eraseHandle(mKeyToHandle);
+        eraseHandle(mContentToHandle);
 
         if (desc.pTexture)
         {
@@ -225,6 +384,9 @@ namespace Falcor
             mTextureToHandle.erase(desc.pTexture.get());
         }
 
+        mResidency.erase(handle.id);
+        mResidencyPolicy.removeTexture(handle.id);
+
         // Clear texture desc.
         desc = {};
 
@@ -247,6 +409,128 @@ namespace Falcor
         return mTextureDescs.size();
     }
 
+    void TextureManager::setTextureCacheOptions(const TextureCache::Options& options)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCacheOptions = options;
+    }
+
+    TextureCache::Options TextureManager::getTextureCacheOptions() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mCacheOptions;
+    }
+
+    void TextureManager::setResidencyOptions(const TextureResidencyPolicy::Options& options)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResidencyPolicy.setOptions(options);
+    }
+
+    TextureResidencyPolicy::Options TextureManager::getResidencyOptions() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mResidencyPolicy.getOptions();
+    }
+
+    void TextureManager::setTextureReplacedCallback(const TextureReplacedCallback& callback)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTextureReplacedCallback = callback;
+    }
+
+    void TextureManager::markTextureUsed(const TextureHandle& handle)
+    {
+        if (!handle) return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mResidencyPolicy.markUsed(handle.id, mFrame);
+    }
+
+    void TextureManager::markTextureUsed(const Texture* pTexture)
+    {
+        if (!pTexture) return;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto it = mTextureToHandle.find(pTexture); it != mTextureToHandle.end())
+        {
+            mResidencyPolicy.markUsed(it->second.id, mFrame);
+        }
+    }
+
+    bool TextureManager::updateResidency(RenderContext* pRenderContext)
+    {
+        FALCOR_ASSERT(pRenderContext);
+
+        // Upload the textures loaded asynchronously since the last update. This publishes previews and completes load requests.
+        mAsyncTextureLoader.uploadStagedTextures();
+
+        std::vector<std::pair<Texture::SharedPtr, Texture::SharedPtr>> replacedTextures;
+        TextureReplacedCallback callback;
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            // Previews of asynchronously loaded textures that have been replaced by the full texture.
+            replacedTextures = std::move(mPendingReplacements);
+            mPendingReplacements.clear();
+
+            for (const auto& change : mResidencyPolicy.update(mFrame++))
+            {
+                const TextureHandle handle = { change.id };
+                auto& desc = getDesc(handle);
+                auto& info = mResidency.at(change.id);
+
+                // Mip levels that are not resident are reloaded from file.
+                Texture::SharedPtr pSrc = desc.pTexture;
+                uint32_t srcDroppedMipCount = info.droppedMipCount;
+                if (change.droppedMipCount < srcDroppedMipCount)
+                {
+                    pSrc = loadTextureFromFile(info.key, info.contentHash, mCacheOptions);
+                    srcDroppedMipCount = 0;
+
+                    if (!pSrc)
+                    {
+                        logWarning("TextureManager::updateResidency() - Failed to reload texture '{}'.", info.key.fullPath);
+                        continue;
+                    }
+                }
+
+                Texture::SharedPtr pTexture = pSrc;
+                if (change.droppedMipCount > srcDroppedMipCount) pTexture = createDowngradedTexture(pRenderContext, pSrc, change.droppedMipCount - srcDroppedMipCount);
+
+                // Replace the texture while keeping its handle.
+                mTextureToHandle.erase(desc.pTexture.get());
+                mTextureToHandle[pTexture.get()] = handle;
+                replacedTextures.emplace_back(desc.pTexture, pTexture);
+                desc.pTexture = pTexture;
+                info.droppedMipCount = change.droppedMipCount;
+            }
+
+            callback = mTextureReplacedCallback;
+        }
+
+        // Invoke the callback outside of the critical section, as it may call back into the texture manager.
+        if (callback)
+        {
+            for (const auto& [pOldTexture, pNewTexture] : replacedTextures) callback(pOldTexture, pNewTexture);
+        }
+
+        return !replacedTextures.empty();
+    }
+
+    uint64_t TextureManager::getResidentBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mResidencyPolicy.getResidentBytes();
+    }
+
+    uint64_t TextureManager::getEvictedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mResidencyPolicy.getEvictedBytes();
+    }
+
     void TextureManager::setShaderData(const ShaderVar& var, const size_t descCount) const
     {
         std::lock_guard<std::mutex> lock(mMutex);
@@ -296,4 +580,22 @@ namespace Falcor
         FALCOR_ASSERT(handle && handle.id < mTextureDescs.size());
         return mTextureDescs[handle.id];
     }
+
+    void TextureManager::addResidency(const TextureHandle& handle, const TextureKey& key, const std::optional<TextureCache::Hash>& contentHash, const Texture::SharedPtr& pTexture)
+    {
+        // Only 2D textures with mip levels can be downgraded.
+        if (!pTexture || pTexture->getType() != Resource::Type::Texture2D || pTexture->getMipCount() <= 1) return;
+
+        mResidency.emplace(handle.id, ResidencyInfo{ key, contentHash });
+        mResidencyPolicy.addTexture(handle.id, getMipSizes(pTexture.get()), getMaxDroppedMipCount(pTexture.get()), mFrame);
+    }
+
+    Texture::SharedPtr TextureManager::loadTextureFromFile(const TextureKey& key, const std::optional<TextureCache::Hash>& contentHash, const TextureCache::Options& cacheOptions)
+    {
+        if (contentHash)
+        {
+            return TextureCache::loadTexture(key.fullPath, *contentHash, key.generateMipLevels, key.loadAsSRGB, key.bindFlags, cacheOptions);
+        }
+        return Texture::createFromFile(key.fullPath, key.generateMipLevels, key.loadAsSRGB, key.bindFlags);
+    }
 }
@@ -27,7 +27,10 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureCache.h"
+#include "TextureResidencyPolicy.h"
 #include <mutex>
+#include <optional>
 
 namespace Falcor
 {
@@ -35,10 +38,21 @@ namespace Falcor
 
         This class manages a collection of textures and implements
         asynchronous texture loading. All operations are thread-safe.
+        While a texture is loaded asynchronously, a low-resolution preview is used in its place.
+        Textures are decoded by worker threads and uploaded on the main thread, in updateResidency() and while waiting for textures to load.
+        Note that asynchronous loading is currently disabled (DISABLE_ASYNC_TEXTURE_LOADER) and textures are loaded on the calling thread.
+
+        Textures loaded from files with identical content share one handle, and decoded textures
+        are stored in a persistent texture cache to speed up later loads (see setTextureCacheOptions()).
 
         Each managed texture is assigned a unique handle upon loading.
         This handle is used in shader code to reference the given texture
         in the array of GPU texture descriptors.
+
+        Textures loaded from file can be subject to a memory budget (see setResidencyOptions()).
+        The owner marks the textures it uses and calls updateResidency() once per frame,
+        which replaces least recently used textures by textures with fewer resident mip levels
+        and reloads them from file when they are used again. The handle of a texture stays the same.
     */
     class FALCOR_API TextureManager
     {
@@ -106,6 +120,30 @@ namespace Falcor
         */
         TextureHandle loadTexture(const std::string& filename, bool generateMipLevels, bool loadAsSRGB, Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource, bool async = true);
 
+        /** Set the priority of a texture that is waiting to be loaded asynchronously.
+            Textures with higher priority are loaded first, for example those covering a larger part of the screen.
+            This has no effect if loading of the texture has already started.
+            \param[in] handle Texture handle.
+            \param[in] priority Load priority. The default priority is zero.
+        */
+        void setLoadPriority(const TextureHandle& handle, float priority);
+
+        /** Cancel loading of a texture that is waiting to be loaded asynchronously.
+            If cancelled, the texture is marked as loaded but has no texture object, as if loading had failed.
+            \param[in] handle Texture handle.
+            \return True if loading was cancelled, false if it has already started or the texture is not being loaded.
+        */
+        bool cancelTextureLoading(const TextureHandle& handle);
+
+        /** Set the options for deduplicating textures by content and for the persistent texture cache.
+            The options only affect textures loaded after the call.
+        */
+        void setTextureCacheOptions(const TextureCache::Options& options);
+
+        /** Get the options for deduplicating textures by content and for the persistent texture cache.
+        */
+        TextureCache::Options getTextureCacheOptions() const;
+
         /** Wait for a requested texture to load.
             If the handle is valid, the call blocks until the texture is loaded (or failed to load).
             \param[in] handle Texture handle.
@@ -138,6 +176,55 @@ namespace Falcor
         */
         size_t getTextureDescCount() const;
 
+        /** Callback invoked when a managed texture is replaced by a texture with a different number of resident mip levels,
+            or when the preview of an asynchronously loaded texture is replaced by the full texture.
+            Holders of references to the old texture should replace them by the new texture, so that the memory of the old texture is released.
+        */
+        using TextureReplacedCallback = std::function<void(const Texture::SharedPtr& pOldTexture, const Texture::SharedPtr& pNewTexture)>;
+
+        /** Set the texture memory budget and residency options.
+            Only textures loaded with loadTexture() are subject to the budget, as they can be reloaded on demand.
+            The budget only has an effect if the owner marks used textures with markTextureUsed() and calls updateResidency() every frame.
+            MaterialSystem does this for the textures of all materials.
+        */
+        void setResidencyOptions(const TextureResidencyPolicy::Options& options);
+
+        /** Get the texture memory budget and residency options.
+        */
+        TextureResidencyPolicy::Options getResidencyOptions() const;
+
+        /** Set the callback invoked when a texture is replaced (see TextureReplacedCallback).
+        */
+        void setTextureReplacedCallback(const TextureReplacedCallback& callback);
+
+        /** Mark a texture as used in the current frame.
+            \param[in] handle Texture handle.
+        */
+        void markTextureUsed(const TextureHandle& handle);
+
+        /** Mark a texture as used in the current frame. Textures that are not managed are ignored.
+            \param[in] pTexture Texture.
+        */
+        void markTextureUsed(const Texture* pTexture);
+
+        /** Update the residency of textures to fit the memory budget, and advance to the next frame.
+            Textures are evicted or have their most detailed mip levels dropped, least recently used first.
+            Textures that are used again are reloaded from file as soon as the budget allows it.
+            This also uploads asynchronously loaded textures, publishing their previews first, and replaces the previews of textures that have finished loading.
+            The texture-replaced callback is invoked from this call only, so it must be called from the main thread.
+            \param[in] pRenderContext Render context used to copy mip levels.
+            \return True if any texture was replaced.
+        */
+        bool updateResidency(RenderContext* pRenderContext);
+
+        /** Get the number of bytes of resident mip levels of textures subject to the memory budget.
+        */
+        uint64_t getResidentBytes() const;
+
+        /** Get the number of bytes of mip levels that are not resident due to the memory budget.
+        */
+        uint64_t getEvictedBytes() const;
+
         /** Bind all textures into a shader var.
             The shader var should refer to a Texture2D descriptor array of fixed size.
             The array must be large enough, otherwise an exception is thrown.
@@ -172,20 +259,54 @@ namespace Falcor
             }
         };
 
+        /** Key to identify a managed texture by the content of its file.
+        */
+        struct ContentKey
+        {
+            TextureCache::Hash hash;
+            bool generateMipLevels;
+            bool loadAsSRGB;
+            Resource::BindFlags bindFlags;
+
+            bool operator<(const ContentKey& rhs) const
+            {
+                return std::tie(hash, generateMipLevels, loadAsSRGB, bindFlags) < std::tie(rhs.hash, rhs.generateMipLevels, rhs.loadAsSRGB, rhs.bindFlags);
+            }
+        };
+
+        /** Residency state of a texture subject to the memory budget.
+        */
+        struct ResidencyInfo
+        {
+            TextureKey key;                                         ///< Key used to reload the texture.
+            std::optional<TextureCache::Hash> contentHash;          ///< Content hash used to reload the texture from the texture cache.
+            uint32_t droppedMipCount = 0;                           ///< Number of most detailed mip levels that are not resident.
+        };
+
         TextureHandle addDesc(const TextureDesc& desc);
         TextureDesc& getDesc(const TextureHandle& handle);
+        void addResidency(const TextureHandle& handle, const TextureKey& key, const std::optional<TextureCache::Hash>& contentHash, const Texture::SharedPtr& pTexture);
+        Texture::SharedPtr loadTextureFromFile(const TextureKey& key, const std::optional<TextureCache::Hash>& contentHash, const TextureCache::Options& cacheOptions);
 
         mutable std::mutex mMutex;                                  ///< Mutex for synchronizing access to shared resources.
-        std::condition_variable mCondition;                         ///< Condition variable to wait on for loading to finish.
 
         // Internal state. Do not access outside of critical section.
         std::vector<TextureDesc> mTextureDescs;                     ///< Array of all texture descs, indexed by handle ID.
         std::vector<TextureHandle> mFreeList;                       ///< List of unused handles.
         std::map<TextureKey, TextureHandle> mKeyToHandle;           ///< Map from texture key to handle.
         std::map<const Texture*, TextureHandle> mTextureToHandle;   ///< Map from texture ptr to handle.
+        std::map<ContentKey, TextureHandle> mContentToHandle;       ///< Map from file content to handle.
+        TextureCache::Options mCacheOptions;                        ///< Options for deduplication and the texture cache.
 
         AsyncTextureLoader mAsyncTextureLoader;                     ///< Utility for asynchronous texture loading.
         size_t mLoadRequestsInProgress = 0;                         ///< Number of load requests currently in progress.
+        std::unordered_map<uint32_t, AsyncTextureLoader::RequestID> mLoadRequests; ///< Async load requests in progress, indexed by handle ID.
+
+        TextureResidencyPolicy mResidencyPolicy;                    ///< Policy deciding the residency of textures to fit the memory budget.
+        std::unordered_map<uint32_t, ResidencyInfo> mResidency;     ///< Residency state of textures subject to the memory budget, indexed by handle ID.
+        TextureReplacedCallback mTextureReplacedCallback;           ///< Callback invoked when textures are replaced.
+        std::vector<std::pair<Texture::SharedPtr, Texture::SharedPtr>> mPendingReplacements; ///< Previews replaced by asynchronously loaded textures, passed to the callback in updateResidency().
+        uint64_t mFrame = 0;                                        ///< Current frame for tracking texture usage.
 
         const size_t mMaxTextureCount;                              ///< Maximum number of textures that can be simultaneously managed.
     };
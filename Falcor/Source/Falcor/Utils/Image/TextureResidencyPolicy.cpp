@@ -0,0 +1,142 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "TextureResidencyPolicy.h"
+#include <numeric>
+
+namespace Falcor
+{
+    void TextureResidencyPolicy::addTexture(uint32_t id, const std::vector<uint64_t>& mipSizes, uint32_t maxDroppedMipCount, uint64_t frame)
+    {
+        checkArgument(!mipSizes.empty(), "'mipSizes' must not be empty.");
+        removeTexture(id);
+
+        TextureInfo info;
+        maxDroppedMipCount = std::min(maxDroppedMipCount, (uint32_t)mipSizes.size() - 1);
+        info.residentSizes.resize(maxDroppedMipCount + 1);
+        uint64_t size = std::accumulate(mipSizes.begin(), mipSizes.end(), uint64_t(0));
+        for (uint32_t i = 0; i <= maxDroppedMipCount; i++)
+        {
+            info.residentSizes[i] = size;
+            size -= mipSizes[i];
+        }
+        info.lastUsedFrame = frame;
+
+        mTotalBytes += info.residentSizes[0];
+        mResidentBytes += info.residentSizes[0];
+        mTextures[id] = std::move(info);
+    }
+
+    void TextureResidencyPolicy::removeTexture(uint32_t id)
+    {
+        auto it = mTextures.find(id);
+        if (it == mTextures.end()) return;
+
+        mTotalBytes -= it->second.residentSizes[0];
+        mResidentBytes -= it->second.residentSizes[it->second.droppedMipCount];
+        mTextures.erase(it);
+    }
+
+    void TextureResidencyPolicy::markUsed(uint32_t id, uint64_t frame)
+    {
+        auto it = mTextures.find(id);
+        if (it != mTextures.end()) it->second.lastUsedFrame = std::max(it->second.lastUsedFrame, frame);
+    }
+
+    std::vector<TextureResidencyPolicy::Change> TextureResidencyPolicy::update(uint64_t frame)
+    {
+        // Order textures from least to most recently used. Ties are broken by ID to make the result deterministic.
+        std::vector<std::pair<uint32_t, TextureInfo*>> textures;
+        textures.reserve(mTextures.size());
+        for (auto& [id, info] : mTextures) textures.emplace_back(id, &info);
+        std::sort(textures.begin(), textures.end(), [](const auto& a, const auto& b)
+        {
+            if (a.second->lastUsedFrame != b.second->lastUsedFrame) return a.second->lastUsedFrame < b.second->lastUsedFrame;
+            return a.first < b.first;
+        });
+
+        // Start from all textures being fully resident.
+        std::vector<uint32_t> targets(textures.size(), 0);
+        uint64_t residentBytes = mTotalBytes;
+        const uint64_t budget = mOptions.budget > 0 ? mOptions.budget : std::numeric_limits<uint64_t>::max();
+
+        auto drop = [&](size_t i, uint32_t droppedMipCount)
+        {
+            const TextureInfo& info = *textures[i].second;
+            droppedMipCount = std::min(droppedMipCount, info.getMaxDroppedMipCount());
+            if (droppedMipCount <= targets[i]) return;
+            residentBytes -= info.residentSizes[targets[i]] - info.residentSizes[droppedMipCount];
+            targets[i] = droppedMipCount;
+        };
+
+        // Evict textures that have not been used recently.
+        for (size_t i = 0; i < textures.size() && residentBytes > budget; i++)
+        {
+            if (frame - std::min(frame, textures[i].second->lastUsedFrame) >= mOptions.evictionFrameCount) drop(i, UINT32_MAX);
+        }
+
+        // Drop the most detailed mip levels, one level at a time.
+        for (uint32_t level = 1; level <= mOptions.maxDroppedMipCount && residentBytes > budget; level++)
+        {
+            for (size_t i = 0; i < textures.size() && residentBytes > budget; i++) drop(i, level);
+        }
+
+        // Evict textures that are not used in the current frame.
+        for (size_t i = 0; i < textures.size() && residentBytes > budget; i++)
+        {
+            if (textures[i].second->lastUsedFrame < frame) drop(i, UINT32_MAX);
+        }
+
+        // Commit the new residency.
+        std::vector<Change> changes;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            TextureInfo& info = *textures[i].second;
+            if (info.droppedMipCount == targets[i]) continue;
+            info.droppedMipCount = targets[i];
+            changes.push_back({ textures[i].first, targets[i] });
+        }
+        mResidentBytes = residentBytes;
+
+        // Report changes in ID order.
+        std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b) { return a.id < b.id; });
+        return changes;
+    }
+
+    uint32_t TextureResidencyPolicy::getDroppedMipCount(uint32_t id) const
+    {
+        auto it = mTextures.find(id);
+        return it != mTextures.end() ? it->second.droppedMipCount : 0;
+    }
+
+    bool TextureResidencyPolicy::isEvicted(uint32_t id) const
+    {
+        auto it = mTextures.find(id);
+        return it != mTextures.end() && it->second.droppedMipCount > 0 && it->second.droppedMipCount == it->second.getMaxDroppedMipCount();
+    }
+}
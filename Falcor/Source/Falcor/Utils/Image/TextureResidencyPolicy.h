@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include <unordered_map>
+
+namespace Falcor
+{
+    /** Policy deciding which textures are resident at which resolution to fit a texture memory budget.
+
+        Textures are tracked by ID together with the size of each of their mip levels and the frame in which they were last used.
+        Each texture is resident with a number of its most detailed mip levels dropped. A texture that is dropped to its
+        coarsest allowed level is considered evicted.
+
+        On update(), the policy first evicts textures that have not been used for a number of frames, least recently used first.
+        If that is not sufficient, it drops the most detailed mip levels of the remaining textures, one level at a time and
+        least recently used first. As a last resort it evicts textures that were not used in the current frame.
+        Textures that are used again are restored as soon as the budget allows it.
+
+        The policy only does the bookkeeping, it does not touch any resources. It is not thread-safe.
+    */
+    class FALCOR_API TextureResidencyPolicy
+    {
+    public:
+        struct Options
+        {
+            uint64_t budget = 0;                    ///< Memory budget in bytes. 0 means unlimited.
+            uint32_t evictionFrameCount = 60;       ///< Number of frames a texture must have been unused before it is evicted.
+            uint32_t maxDroppedMipCount = 2;        ///< Maximum number of mip levels dropped from textures that are still in use.
+        };
+
+        /** Residency change of a texture.
+        */
+        struct Change
+        {
+            uint32_t id;                            ///< Texture ID.
+            uint32_t droppedMipCount;               ///< New number of dropped mip levels.
+        };
+
+        void setOptions(const Options& options) { mOptions = options; }
+        const Options& getOptions() const { return mOptions; }
+
+        /** Add a texture. The texture is initially resident with all mip levels.
+            \param[in] id Texture ID.
+            \param[in] mipSizes Size in bytes of each mip level, starting with the most detailed level.
+            \param[in] maxDroppedMipCount Maximum number of mip levels that can be dropped from the texture, dropping all of them evicts the texture.
+            \param[in] frame Current frame, the texture counts as used in this frame.
+        */
+        void addTexture(uint32_t id, const std::vector<uint64_t>& mipSizes, uint32_t maxDroppedMipCount, uint64_t frame);
+
+        /** Remove a texture.
+        */
+        void removeTexture(uint32_t id);
+
+        /** Mark a texture as used in a frame. Unknown IDs are ignored.
+        */
+        void markUsed(uint32_t id, uint64_t frame);
+
+        /** Compute the residency of all textures to fit the budget in a frame.
+            The computed residency is assumed to be applied by the caller.
+            \param[in] frame Current frame.
+            \return List of textures whose number of dropped mip levels changed.
+        */
+        std::vector<Change> update(uint64_t frame);
+
+        /** Returns the number of dropped mip levels of a texture, or 0 if the ID is unknown.
+        */
+        uint32_t getDroppedMipCount(uint32_t id) const;
+
+        /** Returns true if a texture is evicted.
+        */
+        bool isEvicted(uint32_t id) const;
+
+        /** Returns the number of bytes of resident mip levels.
+        */
+        uint64_t getResidentBytes() const { return mResidentBytes; }
+
+        /** Returns the number of bytes of mip levels that are not resident because they have been dropped.
+        */
+        uint64_t getEvictedBytes() const { return mTotalBytes - mResidentBytes; }
+
+        /** Returns the number of tracked textures.
+        */
+        size_t getTextureCount() const { return mTextures.size(); }
+
+    private:
+        struct TextureInfo
+        {
+            std::vector<uint64_t> residentSizes;    ///< Resident size in bytes for each number of dropped mip levels, up to the maximum.
+            uint64_t lastUsedFrame = 0;
+            uint32_t droppedMipCount = 0;
+
+            uint32_t getMaxDroppedMipCount() const { return (uint32_t)residentSizes.size() - 1; }
+        };
+
+        Options mOptions;
+        std::unordered_map<uint32_t, TextureInfo> mTextures;
+        uint64_t mTotalBytes = 0;
+        uint64_t mResidentBytes = 0;
+    };
+}
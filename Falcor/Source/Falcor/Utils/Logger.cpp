@@ -27,16 +27,21 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "Logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 
 namespace Falcor
 {
     namespace
     {
-        Logger::Level sVerbosity = Logger::Level::Info;
-        Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+        std::atomic<Logger::Level> sVerbosity = Logger::Level::Info;
+        std::atomic<Logger::OutputFlags> sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
         std::string sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
+        // Log file state. Only accessed by the thread writing the messages, except for setting the path.
+        std::mutex sFileMutex;
         bool sInitialized = false;
         FILE* sLogFile = nullptr;
 
@@ -68,8 +73,9 @@ namespace Falcor
             return pFile;
         }
 
-        void printToLogFile(const std::string& s)
+        void printToLogFile(const std::string& s, bool flush)
         {
+            std::lock_guard<std::mutex> lock(sFileMutex);
             if (!sInitialized)
             {
                 sLogFile = openLogFile();
@@ -79,76 +85,362 @@ namespace Falcor
             if (sLogFile)
             {
                 std::fprintf(sLogFile, "%s", s.c_str());
-                std::fflush(sLogFile);
+                if (flush) std::fflush(sLogFile);
             }
         }
-#endif
-    }
 
-    void Logger::shutdown()
-    {
-#if FALCOR_ENABLE_LOGGER
-        if(sLogFile)
+        void flushLogFile()
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
-            sInitialized = false;
+            std::lock_guard<std::mutex> lock(sFileMutex);
+            if (sLogFile) std::fflush(sLogFile);
         }
 #endif
-    }
 
-    const char* getLogLevelString(Logger::Level level)
-    {
-        switch (level)
-        {
-        case Logger::Level::Fatal:
-            return "(Fatal)";
-        case Logger::Level::Error:
-            return "(Error)";
-        case Logger::Level::Warning:
-            return "(Warning)";
-        case Logger::Level::Info:
-            return "(Info)";
-        case Logger::Level::Debug:
-            return "(Debug)";
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+        const char* getLogLevelString(Logger::Level level)
+        {
+            switch (level)
+            {
+            case Logger::Level::Fatal:
+                return "(Fatal)";
+            case Logger::Level::Error:
+                return "(Error)";
+            case Logger::Level::Warning:
+                return "(Warning)";
+            case Logger::Level::Info:
+                return "(Info)";
+            case Logger::Level::Debug:
+                return "(Debug)";
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
+            }
         }
-    }
 
-    void Logger::log(Level level, const std::string_view msg)
-    {
 #if FALCOR_ENABLE_LOGGER
-        if (level <= sVerbosity)
+        // Writes a message to all outputs. The log file is only flushed if requested, which the writer thread
+        // does when it runs out of messages. Must only be called by one thread at a time.
+        void writeMessage(Logger::Level level, const std::string& msg, bool flush)
         {
             std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+            Logger::OutputFlags outputs = sOutputs.load(std::memory_order_relaxed);
 
             // Write to console.
-            if (is_set(sOutputs, OutputFlags::Console))
+            if (is_set(outputs, Logger::OutputFlags::Console))
             {
                 if (level > Logger::Level::Error) std::cout << s;
                 else std::cerr << s;
             }
 
             // Write to file.
-            if (is_set(sOutputs, OutputFlags::File))
+            if (is_set(outputs, Logger::OutputFlags::File))
             {
-                printToLogFile(s);
+                printToLogFile(s, flush);
             }
 
             // Write to debug window if debugger is attached.
-            if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
+            if (is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent())
             {
                 printToDebugWindow(s);
             }
         }
+
+        // Per-level rate limiting using a fixed one second window.
+        struct RateLimit
+        {
+            std::atomic<uint32_t> messagesPerSecond = 0;    ///< Maximum number of messages per second, or 0 for no limit.
+            std::atomic<int64_t> windowStart = 0;           ///< Start of the current window in ms.
+            std::atomic<uint32_t> windowCount = 0;          ///< Number of messages in the current window.
+            std::atomic<uint64_t> suppressedCount = 0;      ///< Total number of suppressed messages.
+            std::atomic<uint64_t> unreportedCount = 0;      ///< Number of suppressed messages not yet reported in the log.
+
+            /** Count a message against the limit.
+                \return True if the message should be logged.
+            */
+            bool acquire()
+            {
+                uint32_t limit = messagesPerSecond.load(std::memory_order_relaxed);
+                if (limit == 0) return true;
+
+                int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                int64_t start = windowStart.load(std::memory_order_relaxed);
+                if (now - start >= 1000 && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+                {
+                    windowCount.store(0, std::memory_order_relaxed);
+                }
+
+                if (windowCount.fetch_add(1, std::memory_order_relaxed) < limit) return true;
+                suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                unreportedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        };
+
+        RateLimit sRateLimits[(size_t)Logger::Level::Count];
+
+        // Bounded multi-producer single-consumer queue of log messages.
+        // Each slot carries a sequence number telling whether it is free for the producer claiming that position,
+        // or holds a message for the consumer (see Dmitry Vyukov's bounded MPMC queue).
+        class MessageQueue
+        {
+        public:
+            MessageQueue()
+                : mSlots(new Slot[kCapacity])
+            {
+                for (size_t i = 0; i < kCapacity; i++) mSlots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /** Try to push a message.
+                \return True if the message was pushed, false if the queue is full.
+            */
+            bool tryPush(Logger::Level level, std::string& msg)
+            {
+                size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    Slot& slot = mSlots[pos & (kCapacity - 1)];
+                    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+                    if (diff == 0)
+                    {
+                        if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            slot.level = level;
+                            slot.msg = std::move(msg);
+                            slot.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = mEnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            /** Try to pop a message. Must only be called by the consumer.
+                \return True if a message was popped, false if the queue is empty.
+            */
+            bool tryPop(Logger::Level& level, std::string& msg)
+            {
+                Slot& slot = mSlots[mDequeuePos & (kCapacity - 1)];
+                if (slot.sequence.load(std::memory_order_acquire) != mDequeuePos + 1) return false;
+                level = slot.level;
+                msg = std::move(slot.msg);
+                slot.sequence.store(mDequeuePos + kCapacity, std::memory_order_release);
+                mDequeuePos++;
+                return true;
+            }
+
+            /** Get the number of messages pushed so far.
+            */
+            size_t getPushedCount() const { return mEnqueuePos.load(std::memory_order_acquire); }
+
+        private:
+            static const size_t kCapacity = 4096; ///< Must be a power of two.
+
+            struct Slot
+            {
+                std::atomic<size_t> sequence;
+                Logger::Level level;
+                std::string msg;
+            };
+
+            std::unique_ptr<Slot[]> mSlots;
+            alignas(64) std::atomic<size_t> mEnqueuePos = 0;
+            alignas(64) size_t mDequeuePos = 0;
+        };
+
+        // Background thread writing the queued messages to the outputs.
+        class LogWriter
+        {
+        public:
+            LogWriter()
+            {
+                mThread = std::thread(&LogWriter::run, this);
+            }
+
+            /** Queue a message. Blocks while the queue is full.
+            */
+            void push(Logger::Level level, std::string&& msg)
+            {
+                while (!mQueue.tryPush(level, msg))
+                {
+                    if (mTerminate) return;
+                    mWakeup.notify_one();
+                    std::this_thread::yield();
+                }
+                if (mSleeping.load(std::memory_order_acquire)) mWakeup.notify_one();
+            }
+
+            /** Wait until all messages queued before the call are written and the log file is flushed.
+                Returns early if the writer is being stopped, as the remaining messages are then written by the stopping thread.
+            */
+            void flush()
+            {
+                size_t target = mQueue.getPushedCount();
+                while (mWrittenCount.load(std::memory_order_acquire) < target || mFlushedCount.load(std::memory_order_acquire) < target)
+                {
+                    if (mTerminate) return;
+                    mWakeup.notify_one();
+                    std::this_thread::yield();
+                }
+            }
+
+            /** Write all queued messages and stop the writer thread.
+            */
+            void stop()
+            {
+                mTerminate = true;
+                mWakeup.notify_one();
+                mThread.join();
+            }
+
+        private:
+            void run()
+            {
+                Logger::Level level;
+                std::string msg;
+                while (true)
+                {
+                    bool wrote = false;
+                    while (mQueue.tryPop(level, msg))
+                    {
+                        writeMessage(level, msg, false);
+                        mWrittenCount.fetch_add(1, std::memory_order_release);
+                        wrote = true;
+                    }
+
+                    reportSuppressedMessages();
+
+                    if (wrote)
+                    {
+                        flushLogFile();
+                        mFlushedCount.store(mWrittenCount.load(std::memory_order_relaxed), std::memory_order_release);
+                    }
+
+                    if (wrote) continue;
+
+                    if (mTerminate) break;
+
+                    // Sleep until woken by a producer. The timeout guards against missed wakeups, as producers don't take the mutex.
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    mSleeping.store(true, std::memory_order_release);
+                    mWakeup.wait_for(lock, std::chrono::milliseconds(10));
+                    mSleeping.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            void reportSuppressedMessages()
+            {
+                for (size_t i = 0; i < (size_t)Logger::Level::Count; i++)
+                {
+                    uint64_t count = sRateLimits[i].unreportedCount.exchange(0, std::memory_order_relaxed);
+                    if (count > 0)
+                    {
+                        writeMessage(Logger::Level::Warning, fmt::format("Suppressed {} {} messages exceeding the rate limit.", count, getLogLevelString((Logger::Level)i)), false);
+                    }
+                }
+            }
+
+            MessageQueue mQueue;
+            std::thread mThread;
+            std::mutex mMutex;
+            std::condition_variable mWakeup;
+            std::atomic<bool> mSleeping = false;
+            std::atomic<bool> mTerminate = false;
+            std::atomic<size_t> mWrittenCount = 0;  ///< Number of messages written.
+            std::atomic<size_t> mFlushedCount = 0;  ///< Number of messages written and flushed to the log file.
+        };
+
+        // The writer is started on the first message and stopped on shutdown. Messages logged while no writer is running,
+        // e.g. during static destruction, are written synchronously.
+        std::mutex sWriterMutex;
+        LogWriter* spWriter = nullptr;
+        std::atomic<bool> sWriterStopped = false;
+
+        // Writes the remaining messages when the application is terminated through std::quick_exit(), e.g. by reportError().
+        // Other threads keep running until the quick exit handlers return, so the writer thread can be joined.
+        void shutdownAtQuickExit()
+        {
+            Logger::shutdown();
+        }
+
+        LogWriter* getWriter()
+        {
+            static std::once_flag sOnce;
+            std::call_once(sOnce, []()
+            {
+                spWriter = new LogWriter();
+                std::at_quick_exit(shutdownAtQuickExit);
+            });
+            return sWriterStopped ? nullptr : spWriter;
+        }
+#endif
+    }
+
+    void Logger::shutdown()
+    {
+#if FALCOR_ENABLE_LOGGER
+        {
+            std::lock_guard<std::mutex> lock(sWriterMutex);
+            if (spWriter && !sWriterStopped)
+            {
+                sWriterStopped = true;
+                spWriter->stop();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(sFileMutex);
+        if(sLogFile)
+        {
+            fclose(sLogFile);
+            sLogFile = nullptr;
+            sInitialized = false;
+        }
+#endif
+    }
+
+    void Logger::log(Level level, const std::string_view msg)
+    {
+#if FALCOR_ENABLE_LOGGER
+        if (level <= sVerbosity.load(std::memory_order_relaxed))
+        {
+            if (!sRateLimits[(size_t)level].acquire()) return;
+
+            LogWriter* pWriter = getWriter();
+            if (pWriter)
+            {
+                // Formatting the level prefix and writing to the outputs is deferred to the writer thread.
+                pWriter->push(level, std::string(msg));
+
+                // Make sure errors are written before the application terminates.
+                if (level <= Level::Error) pWriter->flush();
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(sWriterMutex);
+                writeMessage(level, std::string(msg), true);
+            }
+        }
+#endif
+    }
+
+    void Logger::flush()
+    {
+#if FALCOR_ENABLE_LOGGER
+        LogWriter* pWriter = getWriter();
+        if (pWriter) pWriter->flush();
 #endif
     }
 
     bool Logger::setLogFilePath(const std::string& path)
     {
 #if FALCOR_ENABLE_LOGGER
+        std::lock_guard<std::mutex> lock(sFileMutex);
         if (sLogFile)
         {
             return false;
@@ -166,8 +458,38 @@ namespace Falcor
     void Logger::setVerbosity(Level level) { sVerbosity = level; }
     Logger::Level Logger::getVerbosity() { return sVerbosity; }
 
+    bool Logger::isLevelEnabled(Level level)
+    {
+        return enabled() && level <= sVerbosity.load(std::memory_order_relaxed);
+    }
+
     void Logger::setOutputs(OutputFlags outputs) { sOutputs = outputs; }
     Logger::OutputFlags Logger::getOutputs() { return sOutputs; }
 
     const std::string& Logger::getLogFilePath() { return sLogFilePath; }
+
+    void Logger::setRateLimit(Level level, uint32_t messagesPerSecond)
+    {
+#if FALCOR_ENABLE_LOGGER
+        sRateLimits[(size_t)level].messagesPerSecond = messagesPerSecond;
+#endif
+    }
+
+    uint32_t Logger::getRateLimit(Level level)
+    {
+#if FALCOR_ENABLE_LOGGER
+        return sRateLimits[(size_t)level].messagesPerSecond;
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t Logger::getSuppressedCount(Level level)
+    {
+#if FALCOR_ENABLE_LOGGER
+        return sRateLimits[(size_t)level].suppressedCount;
+#else
+        return 0;
+#endif
+    }
 }
@@ -33,6 +33,8 @@ namespace Falcor
     /** Container class for logging messages.
         To enable log messages, make sure FALCOR_ENABLE_LOGGER is set to `1` in FalcorConfig.h.
         Messages are only printed to the selected outputs if they match the verbosity level.
+        Messages are queued in a lock-free queue and written to the outputs by a background thread,
+        so logging does not block the calling thread on I/O. Fatal messages are written before log() returns.
     */
     class FALCOR_API Logger
     {
@@ -61,9 +63,16 @@ namespace Falcor
         };
 
         /** Shutdown the logger and close the log file.
+            Queued messages are written before returning. Messages logged after shutdown are written synchronously.
+            Applications must call this before returning from main(), otherwise queued messages may be lost.
+            Error and fatal messages are always written before logging returns, and the logger is shut down on std::quick_exit().
         */
         static void shutdown();
 
+        /** Wait until all messages logged so far are written to the outputs.
+        */
+        static void flush();
+
         /** Set the logger verbosity.
             \param level Log level.
         */
@@ -74,6 +83,31 @@ namespace Falcor
         */
         static Level getVerbosity();
 
+        /** Check if messages of a given level are logged with the current verbosity.
+            \param level Log level.
+            \return Return true if messages of the given level are logged.
+        */
+        static bool isLevelEnabled(Level level);
+
+        /** Limit the number of messages logged per second for a given level.
+            Messages exceeding the limit are dropped, and the number of dropped messages is reported in the log.
+            \param level Log level.
+            \param messagesPerSecond Maximum number of messages per second, or 0 to disable the limit.
+        */
+        static void setRateLimit(Level level, uint32_t messagesPerSecond);
+
+        /** Get the rate limit for a given level.
+            \param level Log level.
+            \return Return the maximum number of messages per second, or 0 if there is no limit.
+        */
+        static uint32_t getRateLimit(Level level);
+
+        /** Get the total number of messages dropped due to the rate limit for a given level.
+            \param level Log level.
+            \return Return the number of dropped messages.
+        */
+        static uint64_t getSuppressedCount(Level level);
+
         /** Set the logger outputs.
             \param outputs Log outputs.
         */
@@ -115,6 +149,7 @@ namespace Falcor
     // We define two types of logging helpers, one taking raw strings,
     // the other taking formatted strings. We don't want string formatting and
     // errors being thrown due to missing arguments when passing raw strings.
+    // Formatting is skipped for messages filtered out by the verbosity level.
 
     inline void logDebug(const std::string_view msg)
     {
@@ -124,6 +159,7 @@ namespace Falcor
     template<typename... Args>
     inline void logDebug(const std::string_view fmtString, Args&&... args)
     {
+        if (!Logger::isLevelEnabled(Logger::Level::Debug)) return;
         Logger::log(Logger::Level::Debug, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
@@ -135,6 +171,7 @@ namespace Falcor
     template<typename... Args>
     inline void logInfo(const std::string_view fmtString, Args&&... args)
     {
+        if (!Logger::isLevelEnabled(Logger::Level::Info)) return;
         Logger::log(Logger::Level::Info, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
@@ -146,6 +183,7 @@ namespace Falcor
     template<typename... Args>
     inline void logWarning(const std::string_view fmtString, Args&&... args)
     {
+        if (!Logger::isLevelEnabled(Logger::Level::Warning)) return;
         Logger::log(Logger::Level::Warning, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
@@ -157,6 +195,7 @@ namespace Falcor
     template<typename... Args>
     inline void logError(const std::string_view fmtString, Args&&... args)
     {
+        if (!Logger::isLevelEnabled(Logger::Level::Error)) return;
         Logger::log(Logger::Level::Error, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 
@@ -168,6 +207,7 @@ namespace Falcor
     template<typename... Args>
     inline void logFatal(const std::string_view fmtString, Args&&... args)
     {
+        if (!Logger::isLevelEnabled(Logger::Level::Fatal)) return;
         Logger::log(Logger::Level::Fatal, fmt::format(fmtString, std::forward<Args>(args)...));
     }
 }
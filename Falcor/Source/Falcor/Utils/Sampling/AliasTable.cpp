@@ -27,113 +27,244 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "AliasTable.h"
+#include "Utils/NumericRange.h"
+#include <execution>
+#include <numeric>
 
 namespace Falcor
 {
-    AliasTable::SharedPtr AliasTable::create(std::vector<float> weights, std::mt19937& rng)
+    namespace
     {
-        return SharedPtr(new AliasTable(std::move(weights), rng));
-    }
+        const size_t kParallelBuildThreshold = 1 << 16;     ///< Tables with fewer entries are built serially.
+        const size_t kMinChunkSize = 1 << 14;               ///< Minimum number of entries per task in the parallel build.
 
-    void AliasTable::setShaderData(const ShaderVar& var) const
-    {
-        var["items"] = mpItems;
-        var["weights"] = mpWeights;
-        var["count"] = mCount;
-        var["weightSum"] = (float)mWeightSum;
-    }
+        // This builds an alias table via the O(N) algorithm from Vose 1991, "A linear algorithm for generating random
+        // numbers with a given distribution," IEEE Transactions on Software Engineering 17(9), 972-975.
+        //
+        // Basic idea:  creating each alias table entry combines one overweighted sample and one underweighted sample
+        // into one alias table entry plus a residual sample (the overweighted sample minus some of its weight).
+        //
+        // By first separating all inputs into 2 temporary buffer (one overweighted set, with weights above the
+        // average; one underweighted set, with weights below average), we can simply walk through the lists once,
+        // merging the first elements in each temporary buffer.  The residual sample is interted into either the
+        // overweighted or underweighted set, depending on its residual weight.
+        //
+        // The main complexity is dealing with corner cases, thanks to numerical precision issues, where you don't
+        // have 2 valid entries to combine.  By definition, in these corner cases, all remaining unhandled samples
+        // actually have the average weight (within numerical precision limits)
+        std::vector<AliasTable::Item> buildItemsSerial(std::vector<float> weights, double weightSum)
+        {
+            const uint32_t count = (uint32_t)weights.size();
 
-    // This builds an alias table via the O(N) algorithm from Vose 1991, "A linear algorithm for generating random
-    // numbers with a given distribution," IEEE Transactions on Software Engineering 17(9), 972-975.
-    //
-    // Basic idea:  creating each alias table entry combines one overweighted sample and one underweighted sample
-    // into one alias table entry plus a residual sample (the overweighted sample minus some of its weight).
-    //
-    // By first separating all inputs into 2 temporary buffer (one overweighted set, with weights above the
-    // average; one underweighted set, with weights below average), we can simply walk through the lists once,
-    // merging the first elements in each temporary buffer.  The residual sample is interted into either the
-    // overweighted or underweighted set, depending on its residual weight.
-    //
-    // The main complexity is dealing with corner cases, thanks to numerical precision issues, where you don't
-    // have 2 valid entries to combine.  By definition, in these corner cases, all remaining unhandled samples
-    // actually have the average weight (within numerical precision limits)
-    AliasTable::AliasTable(std::vector<float> weights, std::mt19937& rng)
-        : mCount((uint32_t)weights.size())
-    {
-        // Use >= since we reserve 0xFFFFFFFFu as an invalid flag marker during construction.
-        if (weights.size() >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many entries for alias table.");
+            // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
+            std::vector<uint32_t> lowIdx(count, 0xFFFFFFFFu);
+            std::vector<uint32_t> highIdx(count, 0xFFFFFFFFu);
 
-        std::uniform_int_distribution<uint32_t> rngDist;
+            // Find the average weight
+            float avgWeight = float(weightSum / double(count));
 
-        mpWeights = Buffer::createStructured(sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
+            // Initialize working set. Inset inputs into our lists of above-average or below-average weight elements.
+            int lowCount = 0;
+            int highCount = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (weights[i] < avgWeight)
+                    lowIdx[lowCount++] = i;
+                else
+                    highIdx[highCount++] = i;
+            }
 
-        // Our working set / intermediate buffers (underweight & overweight); initialize to "invalid"
-        std::vector<uint32_t> lowIdx(mCount, 0xFFFFFFFFu);
-        std::vector<uint32_t> highIdx(mCount, 0xFFFFFFFFu);
+            // Create alias table entries by merging above- and below-average samples
+            std::vector<AliasTable::Item> items(count);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
+                if ((lowIdx[i] != 0xFFFFFFFFu) && (highIdx[i] != 0xFFFFFFFFu))
+                {
+                    // Create an alias table tuple:
+                    items[i] = { weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0 };
 
-        // Sum element weights, use double to minimize precision issues
-        mWeightSum = 0.0;
-        for (float f : weights) mWeightSum += f;
+                    // We've removed some weight from element highIdx[i]; update it's weight, then re-enter it
+                    // on the end of either the above-average or below-average lists.
+                    float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
+                    weights[highIdx[i]] = updatedWeight;
+                    if (updatedWeight < avgWeight)
+                        lowIdx[lowCount++] = highIdx[i];
+                    else
+                        highIdx[highCount++] = highIdx[i];
+                }
 
-        // Find the average weight
-        float avgWeight = float(mWeightSum / double(mCount));
+                // The next two cases can only occur towards the end of table creation, because either:
+                //    (a) all the remaining possible alias table entries have weight *exactly* equal to avgWeight,
+                //        which means these alias table entries only have one input item that is selected
+                //        with 100% probability
+                //    (b) all the remaining alias table entires have *almost* avgWeight, but due to (compounding)
+                //        precision issues throughout the process, they don't have *quite* that value.  In this case
+                //        treating these entries as having exactly avgWeight (as in case (a)) is the only right
+                //        thing to do mathematically (other than re-generating the alias table using higher precision
+                //        or trying to reduce catasrophic numerical cancellation in the "updatedWeight" computation above).
+                else if (highIdx[i] != 0xFFFFFFFFu)
+                {
+                    items[i] = { 1.0f, highIdx[i], highIdx[i], 0 };
+                }
+                else if (lowIdx[i] != 0xFFFFFFFFu)
+                {
+                    items[i] = { 1.0f, lowIdx[i], lowIdx[i], 0 };
+                }
 
-        // Initialize working set. Inset inputs into our lists of above-average or below-average weight elements.
-        int lowCount = 0;
-        int highCount = 0;
-        for (uint32_t i = 0; i < mCount; ++i)
-        {
-            if (weights[i] < avgWeight)
-                lowIdx[lowCount++] = i;
-            else
-                highIdx[highCount++] = i;
+                // If there is neither a highIdx[i] or lowIdx[i] for some array element(s).  By construction,
+                // this cannot occur (without some logic bug above).
+                else
+                {
+                    FALCOR_ASSERT(false); // Should not occur
+                }
+            }
+
+            return items;
         }
 
-        // Create alias table entries by merging above- and below-average samples
-        std::vector<AliasTable::Item> items(mCount);
-        for (uint32_t i = 0; i < mCount; ++i)
+        // This builds an alias table in parallel using the sweeping/splitting scheme from Huebschle-Schneider and Sanders 2019,
+        // "Parallel Weighted Random Sampling", ESA 2019.
+        //
+        // The inputs are partitioned into light (below average) and heavy (above average) items. A sequential sweep then fills
+        // each light item's bucket from the current heavy item. Once a heavy item has given away its excess weight, it becomes
+        // light itself: it gets its own bucket, which is filled from the next heavy item.
+        //
+        // With D(i) the prefix sum of deficits (avg - w) of the first i light items and E(j) the prefix sum of excesses (w - avg)
+        // of the first j heavy items, the sweep takes a light item next iff D(i) < E(j + 1). This is a merge of the two sorted
+        // sequences D and E, so the sweep state after k steps is found by a binary search on the k-th diagonal ("merge path").
+        // Every bucket is a function of the sweep state alone, so independent chunks of the output are built in parallel.
+        std::vector<AliasTable::Item> buildItemsParallel(const std::vector<float>& weights, double weightSum)
         {
-            // Usual case:  We have an above-average and below-average sample we can combine into one alias table entry
-            if ((lowIdx[i] != 0xFFFFFFFFu) && (highIdx[i] != 0xFFFFFFFFu))
-            {
-                // Create an alias table tuple:
-                items[i] = { weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i], 0 };
-
-                // We've removed some weight from element highIdx[i]; update it's weight, then re-enter it
-                // on the end of either the above-average or below-average lists.
-                float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
-                weights[highIdx[i]] = updatedWeight;
-                if (updatedWeight < avgWeight)
-                    lowIdx[lowCount++] = highIdx[i];
-                else
-                    highIdx[highCount++] = highIdx[i];
-            }
+            const size_t count = weights.size();
+            const double avgWeight = weightSum / double(count);
+
+            const size_t chunkCount = std::clamp<size_t>(count / kMinChunkSize, 1, 4 * std::max(1u, std::thread::hardware_concurrency()));
+            auto chunkBegin = [&](size_t chunk) { return chunk * count / chunkCount; };
+            auto isLight = [&](size_t i) { return (double)weights[i] < avgWeight; };
+            NumericRange<size_t> chunks(0, chunkCount);
 
-            // The next two cases can only occur towards the end of table creation, because either:
-            //    (a) all the remaining possible alias table entries have weight *exactly* equal to avgWeight,
-            //        which means these alias table entries only have one input item that is selected
-            //        with 100% probability
-            //    (b) all the remaining alias table entires have *almost* avgWeight, but due to (compounding)
-            //        precision issues throughout the process, they don't have *quite* that value.  In this case
-            //        treating these entries as having exactly avgWeight (as in case (a)) is the only right
-            //        thing to do mathematically (other than re-generating the alias table using higher precision
-            //        or trying to reduce catasrophic numerical cancellation in the "updatedWeight" computation above).
-            else if (highIdx[i] != 0xFFFFFFFFu)
+            // Partition the inputs into light and heavy items, preserving their order.
+            std::vector<size_t> lightOffsets(chunkCount + 1, 0);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk)
             {
-                items[i] = { 1.0f, highIdx[i], highIdx[i], 0 };
-            }
-            else if (lowIdx[i] != 0xFFFFFFFFu)
+                size_t lightCount = 0;
+                for (size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); i++) lightCount += isLight(i) ? 1 : 0;
+                lightOffsets[chunk + 1] = lightCount;
+            });
+            std::partial_sum(lightOffsets.begin(), lightOffsets.end(), lightOffsets.begin());
+
+            const size_t lightCount = lightOffsets[chunkCount];
+            const size_t heavyCount = count - lightCount;
+            std::vector<uint32_t> lightIdx(lightCount);
+            std::vector<uint32_t> heavyIdx(heavyCount);
+
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk)
             {
-                items[i] = { 1.0f, lowIdx[i], lowIdx[i], 0 };
-            }
+                size_t lightPos = lightOffsets[chunk];
+                size_t heavyPos = chunkBegin(chunk) - lightPos;
+                for (size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); i++)
+                {
+                    if (isLight(i)) lightIdx[lightPos++] = (uint32_t)i;
+                    else heavyIdx[heavyPos++] = (uint32_t)i;
+                }
+            });
+
+            // Compute prefix sums of the light deficits and heavy excesses.
+            std::vector<double> deficits(lightCount + 1, 0.0);
+            std::vector<double> excesses(heavyCount + 1, 0.0);
+            std::transform_inclusive_scan(std::execution::par, lightIdx.begin(), lightIdx.end(), deficits.begin() + 1, std::plus<double>(),
+                [&](uint32_t i) { return avgWeight - weights[i]; });
+            std::transform_inclusive_scan(std::execution::par, heavyIdx.begin(), heavyIdx.end(), excesses.begin() + 1, std::plus<double>(),
+                [&](uint32_t i) { return weights[i] - avgWeight; });
+
+            // Returns true if the sweep takes a light item in state (i, j). Ties go to the heavy item.
+            auto takeLight = [&](size_t i, size_t j) { return i < lightCount && (j >= heavyCount || deficits[i] < excesses[j + 1]); };
 
-            // If there is neither a highIdx[i] or lowIdx[i] for some array element(s).  By construction,
-            // this cannot occur (without some logic bug above).
-            else
+            // Sweep each chunk of the output independently.
+            std::vector<AliasTable::Item> items(count);
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk)
             {
-                FALCOR_ASSERT(false); // Should not occur
-            }
+                const size_t begin = chunkBegin(chunk);
+                const size_t end = chunkBegin(chunk + 1);
+
+                // Find the number of light items taken in the first 'begin' steps.
+                size_t lo = begin > heavyCount ? begin - heavyCount : 0;
+                size_t hi = std::min(begin, lightCount);
+                while (lo < hi)
+                {
+                    size_t mid = (lo + hi + 1) / 2;
+                    size_t j = begin - mid;
+                    if (j >= heavyCount || deficits[mid - 1] < excesses[j + 1]) lo = mid;
+                    else hi = mid - 1;
+                }
+
+                size_t i = lo;
+                size_t j = begin - lo;
+                for (size_t k = begin; k < end; k++)
+                {
+                    if (takeLight(i, j))
+                    {
+                        // Fill the light item's bucket from the current heavy item.
+                        uint32_t idx = lightIdx[i];
+                        if (j < heavyCount) items[k] = { float(weights[idx] / avgWeight), heavyIdx[j], idx, 0 };
+                        else items[k] = { 1.f, idx, idx, 0 }; // Precision corner case, see buildItemsSerial().
+                        i++;
+                    }
+                    else
+                    {
+                        // The heavy item has given away its excess. Fill its bucket from the next heavy item.
+                        uint32_t idx = heavyIdx[j];
+                        double remaining = weights[idx] - (deficits[i] - excesses[j]);
+                        if (j + 1 < heavyCount) items[k] = { (float)std::clamp(remaining / avgWeight, 0.0, 1.0), heavyIdx[j + 1], idx, 0 };
+                        else items[k] = { 1.f, idx, idx, 0 };
+                        j++;
+                    }
+                }
+            });
+
+            return items;
         }
+    }
+
+    AliasTable::SharedPtr AliasTable::create(std::vector<float> weights, std::mt19937& rng)
+    {
+        return SharedPtr(new AliasTable(std::move(weights), rng));
+    }
+
+    std::vector<AliasTable::Item> AliasTable::buildItems(const std::vector<float>& weights, double& weightSum)
+    {
+        // Use >= since we reserve 0xFFFFFFFFu as an invalid flag marker during construction.
+        if (weights.size() >= std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many entries for alias table.");
+
+        if (weights.size() < kParallelBuildThreshold)
+        {
+            // Sum element weights, use double to minimize precision issues
+            weightSum = 0.0;
+            for (float f : weights) weightSum += f;
+
+            return buildItemsSerial(weights, weightSum);
+        }
+        else
+        {
+            weightSum = std::transform_reduce(std::execution::par, weights.begin(), weights.end(), 0.0, std::plus<double>(), [](float f) { return (double)f; });
+
+            return buildItemsParallel(weights, weightSum);
+        }
+    }
+
+    void AliasTable::setShaderData(const ShaderVar& var) const
+    {
+        var["items"] = mpItems;
+        var["weights"] = mpWeights;
+        var["count"] = mCount;
+        var["weightSum"] = (float)mWeightSum;
+    }
+
+    AliasTable::AliasTable(std::vector<float> weights, std::mt19937& rng)
+        : mCount((uint32_t)weights.size())
+    {
+        std::vector<Item> items = buildItems(weights, mWeightSum);
 
         // TODO: We can simplify the alias table to implicitly store indexB (aka lowIdx[i]), so the AliasTable::Item
         // structure would be 1 float + 1 uint32_t, rather than 128 bits.  This, of course, would change usage in shaders
@@ -143,6 +274,7 @@ namespace Falcor
         // correct location in the alias table.
 
         // Stash the alias table in our GPU buffer
+        mpWeights = Buffer::createStructured(sizeof(float), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, weights.data());
         mpItems = Buffer::createStructured(sizeof(AliasTable::Item), mCount, Resource::BindFlags::ShaderResource, Buffer::CpuAccess::None, items.data());
     }
 }
@@ -28,6 +28,9 @@
 #include "stdafx.h"
 #include "Profiler.h"
 #include "Core/API/GpuTimer.h"
+#include "rapidjson/rapidjson.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 #include <sstream>
 #include <fstream>
 #define USE_PIX
@@ -45,6 +48,155 @@ namespace Falcor
         // Size of the event history. The event history is keeping track of event times to allow
         // for computing statistics (min, max, mean, stddev) over the recent history.
         const size_t kMaxHistorySize = 512;
+
+        // Trace events are recorded into per-thread buffers. Each buffer has a single producer (its thread) and a
+        // single consumer (the main thread collecting the capture), and is a linked list of fixed-size chunks.
+        // The producer publishes events by incrementing the chunk's event count, so recording does not take locks.
+        class ThreadTraceBuffer
+        {
+        public:
+            struct Event
+            {
+                Profiler::TraceEvent::Type type;
+                std::string name;
+                uint64_t id;
+                CpuTimer::TimePoint time;
+            };
+
+            ThreadTraceBuffer(uint32_t threadIndex) : mThreadIndex(threadIndex), mpHead(new Chunk), mpTail(mpHead) {}
+
+            ~ThreadTraceBuffer()
+            {
+                while (mpHead)
+                {
+                    Chunk* pNext = mpHead->pNext.load();
+                    delete mpHead;
+                    mpHead = pNext;
+                }
+            }
+
+            uint32_t getThreadIndex() const { return mThreadIndex; }
+
+            /** Mark the buffer as finished when its thread exits. A finished buffer can be released once consumed.
+            */
+            void setFinished() { mFinished.store(true, std::memory_order_release); }
+            bool isFinished() const { return mFinished.load(std::memory_order_acquire); }
+
+            /** Append an event. Must only be called from the buffer's thread.
+            */
+            void push(Profiler::TraceEvent::Type type, const std::string& name, uint64_t id)
+            {
+                uint32_t count = mpTail->count.load(std::memory_order_relaxed);
+                if (count == kChunkSize)
+                {
+                    Chunk* pChunk = new Chunk;
+                    mpTail->pNext.store(pChunk, std::memory_order_release);
+                    mpTail = pChunk;
+                    count = 0;
+                }
+                mpTail->events[count] = { type, name, id, CpuTimer::getCurrentTimePoint() };
+                mpTail->count.store(count + 1, std::memory_order_release);
+            }
+
+            /** Call a function on all events published since the last call and release the consumed chunks.
+                Must only be called from one thread at a time.
+            */
+            template<typename F>
+            void consume(F func)
+            {
+                while (true)
+                {
+                    uint32_t count = mpHead->count.load(std::memory_order_acquire);
+                    for (; mHeadIndex < count; mHeadIndex++) func(mpHead->events[mHeadIndex]);
+                    if (mHeadIndex < kChunkSize) break;
+                    Chunk* pNext = mpHead->pNext.load(std::memory_order_acquire);
+                    if (!pNext) break;
+                    delete mpHead;
+                    mpHead = pNext;
+                    mHeadIndex = 0;
+                }
+            }
+
+            std::string name;   ///< Thread name. Protected by the registry mutex.
+
+        private:
+            static const uint32_t kChunkSize = 1024;
+
+            struct Chunk
+            {
+                std::array<Event, kChunkSize> events;
+                std::atomic<uint32_t> count = 0;
+                std::atomic<Chunk*> pNext = nullptr;
+            };
+
+            uint32_t mThreadIndex;
+            Chunk* mpHead;              ///< Oldest chunk with unconsumed events. Owned by the consumer.
+            uint32_t mHeadIndex = 0;    ///< Index of the next event to consume in the head chunk.
+            Chunk* mpTail;              ///< Chunk events are appended to. Owned by the producer.
+            std::atomic<bool> mFinished = false;
+        };
+
+        // Registry of the trace buffers of all threads. Buffers are kept alive after their thread exits
+        // so that its events can still be collected, and are released the next time they are consumed.
+        struct TraceBufferRegistry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers;
+            uint32_t nextThreadIndex = 0;
+
+            static TraceBufferRegistry& get()
+            {
+                static TraceBufferRegistry registry;
+                return registry;
+            }
+
+            /** Consume the events of all buffers and release the buffers of exited threads. Must be called with the mutex locked.
+            */
+            template<typename F>
+            void consume(F func)
+            {
+                for (auto it = buffers.begin(); it != buffers.end();)
+                {
+                    bool finished = (*it)->isFinished();
+                    func(**it);
+                    it = finished ? buffers.erase(it) : std::next(it);
+                }
+            }
+        };
+
+        // Thread-local handle to the thread's trace buffer, marking the buffer as finished when the thread exits.
+        struct ThreadTraceBufferHandle
+        {
+            ThreadTraceBuffer* pBuffer = nullptr;
+            ~ThreadTraceBufferHandle() { if (pBuffer) pBuffer->setFinished(); }
+        };
+
+        ThreadTraceBuffer& getThreadTraceBuffer()
+        {
+            thread_local ThreadTraceBufferHandle tHandle;
+            if (!tHandle.pBuffer)
+            {
+                auto& registry = TraceBufferRegistry::get();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.buffers.push_back(std::make_unique<ThreadTraceBuffer>(registry.nextThreadIndex++));
+                tHandle.pBuffer = registry.buffers.back().get();
+            }
+            return *tHandle.pBuffer;
+        }
+
+        const char* getChromeTracePhase(Profiler::TraceEvent::Type type)
+        {
+            switch (type)
+            {
+            case Profiler::TraceEvent::Type::Begin: return "B";
+            case Profiler::TraceEvent::Type::End: return "E";
+            case Profiler::TraceEvent::Type::AsyncBegin: return "b";
+            case Profiler::TraceEvent::Type::AsyncEnd: return "e";
+            case Profiler::TraceEvent::Type::FlowStart: return "s";
+            case Profiler::TraceEvent::Type::FlowEnd: return "f";
+            default: FALCOR_UNREACHABLE(); return "";
+            }
+        }
     }
 
     // Profiler::Stats
@@ -204,6 +356,95 @@ namespace Falcor
         ofs.write(json.data(), json.size());
     }
 
+    std::string Profiler::Capture::toChromeTraceString() const
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+        auto writeCommon = [&](const char* phase, const std::string& name, uint32_t tid, double timestamp)
+        {
+            writer.Key("name");
+            writer.String(name.c_str(), (rapidjson::SizeType)name.size());
+            writer.Key("ph");
+            writer.String(phase);
+            writer.Key("pid");
+            writer.Uint(0);
+            writer.Key("tid");
+            writer.Uint(tid);
+            writer.Key("ts");
+            writer.Double(timestamp);
+        };
+
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        for (const auto& thread : mTraceThreads)
+        {
+            // Name the thread's track.
+            writer.StartObject();
+            writeCommon("M", "thread_name", thread.id, 0.0);
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(thread.name.c_str(), (rapidjson::SizeType)thread.name.size());
+            writer.EndObject();
+            writer.EndObject();
+
+            // Scoped events that started before the capture are skipped, events still running at the end are closed.
+            uint32_t depth = 0;
+            double lastTimestamp = 0.0;
+            for (const auto& event : thread.events)
+            {
+                if (event.type == TraceEvent::Type::End)
+                {
+                    if (depth == 0) continue;
+                    depth--;
+                }
+                else if (event.type == TraceEvent::Type::Begin)
+                {
+                    depth++;
+                }
+                lastTimestamp = event.timestamp;
+
+                writer.StartObject();
+                writeCommon(getChromeTracePhase(event.type), event.name, thread.id, event.timestamp);
+                if (event.type != TraceEvent::Type::Begin && event.type != TraceEvent::Type::End)
+                {
+                    writer.Key("cat");
+                    writer.String("falcor");
+                    writer.Key("id");
+                    writer.Uint64(event.id);
+                    if (event.type == TraceEvent::Type::FlowEnd)
+                    {
+                        writer.Key("bp");
+                        writer.String("e");
+                    }
+                }
+                writer.EndObject();
+            }
+            for (; depth > 0; depth--)
+            {
+                writer.StartObject();
+                writeCommon("E", "", thread.id, lastTimestamp);
+                writer.EndObject();
+            }
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    void Profiler::Capture::writeChromeTraceToFile(const std::string& filename) const
+    {
+        auto json = toChromeTraceString();
+        std::ofstream ofs(filename.c_str());
+        ofs.write(json.data(), json.size());
+    }
+
     Profiler::Capture::Capture(size_t reservedEvents, size_t reservedFrames)
         : mReservedFrames(reservedFrames)
     {
@@ -262,6 +503,11 @@ namespace Falcor
 
     void Profiler::startEvent(const std::string& name, Flags flags)
     {
+        if (is_set(flags, Flags::Internal)) recordTraceEvent(TraceEvent::Type::Begin, name);
+
+        // Events on other threads are only recorded in the trace.
+        if (!isMainThread()) return;
+
         if (mEnabled && is_set(flags, Flags::Internal))
         {
             // '/' is used as a "path delimiter", so it cannot be used in the event name.
@@ -292,6 +538,10 @@ namespace Falcor
 
     void Profiler::endEvent(const std::string& name, Flags flags)
     {
+        if (is_set(flags, Flags::Internal)) recordTraceEvent(TraceEvent::Type::End, name);
+
+        if (!isMainThread()) return;
+
         if (mEnabled && is_set(flags, Flags::Internal))
         {
             // '/' is used as a "path delimiter", so it cannot be used in the event name.
@@ -312,6 +562,39 @@ namespace Falcor
 #endif
     }
 
+    void Profiler::setThreadName(const std::string& name)
+    {
+        auto& buffer = getThreadTraceBuffer();
+        std::lock_guard<std::mutex> lock(TraceBufferRegistry::get().mutex);
+        buffer.name = name;
+    }
+
+    void Profiler::startAsyncEvent(const std::string& name, uint64_t id)
+    {
+        recordTraceEvent(TraceEvent::Type::AsyncBegin, name, id);
+    }
+
+    void Profiler::endAsyncEvent(const std::string& name, uint64_t id)
+    {
+        recordTraceEvent(TraceEvent::Type::AsyncEnd, name, id);
+    }
+
+    void Profiler::startFlow(const std::string& name, uint64_t id)
+    {
+        recordTraceEvent(TraceEvent::Type::FlowStart, name, id);
+    }
+
+    void Profiler::endFlow(const std::string& name, uint64_t id)
+    {
+        recordTraceEvent(TraceEvent::Type::FlowEnd, name, id);
+    }
+
+    void Profiler::recordTraceEvent(TraceEvent::Type type, const std::string& name, uint64_t id)
+    {
+        if (!mTracing.load(std::memory_order_relaxed)) return;
+        getThreadTraceBuffer().push(type, name, id);
+    }
+
     Profiler::Event* Profiler::getEvent(const std::string& name)
     {
         auto event = findEvent(name);
@@ -337,12 +620,46 @@ namespace Falcor
     {
         setEnabled(true);
         mpCapture = Capture::create(mLastFrameEvents.size(), reservedFrames);
+
+        // Discard trace events left over from a previous capture and start tracing.
+        if (isMainThread()) setThreadName("Main");
+        {
+            auto& registry = TraceBufferRegistry::get();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.consume([](ThreadTraceBuffer& buffer) { buffer.consume([](const ThreadTraceBuffer::Event&) {}); });
+        }
+        mTraceStartTime = CpuTimer::getCurrentTimePoint();
+        mTracing = true;
     }
 
     Profiler::Capture::SharedPtr Profiler::endCapture()
     {
         Capture::SharedPtr pCapture;
         std::swap(pCapture, mpCapture);
+
+        if (mTracing)
+        {
+            mTracing = false;
+            if (pCapture)
+            {
+                // Collect the trace events of all threads.
+                auto& registry = TraceBufferRegistry::get();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.consume([&](ThreadTraceBuffer& buffer)
+                {
+                    TraceThread thread;
+                    thread.id = buffer.getThreadIndex();
+                    thread.name = buffer.name.empty() ? "Thread " + std::to_string(thread.id) : buffer.name;
+                    buffer.consume([&](const ThreadTraceBuffer::Event& event)
+                    {
+                        double timestamp = CpuTimer::calcDuration(mTraceStartTime, event.time) * 1000.0;
+                        thread.events.push_back({ event.type, event.name, event.id, timestamp });
+                    });
+                    if (!thread.events.empty()) pCapture->mTraceThreads.push_back(std::move(thread));
+                });
+            }
+        }
+
         if (pCapture) pCapture->finalize();
         return pCapture;
     }
@@ -397,10 +714,14 @@ namespace Falcor
 
     FALCOR_SCRIPT_BINDING(Profiler)
     {
-        auto endCapture = [] (Profiler* pProfiler) {
+        auto endCapture = [] (Profiler* pProfiler, const std::string& traceFilename) {
             std::optional<pybind11::dict> result;
             auto pCapture = pProfiler->endCapture();
-            if (pCapture) result = pCapture->toPython();
+            if (pCapture)
+            {
+                result = pCapture->toPython();
+                if (!traceFilename.empty()) pCapture->writeChromeTraceToFile(traceFilename);
+            }
             return result;
         };
 
@@ -410,6 +731,6 @@ namespace Falcor
         profiler.def_property_readonly("isCapturing", &Profiler::isCapturing);
         profiler.def_property_readonly("events", &Profiler::getPythonEvents);
         profiler.def("startCapture", &Profiler::startCapture, "reservedFrames"_a = 1000);
-        profiler.def("endCapture", endCapture);
+        profiler.def("endCapture", endCapture, "traceFilename"_a = "");
     }
 }
@@ -26,7 +26,9 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include <atomic>
 #include <stack>
+#include <thread>
 #include <unordered_map>
 #include <memory>
 #include "CpuTimer.h"
@@ -42,6 +44,10 @@ namespace Falcor
         It automatically creates event hierarchies based on the order and nesting of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
+
+        The event hierarchy and GPU timing are only available on the main thread (the thread that created the profiler).
+        While a capture is running, CPU events on all threads are additionally recorded into per-thread trace buffers,
+        which can be exported to the Chrome trace event format. Events on other threads are only recorded in the trace.
     */
     class FALCOR_API Profiler
     {
@@ -119,6 +125,35 @@ namespace Falcor
             friend class Profiler;
         };
 
+        /** Event recorded in the trace of a thread.
+        */
+        struct TraceEvent
+        {
+            enum class Type : uint8_t
+            {
+                Begin,          ///< Start of a scoped event.
+                End,            ///< End of a scoped event.
+                AsyncBegin,     ///< Start of an asynchronous operation, which may end on another thread.
+                AsyncEnd,       ///< End of an asynchronous operation.
+                FlowStart,      ///< Start of a flow connecting the enclosing event to an event on another thread.
+                FlowEnd,        ///< End of a flow, binding to the enclosing event.
+            };
+
+            Type type;
+            std::string name;
+            uint64_t id = 0;                ///< Identifier matching async and flow events.
+            double timestamp = 0.0;         ///< Time in microseconds since the start of the capture.
+        };
+
+        /** Trace events recorded on a single thread.
+        */
+        struct TraceThread
+        {
+            std::string name;
+            uint32_t id = 0;
+            std::vector<TraceEvent> events;
+        };
+
         class Capture
         {
         public:
@@ -139,6 +174,18 @@ namespace Falcor
             std::string toJsonString() const;
             void writeToFile(const std::string& filename) const;
 
+            /** Get the trace events recorded on each thread during the capture.
+            */
+            const std::vector<TraceThread>& getTraceThreads() const { return mTraceThreads; }
+
+            /** Convert the trace events to the Chrome trace event JSON format, which can be viewed in chrome://tracing or Perfetto.
+            */
+            std::string toChromeTraceString() const;
+
+            /** Write the trace events in the Chrome trace event JSON format.
+            */
+            void writeChromeTraceToFile(const std::string& filename) const;
+
         private:
             Capture(size_t reservedEvents, size_t reservedFrames);
 
@@ -150,6 +197,7 @@ namespace Falcor
             size_t mFrameCount = 0;
             std::vector<Event*> mEvents;
             std::vector<Lane> mLanes;
+            std::vector<TraceThread> mTraceThreads;
             bool mFinalized = false;
 
             friend class Profiler;
@@ -207,6 +255,35 @@ namespace Falcor
         */
         void endEvent(const std::string& name, Flags flags = Flags::Default);
 
+        /** Set the name of the calling thread, shown as the name of its track in the trace.
+            \param[in] name The thread name.
+        */
+        void setThreadName(const std::string& name);
+
+        /** Record the start of an asynchronous operation in the trace. The operation may end on another thread.
+            \param[in] name The operation name.
+            \param[in] id Identifier matching the start and end of the operation.
+        */
+        void startAsyncEvent(const std::string& name, uint64_t id);
+
+        /** Record the end of an asynchronous operation in the trace.
+            \param[in] name The operation name, which must match the name passed to startAsyncEvent().
+            \param[in] id Identifier matching the start and end of the operation.
+        */
+        void endAsyncEvent(const std::string& name, uint64_t id);
+
+        /** Record the start of a flow in the trace, connecting the current event to the event in which the flow ends, typically on another thread.
+            \param[in] name The flow name.
+            \param[in] id Identifier matching the start and end of the flow.
+        */
+        void startFlow(const std::string& name, uint64_t id);
+
+        /** Record the end of a flow in the trace.
+            \param[in] name The flow name, which must match the name passed to startFlow().
+            \param[in] id Identifier matching the start and end of the flow.
+        */
+        void endFlow(const std::string& name, uint64_t id);
+
         /** Get the event, or create a new one if the event does not yet exist.
             This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
             \param[in] name The event name.
@@ -243,6 +320,9 @@ namespace Falcor
         */
         Event* findEvent(const std::string& name);
 
+        bool isMainThread() const { return std::this_thread::get_id() == mMainThreadId; }
+        void recordTraceEvent(TraceEvent::Type type, const std::string& name, uint64_t id = 0);
+
         bool mEnabled = false;
         bool mPaused = false;
 
@@ -254,6 +334,10 @@ namespace Falcor
         uint32_t mFrameIndex = 0;                           ///< Current frame index.
 
         Capture::SharedPtr mpCapture;                       ///< Currently active capture.
+
+        std::thread::id mMainThreadId = std::this_thread::get_id();  ///< Thread recording the event hierarchy.
+        std::atomic<bool> mTracing = false;                 ///< True while trace events are recorded.
+        CpuTimer::TimePoint mTraceStartTime;                ///< Start time of the trace.
     };
 
     FALCOR_ENUM_CLASS_OPERATORS(Profiler::Flags);
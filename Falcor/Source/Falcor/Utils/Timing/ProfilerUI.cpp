@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "stdafx.h"
 #include "ProfilerUI.h"
+#include <filesystem>
 
 #include "dear_imgui/imgui.h"
 
@@ -236,6 +237,11 @@ namespace Falcor
                 if (saveFileDialog(filters, filename))
                 {
                     pCapture->writeToFile(filename);
+
+                    // Write the trace of all threads next to the capture.
+                    auto tracePath = std::filesystem::path(filename).replace_extension(".trace.json");
+                    pCapture->writeChromeTraceToFile(tracePath.string());
+                    logInfo("Wrote Chrome trace to '{}'.", tracePath.string());
                 }
             }
         }
@@ -31,6 +31,7 @@
 extern "C"
 {
 #include "libavformat/avformat.h"
+#include "libavutil/opt.h"
 #include "libswscale/swscale.h"
 }
 
@@ -288,17 +289,33 @@ namespace Falcor
 
         mFormat = desc.format;
         mRowPitch = getFormatBytesPerBlock(desc.format) * desc.width;
-        if(desc.flipY)
-        {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
-        }
+        mFrameSize = (size_t)mRowPitch * desc.height;
+        mFlipY = desc.flipY;
+        mMaxQueuedFrames = std::max(desc.maxQueuedFrames, 1u);
 
         FALCOR_ASSERT(isFormatSupported(desc.format));
-        mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
+        mpSwsContext = sws_alloc_context();
         if(mpSwsContext == nullptr)
         {
             return error(mFilename, "Failed to allocate SWScale context");
         }
+        av_opt_set_int(mpSwsContext, "srcw", desc.width, 0);
+        av_opt_set_int(mpSwsContext, "srch", desc.height, 0);
+        av_opt_set_int(mpSwsContext, "src_format", getPictureFormatFromFalcorFormat(desc.format), 0);
+        av_opt_set_int(mpSwsContext, "dstw", desc.width, 0);
+        av_opt_set_int(mpSwsContext, "dsth", desc.height, 0);
+        av_opt_set_int(mpSwsContext, "dst_format", mpCodecContext->pix_fmt, 0);
+        av_opt_set_int(mpSwsContext, "sws_flags", SWS_POINT, 0);
+#if LIBSWSCALE_VERSION_INT >= AV_VERSION_INT(6, 1, 100)
+        // Slice threading in the scaler is only available in newer versions. Zero selects the thread count automatically.
+        av_opt_set_int(mpSwsContext, "threads", 0, 0);
+#endif
+        if(sws_init_context(mpSwsContext, nullptr, nullptr) < 0)
+        {
+            return error(mFilename, "Failed to initialize SWScale context");
+        }
+
+        mThread = std::thread(&VideoEncoder::runEncoder, this);
         return true;
     }
 
@@ -337,6 +354,17 @@ namespace Falcor
 
     void VideoEncoder::endCapture()
     {
+        // Let the encoder thread finish the queued frames.
+        if(mThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mTerminate = true;
+            }
+            mQueueChanged.notify_all();
+            mThread.join();
+        }
+
         if(mpOutputContext)
         {
             // Flush the codex
@@ -353,28 +381,86 @@ namespace Falcor
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage);
     }
 
     void VideoEncoder::appendFrame(const void* pData)
     {
-        if(mpFlippedImage)
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        appendFrame(std::vector<uint8_t>(pBytes, pBytes + mFrameSize));
+    }
+
+    void VideoEncoder::appendFrame(std::vector<uint8_t>&& data)
+    {
+        FALCOR_ASSERT(data.size() >= mFrameSize);
+        if(!mThread.joinable()) return;
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if(mQueue.size() >= mMaxQueuedFrames)
         {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
+            mStats.blockedFrames++;
+            mQueueChanged.wait(lock, [&] { return mQueue.size() < mMaxQueuedFrames; });
+        }
+        mQueue.push_back(std::move(data));
+        lock.unlock();
+        mQueueChanged.notify_all();
+    }
+
+    VideoEncoder::Stats VideoEncoder::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats stats = mStats;
+        stats.queuedFrames = mQueue.size() + (mEncoding ? 1 : 0);
+        return stats;
+    }
+
+    void VideoEncoder::runEncoder()
+    {
+        Profiler::instance().setThreadName("VideoEncoder");
+
+        while(true)
+        {
+            std::vector<uint8_t> data;
             {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
+                std::unique_lock<std::mutex> lock(mMutex);
+                mQueueChanged.wait(lock, [&] { return mTerminate || !mQueue.empty(); });
+                if(mQueue.empty()) return;
+                data = std::move(mQueue.front());
+                mQueue.pop_front();
+                mEncoding = true;
             }
+            mQueueChanged.notify_all();
 
-            pData = mpFlippedImage;
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            {
+                FALCOR_PROFILE("encodeFrame");
+                encodeFrame(data.data());
+            }
+            double encodeTimeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mEncoding = false;
+            mStats.encodedFrames++;
+            mStats.lastEncodeTimeMs = encodeTimeMs;
+            mTotalEncodeTimeMs += mStats.lastEncodeTimeMs;
+            mStats.avgEncodeTimeMs = mTotalEncodeTimeMs / mStats.encodedFrames;
         }
+    }
 
+    void VideoEncoder::encodeFrame(const uint8_t* pData)
+    {
         uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
         int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
+        if(mFlipY)
+        {
+            // Flip the image by scaling from the last row upwards.
+            src[0] = const_cast<uint8_t*>(pData) + (size_t)(mpCodecContext->height - 1) * mRowPitch;
+            rowPitch[0] = -(int32_t)mRowPitch;
+        }
+        else
+        {
+            src[0] = const_cast<uint8_t*>(pData);
+            rowPitch[0] = (int32_t)mRowPitch;
+        }
 
         // Scale and convert the image
         sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
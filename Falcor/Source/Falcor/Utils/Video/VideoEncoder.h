@@ -26,6 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 struct AVFormatContext;
 struct AVStream;
@@ -61,6 +65,16 @@ namespace Falcor
             ResourceFormat format = ResourceFormat::BGRA8UnormSrgb;
             bool flipY = false;
             std::string filename;
+            uint32_t maxQueuedFrames = 4;   ///< Maximum number of frames waiting to be encoded. appendFrame() blocks when the queue is full.
+        };
+
+        struct Stats
+        {
+            uint64_t encodedFrames = 0;     ///< Number of frames encoded.
+            uint64_t blockedFrames = 0;     ///< Number of frames for which appendFrame() blocked because the queue was full.
+            size_t queuedFrames = 0;        ///< Number of frames currently queued or being encoded.
+            double lastEncodeTimeMs = 0.0;  ///< Time to scale and encode the last frame in ms.
+            double avgEncodeTimeMs = 0.0;   ///< Average time to scale and encode a frame in ms.
         };
 
         ~VideoEncoder();
@@ -71,15 +85,34 @@ namespace Falcor
         */
         static UniquePtr create(const Desc& desc);
 
+        /** Queue a frame for encoding. The data is copied and encoded on the encoder thread.
+            Blocks if the maximum number of frames are already queued.
+            \param[in] pData Frame data of size width * height in the format given at creation.
+        */
         void appendFrame(const void* pData);
+
+        /** Queue a frame for encoding, taking ownership of the data to avoid a copy.
+            Blocks if the maximum number of frames are already queued.
+            \param[in] data Frame data of size width * height in the format given at creation.
+        */
+        void appendFrame(std::vector<uint8_t>&& data);
+
+        /** Encode all queued frames and close the file.
+        */
         void endCapture();
 
+        /** Get the encoder statistics.
+        */
+        Stats getStats() const;
+
         static bool isFormatSupported(ResourceFormat format);
         static FileDialogFilterVec getSupportedContainerForCodec(Codec codec);
 
     private:
         VideoEncoder(const std::string& filename);
         bool init(const Desc& desc);
+        void runEncoder();
+        void encodeFrame(const uint8_t* pData);
 
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
@@ -90,6 +123,19 @@ namespace Falcor
         const std::string mFilename;
         ResourceFormat mFormat;
         uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        size_t mFrameSize = 0;
+        bool mFlipY = false;                        ///< Flip the image, which is done by the scaler using a negative stride.
+        uint32_t mMaxQueuedFrames = 0;
+
+        mutable std::mutex mMutex;                  ///< Mutex for synchronizing access to the queue and stats.
+        std::condition_variable mQueueChanged;      ///< Condition variable signaled when frames are queued or taken.
+        std::thread mThread;                        ///< Encoder thread.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<std::vector<uint8_t>> mQueue;    ///< Frames waiting to be encoded.
+        bool mEncoding = false;                     ///< True while the encoder thread is encoding a frame.
+        bool mTerminate = false;                    ///< Flag to terminate the encoder thread once the queue is empty.
+        Stats mStats;
+        double mTotalEncodeTimeMs = 0.0;
     };
 }
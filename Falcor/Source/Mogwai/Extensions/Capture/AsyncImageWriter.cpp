@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "stdafx.h"
+#include "AsyncImageWriter.h"
+
+namespace Mogwai
+{
+    AsyncImageWriter::UniquePtr AsyncImageWriter::create(uint32_t threadCount, size_t maxQueueSize)
+    {
+        return UniquePtr(new AsyncImageWriter(threadCount, maxQueueSize));
+    }
+
+    AsyncImageWriter::AsyncImageWriter(uint32_t threadCount, size_t maxQueueSize)
+        : mMaxQueueSize(std::max(maxQueueSize, size_t(1)))
+    {
+        threadCount = std::max(threadCount, 1u);
+        for (uint32_t i = 0; i < threadCount; i++) mThreads.emplace_back(&AsyncImageWriter::runWorker, this);
+    }
+
+    AsyncImageWriter::~AsyncImageWriter()
+    {
+        // Workers finish the queue before terminating.
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+        mQueueChanged.notify_all();
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    bool AsyncImageWriter::enqueue(Image&& image, bool dropIfFull)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mQueue.size() >= mMaxQueueSize)
+        {
+            if (dropIfFull)
+            {
+                mStats.droppedCount++;
+                return false;
+            }
+            mStats.blockedCount++;
+            mQueueChanged.wait(lock, [&] { return mQueue.size() < mMaxQueueSize; });
+        }
+        mQueue.push_back(std::move(image));
+        lock.unlock();
+        mQueueChanged.notify_all();
+        return true;
+    }
+
+    void AsyncImageWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mImageWritten.wait(lock, [&] { return mQueue.empty() && mWritingCount == 0; });
+    }
+
+    AsyncImageWriter::Stats AsyncImageWriter::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Stats stats = mStats;
+        stats.queuedCount = mQueue.size() + mWritingCount;
+        return stats;
+    }
+
+    void AsyncImageWriter::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats = {};
+        mTotalLatencyMs = 0.0;
+    }
+
+    void AsyncImageWriter::runWorker()
+    {
+        Profiler::instance().setThreadName("AsyncImageWriter");
+
+        while (true)
+        {
+            Image image;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mQueueChanged.wait(lock, [&] { return mTerminate || !mQueue.empty(); });
+                if (mQueue.empty()) return;
+                image = std::move(mQueue.front());
+                mQueue.pop_front();
+                mWritingCount++;
+            }
+            mQueueChanged.notify_all();
+
+            FALCOR_PROFILE("writeImage");
+            bool success = true;
+            try
+            {
+                Bitmap::saveImage(image.filename, image.width, image.height, image.fileFormat, image.exportFlags, image.resourceFormat, true, image.data.data());
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write capture '{}': {}", image.filename, e.what());
+                success = false;
+            }
+            double latencyMs = CpuTimer::calcDuration(image.captureTime, CpuTimer::getCurrentTimePoint());
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mWritingCount--;
+                if (success)
+                {
+                    mStats.writtenCount++;
+                    mTotalLatencyMs += latencyMs;
+                    mStats.avgLatencyMs = mTotalLatencyMs / mStats.writtenCount;
+                    mStats.maxLatencyMs = std::max(mStats.maxLatencyMs, latencyMs);
+                }
+                else
+                {
+                    mStats.failedCount++;
+                }
+            }
+            mImageWritten.notify_all();
+        }
+    }
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "../../Mogwai.h"
+
+namespace Mogwai
+{
+    /** Writes images to disk on a pool of worker threads.
+        Images are queued in a bounded queue. When the queue is full, enqueueing either blocks until
+        a worker has taken an image (back-pressure) or drops the image, depending on the caller's choice.
+    */
+    class AsyncImageWriter
+    {
+    public:
+        using UniquePtr = std::unique_ptr<AsyncImageWriter>;
+
+        struct Image
+        {
+            std::string filename;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            ResourceFormat resourceFormat = ResourceFormat::Unknown;
+            Bitmap::FileFormat fileFormat = Bitmap::FileFormat::PngFile;
+            Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None;
+            std::vector<uint8_t> data;
+            CpuTimer::TimePoint captureTime;    ///< Time the capture was issued, used for measuring the capture latency.
+        };
+
+        struct Stats
+        {
+            uint64_t writtenCount = 0;          ///< Number of images written.
+            uint64_t failedCount = 0;           ///< Number of images that failed to write.
+            uint64_t droppedCount = 0;          ///< Number of images dropped because the queue was full.
+            uint64_t blockedCount = 0;          ///< Number of times enqueueing blocked because the queue was full.
+            size_t queuedCount = 0;             ///< Number of images currently queued or being written.
+            double avgLatencyMs = 0.0;          ///< Average time from capture to written file in ms.
+            double maxLatencyMs = 0.0;          ///< Maximum time from capture to written file in ms.
+        };
+
+        /** Create a writer.
+            \param[in] threadCount Number of writer threads.
+            \param[in] maxQueueSize Maximum number of images waiting to be written.
+        */
+        static UniquePtr create(uint32_t threadCount, size_t maxQueueSize);
+
+        /** Destructor. Writes all queued images before returning.
+        */
+        ~AsyncImageWriter();
+
+        /** Queue an image for writing.
+            \param[in] image Image to write.
+            \param[in] dropIfFull If true, the image is dropped if the queue is full, otherwise the call blocks until there is space.
+            \return True if the image was queued, false if it was dropped.
+        */
+        bool enqueue(Image&& image, bool dropIfFull);
+
+        /** Wait until all queued images are written.
+        */
+        void flush();
+
+        /** Get the writer statistics.
+        */
+        Stats getStats() const;
+
+        /** Reset the writer statistics.
+        */
+        void resetStats();
+
+    private:
+        AsyncImageWriter(uint32_t threadCount, size_t maxQueueSize);
+
+        void runWorker();
+
+        size_t mMaxQueueSize;
+
+        mutable std::mutex mMutex;                  ///< Mutex for synchronizing access to shared state.
+        std::condition_variable mQueueChanged;      ///< Condition variable signaled when images are queued or taken.
+        std::condition_variable mImageWritten;      ///< Condition variable signaled when an image is written.
+        std::vector<std::thread> mThreads;          ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::deque<Image> mQueue;                   ///< Images waiting to be written.
+        size_t mWritingCount = 0;                   ///< Number of images being written.
+        bool mTerminate = false;                    ///< Flag to terminate worker threads.
+        Stats mStats;
+        double mTotalLatencyMs = 0.0;
+    };
+}
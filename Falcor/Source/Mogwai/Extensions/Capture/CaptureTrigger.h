@@ -51,6 +51,10 @@ namespace Mogwai
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) {};
         virtual void endRange(RenderGraph* pGraph, const Range& r) {};
 
+        /** Called at the end of every frame, also outside of capture ranges. Used for processing captures still in flight.
+        */
+        virtual void processPending(RenderContext* pCtx) {};
+
         void addRange(const RenderGraph* pGraph, uint64_t startFrame, uint64_t count);
         void reset(const RenderGraph* pGraph = nullptr);
         void renderUI(Gui::Window& w);
@@ -40,6 +40,12 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+        const std::string kDropFramesWhenBusy = "dropFramesWhenBusy";
+
+        const size_t kMaxPendingReadbacks = 8;      ///< Maximum number of readbacks in flight before the frame waits for the oldest one.
+        const size_t kMaxQueuedImages = 16;         ///< Maximum number of images waiting to be written.
+        const uint32_t kMaxWriterThreads = 4;
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -62,6 +68,12 @@ namespace Mogwai
         : CaptureTrigger(pRenderer, "Frame Capture")
     {
         mpImageProcessing = ImageProcessing::create();
+        mpWriter = AsyncImageWriter::create(std::min(Threading::getLogicalThreadCount(), kMaxWriterThreads), kMaxQueuedImages);
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        flush();
     }
 
     void FrameCapture::renderUI(Gui* pGui)
@@ -75,7 +87,16 @@ namespace Mogwai
             w.checkbox("Capture All Outputs", mCaptureAllOutputs);
             w.tooltip("Capture all available outputs instead of the marked ones only.");
 
+            w.checkbox("Drop Frames When Busy", mDropFramesWhenBusy);
+            w.tooltip("Drop captured images when the writers can't keep up, instead of stalling the frame until there is space in the queue.");
+
             if (w.button("Capture Current Frame")) capture();
+
+            auto stats = mpWriter->getStats();
+            w.text(fmt::format("Capture latency: {:.1f} ms avg, {:.1f} ms max", stats.avgLatencyMs, stats.maxLatencyMs));
+            w.text(fmt::format("Written: {}, in flight: {}, blocked: {}, dropped: {}, failed: {}",
+                stats.writtenCount, mPendingReadbacks.size() + stats.queuedCount, stats.blockedCount + mReadbackStallCount, stats.droppedCount, stats.failedCount));
+            if (w.button("Reset Stats")) resetStats();
         }
     }
 
@@ -92,6 +113,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -104,6 +126,9 @@ namespace Mogwai
         auto getUI = [](FrameCapture* pFC) { return pFC->mShowUI; };
         auto setUI = [](FrameCapture* pFC, bool show) { pFC->mShowUI = show; };
         frameCapture.def_property(kUI.c_str(), getUI, setUI);
+        auto getDropFrames = [](FrameCapture* pFC) { return pFC->mDropFramesWhenBusy; };
+        auto setDropFrames = [](FrameCapture* pFC, bool drop) { pFC->mDropFramesWhenBusy = drop; };
+        frameCapture.def_property(kDropFramesWhenBusy.c_str(), getDropFrames, setDropFrames);
     }
 
     std::string FrameCapture::getScriptVar() const
@@ -234,17 +259,86 @@ namespace Mogwai
                 mpImageProcessing->copyColorChannel(pRenderContext, pOutput->getSRV(0, 1, 0, 1), pTex->getUAV(), mask);
             }
 
-            // Write output image.
+            // Queue readback of the output image. It is written once the data is available.
             auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
             auto fileformat = Bitmap::getFormatFromFileExtension(ext);
             std::string filename = basename + suffix + "." + ext;
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            queueReadback(pRenderContext, pTex, filename, fileformat, flags);
+        }
+    }
+
+    void FrameCapture::queueReadback(RenderContext* pRenderContext, const Texture::SharedPtr& pTex, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags)
+    {
+        if (fileFormat == Bitmap::FileFormat::DdsFile) throw RuntimeError("Frame capture does not support saving to DDS.");
+
+        PendingReadback readback;
+        readback.pTexture = pTex;
+        readback.image.filename = filename;
+        readback.image.width = pTex->getWidth();
+        readback.image.height = pTex->getHeight();
+        readback.image.resourceFormat = pTex->getFormat();
+        readback.image.fileFormat = fileFormat;
+        readback.image.exportFlags = exportFlags;
+        readback.image.captureTime = CpuTimer::getCurrentTimePoint();
+
+        // HDR textures with less than 3 channels are expanded to RGBA, same as in Texture::captureToFile().
+        if (getFormatType(pTex->getFormat()) == FormatType::Float && getFormatChannelCount(pTex->getFormat()) < 3)
+        {
+            readback.pTexture = Texture::create2D(pTex->getWidth(), pTex->getHeight(), ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
+            pRenderContext->blit(pTex->getSRV(0, 1, 0, 1), readback.pTexture->getRTV(0, 0, 1));
+            readback.image.resourceFormat = ResourceFormat::RGBA32Float;
+        }
+
+        // Wait for the oldest readback if too many are in flight.
+        retireReadbacks(false);
+        if (mPendingReadbacks.size() >= kMaxPendingReadbacks)
+        {
+            mReadbackStallCount++;
+            retireOldestReadback();
+        }
+
+        readback.pTask = pRenderContext->asyncReadTextureSubresource(readback.pTexture.get(), 0);
+        mPendingReadbacks.push_back(std::move(readback));
+    }
+
+    void FrameCapture::retireOldestReadback()
+    {
+        FALCOR_ASSERT(!mPendingReadbacks.empty());
+        auto& readback = mPendingReadbacks.front();
+        readback.image.data = readback.pTask->getData();
+        mpWriter->enqueue(std::move(readback.image), mDropFramesWhenBusy);
+        mPendingReadbacks.pop_front();
+    }
+
+    void FrameCapture::retireReadbacks(bool wait)
+    {
+        // Readbacks complete in order, so stop at the first one still in flight.
+        while (!mPendingReadbacks.empty() && (wait || mPendingReadbacks.front().pTask->isComplete()))
+        {
+            retireOldestReadback();
         }
     }
 
+    void FrameCapture::processPending(RenderContext* pRenderContext)
+    {
+        retireReadbacks(false);
+    }
+
+    void FrameCapture::flush()
+    {
+        retireReadbacks(true);
+        mpWriter->flush();
+    }
+
+    void FrameCapture::resetStats()
+    {
+        mpWriter->resetStats();
+        mReadbackStallCount = 0;
+    }
+
     void FrameCapture::addFrames(const RenderGraph* pGraph, const uint64_vec& frames)
     {
         for (auto f : frames) addRange(pGraph, f, 1);
@@ -28,6 +28,7 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "AsyncImageWriter.h"
 
 namespace Mogwai
 {
@@ -35,13 +36,19 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~FrameCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void processPending(RenderContext* pRenderContext) override;
         void capture();
 
+        /** Wait until all captured images are written to disk.
+        */
+        void flush();
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -50,8 +57,25 @@ namespace Mogwai
         void addFrames(const std::string& graphName, const uint64_vec& frames);
         std::string graphFramesStr(const RenderGraph* pGraph);
         void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
+        void queueReadback(RenderContext* pRenderContext, const Texture::SharedPtr& pTex, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags);
+        void retireOldestReadback();
+        void retireReadbacks(bool wait);
+        void resetStats();
 
         bool mCaptureAllOutputs = false;
+        bool mDropFramesWhenBusy = false;
         ImageProcessing::SharedPtr mpImageProcessing;
+
+        // Captures are read back asynchronously and written by a pool of writer threads, so that capturing does not stall the frame.
+        struct PendingReadback
+        {
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+            Texture::SharedPtr pTexture;        ///< Texture being read back, kept alive until the copy is done.
+            AsyncImageWriter::Image image;      ///< Image to write, without data.
+        };
+
+        std::deque<PendingReadback> mPendingReadbacks;  ///< Readbacks in flight, oldest first.
+        AsyncImageWriter::UniquePtr mpWriter;
+        uint64_t mReadbackStallCount = 0;               ///< Number of times the frame waited for a readback because too many were in flight.
     };
 }
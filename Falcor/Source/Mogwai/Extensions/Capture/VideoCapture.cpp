@@ -70,6 +70,14 @@ namespace Mogwai
             CaptureTrigger::renderUI(w);
             w.separator();
             mpEncoderUI->render(w, true);
+
+            for (const auto& e : mEncoders)
+            {
+                if (!e.pEncoder) continue;
+                auto stats = e.pEncoder->getStats();
+                w.text(fmt::format("{}: encoded {}, queued {}, blocked {}, encode time {:.2f} ms (avg {:.2f} ms)",
+                    e.output, stats.encodedFrames, stats.queuedFrames, stats.blockedFrames, stats.lastEncodeTimeMs, stats.avgEncodeTimeMs));
+            }
         }
     }
 
@@ -118,6 +126,8 @@ namespace Mogwai
 
     void VideoCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
+        FALCOR_PROFILE("VideoCapture::triggerFrame");
+
         for (const auto& e : mEncoders)
         {
             Texture::SharedPtr pTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(e.output));
@@ -127,7 +137,7 @@ namespace Mogwai
                 pTex = e.pBlitTex;
             }
 
-            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0).data());
+            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0));
         }
     }
 
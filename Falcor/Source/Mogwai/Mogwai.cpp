@@ -57,6 +57,20 @@ namespace Mogwai
         , mAppData(kAppDataPath)
     {
         Program::setGenerateDebugInfoEnabled(options.generateShaderDebugInfo);
+
+        if (!options.shaderCacheFile.empty())
+        {
+            try
+            {
+                auto pShaderCache = ShaderCache::createFromFile(options.shaderCacheFile);
+                logInfo("Loaded {} precompiled shader kernels from '{}'.", pShaderCache->getEntryCount(), options.shaderCacheFile);
+                Program::setShaderCache(pShaderCache);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to load shader cache: {}", e.what());
+            }
+        }
     }
 
     void Renderer::extend(Extension::CreateFunc func, const std::string& name)
@@ -703,6 +717,7 @@ int main(int argc, char** argv)
     args::Flag useSceneCacheFlag(parser, "", "Use scene cache to improve scene load times.", {'c', "use-cache"});
     args::Flag rebuildSceneCacheFlag(parser, "", "Rebuild the scene cache.", {"rebuild-cache"});
     args::Flag generateShaderDebugInfo(parser, "", "Generate shader debug info.", {'d', "debug-shaders"});
+    args::ValueFlag<std::string> shaderCacheFlag(parser, "path", "Shader cache bundle with precompiled kernels (see ShaderPrecompiler).", {"shader-cache"});
     args::Flag enableDebugLayer(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
 
     args::CompletionFlag completionFlag(parser, {"complete"});
@@ -758,6 +773,7 @@ int main(int argc, char** argv)
     if (useSceneCacheFlag) options.useSceneCache = true;
     if (rebuildSceneCacheFlag) options.rebuildSceneCache = true;
     if (generateShaderDebugInfo) options.generateShaderDebugInfo = true;
+    if (shaderCacheFlag) options.shaderCacheFile = args::get(shaderCacheFlag);
 
     try
     {
@@ -76,6 +76,7 @@ namespace Mogwai
             bool useSceneCache = false;
             bool rebuildSceneCache = false;
             bool generateShaderDebugInfo = false;
+            std::string shaderCacheFile;
         };
 
         Renderer(const Options& options);
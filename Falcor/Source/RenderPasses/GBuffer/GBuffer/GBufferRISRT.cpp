@@ -215,54 +215,70 @@ void GBufferRISRT::setScene(RenderContext* pRenderContext, const Scene::SharedPt
 void GBufferRISRT::recreatePrograms()
 {
     mRaytrace.pProgram = nullptr;
+    mRaytrace.pBindingTable = nullptr;
     mRaytrace.pVars = nullptr;
     mpComputePass = nullptr;
 }
 
+void GBufferRISRT::collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests)
+{
+    if (mpScene == nullptr) return;
+
+    if (!mRaytrace.pProgram) createRaytraceProgram(renderData);
+    mRaytrace.pProgram->addDefines(getShaderDefines(renderData));
+    requests.push_back({ mRaytrace.pProgram, mRaytrace.pVars });
+}
+
+void GBufferRISRT::createRaytraceProgram(const RenderData& renderData)
+{
+    Program::DefineList defines;
+    defines.add(mpScene->getSceneDefines());
+    defines.add(mpSampleGenerator->getDefines());
+    defines.add(getShaderDefines(renderData));
+
+    // Create ray tracing program.
+    RtProgram::Desc desc;
+    desc.addShaderLibrary(kProgramRaytraceFile);
+    desc.setMaxPayloadSize(kMaxPayloadSizeBytes);
+    desc.setMaxAttributeSize(mpScene->getRaytracingMaxAttributeSize());
+    desc.setMaxTraceRecursionDepth(kMaxRecursionDepth);
+    desc.addTypeConformances(mpScene->getTypeConformances());
+
+    RtBindingTable::SharedPtr sbt = RtBindingTable::create(1, 1, mpScene->getGeometryCount());
+    sbt->setRayGen(desc.addRayGen("rayGen"));
+    sbt->setMiss(0, desc.addMiss("miss"));
+    sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::TriangleMesh), desc.addHitGroup("closestHit", "anyHit"));
+
+    // Add hit group with intersection shader for displaced meshes.
+    if (mpScene->hasGeometryType(Scene::GeometryType::DisplacedTriangleMesh))
+    {
+        sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::DisplacedTriangleMesh), desc.addHitGroup("displacedTriangleMeshClosestHit", "", "displacedTriangleMeshIntersection"));
+    }
+
+    // Add hit group with intersection shader for curves (represented as linear swept spheres).
+    if (mpScene->hasGeometryType(Scene::GeometryType::Curve))
+    {
+        sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::Curve), desc.addHitGroup("curveClosestHit", "", "curveIntersection"));
+    }
+
+    // Add hit group with intersection shader for SDF grids.
+    if (mpScene->hasGeometryType(Scene::GeometryType::SDFGrid))
+    {
+        sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::SDFGrid), desc.addHitGroup("sdfGridClosestHit", "", "sdfGridIntersection"));
+    }
+
+    // Add hit groups for for other procedural primitives here.
+
+    mRaytrace.pProgram = RtProgram::create(desc, defines);
+    mRaytrace.pBindingTable = sbt;
+}
+
 void GBufferRISRT::executeRaytrace(RenderContext* pRenderContext, const RenderData& renderData)
 {
-    if (!mRaytrace.pProgram || !mRaytrace.pVars)
+    if (!mRaytrace.pProgram) createRaytraceProgram(renderData);
+    if (!mRaytrace.pVars)
     {
-        Program::DefineList defines;
-        defines.add(mpScene->getSceneDefines());
-        defines.add(mpSampleGenerator->getDefines());
-        defines.add(getShaderDefines(renderData));
-
-        // Create ray tracing program.
-        RtProgram::Desc desc;
-        desc.addShaderLibrary(kProgramRaytraceFile);
-        desc.setMaxPayloadSize(kMaxPayloadSizeBytes);
-        desc.setMaxAttributeSize(mpScene->getRaytracingMaxAttributeSize());
-        desc.setMaxTraceRecursionDepth(kMaxRecursionDepth);
-        desc.addTypeConformances(mpScene->getTypeConformances());
-
-        RtBindingTable::SharedPtr sbt = RtBindingTable::create(1, 1, mpScene->getGeometryCount());
-        sbt->setRayGen(desc.addRayGen("rayGen"));
-        sbt->setMiss(0, desc.addMiss("miss"));
-        sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::TriangleMesh), desc.addHitGroup("closestHit", "anyHit"));
-
-        // Add hit group with intersection shader for displaced meshes.
-        if (mpScene->hasGeometryType(Scene::GeometryType::DisplacedTriangleMesh))
-        {
-            sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::DisplacedTriangleMesh), desc.addHitGroup("displacedTriangleMeshClosestHit", "", "displacedTriangleMeshIntersection"));
-        }
-
-        // Add hit group with intersection shader for curves (represented as linear swept spheres).
-        if (mpScene->hasGeometryType(Scene::GeometryType::Curve))
-        {
-            sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::Curve), desc.addHitGroup("curveClosestHit", "", "curveIntersection"));
-        }
-
-        // Add hit group with intersection shader for SDF grids.
-        if (mpScene->hasGeometryType(Scene::GeometryType::SDFGrid))
-        {
-            sbt->setHitGroup(0, mpScene->getGeometryIDs(Scene::GeometryType::SDFGrid), desc.addHitGroup("sdfGridClosestHit", "", "sdfGridIntersection"));
-        }
-
-        // Add hit groups for for other procedural primitives here.
-
-        mRaytrace.pProgram = RtProgram::create(desc, defines);
-        mRaytrace.pVars = RtProgramVars::create(mRaytrace.pProgram, sbt);
+        mRaytrace.pVars = RtProgramVars::create(mRaytrace.pProgram, mRaytrace.pBindingTable);
 
         // Bind static resources.
         ShaderVar var = mRaytrace.pVars->getRootVar();
@@ -274,7 +290,7 @@ void GBufferRISRT::executeRaytrace(RenderContext* pRenderContext, const RenderDa
     ShaderVar var = mRaytrace.pVars->getRootVar();
     setShaderData(var, renderData);
 
-    var["CB"]["gCandidateCount"] = mCandidateCount;
+    var[mCandidateCountVar] = mCandidateCount;
 
     // Dispatch the rays.
     mpScene->raytrace(pRenderContext, mRaytrace.pProgram.get(), mRaytrace.pVars, uint3(mFrameDim, 1));
@@ -304,10 +320,10 @@ Program::DefineList GBufferRISRT::getShaderDefines(const RenderData& renderData)
 
 void GBufferRISRT::setShaderData(const ShaderVar& var, const RenderData& renderData)
 {
-    var["gGBufferRISRT"]["frameDim"] = mFrameDim;
-    var["gGBufferRISRT"]["invFrameDim"] = mInvFrameDim;
-    var["gGBufferRISRT"]["frameCount"] = mFrameCount;
-    var["gGBufferRISRT"]["screenSpacePixelSpreadAngle"] = mpScene->getCamera()->computeScreenSpacePixelSpreadAngle(mFrameDim.y);
+    var[mFrameDimVar] = mFrameDim;
+    var[mInvFrameDimVar] = mInvFrameDim;
+    var[mFrameCountVar] = mFrameCount;
+    var[mPixelSpreadAngleVar] = mpScene->getCamera()->computeScreenSpacePixelSpreadAngle(mFrameDim.y);
 
     // Bind output channels as UAV buffers.
     auto bind = [&](const ChannelDesc& channel)
@@ -46,12 +46,14 @@ public:
 
     RenderPassReflection reflect(const CompileData& compileData) override;
     void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
+    void collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests) override;
     void renderUI(Gui::Widgets& widget) override;
     Dictionary getScriptingDictionary() override;
     void setScene(RenderContext* pRenderContext, const Scene::SharedPtr& pScene) override;
 
 private:
     void executeRaytrace(RenderContext* pRenderContext, const RenderData& renderData);
+    void createRaytraceProgram(const RenderData& renderData);
 
     Program::DefineList getShaderDefines(const RenderData& renderData) const;
     void setShaderData(const ShaderVar& var, const RenderData& renderData);
@@ -73,9 +75,17 @@ private:
     struct
     {
         RtProgram::SharedPtr pProgram;
+        RtBindingTable::SharedPtr pBindingTable;
         RtProgramVars::SharedPtr pVars;
     } mRaytrace;
 
+    // Pre-resolved shader variables, set every frame.
+    ShaderVarHandle mCandidateCountVar = ShaderVarHandle("CB.gCandidateCount");
+    ShaderVarHandle mFrameDimVar = ShaderVarHandle("gGBufferRISRT.frameDim");
+    ShaderVarHandle mInvFrameDimVar = ShaderVarHandle("gGBufferRISRT.invFrameDim");
+    ShaderVarHandle mFrameCountVar = ShaderVarHandle("gGBufferRISRT.frameCount");
+    ShaderVarHandle mPixelSpreadAngleVar = ShaderVarHandle("gGBufferRISRT.screenSpacePixelSpreadAngle");
+
     ComputePass::SharedPtr mpComputePass;
 
 
@@ -96,16 +96,11 @@ RenderPassReflection SpatialReuseRISPass::reflect(const CompileData& compileData
 void SpatialReuseRISPass::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
 
-    if (!mpSpatialReuseRISPass)
+    if (!mpSpatialReuseRISPass) createPass();
+    if (!mpVars)
     {
-        Program::Desc desc;
-        desc.addShaderLibrary(kShaderFile).setShaderModel(kShaderModel).csEntry("main");
-
-        Program::DefineList defines;
-        defines.add(mpSampleGenerator->getDefines());
-
-
-        mpSpatialReuseRISPass = ComputePass::create(desc, defines, true);
+        mpVars = ComputeVars::create(mpSpatialReuseRISPass->getProgram().get());
+        mpSpatialReuseRISPass->setVars(mpVars);
     }
 
     // Bind output channels as UAV buffers.
@@ -118,13 +113,31 @@ void SpatialReuseRISPass::execute(RenderContext* pRenderContext, const RenderDat
     for (const auto& channel : kOutputChannels) bind(channel);
     for (const auto& channel : kInputChannels) bind(channel);
 
-    var["CB"]["width"] = mFrameDim.x;
-    var["CB"]["height"] = mFrameDim.y;
-    var["CB"]["frameCount"] = mFrameCount++;
+    var[mWidthVar] = mFrameDim.x;
+    var[mHeightVar] = mFrameDim.y;
+    var[mFrameCountVar] = mFrameCount++;
 
     mpSpatialReuseRISPass->execute(pRenderContext, mFrameDim.x, mFrameDim.y);
 }
 
+void SpatialReuseRISPass::collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests)
+{
+    if (!mpSpatialReuseRISPass) createPass();
+    requests.push_back({ mpSpatialReuseRISPass->getProgram() });
+}
+
+void SpatialReuseRISPass::createPass()
+{
+    Program::Desc desc;
+    desc.addShaderLibrary(kShaderFile).setShaderModel(kShaderModel).csEntry("main");
+
+    Program::DefineList defines;
+    defines.add(mpSampleGenerator->getDefines());
+
+    // The vars are created on first execute(), as creating them links the program.
+    mpSpatialReuseRISPass = ComputePass::create(desc, defines, false);
+}
+
 void SpatialReuseRISPass::compile(RenderContext* pRenderContext, const CompileData& compileData)
 {
     mFrameDim = compileData.defaultTexDims;
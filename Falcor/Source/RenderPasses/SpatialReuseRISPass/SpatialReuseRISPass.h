@@ -49,6 +49,7 @@ public:
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
     virtual void compile(RenderContext* pRenderContext, const CompileData& compileData) override;
     virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
+    virtual void collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests) override;
     virtual void renderUI(Gui::Widgets& widget) override;
     virtual void setScene(RenderContext* pRenderContext, const Scene::SharedPtr& pScene) override {}
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
@@ -57,7 +58,7 @@ public:
 private:
     SpatialReuseRISPass();
 
-
+    void createPass();
 
     // UI variables
     RenderPassHelpers::IOSize       mOutputSizeSelection = RenderPassHelpers::IOSize::Default; ///< Selected output size.
@@ -67,7 +68,12 @@ private:
 
     SampleGenerator::SharedPtr mpSampleGenerator;
     ComputePass::SharedPtr mpSpatialReuseRISPass;
+    ComputeVars::SharedPtr mpVars;
+
+    // Pre-resolved shader variables, set every frame.
+    ShaderVarHandle mWidthVar = ShaderVarHandle("CB.width");
+    ShaderVarHandle mHeightVar = ShaderVarHandle("CB.height");
+    ShaderVarHandle mFrameCountVar = ShaderVarHandle("CB.frameCount");
 
     uint mFrameCount = 0;
-    //ComputeVars::SharedPtr mpVars;
 };
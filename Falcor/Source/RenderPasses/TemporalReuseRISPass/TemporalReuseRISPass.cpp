@@ -49,13 +49,20 @@ namespace
 
     const ChannelList kOutputChannels =
     {
-        { "emittedLight",               "gEmittedLight",                "Emitted light from the selected light source sample",  true /* optional */, ResourceFormat::RGBA32Float   },
-        { "dirToSample",                "gDirToSample",                 "Direction to the selected light source sample",        true /* optional */, ResourceFormat::RGBA32Float   },
-        { "reservoir",                  "gReservoir",                   "Number of candidates and reservoir weights",                                      true /* optional */, ResourceFormat::RGBA32Float   },
+        { "emittedLight",               "gEmittedLightOut",             "Emitted light from the selected light source sample",  true /* optional */, ResourceFormat::RGBA32Float   },
+        { "dirToSample",                "gDirToSampleOut",              "Direction to the selected light source sample",        true /* optional */, ResourceFormat::RGBA32Float   },
+        { "reservoir",                  "gReservoirOut",                "Number of candidates and reservoir weights",                                      true /* optional */, ResourceFormat::RGBA32Float   },
     };
 
-
-    const std::string kNormalPrev = "normalPrev";
+    // Inputs whose previous frame contents are reused. The render graph keeps them as history resources.
+    const ChannelList kHistoryChannels =
+    {
+        { "posW",                       "gPosWPrev",                    "", true, ResourceFormat::Unknown },
+        { "normW",                      "gNormWPrev",                   "", true, ResourceFormat::Unknown },
+        { "emittedLight",               "gEmittedLightPrev",            "", true, ResourceFormat::Unknown },
+        { "dirToSample",                "gDirToSamplePrev",             "", true, ResourceFormat::Unknown },
+        { "reservoir",                  "gReservoirPrev",               "", true, ResourceFormat::Unknown },
+    };
 }
 
 // Don't remove this. it's required for hot-reload to function properly
@@ -93,7 +100,11 @@ RenderPassReflection TemporalReuseRISPass::reflect(const CompileData& compileDat
 
     addRenderPassInputs(reflector, kInputChannels);
     addRenderPassOutputs(reflector, kOutputChannels);
-    reflector.addInternal(kNormalPrev, "todo: description");
+    for (const auto& channel : kHistoryChannels)
+    {
+        auto pField = reflector.getField(channel.name);
+        pField->flags(pField->getFlags() | RenderPassReflection::Field::Flags::History);
+    }
 
     return reflector;
 }
@@ -105,56 +116,16 @@ void TemporalReuseRISPass::reset()
 }
 
 
-void TemporalReuseRISPass::prepareInternalChannels(RenderContext* pRenderContext, uint32_t width, uint32_t height)
-{
-    // Allocate/resize/clear buffers for intermedate data. These are different depending on accumulation mode.
-    // Buffers that are not used in the current mode are released.
-    auto prepareBuffer = [&](Texture::SharedPtr& pBuf, ResourceFormat format, bool bufUsed)
-    {
-        if (!bufUsed)
-        {
-            pBuf = nullptr;
-            return;
-        }
-        // (Re-)create buffer if needed.
-        if (!pBuf || pBuf->getWidth() != width || pBuf->getHeight() != height)
-        {
-            pBuf = Texture::create2D(width, height, format, 1, 1, nullptr, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess);
-            FALCOR_ASSERT(pBuf);
-            reset();
-        }
-        // Clear data if accumulation has been reset (either above or somewhere else).
-        if (mFrameCount == 0)
-        {
-            if (getFormatType(format) == FormatType::Float) pRenderContext->clearUAV(pBuf->getUAV().get(), float4(0.f));
-            else pRenderContext->clearUAV(pBuf->getUAV().get(), uint4(0));
-        }
-    };
-
-    prepareBuffer(mpPosWPrev, ResourceFormat::RGBA32Float, true);
-    prepareBuffer(mpNormWPrev, ResourceFormat::RGBA32Float, true);
-    prepareBuffer(mpEmittedLightPrev, ResourceFormat::RGBA32Float, true);
-    prepareBuffer(mpDirToSamplePrev, ResourceFormat::RGBA32Float, true);
-    prepareBuffer(mpDirToSamplePrev, ResourceFormat::RGBA32Float, true);
-    prepareBuffer(mpReservoirPrev, ResourceFormat::RGBA32Float, true);
-
-}
-
 void TemporalReuseRISPass::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
     // renderData holds the requested resources
     // auto& pTexture = renderData["src"]->asTexture();
 
-    if (!mpTemporalReuseRISPass)
+    if (!mpTemporalReuseRISPass) createPass();
+    if (!mpVars)
     {
-        Program::Desc desc;
-        desc.addShaderLibrary(kShaderFile).setShaderModel(kShaderModel).csEntry("main");
-
-        Program::DefineList defines;
-        defines.add(mpSampleGenerator->getDefines());
-
-
-        mpTemporalReuseRISPass = ComputePass::create(desc, defines);
+        mpVars = ComputeVars::create(mpTemporalReuseRISPass->getProgram().get());
+        mpTemporalReuseRISPass->setVars(mpVars);
     }
 
     // Bind output channels as UAV buffers.
@@ -167,25 +138,41 @@ void TemporalReuseRISPass::execute(RenderContext* pRenderContext, const RenderDa
     for (const auto& channel : kOutputChannels) bind(channel);
     for (const auto& channel : kInputChannels) bind(channel);
 
-    var["CB"]["width"] = mFrameDim.x;
-    var["CB"]["height"] = mFrameDim.y;
-    var["CB"]["frameCount"] = mFrameCount++;
+    // Bind the previous frame data. The history resources are null until a previous frame was rendered.
+    bool hasHistory = true;
+    for (const auto& channel : kHistoryChannels)
+    {
+        const auto& pHistory = renderData.getHistoryResource(channel.name);
+        var[channel.texname] = pHistory ? pHistory->asTexture() : nullptr;
+        hasHistory = hasHistory && pHistory;
+    }
+
+    var[mWidthVar] = mFrameDim.x;
+    var[mHeightVar] = mFrameDim.y;
+    var[mFrameCountVar] = mFrameCount;
+    var[mHasHistoryVar] = hasHistory;
 
+    mpTemporalReuseRISPass->execute(pRenderContext, mFrameDim.x, mFrameDim.y);
 
+    mFrameCount++;
+}
 
-    // Setup internals
-    prepareInternalChannels(pRenderContext, mFrameDim.x, mFrameDim.y);
+void TemporalReuseRISPass::collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests)
+{
+    if (!mpTemporalReuseRISPass) createPass();
+    requests.push_back({ mpTemporalReuseRISPass->getProgram() });
+}
 
-    //mpTemporalReuseRISPass["gPosWPrev"] = mpPosWPrev;
-    //mpTemporalReuseRISPass["gNormWPrev"] = mpNormWPrev;
-    //mpTemporalReuseRISPass["gEmittedLightPrev"] = mpEmittedLightPrev;
-    //mpTemporalReuseRISPass["gDirToSamplePrev"] = mpDirToSamplePrev;
-    //mpTemporalReuseRISPass["gSampleNormalAreaPrev"] = mpSampleNormalAreaPrev;
-    //mpTemporalReuseRISPass["gReservoirPrev"] = mpReservoirPrev;
+void TemporalReuseRISPass::createPass()
+{
+    Program::Desc desc;
+    desc.addShaderLibrary(kShaderFile).setShaderModel(kShaderModel).csEntry("main");
 
-    mpTemporalReuseRISPass->execute(pRenderContext, mFrameDim.x, mFrameDim.y);
+    Program::DefineList defines;
+    defines.add(mpSampleGenerator->getDefines());
 
-    mFrameCount++;
+    // The vars are created on first execute(), as creating them links the program.
+    mpTemporalReuseRISPass = ComputePass::create(desc, defines, false);
 }
 
 void TemporalReuseRISPass::compile(RenderContext* pRenderContext, const CompileData& compileData)
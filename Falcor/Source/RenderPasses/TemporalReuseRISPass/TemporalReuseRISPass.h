@@ -49,6 +49,7 @@ public:
     virtual RenderPassReflection reflect(const CompileData& compileData) override;
     virtual void compile(RenderContext* pRenderContext, const CompileData& compileData) override;
     virtual void execute(RenderContext* pRenderContext, const RenderData& renderData) override;
+    virtual void collectPrograms(const RenderData& renderData, std::vector<Program::CompileRequest>& requests) override;
     virtual void renderUI(Gui::Widgets& widget) override;
     virtual void setScene(RenderContext* pRenderContext, const Scene::SharedPtr& pScene) override {}
     virtual bool onMouseEvent(const MouseEvent& mouseEvent) override { return false; }
@@ -57,7 +58,7 @@ public:
 private:
     TemporalReuseRISPass();
 
-    void prepareInternalChannels(RenderContext* pRenderContext, uint32_t width, uint32_t height);
+    void createPass();
     void reset();
 
     // UI variables
@@ -68,14 +69,13 @@ private:
 
     SampleGenerator::SharedPtr mpSampleGenerator;
     ComputePass::SharedPtr mpTemporalReuseRISPass;
+    ComputeVars::SharedPtr mpVars;
 
-
-    Texture::SharedPtr mpPosWPrev;
-    Texture::SharedPtr mpNormWPrev;
-    Texture::SharedPtr mpEmittedLightPrev;
-    Texture::SharedPtr mpDirToSamplePrev;
-    Texture::SharedPtr mpSampleNormalAreaPrev;
-    Texture::SharedPtr mpReservoirPrev;
+    // Pre-resolved shader variables, set every frame.
+    ShaderVarHandle mWidthVar = ShaderVarHandle("CB.width");
+    ShaderVarHandle mHeightVar = ShaderVarHandle("CB.height");
+    ShaderVarHandle mFrameCountVar = ShaderVarHandle("CB.frameCount");
+    ShaderVarHandle mHasHistoryVar = ShaderVarHandle("CB.hasHistory");
 
     uint32_t                    mFrameCount = 0;          
 };
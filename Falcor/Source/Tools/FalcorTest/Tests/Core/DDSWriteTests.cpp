@@ -0,0 +1,133 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/ImageIO.h"
+#include <chrono>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kRegionSize = 256;
+
+        void setRegionColor(uint8_t* pTexel, uint32_t regionX, uint32_t regionY)
+        {
+            const uint32_t region = regionY * 16 + regionX;
+            pTexel[0] = (uint8_t)(region * 40);
+            pTexel[1] = (uint8_t)(255 - region * 20);
+            pTexel[2] = (uint8_t)(region * 90);
+            pTexel[3] = 255;
+        }
+
+        // Creates an RGBA8 image with a distinct solid color in each 256x256 region.
+        // If a region is given, the whole image gets the color of that region.
+        Bitmap::UniqueConstPtr createRegionBitmap(uint32_t width, uint32_t height, std::optional<uint2> solidRegion = {})
+        {
+            std::vector<uint8_t> data((size_t)width * height * 4);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    uint2 region = solidRegion ? *solidRegion : uint2(x / kRegionSize, y / kRegionSize);
+                    setRegionColor(&data[((size_t)y * width + x) * 4], region.x, region.y);
+                }
+            }
+            return Bitmap::create(width, height, ResourceFormat::RGBA8Unorm, data.data());
+        }
+
+        std::vector<uint8_t> compressToBlocks(const Bitmap& bitmap, ImageIO::CompressionMode mode, const std::string& name)
+        {
+            const auto path = std::filesystem::temp_directory_path() / name;
+            ImageIO::saveToDDS(path.string(), bitmap, mode);
+            auto pCompressed = ImageIO::loadBitmapFromDDS(path.string());
+            std::filesystem::remove(path);
+            if (!pCompressed) return {};
+            return std::vector<uint8_t>(pCompressed->getData(), pCompressed->getData() + pCompressed->getSize());
+        }
+    }
+
+    CPU_TEST(DDSWriteTiledBC1)
+    {
+        // The image is larger than a compression tile and not a multiple of the tile size.
+        const uint32_t width = 600;
+        const uint32_t height = 300;
+        auto pBitmap = createRegionBitmap(width, height);
+
+        const auto path = std::filesystem::temp_directory_path() / "DDSWriteTiledBC1.dds";
+        ImageIO::saveToDDS(path.string(), *pBitmap, ImageIO::CompressionMode::BC1);
+        auto pCompressed = ImageIO::loadBitmapFromDDS(path.string());
+        std::filesystem::remove(path);
+        EXPECT(pCompressed != nullptr);
+        if (!pCompressed) return;
+
+        const uint32_t blocksX = div_round_up(width, 4u);
+        const uint32_t blocksY = div_round_up(height, 4u);
+        const uint32_t bytesPerBlock = 8;
+        EXPECT(isCompressedFormat(pCompressed->getFormat()));
+        EXPECT_EQ(pCompressed->getWidth(), width);
+        EXPECT_EQ(pCompressed->getHeight(), height);
+        EXPECT_EQ(pCompressed->getSize(), blocksX * blocksY * bytesPerBlock);
+        if (pCompressed->getSize() != blocksX * blocksY * bytesPerBlock) return;
+
+        // Each block must hold the encoding of its region's solid color, which verifies that the tiles are placed correctly.
+        for (uint32_t regionY = 0; regionY < div_round_up(height, kRegionSize); regionY++)
+        {
+            for (uint32_t regionX = 0; regionX < div_round_up(width, kRegionSize); regionX++)
+            {
+                auto pSolid = createRegionBitmap(4, 4, uint2(regionX, regionY));
+                auto expected = compressToBlocks(*pSolid, ImageIO::CompressionMode::BC1, "DDSWriteTiledBC1Block.dds");
+                EXPECT_EQ(expected.size(), bytesPerBlock);
+                if (expected.size() != bytesPerBlock) return;
+
+                const uint32_t blockX = regionX * kRegionSize / 4 + 1;
+                const uint32_t blockY = regionY * kRegionSize / 4 + 1;
+                const uint8_t* pBlock = pCompressed->getData() + ((size_t)blockY * blocksX + blockX) * bytesPerBlock;
+                EXPECT(std::memcmp(pBlock, expected.data(), bytesPerBlock) == 0) << "region (" << regionX << ", " << regionY << ")";
+            }
+        }
+    }
+
+    CPU_TEST(DDSCompressionBenchmark, "Benchmark, enable manually.")
+    {
+        const uint32_t size = 2048;
+        std::vector<uint8_t> data((size_t)size * size * 4);
+        for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)((i * 7 + (i / (size * 4)) * 13) & 0xff);
+        auto pBitmap = Bitmap::create(size, size, ResourceFormat::RGBA8Unorm, data.data());
+
+        const auto path = std::filesystem::temp_directory_path() / "DDSCompressionBenchmark.dds";
+        for (auto mode : { ImageIO::CompressionMode::None, ImageIO::CompressionMode::BC1, ImageIO::CompressionMode::BC2, ImageIO::CompressionMode::BC3,
+            ImageIO::CompressionMode::BC4, ImageIO::CompressionMode::BC5, ImageIO::CompressionMode::BC6, ImageIO::CompressionMode::BC7 })
+        {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            ImageIO::saveToDDS(path.string(), *pBitmap, mode);
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            logInfo("Mode {}: {}x{} in {:.3f} s, {:.1f} MPixels/s", (uint32_t)mode, size, size, seconds, (double)size * size / seconds * 1e-6);
+        }
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Tests/Core/ConstantBufferTests.cs.slang";
+    }
+
+    GPU_TEST(CompileProgramsConcurrently)
+    {
+        auto pProgram1 = ComputeProgram::createFromFile(kShaderFile, "testCbuffer1");
+        auto pProgram2 = ComputeProgram::createFromFile(kShaderFile, "testCbuffer2");
+
+        // Each program is compiled once.
+        auto results = Program::compilePrograms({ { pProgram1 }, { pProgram2 }, { pProgram1 } });
+        EXPECT_EQ(results.size(), 2u);
+        for (const auto& r : results) EXPECT(r.success);
+
+        // The programs are not compiled again on use.
+        const auto stats = Program::getGlobalCompilationStats();
+        auto pVars1 = ComputeVars::create(pProgram1.get());
+        auto pVars2 = ComputeVars::create(pProgram2.get());
+        EXPECT(pProgram1->getActiveVersion()->getKernels(pVars1.get()) != nullptr);
+        EXPECT(pProgram2->getActiveVersion()->getKernels(pVars2.get()) != nullptr);
+        EXPECT_EQ(Program::getGlobalCompilationStats().programVersionCount, stats.programVersionCount);
+        EXPECT_EQ(Program::getGlobalCompilationStats().programKernelsCount, stats.programKernelsCount);
+
+        // Programs that already have a version for their defines are skipped.
+        EXPECT(Program::compilePrograms({ { pProgram1 }, { pProgram2 } }).empty());
+
+        // A new define set is compiled again.
+        pProgram1->addDefine("UNUSED_DEFINE", "1");
+        results = Program::compilePrograms({ { pProgram1, pVars1 } });
+        EXPECT_EQ(results.size(), 1u);
+        EXPECT(results.size() == 1 && results[0].success);
+    }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        struct TestProgram
+        {
+            std::string path;
+            std::string entryPoint;
+            std::string shaderModel;
+        };
+
+        const TestProgram kTestPrograms[] =
+        {
+            { "Tests/Core/ConstantBufferTests.cs.slang", "testCbuffer1", "" },
+            { "Tests/Core/ParamBlockCB.cs.slang", "main", "" },
+            { "Tests/Slang/NestedStructs.cs.slang", "main", "" },
+            { "Tests/Slang/SlangTests.cs.slang", "testHashedStrings", "" },
+            { "Tests/Slang/UnboundedDescriptorArray.cs.slang", "main", "6_5" },
+        };
+
+        void testRoundTrip(GPUUnitTestContext& ctx, const ProgramReflection::SharedPtr& pReflector, const std::string& name)
+        {
+            auto data = pReflector->serialize();
+            auto pRestored = ProgramReflection::deserialize(pReflector->getProgramVersion().get(), data.data(), data.size());
+            EXPECT(pRestored != nullptr) << name;
+            if (!pRestored) return;
+
+            // Serializing the restored reflection must produce identical data.
+            EXPECT(pRestored->serialize() == data) << name;
+
+            auto pBlock = pReflector->getDefaultParameterBlock();
+            auto pRestoredBlock = pRestored->getDefaultParameterBlock();
+            EXPECT(*pRestoredBlock->getElementType() == *pBlock->getElementType()) << name;
+            EXPECT_EQ(pRestoredBlock->getResourceRangeCount(), pBlock->getResourceRangeCount()) << name;
+            EXPECT_EQ(pRestored->getEntryPointGroups().size(), pReflector->getEntryPointGroups().size()) << name;
+            EXPECT(pRestored->getThreadGroupSize() == pReflector->getThreadGroupSize()) << name;
+            EXPECT_EQ(pRestored->getHashedStrings().size(), pReflector->getHashedStrings().size()) << name;
+
+            // Restored reflection looks up types through the Slang program of its version.
+            auto pType = pReflector->findType("uint");
+            auto pRestoredType = pRestored->findType("uint");
+            EXPECT((pRestoredType != nullptr) == (pType != nullptr)) << name;
+            if (pType && pRestoredType) EXPECT(*pRestoredType == *pType) << name;
+
+            // Truncated data is rejected.
+            EXPECT(ProgramReflection::deserialize(pReflector->getProgramVersion().get(), data.data(), data.size() / 2) == nullptr) << name;
+        }
+    }
+
+    GPU_TEST(ProgramReflectionSerialize)
+    {
+        for (const auto& program : kTestPrograms)
+        {
+            ctx.createProgram(program.path, program.entryPoint, Program::DefineList(), Shader::CompilerFlags::None, program.shaderModel);
+            auto pVersion = ctx.getProgram()->getActiveVersion();
+            testRoundTrip(ctx, pVersion->getReflector(), program.path);
+            testRoundTrip(ctx, pVersion->getKernels(&ctx.vars())->getReflector(), program.path);
+        }
+    }
+}
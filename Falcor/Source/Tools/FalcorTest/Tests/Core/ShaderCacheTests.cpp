@@ -0,0 +1,159 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Tests/Core/ConstantBufferTests.cs.slang";
+
+        ShaderCache::Key makeKey(uint8_t value)
+        {
+            ShaderCache::Key key = {};
+            key.fill(value);
+            return key;
+        }
+
+        bool isEqual(const Shader::Blob& a, const Shader::Blob& b)
+        {
+            return a && b && a->getBufferSize() == b->getBufferSize() &&
+                std::memcmp(a->getBufferPointer(), b->getBufferPointer(), a->getBufferSize()) == 0;
+        }
+
+        void runCbufferProgram(GPUUnitTestContext& ctx)
+        {
+            ctx.createProgram(kShaderFile, "testCbuffer1", Program::DefineList(), Shader::CompilerFlags::None);
+            ctx.allocateStructuredBuffer("result", 3);
+            ctx["CB"]["params1"]["a"] = 1;
+            ctx["CB"]["params1"]["b"] = 3;
+            ctx["CB"]["params1"]["c"] = 5.5f;
+            ctx.runProgram(1, 1, 1);
+
+            const float* result = ctx.mapBuffer<const float>("result");
+            EXPECT_EQ(result[0], 1);
+            EXPECT_EQ(result[1], 3);
+            EXPECT_EQ(result[2], 5.5f);
+            ctx.unmapBuffer("result");
+        }
+    }
+
+    CPU_TEST(ShaderCacheBundle)
+    {
+        const std::string data1 = "first kernel";
+        const std::string data2 = "second kernel, somewhat longer";
+
+        auto pCache = ShaderCache::create();
+        auto pBlob1 = ShaderCache::createBlob(data1.data(), data1.size());
+        auto pBlob2 = ShaderCache::createBlob(data2.data(), data2.size());
+        pCache->add(makeKey(1), pBlob1);
+        pCache->add(makeKey(2), pBlob2);
+        EXPECT_EQ(pCache->getEntryCount(), 2u);
+        EXPECT(isEqual(pCache->find(makeKey(1)), pBlob1));
+        EXPECT(!pCache->find(makeKey(3)));
+        EXPECT_EQ(pCache->getStats().hits, 1u);
+        EXPECT_EQ(pCache->getStats().misses, 1u);
+
+        // Round-trip through a bundle file.
+        const auto path = std::filesystem::temp_directory_path() / "ShaderCacheBundle.bin";
+        pCache->writeToFile(path);
+        auto pLoaded = ShaderCache::createFromFile(path);
+        EXPECT_EQ(pLoaded->getEntryCount(), 2u);
+        EXPECT(isEqual(pLoaded->find(makeKey(1)), pBlob1));
+        EXPECT(isEqual(pLoaded->find(makeKey(2)), pBlob2));
+
+        // Merging keeps existing entries.
+        auto pMerged = ShaderCache::create();
+        pMerged->add(makeKey(2), pBlob1);
+        pMerged->add(makeKey(4), pBlob1);
+        pMerged->merge(*pLoaded);
+        EXPECT_EQ(pMerged->getEntryCount(), 3u);
+        EXPECT(isEqual(pMerged->find(makeKey(2)), pBlob1));
+
+        // Files that are not bundles are rejected.
+        {
+            std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+            stream << "not a bundle";
+        }
+        bool threw = false;
+        try
+        {
+            ShaderCache::createFromFile(path);
+        }
+        catch (const RuntimeError&)
+        {
+            threw = true;
+        }
+        EXPECT(threw);
+
+        std::filesystem::remove(path);
+    }
+
+#ifdef FALCOR_D3D12
+    GPU_TEST(ShaderCacheHit)
+    {
+        auto pPrevCache = Program::getShaderCache();
+        auto pCache = ShaderCache::create();
+        Program::setShaderCache(pCache);
+
+        // The first compile adds the dependency list and reflection of the program version,
+        // and the kernel with its reflection to the cache.
+        runCbufferProgram(ctx);
+        EXPECT_EQ(pCache->getEntryCount(), 4u);
+        EXPECT_EQ(pCache->getStats().hits, 0u);
+
+        // Compiling the same program again restores the version and the kernels from the cache without running Slang.
+        runCbufferProgram(ctx);
+        EXPECT_EQ(pCache->getEntryCount(), 4u);
+        EXPECT_EQ(pCache->getStats().hits, 4u);
+
+        // Types can still be looked up in a restored version, which runs the front end on demand.
+        auto pType = ctx.getProgram()->getReflector()->findType("Params");
+        EXPECT(pType != nullptr);
+        if (pType) EXPECT_EQ(pType->getByteSize(), 12u);
+
+        // Versions and kernels loaded from a bundle are used the same way.
+        const auto path = std::filesystem::temp_directory_path() / "ShaderCacheHit.bin";
+        pCache->writeToFile(path);
+        auto pLoaded = ShaderCache::createFromFile(path);
+        Program::setShaderCache(pLoaded);
+        runCbufferProgram(ctx);
+        EXPECT_EQ(pLoaded->getStats().hits, 4u);
+        EXPECT_EQ(pLoaded->getStats().misses, 0u);
+
+        // Different defines result in a different version and kernel.
+        Program::addGlobalDefines(Program::DefineList().add("SHADER_CACHE_TEST_DEFINE", "1"));
+        runCbufferProgram(ctx);
+        Program::removeGlobalDefines(Program::DefineList().add("SHADER_CACHE_TEST_DEFINE", "1"));
+        EXPECT_EQ(pLoaded->getEntryCount(), 8u);
+
+        Program::setShaderCache(pPrevCache);
+        std::filesystem::remove(path);
+    }
+#endif
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <chrono>
+
+namespace Falcor
+{
+    namespace
+    {
+        const char kShaderFile[] = "Tests/Core/ConstantBufferTests.cs.slang";
+
+        void testHandles(GPUUnitTestContext& ctx, const ShaderVarHandle& a, const ShaderVarHandle& b, const ShaderVarHandle& c, int valueA)
+        {
+            ctx.allocateStructuredBuffer("result", 3);
+            auto var = ctx.vars().getRootVar();
+            EXPECT(var[a].isValid());
+            var[a] = valueA;
+            var[b] = 3u;
+            var[c] = 5.5f;
+            ctx.runProgram(1, 1, 1);
+
+            const float* result = ctx.mapBuffer<const float>("result");
+            EXPECT_EQ(result[0], (float)valueA);
+            EXPECT_EQ(result[1], 3.f);
+            EXPECT_EQ(result[2], 5.5f);
+            ctx.unmapBuffer("result");
+        }
+    }
+
+    GPU_TEST(ShaderVarHandle)
+    {
+        ShaderVarHandle a("CB.params1.a"), b("CB.params1.b"), c("CB.params1.c");
+
+        ctx.createProgram(kShaderFile, "testCbuffer1", Program::DefineList(), Shader::CompilerFlags::None);
+        auto var = ctx.vars().getRootVar();
+        EXPECT(a.apply(var).getOffset() == var["CB"]["params1"]["a"].getOffset());
+        testHandles(ctx, a, b, c, 1);
+
+        // Handles resolve again against the reflection of a new program.
+        ctx.createProgram(kShaderFile, "testCbuffer1", Program::DefineList().add("UNUSED_DEFINE", "1"), Shader::CompilerFlags::None);
+        testHandles(ctx, a, b, c, 7);
+
+        // Members of a ConstantBuffer<> parameter.
+        ctx.createProgram(kShaderFile, "testCbuffer2", Program::DefineList(), Shader::CompilerFlags::None);
+        testHandles(ctx, ShaderVarHandle("params2.a"), ShaderVarHandle("params2.b"), ShaderVarHandle("params2.c"), 2);
+
+        // Relative to a non-root variable.
+        EXPECT(ctx.vars().getRootVar()["params2"][ShaderVarHandle("c")].isValid());
+
+        EXPECT(!ctx.vars().getRootVar()[ShaderVarHandle("params2.missing")].isValid());
+    }
+
+    GPU_TEST(ShaderVarHandleBenchmark, "Benchmark, enable manually.")
+    {
+        ctx.createProgram(kShaderFile, "testCbuffer1", Program::DefineList(), Shader::CompilerFlags::None);
+        auto var = ctx.vars().getRootVar();
+        ShaderVarHandle handle("CB.params1.c");
+
+        const uint32_t kLookupCount = 1000000;
+        uint32_t validCount = 0;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < kLookupCount; i++) validCount += var["CB"]["params1"]["c"].isValid() ? 1 : 0;
+        double stringSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < kLookupCount; i++) validCount += var[handle].isValid() ? 1 : 0;
+        double handleSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        EXPECT_EQ(validCount, 2 * kLookupCount);
+        logInfo("String lookups: {:.2f} M/s", kLookupCount / stringSeconds * 1e-6);
+        logInfo("Handle lookups: {:.2f} M/s ({:.1f}x)", kLookupCount / handleSeconds * 1e-6, stringSeconds / handleSeconds);
+    }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Render pass counting the calls to compile().
+        */
+        class CompileCountPass : public RenderPass
+        {
+        public:
+            using SharedPtr = std::shared_ptr<CompileCountPass>;
+
+            static SharedPtr create(bool hasInput) { return SharedPtr(new CompileCountPass(hasInput)); }
+
+            RenderPassReflection reflect(const CompileData& compileData) override
+            {
+                RenderPassReflection reflector;
+                if (mHasInput) reflector.addInput("src", "Input");
+                reflector.addOutput("dst", "Output").format(mFormat).texture2D(16, 16);
+                return reflector;
+            }
+
+            void compile(RenderContext* pRenderContext, const CompileData& compileData) override { mCompileCount++; }
+            void execute(RenderContext* pRenderContext, const RenderData& renderData) override {}
+
+            void setFormat(ResourceFormat format) { mFormat = format; requestRecompile(); }
+            void setDirty() { requestRecompile(); }
+            uint32_t getCompileCount() const { return mCompileCount; }
+
+        private:
+            CompileCountPass(bool hasInput) : RenderPass({ "CompileCountPass", "Counts the calls to compile()." }), mHasInput(hasInput) {}
+
+            bool mHasInput;
+            ResourceFormat mFormat = ResourceFormat::RGBA8Unorm;
+            uint32_t mCompileCount = 0;
+        };
+    }
+
+    GPU_TEST(RenderGraphCompileReuse)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+        auto pGraph = RenderGraph::create("CompileReuse");
+        auto pA = CompileCountPass::create(false);
+        auto pB = CompileCountPass::create(true);
+        pGraph->addPass(pA, "A");
+        pGraph->addPass(pB, "B");
+        pGraph->addEdge("A.dst", "B.src");
+        pGraph->markOutput("B.dst");
+
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(pGraph->getCompileStats().fullCount, 1u);
+        EXPECT_EQ(pA->getCompileCount(), 1u);
+        EXPECT_EQ(pB->getCompileCount(), 1u);
+
+        // Toggling an output back and forth reuses the compiled graph.
+        pGraph->unmarkOutput("B.dst");
+        pGraph->markOutput("B.dst");
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(pGraph->getCompileStats().reuseCount, 1u);
+        EXPECT_EQ(pA->getCompileCount(), 1u);
+        EXPECT_EQ(pB->getCompileCount(), 1u);
+
+        // A pass requesting a recompile without changing its reflection is compiled on its own.
+        pA->setDirty();
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(pGraph->getCompileStats().incrementalCount, 1u);
+        EXPECT_EQ(pA->getCompileCount(), 2u);
+        EXPECT_EQ(pB->getCompileCount(), 1u);
+
+        // Changing the reflection of a pass compiles the whole graph.
+        pA->setFormat(ResourceFormat::RGBA32Float);
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(pGraph->getCompileStats().fullCount, 2u);
+        EXPECT_EQ(pA->getCompileCount(), 3u);
+        EXPECT_EQ(pB->getCompileCount(), 2u);
+
+        // Adding an output compiles the whole graph.
+        pGraph->markOutput("A.dst");
+        EXPECT(pGraph->compile(pRenderContext));
+        EXPECT_EQ(pGraph->getCompileStats().fullCount, 3u);
+        EXPECT(pGraph->getOutput("A.dst") != nullptr);
+    }
+}
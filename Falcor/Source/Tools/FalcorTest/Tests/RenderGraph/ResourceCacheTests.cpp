@@ -0,0 +1,129 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Resource without any GPU allocation, used to test the resource cache bookkeeping.
+        */
+        class DummyResource : public Resource
+        {
+        public:
+            DummyResource() : Resource(Type::Texture2D, BindFlags::None, 0) {}
+
+            ShaderResourceView::SharedPtr getSRV() override { return nullptr; }
+            UnorderedAccessView::SharedPtr getUAV() override { return nullptr; }
+#if FALCOR_ENABLE_CUDA
+            void* getCUDADeviceAddress() const override { return nullptr; }
+            void* getCUDADeviceAddress(ResourceViewInfo const& viewInfo) const override { return nullptr; }
+#endif
+        };
+
+        RenderPassReflection::Field createField(const std::string& name, RenderPassReflection::Field::Visibility visibility, RenderPassReflection::Field::Flags flags)
+        {
+            RenderPassReflection::Field field(name, "", visibility);
+            field.texture2D(16, 16).flags(flags);
+            return field;
+        }
+    }
+
+    CPU_TEST(ResourceCacheHistory)
+    {
+        using Field = RenderPassReflection::Field;
+
+        uint32_t allocationCount = 0;
+        auto pCache = ResourceCache::create([&](const ResourceCache::DefaultProperties&, const Field&, bool, const std::string&)
+        {
+            allocationCount++;
+            return std::make_shared<DummyResource>();
+        });
+
+        // A history output read by a later pass, and a regular internal resource.
+        pCache->registerField("A.dst", createField("dst", Field::Visibility::Output, Field::Flags::History), 0);
+        pCache->registerField("B.src", createField("src", Field::Visibility::Input, Field::Flags::None), 1, "A.dst");
+        pCache->registerField("B.tmp", createField("tmp", Field::Visibility::Internal, Field::Flags::None), 1);
+        pCache->allocateResources({ uint2(16, 16), ResourceFormat::RGBA32Float });
+        EXPECT_EQ(allocationCount, 3u);
+
+        const auto pTmp = pCache->getResource("B.tmp");
+        Resource::SharedPtr pPrevious;
+        for (uint32_t frame = 0; frame < 4; frame++)
+        {
+            pCache->swapHistoryResources();
+
+            // The input aliases the current resource. The history resource holds the previous frame, once there is one.
+            const auto& pCurrent = pCache->getResource("A.dst");
+            EXPECT(pCurrent != nullptr);
+            EXPECT(pCache->getResource("B.src") == pCurrent);
+            EXPECT(pCache->getHistoryResource("A.dst") == pPrevious);
+            EXPECT(pCache->getHistoryResource("B.src") == pPrevious);
+            EXPECT(pCache->getResource("B.tmp") == pTmp);
+            EXPECT(pCache->getHistoryResource("B.tmp") == nullptr);
+
+            if (pPrevious) EXPECT(pCurrent != pPrevious);
+            pPrevious = pCurrent;
+        }
+        EXPECT_EQ(allocationCount, 3u);
+
+        // Reallocating the resources invalidates the history.
+        pCache->reset();
+        pCache->registerField("A.dst", createField("dst", Field::Visibility::Output, Field::Flags::History), 0);
+        pCache->registerField("B.src", createField("src", Field::Visibility::Input, Field::Flags::None), 1, "A.dst");
+        pCache->allocateResources({ uint2(16, 16), ResourceFormat::RGBA32Float });
+        EXPECT_EQ(allocationCount, 5u);
+        pCache->swapHistoryResources();
+        EXPECT(pCache->getHistoryResource("B.src") == nullptr);
+    }
+
+    CPU_TEST(ResourceCacheHistoryFromInput)
+    {
+        using Field = RenderPassReflection::Field;
+
+        uint32_t allocationCount = 0;
+        auto pCache = ResourceCache::create([&](const ResourceCache::DefaultProperties&, const Field&, bool, const std::string&)
+        {
+            allocationCount++;
+            return std::make_shared<DummyResource>();
+        });
+
+        // A history flag on the input double-buffers the output it is connected to.
+        pCache->registerField("A.dst", createField("dst", Field::Visibility::Output, Field::Flags::None), 0);
+        pCache->registerField("B.src", createField("src", Field::Visibility::Input, Field::Flags::History), 1, "A.dst");
+        pCache->allocateResources({ uint2(16, 16), ResourceFormat::RGBA32Float });
+        EXPECT_EQ(allocationCount, 2u);
+
+        pCache->swapHistoryResources();
+        const auto pFirst = pCache->getResource("A.dst");
+        EXPECT(pCache->getHistoryResource("B.src") == nullptr);
+        pCache->swapHistoryResources();
+        EXPECT(pCache->getHistoryResource("B.src") == pFirst);
+        EXPECT(pCache->getResource("B.src") != pFirst);
+    }
+}
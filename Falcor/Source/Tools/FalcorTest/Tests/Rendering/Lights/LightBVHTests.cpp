@@ -0,0 +1,191 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridWidth = 16;             // The scene has kGridWidth x kGridWidth quad lights.
+        const float kLightSpacing = 2.f;
+        const float3 kMoveOffset = float3(0.f, 10.f, 0.f);
+
+        /** Creates a scene with a grid of emissive quads. Every other quad, in a checkerboard pattern, is animated
+            and moves by kMoveOffset at time 0.5. This spreads each group of neighboring lights over two layers.
+        */
+        Scene::SharedPtr createScene()
+        {
+            auto pBuilder = SceneBuilder::create();
+
+            auto pMaterial = StandardMaterial::create("Emissive");
+            pMaterial->setEmissiveColor(float3(1.f));
+            const uint32_t meshID = pBuilder->addTriangleMesh(TriangleMesh::createQuad(), pMaterial);
+
+            for (uint32_t z = 0; z < kGridWidth; z++)
+            {
+                for (uint32_t x = 0; x < kGridWidth; x++)
+                {
+                    const std::string name = "Light" + std::to_string(x + z * kGridWidth);
+                    const float3 position = float3(x, 0.f, z) * kLightSpacing;
+
+                    SceneBuilder::Node node = { name, glm::translate(float4x4(1.f), position), glm::identity<float4x4>(), glm::identity<float4x4>() };
+                    const uint32_t nodeID = pBuilder->addNode(node);
+                    pBuilder->addMeshInstance(nodeID, meshID);
+
+                    if ((x + z) % 2 == 0)
+                    {
+                        auto pAnimation = Animation::create(name, nodeID, 1.0);
+                        Animation::Keyframe keyframe;
+                        keyframe.time = 0.0;
+                        keyframe.translation = position;
+                        pAnimation->addKeyframe(keyframe);
+                        keyframe.time = 1.0;
+                        keyframe.translation = position + 2.f * kMoveOffset;
+                        pAnimation->addKeyframe(keyframe);
+                        pBuilder->addAnimation(pAnimation);
+                    }
+                }
+            }
+
+            return pBuilder->getScene();
+        }
+
+        /** Returns the global indices of the triangles of the mesh lights updated by the last light collection update.
+        */
+        std::vector<uint32_t> getUpdatedTriangles(const LightCollection& lightCollection)
+        {
+            std::vector<uint32_t> updatedTriangles;
+            for (uint32_t lightIdx : lightCollection.getUpdatedLights())
+            {
+                const auto& meshLight = lightCollection.getMeshLights()[lightIdx];
+                for (uint32_t i = 0; i < meshLight.triangleCount; i++) updatedTriangles.push_back(meshLight.triangleOffset + i);
+            }
+            return updatedTriangles;
+        }
+
+        /** Compares the attributes of two nodes. Bounds and flux are compared with a tolerance,
+            as the node extents are stored at reduced precision and the flux may be summed up in a different order.
+        */
+        void compareAttributes(GPUUnitTestContext& ctx, const PackedNode& node, const PackedNode& refNode, size_t nodeIndex)
+        {
+            SharedNodeAttributes attribs = node.getNodeAttributes();
+            SharedNodeAttributes refAttribs = refNode.getNodeAttributes();
+            float3 aabbMin, aabbMax, refAABBMin, refAABBMax;
+            attribs.getAABB(aabbMin, aabbMax);
+            refAttribs.getAABB(refAABBMin, refAABBMax);
+
+            const float boundsEpsilon = 1e-3f * (1.f + glm::length(refAABBMax - refAABBMin));
+            EXPECT_LE(glm::length(aabbMin - refAABBMin), boundsEpsilon) << "node = " << nodeIndex;
+            EXPECT_LE(glm::length(aabbMax - refAABBMax), boundsEpsilon) << "node = " << nodeIndex;
+            EXPECT_LE(std::abs(attribs.flux - refAttribs.flux), 1e-4f * refAttribs.flux) << "node = " << nodeIndex;
+            EXPECT_LE(std::abs(attribs.cosConeAngle - refAttribs.cosConeAngle), 1e-4f) << "node = " << nodeIndex;
+        }
+
+        /** Compares the nodes of two BVHs with the same hierarchy.
+        */
+        void compareNodes(GPUUnitTestContext& ctx, const std::vector<PackedNode>& nodes, const std::vector<PackedNode>& refNodes)
+        {
+            EXPECT_EQ(nodes.size(), refNodes.size());
+            if (nodes.size() != refNodes.size()) return;
+
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                EXPECT_EQ(nodes[i].isLeaf(), refNodes[i].isLeaf()) << "node = " << i;
+                if (nodes[i].isLeaf() != refNodes[i].isLeaf()) continue;
+
+                if (nodes[i].isLeaf())
+                {
+                    EXPECT_EQ(nodes[i].getLeafNode().triangleCount, refNodes[i].getLeafNode().triangleCount) << "node = " << i;
+                    EXPECT_EQ(nodes[i].getLeafNode().triangleOffset, refNodes[i].getLeafNode().triangleOffset) << "node = " << i;
+                }
+                else
+                {
+                    EXPECT_EQ(nodes[i].getInternalNode().rightChildIdx, refNodes[i].getInternalNode().rightChildIdx) << "node = " << i;
+                }
+
+                compareAttributes(ctx, nodes[i], refNodes[i], i);
+            }
+        }
+    }
+
+    GPU_TEST(LightBVHRefit)
+    {
+        RenderContext* pRenderContext = ctx.getRenderContext();
+
+        auto pScene = createScene();
+        pScene->update(pRenderContext, 0.0);
+        auto pLightCollection = pScene->getLightCollection(pRenderContext);
+        EXPECT(pLightCollection->hasCPUTriangleData());
+
+        // Use single triangle leaves, so that the BVH is deep enough for the refit to process subtrees in parallel.
+        LightBVHBuilder::Options options;
+        options.maxTriangleCountPerLeaf = 1;
+        auto pBuilder = LightBVHBuilder::create(options);
+
+        // Build two BVHs with the initial light positions. One is refit on the CPU, the other fully refit on the GPU.
+        auto pBVH = LightBVH::create(pLightCollection);
+        pBuilder->build(*pBVH);
+        auto pRefBVH = LightBVH::create(pLightCollection);
+        pBuilder->build(*pRefBVH);
+
+        const std::vector<PackedNode> initialNodes = pBVH->getNodes();
+        const float initialCost = pBuilder->evalCost(*pBVH);
+        EXPECT_GT(initialCost, 0.f);
+
+        // Move half of the lights.
+        pScene->update(pRenderContext, 0.5);
+        EXPECT_EQ(pLightCollection->getUpdatedLights().size(), (size_t)kGridWidth * kGridWidth / 2);
+
+        const bool refitResult = pBuilder->refit(*pBVH, getUpdatedTriangles(*pLightCollection));
+        pRefBVH->refit(pRenderContext);
+        compareNodes(ctx, pBVH->getNodes(), pRefBVH->getNodes());
+
+        // The refit BVH keeps the hierarchy built for the initial positions, so its cost is higher than that of a full rebuild.
+        const float refitCost = pBuilder->evalCost(*pBVH);
+        EXPECT_LE(std::abs(refitCost - pBuilder->evalCost(*pRefBVH)), 1e-3f * refitCost);
+        EXPECT_EQ(refitResult, refitCost <= initialCost * options.rebuildCostRatio);
+
+        auto pRebuiltBVH = LightBVH::create(pLightCollection);
+        pBuilder->build(*pRebuiltBVH);
+        EXPECT_GT(refitCost, pBuilder->evalCost(*pRebuiltBVH));
+
+        // Both BVHs bound the same triangles with the same total flux.
+        compareAttributes(ctx, pBVH->getNodes()[0], pRebuiltBVH->getNodes()[0], 0);
+
+        // Move the lights back. Refitting must restore the nodes and cost of the initial build.
+        pScene->update(pRenderContext, 0.0);
+        EXPECT_EQ(pLightCollection->getUpdatedLights().size(), (size_t)kGridWidth * kGridWidth / 2);
+
+        pBuilder->refit(*pBVH, getUpdatedTriangles(*pLightCollection));
+        compareNodes(ctx, pBVH->getNodes(), initialNodes);
+        EXPECT_LE(std::abs(pBuilder->evalCost(*pBVH) - initialCost), 1e-4f * initialCost);
+    }
+}
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Sampling/AliasTable.h"
+#include "Utils/Timing/TimeReport.h"
 
 #include "hypothesis/hypothesis.h"
 
@@ -131,6 +132,88 @@ namespace Falcor
                 ctx.unmapBuffer("weightResult");
             }
         }
+
+        void testAliasTableCPU(CPUUnitTestContext& ctx, uint32_t N)
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> uniform;
+
+            // Generate pseudo-random weights with a few zero weights and a few large outliers.
+            std::vector<float> weights(N);
+            for (uint32_t i = 0; i < N; ++i) weights[i] = uniform(rng);
+            for (uint32_t i = 0; i < N / 100; ++i) weights[(size_t)(uniform(rng) * N)] = 0.f;
+            for (uint32_t i = 0; i < N / 1000; ++i) weights[(size_t)(uniform(rng) * N)] = 100.f;
+
+            double weightSum = 0.0;
+            auto items = AliasTable::buildItems(weights, weightSum);
+            EXPECT_EQ(items.size(), weights.size());
+
+            // Each entry must own exactly one bucket.
+            std::vector<uint32_t> owners(N, 0);
+            for (const auto& item : items)
+            {
+                EXPECT(item.indexA < N && item.indexB < N);
+                EXPECT(item.threshold >= 0.f && item.threshold <= 1.f);
+                owners[item.indexB]++;
+            }
+            for (uint32_t i = 0; i < N; ++i) EXPECT_EQ(owners[i], 1u) << "index " << i;
+
+            // Sample the table on the CPU the same way as AliasTable.slang and build a histogram.
+            const uint32_t samplesPerWeight = 100;
+            const uint32_t sampleCount = N * samplesPerWeight;
+            std::vector<uint32_t> histogram(N, 0);
+            for (uint32_t i = 0; i < sampleCount; ++i)
+            {
+                const auto& item = items[std::min((uint32_t)(uniform(rng) * N), N - 1)];
+                histogram[uniform(rng) >= item.threshold ? item.indexA : item.indexB]++;
+            }
+
+            // Verify histogram using a chi-square test.
+            std::vector<double> expFrequencies(N);
+            std::vector<double> obsFrequencies(N);
+            for (uint32_t i = 0; i < N; ++i)
+            {
+                expFrequencies[i] = (weights[i] / weightSum) * sampleCount;
+                obsFrequencies[i] = (double)histogram[i];
+            }
+
+            const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.1);
+            if (!success) std::cout << report << std::endl;
+            EXPECT(success);
+        }
+
+        std::vector<float> generateWeights(uint32_t N)
+        {
+            std::mt19937 rng;
+            std::uniform_real_distribution<float> uniform;
+            std::vector<float> weights(N);
+            for (auto& weight : weights) weight = uniform(rng);
+            return weights;
+        }
+    }
+
+    CPU_TEST(AliasTableBuild)
+    {
+        // Serial build.
+        testAliasTableCPU(ctx, 1000);
+        // Parallel build.
+        testAliasTableCPU(ctx, 100000);
+    }
+
+    CPU_TEST(AliasTableBuildBenchmark, "Benchmark, enable manually.")
+    {
+        const uint32_t sizes[] = { 1u << 20, 1u << 24 };
+        std::vector<std::vector<float>> weights;
+        for (uint32_t N : sizes) weights.push_back(generateWeights(N));
+
+        TimeReport report;
+        for (const auto& w : weights)
+        {
+            double weightSum = 0.0;
+            auto items = AliasTable::buildItems(w, weightSum);
+            report.measure("Build alias table (" + std::to_string(w.size()) + " entries)");
+        }
+        report.printToLog();
     }
 
     GPU_TEST(AliasTable)
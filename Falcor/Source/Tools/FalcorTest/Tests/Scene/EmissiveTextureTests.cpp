@@ -0,0 +1,151 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Lights/EmissiveTexture.h"
+#include "Scene/Lights/LightCollectionShared.slang"
+
+namespace Falcor
+{
+    namespace
+    {
+        EmissiveTexture::SharedPtr createGradientTexture(uint32_t width, uint32_t height, Sampler::AddressMode addressMode = Sampler::AddressMode::Wrap)
+        {
+            std::vector<float3> texels((size_t)width * height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++) texels[y * width + x] = float3(x, y, 1.f);
+            }
+            return EmissiveTexture::create(width, height, std::move(texels), addressMode, addressMode, float3(-1.f));
+        }
+    }
+
+    CPU_TEST(EmissiveTextureFetch)
+    {
+        auto fetchX = [](Sampler::AddressMode mode, int64_t x) { return createGradientTexture(4, 4, mode)->fetch(x, 0).x; };
+
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Wrap, -1), 3.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Wrap, 5), 1.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Mirror, -1), 0.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Mirror, 4), 3.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Mirror, 9), 1.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Clamp, -3), 0.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Clamp, 7), 3.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Border, 4), -1.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::Border, 2), 2.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::MirrorOnce, -2), 1.f);
+        EXPECT_EQ(fetchX(Sampler::AddressMode::MirrorOnce, 6), 3.f);
+
+        auto pTexture = createGradientTexture(4, 4);
+        EXPECT(pTexture->samplePoint(float2(0.3f, 0.6f)) == float3(1.f, 2.f, 1.f));
+        EXPECT(pTexture->samplePoint(float2(-0.1f, 1.1f)) == float3(3.f, 0.f, 1.f));
+    }
+
+    CPU_TEST(EmissiveTextureIntegrateTriangle)
+    {
+        // Constant texture: the average is the constant for any triangle, including ones that wrap around.
+        {
+            auto pTexture = EmissiveTexture::create(8, 4, std::vector<float3>(32, float3(0.5f, 1.f, 2.f)));
+            const float2 texCoords[][3] =
+            {
+                { float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f) },
+                { float2(0.1f, 0.2f), float2(0.7f, 0.35f), float2(0.4f, 0.9f) },
+                { float2(-1.3f, 2.2f), float2(0.7f, -0.35f), float2(3.4f, 0.9f) },
+            };
+            for (const auto& t : texCoords)
+            {
+                float3 average = pTexture->integrateTriangle(t);
+                EXPECT_LE(glm::length(average - float3(0.5f, 1.f, 2.f)), 1e-5f);
+            }
+        }
+
+        // Half of a 4x4 texture: texels below the diagonal are fully covered, texels on the diagonal are half covered.
+        {
+            auto pTexture = createGradientTexture(4, 4);
+
+            glm::dvec3 sum(0.0);
+            double weightSum = 0.0;
+            for (uint32_t y = 0; y < 4; y++)
+            {
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    double weight = x + y <= 2 ? 1.0 : x + y == 3 ? 0.5 : 0.0;
+                    sum += glm::dvec3(x, y, 1.0) * weight;
+                    weightSum += weight;
+                }
+            }
+            const float3 expected = float3(sum / weightSum);
+
+            const float2 texCoords[3] = { float2(0.f, 0.f), float2(1.f, 0.f), float2(0.f, 1.f) };
+            EXPECT_LE(glm::length(pTexture->integrateTriangle(texCoords) - expected), 1e-5f);
+
+            // The same triangle with opposite winding and shifted by whole texture periods gives the same result with wrap addressing.
+            const float2 shiftedTexCoords[3] = { float2(2.f, -1.f), float2(2.f, 0.f), float2(3.f, -1.f) };
+            EXPECT_LE(glm::length(pTexture->integrateTriangle(shiftedTexCoords) - expected), 1e-5f);
+        }
+
+        // Triangles that are degenerate in texture space use the average of the vertex samples.
+        {
+            auto pTexture = createGradientTexture(4, 4);
+
+            const float2 point[3] = { float2(0.3f, 0.6f), float2(0.3f, 0.6f), float2(0.3f, 0.6f) };
+            EXPECT(pTexture->integrateTriangle(point) == float3(1.f, 2.f, 1.f));
+
+            const float2 line[3] = { float2(0.1f, 0.1f), float2(0.4f, 0.4f), float2(0.9f, 0.9f) };
+            EXPECT_LE(glm::length(pTexture->integrateTriangle(line) - float3(4.f / 3.f, 4.f / 3.f, 1.f)), 1e-5f);
+        }
+    }
+
+    CPU_TEST(PackedEmissiveTriangle)
+    {
+        EmissiveTriangle tri;
+        tri.posW[0] = float3(1.f, 2.f, 3.f);
+        tri.posW[1] = float3(-4.f, 5.5f, 0.25f);
+        tri.posW[2] = float3(7.f, -8.f, 9.f);
+        tri.texCoords[0] = float2(0.f, 0.5f);
+        tri.texCoords[1] = float2(1.f, 0.25f);
+        tri.texCoords[2] = float2(-2.f, 3.f);
+        tri.normal = glm::normalize(float3(1.f, 2.f, -3.f));
+        tri.area = 12.5f;
+        tri.materialID = 17;
+        tri.lightIdx = 42;
+
+        PackedEmissiveTriangle packedTri;
+        packedTri.pack(tri);
+        const EmissiveTriangle result = packedTri.unpack();
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            EXPECT(result.posW[i] == tri.posW[i]) << "i=" << i;
+            EXPECT(result.texCoords[i] == tri.texCoords[i]) << "i=" << i; // Exactly representable in fp16.
+        }
+        EXPECT_LE(glm::length(result.normal - tri.normal), 1e-4f);
+        EXPECT_EQ(result.area, tri.area);
+        EXPECT_EQ(result.materialID, tri.materialID);
+        EXPECT_EQ(result.lightIdx, tri.lightIdx);
+    }
+}
@@ -29,12 +29,128 @@
 #include "Scene/Lights/EnvMap.h"
 #include "Rendering/Lights/EnvMapSampler.h"
 
+#include "hypothesis/hypothesis.h"
+#include <random>
+
 namespace Falcor
 {
     namespace
     {
         // This file is located in the Media/ directory fetched by packman.
         const char kEnvMapFile[] = "LightProbes/20050806-03_hd.hdr";
+
+        /** Create a synthetic lat-long env map with a smooth gradient and a bright spot.
+        */
+        Bitmap::UniqueConstPtr createTestEnvMap(uint32_t width, uint32_t height)
+        {
+            std::vector<float4> texels((size_t)width * height);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    float u = (x + 0.5f) / width;
+                    float v = (y + 0.5f) / height;
+                    float3 c = float3(0.1f + u, 0.2f + v, 0.3f + u * v);
+                    if (x >= width / 4 && x < width / 4 + 4 && y >= height / 3 && y < height / 3 + 2) c *= 50.f;
+                    texels[(size_t)y * width + x] = float4(c, 1.f);
+                }
+            }
+            return Bitmap::create(width, height, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(texels.data()));
+        }
+
+        /** Hierarchical sample warping. This mirrors EnvMapSampler::sample() in EnvMapSampler.slang.
+            Returns the index of the selected texel in the base mip.
+        */
+        uint32_t sampleImportanceMap(const EnvMapSampler::ImportanceMips& mips, float2 p)
+        {
+            uint2 pos = uint2(0);
+            for (int mip = (int)mips.size() - 2; mip >= 0; mip--)
+            {
+                pos *= 2u;
+
+                const uint32_t dim = 1u << ((uint32_t)mips.size() - 1 - mip);
+                auto load = [&](uint2 xy) { return mips[mip][(size_t)xy.y * dim + xy.x]; };
+                float w[4] = { load(pos), load(pos + uint2(1, 0)), load(pos + uint2(0, 1)), load(pos + uint2(1, 1)) };
+                float q[2] = { w[0] + w[2], w[1] + w[3] };
+
+                uint2 off;
+                float d = q[0] / (q[0] + q[1]);
+                if (p.x < d) { off.x = 0; p.x = p.x / d; }
+                else { off.x = 1; p.x = (p.x - d) / (1.f - d); }
+
+                float e = off.x == 0 ? (w[0] / q[0]) : (w[1] / q[1]);
+                if (p.y < e) { off.y = 0; p.y = p.y / e; }
+                else { off.y = 1; p.y = (p.y - e) / (1.f - e); }
+
+                pos += off;
+            }
+            const uint32_t dimension = 1u << ((uint32_t)mips.size() - 1);
+            return pos.y * dimension + pos.x;
+        }
+    }
+
+    CPU_TEST(EnvMapImportanceMapCPU)
+    {
+        // A constant env map has a constant importance map.
+        {
+            std::vector<float4> texels(32 * 16, float4(0.5f, 1.f, 2.f, 1.f));
+            auto pBitmap = Bitmap::create(32, 16, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(texels.data()));
+            auto mips = EnvMapSampler::computeImportanceMap(*pBitmap, 16, 4);
+            EXPECT_EQ(mips.size(), 5u);
+
+            const float L = 0.2126f * 0.5f + 0.7152f * 1.f + 0.0722f * 2.f;
+            for (const auto& mip : mips)
+            {
+                for (float value : mip) EXPECT_LE(std::abs(value - L), 1e-5f);
+            }
+        }
+
+        // Check the mip hierarchy and sample the importance map the same way the shader does.
+        auto pBitmap = createTestEnvMap(128, 64);
+        const uint32_t dimension = 16;
+        auto mips = EnvMapSampler::computeImportanceMap(*pBitmap, dimension, 16);
+        EXPECT_EQ(mips.size(), 5u);
+        if (mips.size() != 5) return;
+
+        for (size_t mip = 1; mip < mips.size(); mip++)
+        {
+            const uint32_t dim = dimension >> mip;
+            EXPECT_EQ(mips[mip].size(), dim * dim);
+            for (uint32_t y = 0; y < dim; y++)
+            {
+                for (uint32_t x = 0; x < dim; x++)
+                {
+                    const auto& src = mips[mip - 1];
+                    float expected = 0.25f * (src[(2 * y) * 2 * dim + 2 * x] + src[(2 * y) * 2 * dim + 2 * x + 1] + src[(2 * y + 1) * 2 * dim + 2 * x] + src[(2 * y + 1) * 2 * dim + 2 * x + 1]);
+                    EXPECT_LE(std::abs(mips[mip][y * dim + x] - expected), 1e-5f * expected) << "mip=" << mip << " x=" << x << " y=" << y;
+                }
+            }
+        }
+
+        const uint32_t N = dimension * dimension;
+        const uint32_t sampleCount = N * 1000;
+        double weightSum = 0.0;
+        for (float w : mips[0]) weightSum += w;
+
+        std::vector<double> expFrequencies(N);
+        for (uint32_t i = 0; i < N; i++) expFrequencies[i] = mips[0][i] / weightSum * sampleCount;
+
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> uniform;
+        std::vector<double> obsFrequencies(N, 0.0);
+        for (uint32_t i = 0; i < sampleCount; i++) obsFrequencies[sampleImportanceMap(mips, float2(uniform(rng), uniform(rng)))]++;
+
+        const auto& [success, report] = hypothesis::chi2_test(N, obsFrequencies.data(), expFrequencies.data(), sampleCount, 5, 0.1);
+        if (!success) std::cout << report << std::endl;
+        EXPECT(success);
+    }
+
+    CPU_TEST(EnvMapImportanceMapUnsupportedFormat)
+    {
+        // Formats without a CPU texel reader return an empty importance map so the caller can fall back to the GPU path.
+        std::vector<uint8_t> texels(16 * 8, 128);
+        auto pBitmap = Bitmap::create(16, 8, ResourceFormat::R8Unorm, texels.data());
+        EXPECT(EnvMapSampler::computeImportanceMap(*pBitmap, 8, 4).empty());
     }
 
     GPU_TEST(EnvMap)
@@ -64,4 +180,40 @@ namespace Falcor
         EXPECT_EQ(w, h);
         EXPECT_EQ(w, 1 << (mipCount - 1));
     }
+    GPU_TEST(EnvMapImportanceMapCPUvsGPU)
+    {
+        // Build the importance map with the CPU builder and the GPU setup pass and compare all mips.
+        EnvMap::SharedPtr pEnvMap = EnvMap::createFromFile(kEnvMapFile);
+        EXPECT_NE(pEnvMap, nullptr);
+        if (pEnvMap == nullptr) return;
+
+        EnvMapSampler::Options options;
+        options.dimension = 64;
+        options.samples = 16;
+        options.useCache = false;
+        auto pCPUSampler = EnvMapSampler::create(ctx.getRenderContext(), pEnvMap, options);
+
+        options.useCPUBuilder = false;
+        auto pGPUSampler = EnvMapSampler::create(ctx.getRenderContext(), pEnvMap, options);
+
+        auto pCPUMap = pCPUSampler->getImportanceMap();
+        auto pGPUMap = pGPUSampler->getImportanceMap();
+        EXPECT_EQ(pCPUMap->getWidth(), pGPUMap->getWidth());
+        EXPECT_EQ(pCPUMap->getMipCount(), pGPUMap->getMipCount());
+
+        for (uint32_t mip = 0; mip < pCPUMap->getMipCount(); mip++)
+        {
+            auto cpuData = ctx.getRenderContext()->readTextureSubresource(pCPUMap.get(), pCPUMap->getSubresourceIndex(0, mip));
+            auto gpuData = ctx.getRenderContext()->readTextureSubresource(pGPUMap.get(), pGPUMap->getSubresourceIndex(0, mip));
+            EXPECT_EQ(cpuData.size(), gpuData.size());
+            if (cpuData.size() != gpuData.size()) continue;
+
+            const float* pCPU = reinterpret_cast<const float*>(cpuData.data());
+            const float* pGPU = reinterpret_cast<const float*>(gpuData.data());
+            for (size_t i = 0; i < cpuData.size() / sizeof(float); i++)
+            {
+                EXPECT_LE(std::abs(pCPU[i] - pGPU[i]), 1e-3f * std::max(1.f, std::abs(pGPU[i]))) << "mip=" << mip << " i=" << i;
+            }
+        }
+    }
 }
@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFGridFile.h"
+#include "Scene/SDFs/SDFPrimitiveEvaluator.h"
+#include "Utils/NumericRange.h"
+#include <chrono>
+#include <execution>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridWidth = 64;
+
+        std::vector<float> createTestValues(uint32_t gridWidth)
+        {
+            Transform transform;
+            transform.setTranslation(float3(0.1f, -0.05f, 0.f));
+            transform.setRotationEulerDeg(float3(0.f, 45.f, 10.f));
+
+            std::vector<SDF3DPrimitive> primitives;
+            primitives.push_back(SDF3DPrimitive().initSphere(0.3f, 0.f, 0.f, SDFOperationType::Union, Transform()));
+            primitives.push_back(SDF3DPrimitive().initBox(float3(0.2f, 0.05f, 0.2f), 0.01f, 0.f, SDFOperationType::Subtraction, transform));
+            return SDFPrimitiveEvaluator(primitives).evalGrid(gridWidth);
+        }
+
+        std::filesystem::path writeLegacyFile(const std::string& name, const std::vector<float>& values, uint32_t gridWidth)
+        {
+            std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+            std::ofstream file(path, std::ios::out | std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&gridWidth), sizeof(uint32_t));
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+            return path;
+        }
+
+        /** Reads all values of a grid in boxes of 8^3 values, in parallel, the way SDF grids consume bricks.
+        */
+        void readAllBricks(uint32_t gridWidth, const SDFGrid::BrickValuesFunc& getBrickValues)
+        {
+            const uint32_t kBrickWidth = 8;
+            const uint32_t bricksPerAxis = div_round_up(gridWidth, kBrickWidth - 1);
+            auto range = NumericRange<uint32_t>(0, bricksPerAxis * bricksPerAxis * bricksPerAxis);
+            std::for_each(std::execution::par, range.begin(), range.end(), [&](uint32_t brickID)
+            {
+                const uint3 firstValueCoords = uint3(brickID % bricksPerAxis, (brickID / bricksPerAxis) % bricksPerAxis, brickID / (bricksPerAxis * bricksPerAxis)) * (kBrickWidth - 1);
+                const uint3 valueCount = glm::min(uint3(kBrickWidth), uint3(gridWidth + 1) - firstValueCoords);
+                float values[kBrickWidth * kBrickWidth * kBrickWidth];
+                getBrickValues(firstValueCoords, valueCount, values);
+            });
+        }
+
+        void testRoundTrip(CPUUnitTestContext& ctx, uint32_t bitsPerValue, float narrowBandThickness)
+        {
+            const std::vector<float> values = createTestValues(kGridWidth);
+            const std::filesystem::path legacyPath = writeLegacyFile("SDFGridFileTest.legacy.sdfg", values, kGridWidth);
+            const std::filesystem::path path = std::filesystem::temp_directory_path() / "SDFGridFileTest.sdfg";
+
+            SDFGridFile::Options options;
+            options.bitsPerValue = bitsPerValue;
+            options.narrowBandThickness = narrowBandThickness;
+            EXPECT(SDFGridFile::convertLegacyFile(legacyPath, path, options));
+            EXPECT(SDFGridFile::isSDFGridFile(path));
+            EXPECT(!SDFGridFile::isSDFGridFile(legacyPath));
+            EXPECT(SDFGridFile::open(legacyPath) == nullptr);
+
+            SDFGridFile::SharedPtr pFile = SDFGridFile::open(path);
+            EXPECT(pFile != nullptr);
+            if (pFile)
+            {
+                EXPECT_EQ(pFile->getGridWidth(), kGridWidth);
+                EXPECT_EQ(pFile->getBitsPerValue(), bitsPerValue);
+                EXPECT_LT(pFile->getFileSize(), values.size() * sizeof(float) / 2);
+
+                // Values are clamped to the stored distance and rounded to the nearest quantized value.
+                const float maxDistance = pFile->getMaxDistance();
+                const float tolerance = 0.501f * maxDistance / float((1 << (bitsPerValue - 1)) - 1);
+
+                // Read the whole grid, boxes that straddle chunk boundaries and a box at the far boundary of the grid.
+                const uint3 boxes[][2] =
+                {
+                    { uint3(0), uint3(kGridWidth + 1) },
+                    { uint3(7), uint3(9) },
+                    { uint3(10, 30, 47), uint3(18, 5, 18) },
+                    { uint3(kGridWidth - 3), uint3(4) },
+                };
+
+                for (const auto& box : boxes)
+                {
+                    const uint3 firstValueCoords = box[0];
+                    const uint3 valueCount = box[1];
+                    std::vector<float> readValues(valueCount.x * valueCount.y * valueCount.z);
+                    pFile->readValues(firstValueCoords, valueCount, readValues.data());
+
+                    float maxError = 0.f;
+                    for (uint32_t z = 0; z < valueCount.z; z++)
+                    {
+                        for (uint32_t y = 0; y < valueCount.y; y++)
+                        {
+                            for (uint32_t x = 0; x < valueCount.x; x++)
+                            {
+                                const uint3 coords = firstValueCoords + uint3(x, y, z);
+                                const float expected = glm::clamp(values[coords.x + (kGridWidth + 1) * (coords.y + (kGridWidth + 1) * coords.z)], -maxDistance, maxDistance);
+                                maxError = std::max(maxError, std::abs(readValues[x + valueCount.x * (y + valueCount.y * z)] - expected));
+                            }
+                        }
+                    }
+                    EXPECT_LE(maxError, tolerance);
+                }
+            }
+
+            pFile.reset();
+            std::filesystem::remove(path);
+            std::filesystem::remove(legacyPath);
+        }
+    }
+
+    CPU_TEST(SDFGridFileRoundTrip)
+    {
+        testRoundTrip(ctx, 8, 1.f);
+        testRoundTrip(ctx, 16, 4.f);
+    }
+
+    CPU_TEST(SDFGridFileReadBenchmark, "Benchmark, enable manually.")
+    {
+        const uint32_t gridWidth = 256;
+        const std::vector<float> values = createTestValues(gridWidth);
+        const size_t valueBytes = values.size() * sizeof(float);
+
+        const std::filesystem::path legacyPath = writeLegacyFile("SDFGridFileBenchmark.legacy.sdfg", values, gridWidth);
+        const std::filesystem::path paths[] =
+        {
+            std::filesystem::temp_directory_path() / "SDFGridFileBenchmark8.sdfg",
+            std::filesystem::temp_directory_path() / "SDFGridFileBenchmark16.sdfg",
+        };
+
+        SDFGridFile::Options options;
+        options.bitsPerValue = 8;
+        EXPECT(SDFGridFile::convertLegacyFile(legacyPath, paths[0], options));
+        options.bitsPerValue = 16;
+        options.narrowBandThickness = 4.f;
+        EXPECT(SDFGridFile::convertLegacyFile(legacyPath, paths[1], options));
+
+        // Throughput is reported in MB of float values delivered to the consumer per second.
+        auto measure = [&](const std::string& name, const std::function<void()>& func)
+        {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            func();
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            logInfo("{}: {:.3f} s, {:.1f} MB/s", name, seconds, valueBytes / seconds / (1024.0 * 1024.0));
+        };
+
+        measure("Read legacy file into memory", [&]()
+        {
+            std::ifstream file(legacyPath, std::ios::in | std::ios::binary);
+            uint32_t fileGridWidth = 0;
+            file.read(reinterpret_cast<char*>(&fileGridWidth), sizeof(uint32_t));
+            std::vector<float> fileValues(values.size());
+            file.read(reinterpret_cast<char*>(fileValues.data()), valueBytes);
+        });
+
+        measure("Stream legacy file", [&]()
+        {
+            uint32_t fileGridWidth = 0;
+            SDFGrid::BrickValuesFunc getBrickValues;
+            EXPECT(SDFGridFile::openLegacyFile(legacyPath, fileGridWidth, getBrickValues));
+            readAllBricks(fileGridWidth, getBrickValues);
+        });
+
+        for (const auto& path : paths)
+        {
+            SDFGridFile::SharedPtr pFile = SDFGridFile::open(path);
+            EXPECT(pFile != nullptr);
+            if (!pFile) continue;
+
+            logInfo("{}: {} bits per value, {} bytes ({:.1f}x smaller than legacy file)", path.filename().string(), pFile->getBitsPerValue(), pFile->getFileSize(), double(valueBytes) / pFile->getFileSize());
+            measure("Stream " + path.filename().string(), [&]()
+            {
+                readAllBricks(pFile->getGridWidth(), [&](const uint3& firstValueCoords, const uint3& valueCount, float* pValues) { pFile->readValues(firstValueCoords, valueCount, pValues); });
+            });
+        }
+
+        for (const auto& path : paths) std::filesystem::remove(path);
+        std::filesystem::remove(legacyPath);
+    }
+}
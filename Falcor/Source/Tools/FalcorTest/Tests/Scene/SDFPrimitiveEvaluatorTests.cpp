@@ -0,0 +1,181 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SDFPrimitiveEvaluator.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        const float kEpsilon = 1e-5f;
+
+        SDF3DPrimitive createSphere(float radius, const float3& translation, SDFOperationType operationType = SDFOperationType::Union, float smoothing = 0.f)
+        {
+            Transform transform;
+            transform.setTranslation(translation);
+            return SDF3DPrimitive().initSphere(radius, 0.f, smoothing, operationType, transform);
+        }
+
+        /** Creates primitives covering all shape types and operations, with rotations and non-uniform scaling.
+        */
+        std::vector<SDF3DPrimitive> createTestPrimitives()
+        {
+            Transform boxTransform;
+            boxTransform.setTranslation(float3(0.1f, 0.f, -0.05f));
+            boxTransform.setRotationEulerDeg(float3(30.f, 45.f, 10.f));
+            boxTransform.setScaling(float3(1.f, 1.5f, 0.75f));
+
+            Transform torusTransform;
+            torusTransform.setTranslation(float3(-0.1f, 0.1f, 0.f));
+            torusTransform.setRotationEulerDeg(float3(0.f, 0.f, 60.f));
+
+            Transform coneTransform;
+            coneTransform.setTranslation(float3(0.f, -0.2f, 0.1f));
+
+            std::vector<SDF3DPrimitive> primitives;
+            primitives.push_back(SDF3DPrimitive().initBox(float3(0.15f, 0.1f, 0.2f), 0.01f, 0.f, SDFOperationType::Union, boxTransform));
+            primitives.push_back(SDF3DPrimitive().initTorus(0.15f, 0.03f, 0.05f, SDFOperationType::SmoothUnion, torusTransform));
+            primitives.push_back(SDF3DPrimitive().initCone(0.4f, 0.2f, 0.f, 0.f, SDFOperationType::Union, coneTransform));
+            primitives.push_back(SDF3DPrimitive().initEllipsoid(float3(0.1f, 0.05f, 0.08f), 0.f, 0.02f, SDFOperationType::SmoothSubtraction, Transform()));
+            primitives.push_back(SDF3DPrimitive().initCapsule(0.1f, 0.05f, 0.f, SDFOperationType::Union, torusTransform));
+            primitives.push_back(createSphere(0.35f, float3(0.f), SDFOperationType::SmoothIntersection, 0.05f));
+            primitives.push_back(createSphere(0.05f, float3(0.2f, 0.2f, 0.f), SDFOperationType::Subtraction));
+            return primitives;
+        }
+    }
+
+    CPU_TEST(SDFPrimitiveEvaluator_Shapes)
+    {
+        // Sphere.
+        {
+            SDFPrimitiveEvaluator evaluator({ createSphere(0.25f, float3(0.1f, 0.f, 0.f)) });
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.1f, 0.f, 0.f)) + 0.25f), kEpsilon);
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.1f, 0.4f, 0.f)) - 0.15f), kEpsilon);
+            EXPECT_LE(std::abs(evaluator.eval(float3(-0.15f, 0.f, 0.f))), kEpsilon);
+        }
+
+        // Box.
+        {
+            SDFPrimitiveEvaluator evaluator({ SDF3DPrimitive().initBox(float3(0.1f, 0.2f, 0.3f), 0.f, 0.f, SDFOperationType::Union, Transform()) });
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.f)) + 0.1f), kEpsilon);
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.3f, 0.f, 0.f)) - 0.2f), kEpsilon);
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.13f, 0.24f, 0.f)) - 0.05f), kEpsilon);
+        }
+
+        // Translated and rotated box.
+        {
+            Transform transform;
+            transform.setTranslation(float3(0.1f, 0.f, 0.f));
+            transform.setRotationEulerDeg(float3(0.f, 0.f, 90.f));
+            SDFPrimitiveEvaluator evaluator({ SDF3DPrimitive().initBox(float3(0.2f, 0.1f, 0.1f), 0.f, 0.f, SDFOperationType::Union, transform) });
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.1f, 0.3f, 0.f)) - 0.1f), kEpsilon);
+            EXPECT_LE(std::abs(evaluator.eval(float3(0.3f, 0.f, 0.f)) - 0.1f), kEpsilon);
+        }
+    }
+
+    CPU_TEST(SDFPrimitiveEvaluator_Operations)
+    {
+        const float3 p = float3(0.2f, 0.f, 0.f);
+        const float dA = 0.2f - 0.15f;
+        const float dB = 0.3f - 0.2f;
+
+        SDFPrimitiveEvaluator unionEvaluator({ createSphere(0.15f, float3(0.f)), createSphere(0.2f, float3(-0.1f, 0.f, 0.f)) });
+        EXPECT_LE(std::abs(unionEvaluator.eval(p) - std::min(dA, dB)), kEpsilon);
+
+        SDFPrimitiveEvaluator subtractionEvaluator({ createSphere(0.15f, float3(0.f)), createSphere(0.2f, float3(-0.1f, 0.f, 0.f), SDFOperationType::Subtraction) });
+        EXPECT_LE(std::abs(subtractionEvaluator.eval(p) - std::max(dA, -dB)), kEpsilon);
+
+        SDFPrimitiveEvaluator intersectionEvaluator({ createSphere(0.15f, float3(0.f)), createSphere(0.2f, float3(-0.1f, 0.f, 0.f), SDFOperationType::Intersection) });
+        EXPECT_LE(std::abs(intersectionEvaluator.eval(p) - std::max(dA, dB)), kEpsilon);
+
+        // Smooth union blends distances that are closer than the smoothing distance, and is never larger than the union.
+        SDFPrimitiveEvaluator smoothUnionEvaluator({ createSphere(0.15f, float3(0.f)), createSphere(0.2f, float3(-0.1f, 0.f, 0.f), SDFOperationType::SmoothUnion, 0.1f) });
+        const float h = 0.1f - std::abs(dA - dB);
+        EXPECT_LE(std::abs(smoothUnionEvaluator.eval(p) - (std::min(dA, dB) - h * h * 0.25f / 0.1f)), kEpsilon);
+    }
+
+    CPU_TEST(SDFPrimitiveEvaluator_Interval)
+    {
+        SDFPrimitiveEvaluator evaluator(createTestPrimitives());
+
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> dist(0.f, 1.f);
+
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            const float3 center = float3(dist(rng), dist(rng), dist(rng)) - 0.5f;
+            const float3 halfExtent = 0.1f * float3(dist(rng), dist(rng), dist(rng));
+            const float2 bounds = evaluator.evalInterval(center, halfExtent);
+
+            // All distances inside the box must be contained in the interval.
+            for (uint32_t j = 0; j < 32; j++)
+            {
+                const float3 p = center + (2.f * float3(dist(rng), dist(rng), dist(rng)) - 1.f) * halfExtent;
+                const float d = evaluator.eval(p);
+                EXPECT_LE(bounds.x, d + kEpsilon);
+                EXPECT_GE(bounds.y, d - kEpsilon);
+            }
+        }
+    }
+
+    CPU_TEST(SDFPrimitiveEvaluator_Grid)
+    {
+        const uint32_t gridWidth = 20;
+        const uint32_t gridWidthInValues = gridWidth + 1;
+
+        SDFPrimitiveEvaluator evaluator(createTestPrimitives());
+        std::vector<float> values = evaluator.evalGrid(gridWidth);
+        EXPECT_EQ(values.size(), (size_t)gridWidthInValues * gridWidthInValues * gridWidthInValues);
+
+        // Values are placed at voxel corners with x changing fastest.
+        for (uint32_t z = 0; z < gridWidthInValues; z += 3)
+        {
+            for (uint32_t y = 0; y < gridWidthInValues; y += 5)
+            {
+                for (uint32_t x = 0; x < gridWidthInValues; x += 7)
+                {
+                    const float3 p = -0.5f + float3(x, y, z) / float(gridWidth);
+                    EXPECT_EQ(values[x + gridWidthInValues * (y + gridWidthInValues * z)], evaluator.eval(p));
+                }
+            }
+        }
+
+        // Values within the narrow band are exact, values outside are clamped to the narrow band with the correct sign.
+        const float narrowBandDistance = 2.f / gridWidth;
+        std::vector<float> narrowBandValues = evaluator.evalGrid(gridWidth, narrowBandDistance);
+        EXPECT_EQ(narrowBandValues.size(), values.size());
+
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            const float exact = std::clamp(values[i], -narrowBandDistance, narrowBandDistance);
+            const float approximate = std::clamp(narrowBandValues[i], -narrowBandDistance, narrowBandDistance);
+            EXPECT_LE(std::abs(exact - approximate), kEpsilon) << "index = " << i;
+        }
+    }
+}
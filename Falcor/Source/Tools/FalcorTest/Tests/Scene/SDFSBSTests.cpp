@@ -0,0 +1,186 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SDFs/SparseBrickSet/SDFSBS.h"
+#include "Scene/SDFs/SDFPrimitiveEvaluator.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kGridWidth = 32;
+
+        std::vector<SDF3DPrimitive> createTestPrimitives()
+        {
+            Transform transform;
+            transform.setTranslation(float3(0.05f, 0.f, -0.02f));
+            transform.setRotationEulerDeg(float3(20.f, 30.f, 0.f));
+
+            std::vector<SDF3DPrimitive> primitives;
+            primitives.push_back(SDF3DPrimitive().initSphere(0.25f, 0.f, 0.f, SDFOperationType::Union, Transform()));
+            primitives.push_back(SDF3DPrimitive().initBox(float3(0.1f, 0.3f, 0.1f), 0.01f, 0.02f, SDFOperationType::SmoothSubtraction, transform));
+            return primitives;
+        }
+
+        /** Compares the indirection and brick textures of a brick set built on the CPU against a reference built on the GPU.
+            Values on the far boundary of the grid are padding, which is set to the largest distance on the GPU but holds the grid values on the CPU.
+            Texels, or BC4 blocks, containing such values are therefore skipped, as are unused bricks at the end of the brick texture.
+        */
+        void compareTextures(GPUUnitTestContext& ctx, const SDFSBS::SharedPtr& pRefSBS, const SDFSBS::SharedPtr& pSBS, uint32_t brickWidth, bool compressed)
+        {
+            RenderContext* pRenderContext = ctx.getRenderContext();
+            const Texture::SharedPtr& pRefIndirectionTexture = pRefSBS->getIndirectionTexture();
+            const Texture::SharedPtr& pIndirectionTexture = pSBS->getIndirectionTexture();
+            const Texture::SharedPtr& pRefBrickTexture = pRefSBS->getBrickTexture();
+            const Texture::SharedPtr& pBrickTexture = pSBS->getBrickTexture();
+
+            EXPECT_EQ(pIndirectionTexture->getWidth(), pRefIndirectionTexture->getWidth());
+            EXPECT_EQ(pBrickTexture->getWidth(), pRefBrickTexture->getWidth());
+            EXPECT_EQ(pBrickTexture->getHeight(), pRefBrickTexture->getHeight());
+            if (pIndirectionTexture->getWidth() != pRefIndirectionTexture->getWidth() ||
+                pBrickTexture->getWidth() != pRefBrickTexture->getWidth() ||
+                pBrickTexture->getHeight() != pRefBrickTexture->getHeight()) return;
+
+            // Compare the indirection textures, which map virtual bricks to the same brick IDs as the prefix sum on the GPU.
+            std::vector<uint8_t> refIndirectionData = pRenderContext->readTextureSubresource(pRefIndirectionTexture.get(), 0);
+            std::vector<uint8_t> indirectionData = pRenderContext->readTextureSubresource(pIndirectionTexture.get(), 0);
+            EXPECT_EQ(indirectionData.size(), refIndirectionData.size());
+            if (indirectionData.size() != refIndirectionData.size()) return;
+
+            const uint32_t* pRefIndirection = reinterpret_cast<const uint32_t*>(refIndirectionData.data());
+            const uint32_t* pIndirection = reinterpret_cast<const uint32_t*>(indirectionData.data());
+            const uint32_t virtualBricksPerAxis = pRefIndirectionTexture->getWidth();
+            const uint32_t virtualBrickCount = virtualBricksPerAxis * virtualBricksPerAxis * virtualBricksPerAxis;
+            for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; virtualBrickID++)
+            {
+                EXPECT_EQ(pIndirection[virtualBrickID], pRefIndirection[virtualBrickID]) << "virtualBrickID = " << virtualBrickID;
+            }
+
+            // Compare the bricks, one texel or BC4 block at a time.
+            std::vector<uint8_t> refBrickData = pRenderContext->readTextureSubresource(pRefBrickTexture.get(), 0);
+            std::vector<uint8_t> brickData = pRenderContext->readTextureSubresource(pBrickTexture.get(), 0);
+            EXPECT_EQ(brickData.size(), refBrickData.size());
+            if (brickData.size() != refBrickData.size()) return;
+
+            const uint32_t brickWidthInValues = brickWidth + 1;
+            const uint32_t bricksAlongX = pRefBrickTexture->getWidth() / (brickWidthInValues * brickWidthInValues);
+            const uint32_t texelWidth = compressed ? 4 : 1;
+            const uint32_t texelSize = compressed ? 8 : 1;
+            const uint32_t texelsPerRow = pRefBrickTexture->getWidth() / texelWidth;
+
+            for (uint32_t virtualBrickID = 0; virtualBrickID < virtualBrickCount; virtualBrickID++)
+            {
+                const uint32_t brickID = pRefIndirection[virtualBrickID];
+                if (brickID == std::numeric_limits<uint32_t>::max()) continue;
+
+                const uint3 virtualBrickCoords = uint3(virtualBrickID % virtualBricksPerAxis, (virtualBrickID / virtualBricksPerAxis) % virtualBricksPerAxis, virtualBrickID / (virtualBricksPerAxis * virtualBricksPerAxis));
+                const uint2 brickTextureCoords = uint2(brickID % bricksAlongX, brickID / bricksAlongX) * uint2(brickWidthInValues * brickWidthInValues, brickWidthInValues);
+
+                for (uint32_t z = 0; z < brickWidthInValues; z++)
+                {
+                    for (uint32_t y = 0; y < brickWidthInValues; y += texelWidth)
+                    {
+                        for (uint32_t x = 0; x < brickWidthInValues; x += texelWidth)
+                        {
+                            // Skip texels or blocks that contain padding.
+                            const uint3 maxGridCoords = virtualBrickCoords * brickWidth + uint3(x + texelWidth - 1, y + texelWidth - 1, z);
+                            if (glm::any(glm::greaterThanEqual(maxGridCoords, uint3(kGridWidth)))) continue;
+
+                            const uint2 texelCoords = (brickTextureCoords + uint2(x + z * brickWidthInValues, y)) / texelWidth;
+                            const size_t offset = (texelCoords.x + (size_t)texelsPerRow * texelCoords.y) * texelSize;
+                            EXPECT_EQ(std::memcmp(brickData.data() + offset, refBrickData.data() + offset, texelSize), 0) << "brickID = " << brickID << ", x = " << x << ", y = " << y << ", z = " << z;
+                        }
+                    }
+                }
+            }
+        }
+
+        void testCPUvsGPU(GPUUnitTestContext& ctx, uint32_t brickWidth, bool compressed)
+        {
+            const std::vector<SDF3DPrimitive> primitives = createTestPrimitives();
+            const std::vector<float> values = SDFPrimitiveEvaluator(primitives).evalGrid(kGridWidth);
+
+            // Build on the GPU from values.
+            auto pGPUSBS = SDFSBS::create(brickWidth, compressed);
+            pGPUSBS->setValues(values, kGridWidth);
+            pGPUSBS->createResources(ctx.getRenderContext());
+
+            // Build on the CPU from the same values.
+            auto pCPUSBS = SDFSBS::create(brickWidth, compressed);
+            pCPUSBS->setValues(values, kGridWidth);
+            EXPECT(!pCPUSBS->isBuiltOnCPU());
+            pCPUSBS->buildOnCPU();
+            EXPECT(pCPUSBS->isBuiltOnCPU());
+            pCPUSBS->createResources(ctx.getRenderContext());
+
+            // Bake on the CPU from primitives, skipping bricks far from the surface.
+            auto pBakedSBS = SDFSBS::create(brickWidth, compressed);
+            pBakedSBS->bakePrimitives(primitives, kGridWidth);
+            EXPECT(pBakedSBS->isBuiltOnCPU());
+            pBakedSBS->createResources(ctx.getRenderContext());
+
+            EXPECT_GT(pGPUSBS->getAABBCount(), 0u);
+            EXPECT_EQ(pCPUSBS->getAABBCount(), pGPUSBS->getAABBCount());
+            EXPECT_EQ(pBakedSBS->getAABBCount(), pGPUSBS->getAABBCount());
+            EXPECT_EQ(pCPUSBS->getSize(), pGPUSBS->getSize());
+            EXPECT_EQ(pCPUSBS->getVirtualBrickCoordsBitCount(), pGPUSBS->getVirtualBrickCoordsBitCount());
+
+            compareTextures(ctx, pGPUSBS, pCPUSBS, brickWidth, compressed);
+            compareTextures(ctx, pGPUSBS, pBakedSBS, brickWidth, compressed);
+        }
+    }
+
+    GPU_TEST(SDFSBSBuildCPUvsGPU)
+    {
+        testCPUvsGPU(ctx, 7, false);
+        testCPUvsGPU(ctx, 4, false);
+    }
+
+    GPU_TEST(SDFSBSBuildCompressedCPUvsGPU)
+    {
+        testCPUvsGPU(ctx, 7, true);
+        testCPUvsGPU(ctx, 15, true);
+    }
+
+    GPU_TEST(SDFSBSBuildCPUEmpty)
+    {
+        // A grid without a surface yields no bricks, but is still built and can be uploaded.
+        const std::vector<float> values((kGridWidth + 1) * (kGridWidth + 1) * (kGridWidth + 1), 1.f);
+
+        auto pSBS = SDFSBS::create(7, false);
+        pSBS->setValues(values, kGridWidth);
+        pSBS->buildOnCPU();
+        EXPECT(pSBS->isBuiltOnCPU());
+        EXPECT_EQ(pSBS->getAABBCount(), 0u);
+
+        pSBS->createResources(ctx.getRenderContext());
+        EXPECT(pSBS->getAABBBuffer() != nullptr);
+        EXPECT(pSBS->getIndirectionTexture() != nullptr);
+        EXPECT(pSBS->getBrickTexture() != nullptr);
+    }
+}
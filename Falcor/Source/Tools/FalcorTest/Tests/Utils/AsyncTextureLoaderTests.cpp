@@ -0,0 +1,145 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncTextureLoader.h"
+#include "Utils/Image/TextureCache.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Textures are uploaded by the thread calling uploadStagedTextures(), so keep uploading while waiting.
+        Texture::SharedPtr waitForTexture(AsyncTextureLoader& loader, std::future<Texture::SharedPtr>& future)
+        {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                loader.uploadStagedTextures(std::chrono::milliseconds(10));
+            }
+            return future.get();
+        }
+    }
+
+    GPU_TEST(AsyncTextureLoaderLoad)
+    {
+        AsyncTextureLoader loader(2);
+
+        // texture5.png is 1x1, which is too small to get a preview or a mip chain.
+        const uint32_t kTinyTexture = 4;
+        std::vector<std::atomic<uint32_t>> previewCounts(6);
+        std::vector<std::future<Texture::SharedPtr>> futures;
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            AsyncTextureLoader::LoadOptions options;
+            options.priority = (float)i;
+            options.previewMaxDimension = 16;
+            options.previewCallback = [&previewCounts, i](Texture::SharedPtr pPreview)
+            {
+                if (pPreview && std::max(pPreview->getWidth(), pPreview->getHeight()) <= 16) previewCounts[i]++;
+            };
+            futures.push_back(loader.loadFromFile("texture" + std::to_string(i + 1) + ".png", true, false, Resource::BindFlags::ShaderResource, {}, options));
+        }
+
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            Texture::SharedPtr pTexture = waitForTexture(loader, futures[i]);
+            EXPECT(pTexture != nullptr);
+            if (pTexture && i != kTinyTexture) EXPECT_GT(pTexture->getMipCount(), 1u);
+            EXPECT_EQ(previewCounts[i].load(), i == kTinyTexture ? 0u : 1u);
+        }
+
+        // Missing files complete with nullptr.
+        auto missing = loader.loadFromFile("missing_texture.png", false, false);
+        EXPECT(waitForTexture(loader, missing) == nullptr);
+    }
+
+    GPU_TEST(AsyncTextureLoaderDDSPreview)
+    {
+        // Write a DDS file with a full mip chain.
+        std::string sourcePath;
+        EXPECT(findFileInDataDirectories("texture2.png", sourcePath));
+        const auto ddsPath = std::filesystem::temp_directory_path() / "AsyncTextureLoaderDDSPreview.dds";
+        EXPECT(TextureCache::writeCacheFile(sourcePath, ddsPath, true, false, TextureCache::Options()));
+
+        // The coarse mip levels are read without the more detailed ones.
+        ImageIO::MipChain fullChain, previewChain;
+        EXPECT(ImageIO::loadMipChainFromDDS(ddsPath.string(), std::numeric_limits<uint32_t>::max(), fullChain));
+        EXPECT(ImageIO::loadMipChainFromDDS(ddsPath.string(), 16, previewChain));
+        EXPECT_EQ(fullChain.skippedMipLevels, 0u);
+        EXPECT_GT(previewChain.skippedMipLevels, 0u);
+        EXPECT_LE(std::max(previewChain.width, previewChain.height), 16u);
+        EXPECT_EQ(previewChain.mipLevels + previewChain.skippedMipLevels, fullChain.mipLevels);
+        EXPECT_LT(previewChain.data.size(), fullChain.data.size());
+
+        // The preview is published before the full texture.
+        AsyncTextureLoader loader(1);
+        Texture::SharedPtr pPreview;
+        bool previewFirst = false;
+        AsyncTextureLoader::LoadOptions options;
+        options.previewMaxDimension = 16;
+        options.previewCallback = [&](Texture::SharedPtr pTexture) { pPreview = pTexture; };
+        auto callback = [&](Texture::SharedPtr) { previewFirst = pPreview != nullptr; };
+        auto future = loader.loadFromFile(ddsPath.string(), true, false, Resource::BindFlags::ShaderResource, callback, options);
+        Texture::SharedPtr pTexture = waitForTexture(loader, future);
+
+        EXPECT(pTexture != nullptr);
+        EXPECT(pPreview != nullptr);
+        EXPECT(previewFirst);
+        if (pTexture && pPreview)
+        {
+            EXPECT_EQ(pTexture->getMipCount(), fullChain.mipLevels);
+            EXPECT_EQ(pPreview->getMipCount(), previewChain.mipLevels);
+            EXPECT_EQ(pPreview->getWidth(), previewChain.width);
+        }
+
+        std::filesystem::remove(ddsPath);
+    }
+
+    GPU_TEST(AsyncTextureLoaderCancel)
+    {
+        // Without worker threads all requests stay pending.
+        AsyncTextureLoader loader(0);
+
+        std::vector<AsyncTextureLoader::RequestID> ids(3);
+        std::vector<std::future<Texture::SharedPtr>> futures;
+        uint32_t callbackCount = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            futures.push_back(loader.loadFromFile("texture1.png", false, false, Resource::BindFlags::ShaderResource, [&](Texture::SharedPtr) { callbackCount++; }, {}, &ids[i]));
+            EXPECT_NE(ids[i], AsyncTextureLoader::kInvalidRequestID);
+        }
+        EXPECT_EQ(loader.getPendingRequestCount(), 3u);
+
+        EXPECT(loader.setPriority(ids[1], 10.f));
+        EXPECT(loader.cancel(ids[1]));
+        EXPECT(!loader.cancel(ids[1]));
+        EXPECT(!loader.setPriority(ids[1], 1.f));
+        EXPECT_EQ(loader.getPendingRequestCount(), 2u);
+        EXPECT_EQ(callbackCount, 1u);
+        EXPECT(futures[1].get() == nullptr);
+    }
+}
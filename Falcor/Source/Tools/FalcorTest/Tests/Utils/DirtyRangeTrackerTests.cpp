@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Algorithm/DirtyRangeTracker.h"
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        using Range = DirtyRangeTracker::Range;
+    }
+
+    CPU_TEST(DirtyRangeTracker_Sequential)
+    {
+        DirtyRangeTracker tracker;
+        EXPECT(!tracker.isDirty());
+        EXPECT(tracker.getRanges().empty());
+
+        // Consecutive elements collapse into one range.
+        for (size_t i = 0; i < 1000; i++) tracker.markDirty(i * 64, 64);
+        EXPECT(tracker.isDirty());
+        EXPECT_EQ(tracker.getRanges().size(), 1);
+        EXPECT(tracker.getRanges()[0] == (Range{ 0, 64000 }));
+        EXPECT_EQ(tracker.getDirtyByteCount(), 64000);
+
+        tracker.clear();
+        EXPECT(!tracker.isDirty());
+        EXPECT_EQ(tracker.getDirtyByteCount(), 0);
+    }
+
+    CPU_TEST(DirtyRangeTracker_Coalesce)
+    {
+        DirtyRangeTracker tracker;
+        tracker.markDirty(100, 10);
+        tracker.markDirty(0, 10);
+        tracker.markDirty(10, 5);   // Adjacent to [0,10)
+        tracker.markDirty(105, 20); // Overlaps [100,110)
+        tracker.markDirty(200, 0);  // Empty, ignored
+        tracker.markDirty(300, 8);
+
+        const auto& ranges = tracker.getRanges();
+        EXPECT_EQ(ranges.size(), 3);
+        EXPECT(ranges[0] == (Range{ 0, 15 }));
+        EXPECT(ranges[1] == (Range{ 100, 25 }));
+        EXPECT(ranges[2] == (Range{ 300, 8 }));
+
+        // Merging with a gap.
+        tracker.setMergeGap(85);
+        EXPECT_EQ(tracker.getRanges().size(), 2);
+        EXPECT(tracker.getRanges()[0] == (Range{ 0, 125 }));
+
+        // New ranges after coalescing.
+        tracker.markDirty(50, 400);
+        EXPECT_EQ(tracker.getRanges().size(), 1);
+        EXPECT(tracker.getRanges()[0] == (Range{ 0, 450 }));
+    }
+
+    CPU_TEST(DirtyRangeTracker_Random)
+    {
+        const size_t kSize = 4096;
+        std::mt19937 rng;
+
+        for (size_t mergeGap : { 0u, 1u, 16u })
+        {
+            DirtyRangeTracker tracker(mergeGap);
+            std::vector<bool> reference(kSize, false);
+
+            for (uint32_t i = 0; i < 200; i++)
+            {
+                size_t offset = rng() % kSize;
+                size_t size = std::min<size_t>(rng() % 32, kSize - offset);
+                tracker.markDirty(offset, size);
+                for (size_t j = offset; j < offset + size; j++) reference[j] = true;
+            }
+
+            // Ranges must be sorted, disjoint, separated by more than the merge gap and cover all dirty bytes.
+            const auto& ranges = tracker.getRanges();
+            std::vector<bool> covered(kSize, false);
+            for (size_t r = 0; r < ranges.size(); r++)
+            {
+                if (r > 0) EXPECT_GT(ranges[r].offset, ranges[r - 1].end() + mergeGap);
+                for (size_t j = ranges[r].offset; j < ranges[r].end(); j++) covered[j] = true;
+            }
+            for (size_t j = 0; j < kSize; j++)
+            {
+                if (reference[j]) EXPECT(covered[j]) << "byte " << j;
+                if (mergeGap == 0) EXPECT_EQ((bool)reference[j], (bool)covered[j]) << "byte " << j;
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <chrono>
+#include <thread>
+
+namespace Falcor
+{
+    CPU_TEST(LoggerRateLimit)
+    {
+        const Logger::Level prevVerbosity = Logger::getVerbosity();
+        Logger::setVerbosity(Logger::Level::Debug);
+        Logger::setRateLimit(Logger::Level::Debug, 10);
+
+        const uint64_t prevSuppressed = Logger::getSuppressedCount(Logger::Level::Debug);
+        for (uint32_t i = 0; i < 100; i++) logDebug("LoggerRateLimit message {}", i);
+        const uint64_t suppressed = Logger::getSuppressedCount(Logger::Level::Debug) - prevSuppressed;
+
+        // At most 10 messages pass per one second window, the loop may straddle two windows.
+        EXPECT_GE(suppressed, 80u);
+        EXPECT_LE(suppressed, 90u);
+
+        Logger::setRateLimit(Logger::Level::Debug, 0);
+        Logger::setVerbosity(prevVerbosity);
+        Logger::flush();
+    }
+
+    CPU_TEST(LoggerVerbosityFilter)
+    {
+        const Logger::Level prevVerbosity = Logger::getVerbosity();
+        Logger::setVerbosity(Logger::Level::Warning);
+        EXPECT(Logger::isLevelEnabled(Logger::Level::Error) == Logger::enabled());
+        EXPECT(Logger::isLevelEnabled(Logger::Level::Warning) == Logger::enabled());
+        EXPECT(!Logger::isLevelEnabled(Logger::Level::Info));
+
+        // Arguments are not formatted for filtered messages, so a mismatching format string does not throw.
+        bool threw = false;
+        try
+        {
+            logInfo("LoggerVerbosityFilter {} {}", 1);
+        }
+        catch (const std::exception&)
+        {
+            threw = true;
+        }
+        EXPECT(!threw);
+
+        Logger::setVerbosity(prevVerbosity);
+    }
+
+    CPU_TEST(LoggerBenchmark, "Benchmark, enable manually.")
+    {
+        const uint32_t threadCount = 16;
+        const uint32_t messagesPerThread = 100000;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([t]()
+            {
+                for (uint32_t i = 0; i < messagesPerThread; i++) logInfo("LoggerBenchmark thread {} message {}", t, i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        double logSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+        Logger::flush();
+        double totalSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        const double messageCount = (double)threadCount * messagesPerThread;
+        logInfo("Logged {} messages from {} threads: {:.0f} calls/s, {:.0f} messages/s written", messageCount, threadCount, messageCount / logSeconds, messageCount / totalSeconds);
+    }
+}
@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/MipGenerator.h"
+#include <chrono>
+
+namespace Falcor
+{
+    namespace
+    {
+        Bitmap::UniqueConstPtr createBitmap(uint32_t width, uint32_t height, ResourceFormat format, const std::function<uint8_t(uint32_t x, uint32_t y, uint32_t c)>& func)
+        {
+            const uint32_t channelCount = getFormatChannelCount(format);
+            std::vector<uint8_t> data((size_t)width * height * channelCount);
+            for (uint32_t y = 0; y < height; y++)
+            {
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    for (uint32_t c = 0; c < channelCount; c++) data[((size_t)y * width + x) * channelCount + c] = func(x, y, c);
+                }
+            }
+            return Bitmap::create(width, height, format, data.data());
+        }
+
+        float computeCoverage(const Bitmap& bitmap, float alphaCutoff)
+        {
+            const uint8_t* pData = bitmap.getData();
+            const size_t texelCount = (size_t)bitmap.getWidth() * bitmap.getHeight();
+            size_t count = 0;
+            for (size_t i = 0; i < texelCount; i++) count += pData[i * 4 + 3] / 255.f > alphaCutoff ? 1 : 0;
+            return (float)count / texelCount;
+        }
+    }
+
+    CPU_TEST(MipGeneratorChain)
+    {
+        EXPECT(MipGenerator::isFormatSupported(ResourceFormat::RGBA8Unorm));
+        EXPECT(MipGenerator::isFormatSupported(ResourceFormat::BGRA8UnormSrgb));
+        EXPECT(MipGenerator::isFormatSupported(ResourceFormat::RGBA16Float));
+        EXPECT(MipGenerator::isFormatSupported(ResourceFormat::R32Float));
+        EXPECT(!MipGenerator::isFormatSupported(ResourceFormat::BC1Unorm));
+        EXPECT(!MipGenerator::isFormatSupported(ResourceFormat::RGBA16Unorm));
+        EXPECT(!MipGenerator::isFormatSupported(ResourceFormat::R11G11B10Float));
+
+        // Non-power-of-two dimensions are rounded down for each level.
+        auto pBitmap = createBitmap(37, 10, ResourceFormat::RGBA8Unorm, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(x + y + c); });
+        auto mips = MipGenerator::generateMips(*pBitmap);
+        EXPECT_EQ(mips.size(), 6u);
+        const uint32_t expectedWidths[] = { 37, 18, 9, 4, 2, 1 };
+        const uint32_t expectedHeights[] = { 10, 5, 2, 1, 1, 1 };
+        for (size_t i = 0; i < mips.size(); i++)
+        {
+            EXPECT_EQ(mips[i]->getWidth(), expectedWidths[i]);
+            EXPECT_EQ(mips[i]->getHeight(), expectedHeights[i]);
+            EXPECT_EQ(mips[i]->getFormat(), ResourceFormat::RGBA8Unorm);
+        }
+        EXPECT_EQ(std::memcmp(mips[0]->getData(), pBitmap->getData(), pBitmap->getSize()), 0);
+
+        MipGenerator::Options options;
+        options.maxMipCount = 2;
+        EXPECT_EQ(MipGenerator::generateMips(*pBitmap, options).size(), 2u);
+    }
+
+    CPU_TEST(MipGeneratorFilters)
+    {
+        // A box filter averages 2x2 texels.
+        auto pBitmap = createBitmap(4, 4, ResourceFormat::R8Unorm, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(x * 10 + y * 40); });
+        auto mips = MipGenerator::generateMips(*pBitmap);
+        EXPECT_EQ(mips.size(), 3u);
+        const uint8_t* pMip1 = mips[1]->getData();
+        EXPECT_EQ(pMip1[0], 25u);
+        EXPECT_EQ(pMip1[1], 45u);
+        EXPECT_EQ(pMip1[2], 105u);
+        EXPECT_EQ(pMip1[3], 125u);
+        EXPECT_EQ(mips[2]->getData()[0], 75u);
+
+        // Constant images stay constant with all filters.
+        for (auto filter : { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser, MipGenerator::Filter::Lanczos })
+        {
+            MipGenerator::Options options;
+            options.filter = filter;
+            auto pConstant = createBitmap(33, 17, ResourceFormat::RGBA8UnormSrgb, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(50 + c * 60); });
+            for (const auto& pMip : MipGenerator::generateMips(*pConstant, options))
+            {
+                const uint8_t* pData = pMip->getData();
+                for (size_t i = 0; i < pMip->getSize(); i++) EXPECT_EQ(pData[i], 50u + (i % 4) * 60u) << "i = " << i;
+            }
+        }
+    }
+
+    CPU_TEST(MipGeneratorSrgb)
+    {
+        // Averaging black and white in linear space gives 188 in sRGB, not 128.
+        auto pBitmap = createBitmap(2, 1, ResourceFormat::RGBA8UnormSrgb, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(c == 3 || x == 0 ? 255 : 0); });
+        auto mips = MipGenerator::generateMips(*pBitmap);
+        EXPECT_EQ(mips.size(), 2u);
+        EXPECT_EQ(mips[1]->getData()[0], 188u);
+        EXPECT_EQ(mips[1]->getData()[3], 255u);
+
+        // The option enables linear filtering for formats that are not sRGB.
+        auto pLinear = createBitmap(2, 1, ResourceFormat::RGBA8Unorm, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(c == 3 || x == 0 ? 255 : 0); });
+        EXPECT_EQ(MipGenerator::generateMips(*pLinear)[1]->getData()[0], 128u);
+        MipGenerator::Options options;
+        options.srgb = true;
+        EXPECT_EQ(MipGenerator::generateMips(*pLinear, options)[1]->getData()[0], 188u);
+    }
+
+    CPU_TEST(MipGeneratorAlphaCoverage)
+    {
+        // Filtering random alpha values reduces the fraction of texels above a high cutoff.
+        const float alphaCutoff = 0.75f;
+        auto pBitmap = createBitmap(64, 64, ResourceFormat::RGBA8Unorm, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(c < 3 ? 255 : ((x * 73856093u) ^ (y * 19349663u)) * 2654435761u >> 24); });
+        const float coverage = computeCoverage(*pBitmap, alphaCutoff);
+
+        MipGenerator::Options options;
+        auto mips = MipGenerator::generateMips(*pBitmap, options);
+        EXPECT_LT(computeCoverage(*mips[2], alphaCutoff), 0.5f * coverage);
+
+        options.alphaCutoff = alphaCutoff;
+        mips = MipGenerator::generateMips(*pBitmap, options);
+        for (size_t i = 1; i < 4; i++)
+        {
+            EXPECT_LE(std::abs(computeCoverage(*mips[i], alphaCutoff) - coverage), 0.05f) << "mip = " << i;
+        }
+    }
+
+    CPU_TEST(MipGeneratorBenchmark, "Benchmark, enable manually.")
+    {
+        const uint32_t size = 4096;
+        auto pBitmap = createBitmap(size, size, ResourceFormat::RGBA8UnormSrgb, [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)((x * 7 + y * 13 + c * 31) & 0xff); });
+
+        for (auto filter : { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser, MipGenerator::Filter::Lanczos })
+        {
+            MipGenerator::Options options;
+            options.filter = filter;
+            options.alphaCutoff = 0.5f;
+
+            auto startTime = std::chrono::high_resolution_clock::now();
+            auto mips = MipGenerator::generateMips(*pBitmap, options);
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            logInfo("Filter {}: {} mips of {}x{} in {:.3f} s, {:.1f} MTexels/s", (uint32_t)filter, mips.size(), size, size, seconds, (double)size * size / seconds * 1e-6);
+        }
+    }
+}
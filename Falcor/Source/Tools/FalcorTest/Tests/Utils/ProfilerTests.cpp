@@ -0,0 +1,126 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include <thread>
+
+namespace Falcor
+{
+    CPU_TEST(ProfilerTraceThreads)
+    {
+        Profiler& profiler = Profiler::instance();
+        const bool wasEnabled = profiler.isEnabled();
+
+        profiler.startCapture();
+        profiler.startAsyncEvent("task", 1);
+        profiler.startFlow("task", 1);
+
+        std::thread worker([&profiler]()
+        {
+            profiler.setThreadName("ProfilerTestWorker");
+            profiler.startEvent("work");
+            profiler.endFlow("task", 1);
+            profiler.startEvent("nested");
+            profiler.endEvent("nested");
+            profiler.endEvent("work");
+            profiler.endAsyncEvent("task", 1);
+        });
+        worker.join();
+
+        auto pCapture = profiler.endCapture();
+        profiler.setEnabled(wasEnabled);
+        EXPECT(pCapture != nullptr);
+        if (!pCapture) return;
+
+        // The worker's events are recorded in order on its own track.
+        const Profiler::TraceThread* pWorkerThread = nullptr;
+        const Profiler::TraceThread* pMainThread = nullptr;
+        for (const auto& thread : pCapture->getTraceThreads())
+        {
+            if (thread.name == "ProfilerTestWorker") pWorkerThread = &thread;
+            if (thread.name == "Main") pMainThread = &thread;
+        }
+        EXPECT(pWorkerThread != nullptr);
+        EXPECT(pMainThread != nullptr);
+        if (!pWorkerThread || !pMainThread) return;
+
+        using Type = Profiler::TraceEvent::Type;
+        const std::vector<std::pair<Type, std::string>> expected =
+        {
+            { Type::Begin, "work" }, { Type::FlowEnd, "task" }, { Type::Begin, "nested" }, { Type::End, "nested" }, { Type::End, "work" }, { Type::AsyncEnd, "task" },
+        };
+        EXPECT_EQ(pWorkerThread->events.size(), expected.size());
+        if (pWorkerThread->events.size() != expected.size()) return;
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            const auto& event = pWorkerThread->events[i];
+            EXPECT(event.type == expected[i].first) << "event " << i;
+            EXPECT_EQ(event.name, expected[i].second) << "event " << i;
+            if (i > 0) EXPECT_GE(event.timestamp, pWorkerThread->events[i - 1].timestamp);
+        }
+
+        bool hasAsyncBegin = false;
+        for (const auto& event : pMainThread->events)
+        {
+            if (event.type == Type::AsyncBegin && event.name == "task" && event.id == 1) hasAsyncBegin = true;
+        }
+        EXPECT(hasAsyncBegin);
+
+        // The Chrome trace names the thread tracks and contains the async and flow events.
+        const std::string trace = pCapture->toChromeTraceString();
+        EXPECT(trace.find("\"traceEvents\"") != std::string::npos);
+        EXPECT(trace.find("\"thread_name\"") != std::string::npos);
+        EXPECT(trace.find("\"ProfilerTestWorker\"") != std::string::npos);
+        EXPECT(trace.find("\"ph\":\"b\"") != std::string::npos);
+        EXPECT(trace.find("\"ph\":\"f\"") != std::string::npos);
+    }
+
+    CPU_TEST(ProfilerTraceNotRecordedOutsideCapture)
+    {
+        Profiler& profiler = Profiler::instance();
+        const bool wasEnabled = profiler.isEnabled();
+
+        // Events recorded before the capture starts are not part of the capture.
+        std::thread([&profiler]()
+        {
+            profiler.setThreadName("ProfilerTestIdleWorker");
+            profiler.startEvent("idle");
+            profiler.endEvent("idle");
+        }).join();
+
+        profiler.startCapture();
+        auto pCapture = profiler.endCapture();
+        profiler.setEnabled(wasEnabled);
+        EXPECT(pCapture != nullptr);
+        if (!pCapture) return;
+
+        for (const auto& thread : pCapture->getTraceThreads())
+        {
+            EXPECT_NE(thread.name, "ProfilerTestIdleWorker");
+        }
+    }
+}
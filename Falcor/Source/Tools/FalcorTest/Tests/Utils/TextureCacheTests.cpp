@@ -0,0 +1,135 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureCache.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        std::filesystem::path getTestImagePath()
+        {
+            std::string fullPath;
+            if (!findFileInDataDirectories("texture2.png", fullPath)) throw RuntimeError("Can't find test image.");
+            return fullPath;
+        }
+
+        std::filesystem::path copyToTemp(const std::filesystem::path& path, const std::string& name)
+        {
+            auto tempPath = std::filesystem::temp_directory_path() / name;
+            std::filesystem::copy_file(path, tempPath, std::filesystem::copy_options::overwrite_existing);
+            return tempPath;
+        }
+    }
+
+    CPU_TEST(TextureCacheHash)
+    {
+        const auto path = getTestImagePath();
+        const auto copyPath = copyToTemp(path, "TextureCacheHashCopy.png");
+
+        TextureCache::Hash hash, copyHash, otherHash;
+        EXPECT(TextureCache::hashFile(path, hash));
+        EXPECT(TextureCache::hashFile(copyPath, copyHash));
+        EXPECT(hash == copyHash);
+
+        std::string otherPath;
+        EXPECT(findFileInDataDirectories("texture3.png", otherPath));
+        EXPECT(TextureCache::hashFile(otherPath, otherHash));
+        EXPECT(hash != otherHash);
+
+        EXPECT(!TextureCache::hashFile(std::filesystem::temp_directory_path() / "TextureCacheMissingFile.png", otherHash));
+
+        // The cache path depends on all settings affecting the cached data.
+        TextureCache::Options options;
+        const auto cachePath = TextureCache::getCachePath(hash, true, false, options);
+        EXPECT(cachePath == TextureCache::getCachePath(copyHash, true, false, options));
+        EXPECT(cachePath != TextureCache::getCachePath(hash, false, false, options));
+        EXPECT(cachePath != TextureCache::getCachePath(hash, true, true, options));
+        options.compression = ImageIO::CompressionMode::BC7;
+        EXPECT(cachePath != TextureCache::getCachePath(hash, true, false, options));
+
+        EXPECT(TextureCache::isCacheable(path, Resource::BindFlags::ShaderResource));
+        EXPECT(!TextureCache::isCacheable(path, Resource::BindFlags::ShaderResource | Resource::BindFlags::UnorderedAccess));
+        EXPECT(!TextureCache::isCacheable("texture.DDS", Resource::BindFlags::ShaderResource));
+
+        std::filesystem::remove(copyPath);
+    }
+
+    CPU_TEST(TextureCacheWrite)
+    {
+        const auto path = getTestImagePath();
+        const auto cachePath = std::filesystem::temp_directory_path() / "TextureCacheWrite.dds";
+        std::filesystem::remove(cachePath);
+
+        EXPECT(TextureCache::writeCacheFile(path, cachePath, true, false, TextureCache::Options()));
+        EXPECT(std::filesystem::exists(cachePath));
+
+        auto pSource = Bitmap::createFromFile(path.string(), true);
+        auto pCached = ImageIO::loadBitmapFromDDS(cachePath.string());
+        EXPECT(pSource != nullptr && pCached != nullptr);
+        if (pSource && pCached)
+        {
+            EXPECT_EQ(pCached->getWidth(), pSource->getWidth());
+            EXPECT_EQ(pCached->getHeight(), pSource->getHeight());
+        }
+
+        std::filesystem::remove(cachePath);
+    }
+
+    GPU_TEST(TextureManagerDeduplicate)
+    {
+        const auto path = getTestImagePath();
+        const auto copyPath = copyToTemp(path, "TextureManagerDeduplicateCopy.png");
+
+        auto pManager = TextureManager::create(16, 1);
+        TextureCache::Options options;
+        options.useDiskCache = false;
+        pManager->setTextureCacheOptions(options);
+
+        auto handle = pManager->loadTexture(path.string(), true, false, Resource::BindFlags::ShaderResource, false);
+        auto copyHandle = pManager->loadTexture(copyPath.string(), true, false, Resource::BindFlags::ShaderResource, false);
+        auto srgbHandle = pManager->loadTexture(copyPath.string(), true, true, Resource::BindFlags::ShaderResource, false);
+        EXPECT(handle.isValid());
+        EXPECT(handle == copyHandle);
+        EXPECT(!(handle == srgbHandle));
+
+        // Removing the texture removes all paths referring to it.
+        pManager->removeTexture(handle);
+        auto newHandle = pManager->loadTexture(copyPath.string(), true, false, Resource::BindFlags::ShaderResource, false);
+        EXPECT(pManager->getTexture(newHandle) != nullptr);
+
+        // Without deduplication each path has its own texture.
+        options.deduplicate = false;
+        pManager->setTextureCacheOptions(options);
+        auto otherHandle = pManager->loadTexture(path.string(), true, false, Resource::BindFlags::ShaderResource, false);
+        EXPECT(!(otherHandle == newHandle));
+
+        pManager.reset();
+        std::filesystem::remove(copyPath);
+    }
+}
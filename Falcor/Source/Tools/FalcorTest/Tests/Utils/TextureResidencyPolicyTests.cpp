@@ -0,0 +1,150 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TextureResidencyPolicy.h"
+
+namespace Falcor
+{
+    namespace
+    {
+        // Mip sizes of a 8x8 texture with 1 byte per texel.
+        const std::vector<uint64_t> kMipSizes = { 64, 16, 4, 1 };
+        const uint64_t kTextureSize = 85;
+
+        TextureResidencyPolicy::Options createOptions(uint64_t budget)
+        {
+            TextureResidencyPolicy::Options options;
+            options.budget = budget;
+            options.evictionFrameCount = 10;
+            options.maxDroppedMipCount = 2;
+            return options;
+        }
+    }
+
+    CPU_TEST(TextureResidencyPolicyUnlimited)
+    {
+        TextureResidencyPolicy policy;
+        for (uint32_t id = 0; id < 3; id++) policy.addTexture(id, kMipSizes, 3, 0);
+
+        EXPECT_EQ(policy.getTextureCount(), 3u);
+        EXPECT(policy.update(100).empty());
+        EXPECT_EQ(policy.getResidentBytes(), 3 * kTextureSize);
+        EXPECT_EQ(policy.getEvictedBytes(), 0u);
+
+        policy.removeTexture(1);
+        EXPECT_EQ(policy.getTextureCount(), 2u);
+        EXPECT_EQ(policy.getResidentBytes(), 2 * kTextureSize);
+    }
+
+    CPU_TEST(TextureResidencyPolicyEvictUnused)
+    {
+        TextureResidencyPolicy policy;
+        policy.setOptions(createOptions(200));
+        for (uint32_t id = 0; id < 3; id++) policy.addTexture(id, kMipSizes, 3, 0);
+
+        // Over budget, but all textures were used recently.
+        policy.markUsed(1, 5);
+        policy.markUsed(2, 5);
+        auto changes = policy.update(5);
+        EXPECT_EQ(changes.size(), 1u);
+        EXPECT_EQ(policy.getResidentBytes(), 3 * kTextureSize - 64);
+
+        // Texture 0 has not been used for 20 frames and is evicted instead of dropping mip levels of the textures in use.
+        policy.markUsed(1, 20);
+        policy.markUsed(2, 20);
+        changes = policy.update(20);
+        EXPECT(policy.isEvicted(0));
+        EXPECT_EQ(policy.getDroppedMipCount(0), 3u);
+        EXPECT_EQ(policy.getDroppedMipCount(1), 0u);
+        EXPECT_EQ(policy.getDroppedMipCount(2), 0u);
+        EXPECT_EQ(policy.getResidentBytes(), 2 * kTextureSize + 1);
+        EXPECT_EQ(policy.getEvictedBytes(), kTextureSize - 1);
+
+        // Using the evicted texture again restores it if the budget allows it.
+        policy.setOptions(createOptions(1000));
+        policy.markUsed(0, 21);
+        changes = policy.update(21);
+        EXPECT_EQ(changes.size(), 1u);
+        if (changes.size() == 1)
+        {
+            EXPECT_EQ(changes[0].id, 0u);
+            EXPECT_EQ(changes[0].droppedMipCount, 0u);
+        }
+        EXPECT_EQ(policy.getResidentBytes(), 3 * kTextureSize);
+    }
+
+    CPU_TEST(TextureResidencyPolicyDropMips)
+    {
+        TextureResidencyPolicy policy;
+        policy.setOptions(createOptions(100));
+        for (uint32_t id = 0; id < 3; id++) policy.addTexture(id, kMipSizes, 3, 0);
+
+        // All textures are in use, the most detailed mip level is dropped from each of them.
+        for (uint32_t id = 0; id < 3; id++) policy.markUsed(id, 1);
+        auto changes = policy.update(1);
+        EXPECT_EQ(changes.size(), 3u);
+        for (uint32_t id = 0; id < 3; id++) EXPECT_EQ(policy.getDroppedMipCount(id), 1u);
+        EXPECT_EQ(policy.getResidentBytes(), 3 * (kTextureSize - 64));
+
+        // Least recently used textures are downgraded first.
+        policy.setOptions(createOptions(55));
+        policy.markUsed(0, 2);
+        policy.markUsed(2, 2);
+        changes = policy.update(2);
+        EXPECT_EQ(changes.size(), 1u);
+        EXPECT_EQ(policy.getDroppedMipCount(0), 1u);
+        EXPECT_EQ(policy.getDroppedMipCount(1), 2u);
+        EXPECT_EQ(policy.getDroppedMipCount(2), 1u);
+        EXPECT_EQ(policy.getResidentBytes(), 2u * 21u + 5u);
+
+        // Textures that can't drop mip levels, e.g., due to block compression, are left as they are.
+        policy.addTexture(3, kMipSizes, 0, 2);
+        policy.markUsed(3, 2);
+        policy.update(2);
+        EXPECT_EQ(policy.getDroppedMipCount(3), 0u);
+    }
+
+    CPU_TEST(TextureResidencyPolicyEvictNotInFrame)
+    {
+        TextureResidencyPolicy policy;
+        policy.setOptions(createOptions(10));
+        for (uint32_t id = 0; id < 3; id++) policy.addTexture(id, kMipSizes, 3, 0);
+
+        // Dropping the maximum number of mip levels is not sufficient, so textures not used in the current frame are evicted.
+        policy.markUsed(0, 40);
+        policy.markUsed(1, 40);
+        policy.markUsed(2, 39);
+        policy.update(40);
+        EXPECT_EQ(policy.getDroppedMipCount(0), 2u);
+        EXPECT_EQ(policy.getDroppedMipCount(1), 2u);
+        EXPECT(policy.isEvicted(2));
+
+        // Textures used in the current frame are never evicted, even if that exceeds the budget.
+        EXPECT_EQ(policy.getResidentBytes(), 2u * 5u + 1u);
+    }
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Falcor.h"
+#include "Scene/SDFs/SDFGridFile.h"
+#include <args.hxx>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace Falcor;
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Utility to convert SDF grid files from the legacy format of uncompressed floats to compressed SDF grid files.");
+    parser.helpParams.programName = "SDFGridConverter";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<uint32_t> bitsFlag(parser, "bits", "Bits per quantized value, 8 or 16 (default 8).", {'b', "bits"});
+    args::ValueFlag<float> thicknessFlag(parser, "thickness", "Largest stored distance in half voxel diagonals (default 1).", {'t', "thickness"});
+    args::Positional<std::string> inputFile(parser, "input", "The legacy SDF grid file.", args::Options::Required);
+    args::Positional<std::string> outputFile(parser, "output", "The compressed SDF grid file to write.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    SDFGridFile::Options options;
+    if (bitsFlag) options.bitsPerValue = args::get(bitsFlag);
+    if (thicknessFlag) options.narrowBandThickness = args::get(thicknessFlag);
+
+    if (options.bitsPerValue != 8 && options.bitsPerValue != 16)
+    {
+        std::cerr << "Bits per value must be 8 or 16." << std::endl;
+        return 1;
+    }
+    if (!(options.narrowBandThickness > 0.f))
+    {
+        std::cerr << "Thickness must be positive." << std::endl;
+        return 1;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    const bool converted = SDFGridFile::convertLegacyFile(args::get(inputFile), args::get(outputFile), options);
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    // Write the queued log messages while the logger thread is still running.
+    Logger::shutdown();
+
+    if (!converted)
+    {
+        std::cerr << "Failed to convert '" << args::get(inputFile) << "'." << std::endl;
+        return 1;
+    }
+
+    const size_t inputSize = std::filesystem::file_size(args::get(inputFile));
+    const size_t outputSize = std::filesystem::file_size(args::get(outputFile));
+    std::cout << "Converted '" << args::get(inputFile) << "' (" << inputSize << " bytes) to '" << args::get(outputFile) << "' (" << outputSize << " bytes)"
+        << " in " << seconds << " s, compression ratio " << double(inputSize) / double(outputSize) << "." << std::endl;
+
+    return 0;
+}
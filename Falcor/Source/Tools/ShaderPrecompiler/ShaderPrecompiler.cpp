@@ -0,0 +1,202 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ShaderPrecompiler.h"
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+
+#include <args.hxx>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef FALCOR_D3D12
+FALCOR_EXPORT_D3D12_AGILITY_SDK
+#endif
+
+/** Global to hold return code.
+    The instance of ShaderPrecompiler is destroyed before leaving Sample::run().
+*/
+static int sReturnCode = 1;
+
+void ShaderPrecompiler::loadDefines()
+{
+    std::string fullpath;
+    if (!findFileInDataDirectories(mOptions.definesFile, fullpath)) throw RuntimeError("Can't find defines file '{}'.", mOptions.definesFile);
+
+    rapidjson::Document document;
+    document.Parse(readFile(fullpath).c_str());
+    if (document.HasParseError())
+    {
+        throw RuntimeError("Failed to parse defines file '{}': {}", fullpath, rapidjson::GetParseError_En(document.GetParseError()));
+    }
+    if (!document.IsObject()) throw RuntimeError("Defines file '{}' must contain a JSON object.", fullpath);
+
+    // The snapshot maps define names to values, which may be strings, numbers or booleans.
+    Program::DefineList defines;
+    for (const auto& member : document.GetObject())
+    {
+        const auto& value = member.value;
+        std::string str;
+        if (value.IsString()) str = value.GetString();
+        else if (value.IsBool()) str = value.GetBool() ? "1" : "0";
+        else if (value.IsInt64()) str = std::to_string(value.GetInt64());
+        else if (value.IsNumber()) str = std::to_string(value.GetDouble());
+        else throw RuntimeError("Define '{}' in '{}' has an unsupported value type.", member.name.GetString(), fullpath);
+        defines.add(member.name.GetString(), str);
+    }
+
+    Program::addGlobalDefines(defines);
+    logInfo("Added {} global defines from '{}'.", defines.size(), fullpath);
+}
+
+void ShaderPrecompiler::load()
+{
+    mpShaderCache = ShaderCache::create();
+    if (mOptions.append && std::filesystem::exists(mOptions.outputFile))
+    {
+        mpShaderCache->merge(*ShaderCache::createFromFile(mOptions.outputFile));
+    }
+    Program::setShaderCache(mpShaderCache);
+
+    if (!mOptions.definesFile.empty()) loadDefines();
+
+    if (!mOptions.sceneFile.empty())
+    {
+        mpScene = SceneBuilder::create(mOptions.sceneFile)->getScene();
+    }
+
+    for (const auto& graphFile : mOptions.graphFiles)
+    {
+        auto graphs = RenderGraphImporter::importAllGraphs(graphFile);
+        if (graphs.empty()) throw RuntimeError("No render graphs found in '{}'.", graphFile);
+        mGraphs.insert(mGraphs.end(), graphs.begin(), graphs.end());
+    }
+}
+
+void ShaderPrecompiler::onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
+{
+    try
+    {
+#ifndef FALCOR_D3D12
+        throw RuntimeError("The shader cache only supports the D3D12 backend.");
+#endif
+        load();
+
+        // Compiling a graph collects the programs of its passes using RenderPass::collectPrograms() and compiles them
+        // with Program::compilePrograms(). Kernels of programs without specialization parameters are compiled from the
+        // program reflection alone. The graphs are never executed.
+        for (const auto& pGraph : mGraphs)
+        {
+            size_t entryCount = mpShaderCache->getEntryCount();
+            auto prevStats = Program::getGlobalCompilationStats();
+
+            pGraph->setScene(mpScene);
+            pGraph->onResize(pTargetFbo.get());
+            std::string log;
+            if (!pGraph->compile(pRenderContext, log)) throw RuntimeError("Failed to compile render graph '{}':\n{}", pGraph->getName(), log);
+
+            const auto& stats = Program::getGlobalCompilationStats();
+            std::cout << pGraph->getName() << ": " << stats.programVersionCount - prevStats.programVersionCount << " programs, "
+                << stats.programKernelsCount - prevStats.programKernelsCount << " kernel sets, "
+                << mpShaderCache->getEntryCount() - entryCount << " cache entries" << std::endl;
+        }
+
+        mpShaderCache->writeToFile(mOptions.outputFile);
+        std::cout << "Wrote " << mpShaderCache->getEntryCount() << " cache entries to '" << mOptions.outputFile << "'." << std::endl;
+        sReturnCode = 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+    }
+
+    Program::setShaderCache(nullptr);
+    gpFramework->shutdown();
+}
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Compiles the shader kernels used by render graphs into a shader cache bundle, without executing the graphs.");
+    parser.helpParams.programName = "ShaderPrecompiler";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> outputFlag(parser, "path", "Shader cache bundle to write.", {'o', "output"}, args::Options::Required);
+    args::ValueFlag<std::string> sceneFlag(parser, "path", "Scene file to compile the graphs for.", {'S', "scene"});
+    args::ValueFlag<std::string> definesFlag(parser, "path", "JSON file with global shader defines (a snapshot of the deployment's scene defines).", {'d', "defines"});
+    args::Flag appendFlag(parser, "", "Add to the kernels in an existing bundle.", {'a', "append"});
+    args::Flag enableDebugLayer(parser, "", "Enable debug layer (enabled by default in Debug build).", {"enable-debug-layer"});
+    args::PositionalList<std::string> graphsArg(parser, "graphs", "Render graph scripts.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    ShaderPrecompiler::Options options;
+    options.graphFiles = args::get(graphsArg);
+    options.outputFile = args::get(outputFlag);
+    if (sceneFlag) options.sceneFile = args::get(sceneFlag);
+    if (definesFlag) options.definesFile = args::get(definesFlag);
+    options.append = appendFlag;
+
+    ShaderPrecompiler::UniquePtr pRenderer = std::make_unique<ShaderPrecompiler>(options);
+    SampleConfig config;
+    config.windowDesc.title = "ShaderPrecompiler";
+    config.windowDesc.mode = Window::WindowMode::Minimized;
+    config.windowDesc.width = config.windowDesc.height = 2;
+    config.suppressInput = true;
+    config.showMessageBoxOnError = false;
+    // Kernels are compiled by the CPU, so the device is only needed to create the program objects.
+    config.deviceDesc.useSoftwareAdapter = true;
+    if (enableDebugLayer) config.deviceDesc.enableDebugLayer = true;
+    Sample::run(config, pRenderer, argc, argv);
+    return sReturnCode;
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** Tool compiling the shader kernels used by render graphs ahead of time.
+    The render graphs are compiled but not executed. Graph compilation enumerates the programs of all passes using
+    RenderPass::collectPrograms() and compiles them, and all kernels compiled along the way are written to a shader
+    cache bundle, which can then be loaded using Program::setShaderCache().
+    The device is created on the WARP software adapter, as it is only needed to create the program objects.
+    Kernels of programs with specialization parameters are only compiled if the pass provides its variables.
+    Bundles hold DXIL kernels only, as the GFX backend (SPIR-V) does not use the shader cache.
+*/
+class ShaderPrecompiler : public IRenderer
+{
+public:
+    struct Options
+    {
+        std::vector<std::string> graphFiles;    ///< Render graph scripts.
+        std::string sceneFile;                  ///< Optional scene to compile the graphs for.
+        std::string definesFile;                ///< Optional JSON file with global defines.
+        std::string outputFile;                 ///< Shader cache bundle to write.
+        bool append = false;                    ///< Add to the kernels in an existing bundle.
+    };
+
+    ShaderPrecompiler(const Options& options) : mOptions(options) {}
+
+    void onFrameRender(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo) override;
+
+private:
+    void load();
+    void loadDefines();
+
+    Options mOptions;
+    ShaderCache::SharedPtr mpShaderCache;
+    Scene::SharedPtr mpScene;
+    std::vector<RenderGraph::SharedPtr> mGraphs;
+};
@@ -0,0 +1,212 @@
+/***************************************************************************
+ # Copyright (c) 2015-21, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Falcor.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Image/MipGenerator.h"
+#include <args.hxx>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace Falcor;
+
+namespace
+{
+    const std::map<std::string, ImageIO::CompressionMode> kCompressionModes =
+    {
+        { "BC1", ImageIO::CompressionMode::BC1 },
+        { "BC2", ImageIO::CompressionMode::BC2 },
+        { "BC3", ImageIO::CompressionMode::BC3 },
+        { "BC4", ImageIO::CompressionMode::BC4 },
+        { "BC5", ImageIO::CompressionMode::BC5 },
+        { "BC6", ImageIO::CompressionMode::BC6 },
+        { "BC7", ImageIO::CompressionMode::BC7 },
+        { "None", ImageIO::CompressionMode::None },
+    };
+
+    const std::map<std::string, MipGenerator::Filter> kMipFilters =
+    {
+        { "box", MipGenerator::Filter::Box },
+        { "kaiser", MipGenerator::Filter::Kaiser },
+        { "lanczos", MipGenerator::Filter::Lanczos },
+    };
+
+    const std::string kImageExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".tif", ".tiff", ".exr", ".hdr" };
+
+    bool isImageFile(const std::filesystem::path& path)
+    {
+        for (const auto& ext : kImageExtensions)
+        {
+            if (hasSuffix(path.string(), ext, false)) return true;
+        }
+        return false;
+    }
+
+    struct ConvertOptions
+    {
+        ImageIO::CompressionMode mode = ImageIO::CompressionMode::BC7;
+        bool generateMips = false;
+        MipGenerator::Options mipOptions;
+    };
+
+    void convertFile(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, const ConvertOptions& options)
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(inputPath.string(), true);
+        if (!pBitmap) throw RuntimeError("Failed to load image.");
+
+        std::error_code ec;
+        std::filesystem::create_directories(outputPath.parent_path(), ec);
+
+        if (options.generateMips)
+        {
+            ImageIO::saveToDDS(outputPath.string(), MipGenerator::generateMips(*pBitmap, options.mipOptions), options.mode);
+        }
+        else
+        {
+            ImageIO::saveToDDS(outputPath.string(), *pBitmap, options.mode);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    args::ArgumentParser parser("Utility to convert images to DDS files with block compression.\nIf the input is a directory, all images in its directory tree are converted, preserving the relative paths.");
+    parser.helpParams.programName = "TextureConverter";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::MapFlag<std::string, ImageIO::CompressionMode> modeFlag(parser, "mode", "Compression mode: BC1-BC7 or None (default BC7).", {'m', "mode"}, kCompressionModes);
+    args::Flag mipsFlag(parser, "mips", "Generate the full mip chain.", {"mips"});
+    args::MapFlag<std::string, MipGenerator::Filter> filterFlag(parser, "filter", "Mip filter: box, kaiser or lanczos (default box).", {'f', "filter"}, kMipFilters);
+    args::Flag srgbFlag(parser, "srgb", "Filter mips in linear space, assuming sRGB encoded images.", {"srgb"});
+    args::ValueFlag<float> alphaCutoffFlag(parser, "cutoff", "Preserve the alpha test coverage of mips for the given alpha cutoff.", {"alpha-cutoff"});
+    args::Flag skipExistingFlag(parser, "skip-existing", "Skip images whose output file is newer than the image.", {"skip-existing"});
+    args::Positional<std::string> inputArg(parser, "input", "Image file or directory of images.", args::Options::Required);
+    args::Positional<std::string> outputArg(parser, "output", "DDS file or output directory.", args::Options::Required);
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    ConvertOptions options;
+    if (modeFlag) options.mode = args::get(modeFlag);
+    options.generateMips = mipsFlag;
+    if (filterFlag) options.mipOptions.filter = args::get(filterFlag);
+    options.mipOptions.srgb = srgbFlag;
+    if (alphaCutoffFlag) options.mipOptions.alphaCutoff = args::get(alphaCutoffFlag);
+
+    // Collect the files to convert.
+    const std::filesystem::path inputPath = args::get(inputArg);
+    const std::filesystem::path outputPath = args::get(outputArg);
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> files;
+    if (std::filesystem::is_directory(inputPath))
+    {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(inputPath))
+        {
+            if (!entry.is_regular_file() || !isImageFile(entry.path())) continue;
+            auto outputFile = outputPath / std::filesystem::relative(entry.path(), inputPath);
+            outputFile.replace_extension(".dds");
+            files.emplace_back(entry.path(), outputFile);
+        }
+        std::sort(files.begin(), files.end());
+    }
+    else if (std::filesystem::exists(inputPath))
+    {
+        files.emplace_back(inputPath, outputPath);
+    }
+    else
+    {
+        std::cerr << "Input '" << inputPath.string() << "' does not exist." << std::endl;
+        return 1;
+    }
+
+    // Convert the files one by one. The block compression of each image runs in parallel.
+    size_t failedCount = 0;
+    size_t skippedCount = 0;
+    auto totalStartTime = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const auto& [inputFile, outputFile] = files[i];
+        std::cout << "[" << (i + 1) << "/" << files.size() << "] " << inputFile.string() << " -> " << outputFile.string();
+
+        if (skipExistingFlag && std::filesystem::exists(outputFile) && std::filesystem::last_write_time(outputFile) >= std::filesystem::last_write_time(inputFile))
+        {
+            std::cout << " (skipped)" << std::endl;
+            skippedCount++;
+            continue;
+        }
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            convertFile(inputFile, outputFile, options);
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            std::cout << " (" << seconds << " s)" << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << " failed: " << e.what() << std::endl;
+            failedCount++;
+        }
+    }
+    double totalSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - totalStartTime).count();
+
+    std::cout << "Converted " << (files.size() - failedCount - skippedCount) << " of " << files.size() << " images in " << totalSeconds << " s";
+    if (skippedCount > 0) std::cout << ", skipped " << skippedCount;
+    if (failedCount > 0) std::cout << ", " << failedCount << " failed";
+    std::cout << "." << std::endl;
+
+    // Write the queued log messages while the logger thread is still running.
+    Logger::shutdown();
+
+    return failedCount > 0 ? 1 : 0;
+}